@@ -0,0 +1,162 @@
+package com.esw.postureanalyzer.views;
+
+import android.content.Context;
+import android.graphics.Bitmap;
+import android.graphics.Canvas;
+import android.util.Log;
+import android.view.View;
+
+import androidx.test.ext.junit.runners.AndroidJUnit4;
+import androidx.test.platform.app.InstrumentationRegistry;
+
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.Locale;
+import java.util.Random;
+
+import static org.junit.Assert.*;
+
+/**
+ * Instrumented rendering benchmark for the calendar heatmap. A year of days
+ * is scrolled through a phone-sized viewport, once redrawing every cell per
+ * frame (drawLayer, the path before CachedLayerView) and once through
+ * View.draw(), which replays the recorded Picture. Results go to logcat
+ * under "HeatmapRenderBenchmark".
+ */
+@RunWith(AndroidJUnit4.class)
+public class HeatmapRenderBenchmarkTest {
+    private static final String TAG = "HeatmapRenderBenchmark";
+    private static final int WIDTH = 1080;
+    private static final int VIEWPORT_HEIGHT = 1920;
+    private static final int DAYS = 365;
+    private static final int WARMUP_FRAMES = 20;
+    private static final int FRAMES = 120;
+    private static final int SCROLL_STEP = 64;
+
+    @Test
+    public void scrollingAYear() {
+        InstrumentationRegistry.getInstrumentation().runOnMainSync(this::runBenchmark);
+    }
+
+    private void runBenchmark() {
+        Context context = InstrumentationRegistry.getInstrumentation().getTargetContext();
+        PostureHeatmapView view = new PostureHeatmapView(context, null);
+        float[] scores = yearOfScores();
+        List<PostureHeatmapView.DayData> days = new ArrayList<>();
+        for (int i = 0; i < DAYS; i++) {
+            days.add(new PostureHeatmapView.DayData(i * 86_400_000L, scores[i], 1, "day " + i));
+        }
+        view.setData(days);
+        view.measure(View.MeasureSpec.makeMeasureSpec(WIDTH, View.MeasureSpec.EXACTLY),
+                View.MeasureSpec.makeMeasureSpec(0, View.MeasureSpec.UNSPECIFIED));
+        int contentHeight = view.getMeasuredHeight();
+        view.layout(0, 0, WIDTH, contentHeight);
+        int maxScroll = contentHeight - VIEWPORT_HEIGHT;
+        assertTrue("content shorter than the viewport", maxScroll > 0);
+
+        Bitmap frame = Bitmap.createBitmap(WIDTH, VIEWPORT_HEIGHT, Bitmap.Config.ARGB_8888);
+        Canvas canvas = new Canvas(frame);
+        HeatmapLayout layout = HeatmapLayout.calendar(WIDTH, scores);
+
+        // Old path: lay out and draw every cell on every frame
+        long[] redrawNs = new long[FRAMES];
+        for (int f = -WARMUP_FRAMES; f < FRAMES; f++) {
+            int scrollY = scrollOffset(f, maxScroll);
+            long start = System.nanoTime();
+            canvas.save();
+            canvas.translate(0, -scrollY);
+            view.drawLayer(canvas, WIDTH, contentHeight);
+            canvas.restore();
+            if (f >= 0) {
+                redrawNs[f] = System.nanoTime() - start;
+            }
+        }
+        assertVisibleCellsPainted(frame, layout, scrollOffset(FRAMES - 1, maxScroll));
+
+        // View path: the first draw records the Picture, later ones replay it
+        frame.eraseColor(0);
+        long recordStart = System.nanoTime();
+        view.draw(canvas);
+        long recordNs = System.nanoTime() - recordStart;
+
+        long[] cachedNs = new long[FRAMES];
+        for (int f = -WARMUP_FRAMES; f < FRAMES; f++) {
+            int scrollY = scrollOffset(f, maxScroll);
+            long start = System.nanoTime();
+            canvas.save();
+            canvas.translate(0, -scrollY);
+            view.draw(canvas);
+            canvas.restore();
+            if (f >= 0) {
+                cachedNs[f] = System.nanoTime() - start;
+            }
+        }
+        assertVisibleCellsPainted(frame, layout, scrollOffset(FRAMES - 1, maxScroll));
+
+        Log.i(TAG, String.format(Locale.US, "Calendar heatmap, %d days, %dx%d viewport over %d px",
+                DAYS, WIDTH, VIEWPORT_HEIGHT, contentHeight));
+        Log.i(TAG, "Redraw every frame: " + summarize(redrawNs));
+        Log.i(TAG, String.format(Locale.US, "Recorded layer: %s (first draw %.2f ms)",
+                summarize(cachedNs), recordNs / 1e6));
+
+        // Loose bound: the point is the logged numbers, not a tight gate
+        assertTrue("Picture replay slower than redrawing",
+                median(cachedNs) <= median(redrawNs) * 1.5);
+    }
+
+    private static float[] yearOfScores() {
+        Random random = new Random(42);
+        float[] scores = new float[DAYS];
+        for (int i = 0; i < DAYS; i++) {
+            scores[i] = random.nextFloat() * 100f;
+        }
+        return scores;
+    }
+
+    /**
+     * Scroll down and back up through the content
+     */
+    private static int scrollOffset(int frame, int maxScroll) {
+        int period = 2 * maxScroll;
+        int position = Math.floorMod(frame * SCROLL_STEP, period);
+        return position <= maxScroll ? position : period - position;
+    }
+
+    private static void assertVisibleCellsPainted(Bitmap frame, HeatmapLayout layout, int scrollY) {
+        int checked = 0;
+        for (int i = 0; i < layout.count; i++) {
+            int x = (int) ((layout.rects[i * 4] + layout.rects[i * 4 + 2]) / 2);
+            int y = (int) ((layout.rects[i * 4 + 1] + layout.rects[i * 4 + 3]) / 2) - scrollY;
+            if (y < 0 || y >= frame.getHeight()) {
+                continue;
+            }
+            assertEquals("cell " + i, layout.colors[i], frame.getPixel(x, y));
+            checked++;
+        }
+        assertTrue(checked > 0);
+    }
+
+    private static long median(long[] frameNs) {
+        long[] sorted = frameNs.clone();
+        Arrays.sort(sorted);
+        return sorted[sorted.length / 2];
+    }
+
+    private static String summarize(long[] frameNs) {
+        long[] sorted = frameNs.clone();
+        Arrays.sort(sorted);
+        double sum = 0;
+        for (long ns : sorted) {
+            sum += ns;
+        }
+        return String.format(Locale.US, "avg %.3f ms, p50 %.3f ms, p95 %.3f ms, max %.3f ms",
+                sum / sorted.length / 1e6,
+                sorted[sorted.length / 2] / 1e6,
+                sorted[(int) (sorted.length * 0.95)] / 1e6,
+                sorted[sorted.length - 1] / 1e6);
+    }
+}
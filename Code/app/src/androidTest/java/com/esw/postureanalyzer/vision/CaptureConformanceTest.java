@@ -0,0 +1,135 @@
+package com.esw.postureanalyzer.vision;
+
+import android.content.Context;
+import android.hardware.usb.UsbConstants;
+import android.hardware.usb.UsbDevice;
+import android.hardware.usb.UsbDeviceConnection;
+import android.hardware.usb.UsbInterface;
+import android.hardware.usb.UsbManager;
+
+import androidx.test.ext.junit.runners.AndroidJUnit4;
+import androidx.test.platform.app.InstrumentationRegistry;
+
+import org.junit.Before;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+import java.io.File;
+
+import static org.junit.Assert.*;
+import static org.junit.Assume.assumeNotNull;
+import static org.junit.Assume.assumeTrue;
+
+/**
+ * Runs the shared capture conformance suite on every backend. Synthetic and
+ * replay always run; V4L2 and USB-host UVC are skipped unless a readable
+ * node or a permitted USB camera is attached. Throughput goes to logcat
+ * under "CaptureConformance".
+ */
+@RunWith(AndroidJUnit4.class)
+public class CaptureConformanceTest {
+    private static final int WIDTH = 640;
+    private static final int HEIGHT = 480;
+    private static final int FRAMES = 120;
+
+    // V4L2_PIX_FMT_YUYV
+    private static final int FOURCC_YUYV = 0x56595559;
+
+    private Context context;
+
+    @Before
+    public void setUp() {
+        assertTrue("libuvccamera failed to load", CaptureConformance.isAvailable());
+        context = InstrumentationRegistry.getInstrumentation().getTargetContext();
+    }
+
+    @Test
+    public void syntheticPacedConforms() {
+        CaptureConformance.Result result = CaptureConformance.runSynthetic(WIDTH, HEIGHT, 60, FRAMES);
+        assertTrue(result.toString(), result.passed());
+        assertEquals(60.0, result.fps, 3.0);
+        assertEquals(0, result.dropped);
+    }
+
+    @Test
+    public void syntheticUnpacedConforms() {
+        CaptureConformance.Result result = CaptureConformance.runSynthetic(WIDTH, HEIGHT, 0, FRAMES);
+        assertTrue(result.toString(), result.passed());
+        assertTrue("Unpaced generator below camera rate: " + result, result.fps > 30.0);
+    }
+
+    @Test
+    public void replayConforms() {
+        File recording = new File(context.getCacheDir(), "conformance.yuyv");
+        try {
+            assertTrue(CaptureConformance.recordSynthetic(recording.getPath(), WIDTH, HEIGHT, 10));
+            assertEquals((long) WIDTH * HEIGHT * 2 * 10, recording.length());
+
+            // Fewer frames on disk than leased, so the run also covers looping
+            CaptureConformance.Result result =
+                    CaptureConformance.runReplay(recording.getPath(), WIDTH, HEIGHT, 0, FRAMES);
+            assertTrue(result.toString(), result.passed());
+            assertEquals(0, result.dropped);
+        } finally {
+            recording.delete();
+        }
+    }
+
+    @Test
+    public void replayRejectsMissingFile() {
+        File missing = new File(context.getCacheDir(), "missing.yuyv");
+        CaptureConformance.Result result =
+                CaptureConformance.runReplay(missing.getPath(), WIDTH, HEIGHT, 0, FRAMES);
+        assertFalse(result.passed());
+    }
+
+    @Test
+    public void v4l2Conforms() {
+        String node = null;
+        for (int i = 0; i < 10 && node == null; i++) {
+            File candidate = new File("/dev/video" + i);
+            if (candidate.canRead() && candidate.canWrite()) {
+                node = candidate.getPath();
+            }
+        }
+        assumeNotNull(node);
+
+        CaptureConformance.Result result = CaptureConformance.runV4L2(node, WIDTH, HEIGHT, FOURCC_YUYV, FRAMES);
+        assertTrue(result.toString(), result.passed());
+    }
+
+    @Test
+    public void usbHostConforms() {
+        UsbManager usbManager = (UsbManager) context.getSystemService(Context.USB_SERVICE);
+        assumeNotNull(usbManager);
+
+        UsbDevice camera = null;
+        for (UsbDevice device : usbManager.getDeviceList().values()) {
+            if (isVideoDevice(device) && usbManager.hasPermission(device)) {
+                camera = device;
+                break;
+            }
+        }
+        assumeNotNull(camera);
+
+        UsbDeviceConnection connection = usbManager.openDevice(camera);
+        assumeTrue(connection != null);
+        try {
+            CaptureConformance.Result result =
+                    CaptureConformance.runUsbHost(connection, camera, WIDTH, HEIGHT, FRAMES);
+            assertTrue(result.toString(), result.passed());
+        } finally {
+            connection.close();
+        }
+    }
+
+    private static boolean isVideoDevice(UsbDevice device) {
+        for (int i = 0; i < device.getInterfaceCount(); i++) {
+            UsbInterface usbInterface = device.getInterface(i);
+            if (usbInterface.getInterfaceClass() == UsbConstants.USB_CLASS_VIDEO) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
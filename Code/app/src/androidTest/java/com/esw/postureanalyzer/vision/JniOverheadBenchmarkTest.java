@@ -0,0 +1,37 @@
+package com.esw.postureanalyzer.vision;
+
+import android.os.Build;
+import android.util.Log;
+
+import androidx.test.ext.junit.runners.AndroidJUnit4;
+
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+import static org.junit.Assert.*;
+
+/**
+ * Instrumented JNI transition benchmark. Results go to logcat under
+ * "JniOverheadBenchmark".
+ */
+@RunWith(AndroidJUnit4.class)
+public class JniOverheadBenchmarkTest {
+    private static final String TAG = "JniOverheadBenchmark";
+    private static final int ITERATIONS = 1_000_000;
+
+    @Test
+    public void measuresCallingConventions() {
+        assertTrue("libuvccamera failed to load", JniBenchmark.isAvailable());
+
+        JniBenchmark.Result result = JniBenchmark.run(ITERATIONS);
+        assertNotNull(result);
+        Log.i(TAG, result.toString());
+
+        assertTrue(result.regularNs > 0);
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.O) {
+            // Loose bound: the point is the logged numbers, not a tight gate
+            assertTrue("@CriticalNative slower than regular JNI: " + result,
+                    result.criticalNs <= result.regularNs * 1.5);
+        }
+    }
+}
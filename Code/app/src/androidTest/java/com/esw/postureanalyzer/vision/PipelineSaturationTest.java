@@ -0,0 +1,89 @@
+package com.esw.postureanalyzer.vision;
+
+import android.content.Context;
+
+import androidx.test.ext.junit.runners.AndroidJUnit4;
+import androidx.test.platform.app.InstrumentationRegistry;
+
+import com.esw.postureanalyzer.performance.SaturationCurve;
+
+import org.junit.Before;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+import static org.junit.Assert.*;
+
+/**
+ * Offered-load sweeps with the synthetic frame source. The source-only run
+ * checks the generator outpaces any camera; the pipeline runs log a
+ * saturation curve (CSV under "PipelineStress") for decode -> pose -> classify.
+ */
+@RunWith(AndroidJUnit4.class)
+public class PipelineSaturationTest {
+    private static final int WIDTH = 640;
+    private static final int HEIGHT = 480;
+    private static final int[] OFFERED_FPS = {15, 30, 60, 120, 240};
+    private static final long STEP_MS = 3000;
+
+    private Context context;
+
+    @Before
+    public void setUp() {
+        assertTrue("libuvccamera failed to load", CaptureConformance.isAvailable());
+        context = InstrumentationRegistry.getInstrumentation().getTargetContext();
+    }
+
+    @Test
+    public void sourceSustainsHighRates() {
+        for (int fps : new int[]{240, 480}) {
+            SyntheticFrameSource source = SyntheticFrameSource.open(WIDTH, HEIGHT,
+                    SyntheticFrameSource.PIXEL_FORMAT_YUYV, fps, true, null);
+            assertNotNull(source);
+            try {
+                SaturationCurve curve = new SaturationCurve();
+                SaturationCurve.Step step = curve.beginStep(fps);
+                byte[] buffer = source.newFrameBuffer();
+                long start = System.nanoTime();
+                while (System.nanoTime() - start < 2_000_000_000L) {
+                    int size = source.read(buffer, 100);
+                    assertTrue("read failed", size >= 0);
+                    FrameStamp stamp = size > 0 ? FrameStamp.parse(buffer, size) : null;
+                    if (stamp != null) {
+                        step.onCaptured(stamp.sequence);
+                    }
+                }
+                SaturationCurve.Point point = step.finish(System.nanoTime() - start);
+                assertTrue("Generator fell behind at " + fps + " fps: " + point.capturedFps,
+                        point.capturedFps >= fps * 0.9);
+            } finally {
+                source.close();
+            }
+        }
+    }
+
+    @Test
+    public void yuyvPipelineCurve() {
+        runCurve(SyntheticFrameSource.PIXEL_FORMAT_YUYV);
+    }
+
+    @Test
+    public void mjpegPipelineCurve() {
+        runCurve(SyntheticFrameSource.PIXEL_FORMAT_MJPEG);
+    }
+
+    private void runCurve(int pixelFormat) {
+        PipelineStressRunner runner = new PipelineStressRunner(context, WIDTH, HEIGHT, pixelFormat);
+        try {
+            SaturationCurve curve = runner.run(OFFERED_FPS, STEP_MS);
+            assertNotNull("synthetic source failed to start", curve);
+            assertEquals(OFFERED_FPS.length, curve.getPoints().size());
+            for (SaturationCurve.Point point : curve.getPoints()) {
+                assertTrue(point.processedFps <= point.capturedFps + 1e-6);
+                assertTrue(point.lossPercent >= 0 && point.lossPercent <= 100);
+            }
+            assertTrue("Nothing made it through the pipeline", curve.getPeakProcessedFps() > 0);
+        } finally {
+            runner.release();
+        }
+    }
+}
@@ -0,0 +1,87 @@
+package com.esw.postureanalyzer.vision;
+
+import android.util.Log;
+
+import androidx.test.ext.junit.runners.AndroidJUnit4;
+
+import org.junit.Before;
+import org.junit.Test;
+import org.junit.runner.RunWith;
+
+import java.io.File;
+import java.util.List;
+
+import static org.junit.Assert.*;
+import static org.junit.Assume.assumeNotNull;
+import static org.junit.Assume.assumeTrue;
+
+/**
+ * mmap vs userptr vs dmabuf on the vivid test driver. Skipped unless vivid
+ * is loaded and its capture node is readable by the app (rooted board,
+ * `modprobe vivid` and permissive node permissions). Load vivid with
+ * multiplanar=2 to run the same checks through the MPLANE API.
+ * The comparison goes to logcat under "V4L2MemoryBenchmark".
+ */
+@RunWith(AndroidJUnit4.class)
+public class V4L2MemoryBenchmarkTest {
+    private static final String TAG = "V4L2MemoryBenchmark";
+
+    private static final int WIDTH = 640;
+    private static final int HEIGHT = 480;
+    private static final int FRAMES = 300;
+
+    // V4L2_PIX_FMT_YUYV
+    private static final int FOURCC_YUYV = 0x56595559;
+
+    private String node;
+
+    @Before
+    public void setUp() {
+        assertTrue("libuvccamera failed to load", V4L2MemoryBenchmark.isAvailable());
+        node = V4L2MemoryBenchmark.findVividCaptureNode();
+        assumeNotNull(node);
+        File device = new File(node);
+        assumeTrue(device.canRead() && device.canWrite());
+    }
+
+    @Test
+    public void mmapAndUserptrConform() {
+        for (int memory : new int[]{V4L2MemoryBenchmark.MEMORY_MMAP, V4L2MemoryBenchmark.MEMORY_USERPTR}) {
+            CaptureConformance.Result result =
+                    CaptureConformance.runV4L2(node, WIDTH, HEIGHT, FOURCC_YUYV, memory, 120);
+            assertTrue(result.toString(), result.passed());
+        }
+    }
+
+    @Test
+    public void dmabufConforms() {
+        // Needs a dma-heap the app may allocate from (Android 12+)
+        assumeTrue(new File("/dev/dma_heap/system").canRead());
+        CaptureConformance.Result result = CaptureConformance.runV4L2(node, WIDTH, HEIGHT, FOURCC_YUYV,
+                V4L2MemoryBenchmark.MEMORY_DMABUF, 120);
+        assertTrue(result.toString(), result.passed());
+    }
+
+    @Test
+    public void userBuffersAvoidTheCopy() {
+        List<V4L2MemoryBenchmark.Result> results =
+                V4L2MemoryBenchmark.runAll(node, WIDTH, HEIGHT, FOURCC_YUYV, FRAMES);
+        for (V4L2MemoryBenchmark.Result result : results) {
+            Log.i(TAG, result.toString());
+        }
+
+        V4L2MemoryBenchmark.Result mmap = results.get(0);
+        V4L2MemoryBenchmark.Result userptr = results.get(1);
+        assertTrue(mmap.toString(), mmap.passed());
+        assertTrue(userptr.toString(), userptr.passed());
+
+        assertEquals(1.0, mmap.copiesPerFrame, 1e-9);
+        assertTrue(mmap.bytesCopiedPerFrame >= WIDTH * HEIGHT * 2);
+        assertEquals(0.0, userptr.copiesPerFrame, 1e-9);
+
+        V4L2MemoryBenchmark.Result dmabuf = results.get(2);
+        if (dmabuf.passed()) {
+            assertEquals(0.0, dmabuf.copiesPerFrame, 1e-9);
+        }
+    }
+}
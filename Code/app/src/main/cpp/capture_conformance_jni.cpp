@@ -0,0 +1,148 @@
+#include <jni.h>
+#include <android/log.h>
+#include <cstdio>
+#include "jni_support.h"
+#include "frame_source_conformance.h"
+#include "replay_source.h"
+#include "synthetic_source.h"
+#include "uvc_camera.h"
+#include "v4l2_camera.h"
+
+#define LOG_TAG "CaptureConformance-JNI"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+// Bindings for com.esw.postureanalyzer.vision.CaptureConformance, registered
+// from JNI_OnLoad. Every backend runs the same runConformance<Backend>.
+
+namespace {
+
+const char* const kClassName = "com/esw/postureanalyzer/vision/CaptureConformance";
+
+// Generous enough for a real camera's first frame after STREAMON
+const int kLeaseTimeoutMs = 2000;
+
+// Layout of the metrics array shared with CaptureConformance.Result
+enum Metric {
+    kMetricFrames,
+    kMetricFps,
+    kMetricWallFps,
+    kMetricMeanLeaseUs,
+    kMetricMaxLeaseUs,
+    kMetricDropped,
+    kMetricTimeouts,
+    kMetricCount,
+};
+
+// Copies the metrics out; returns the failure text, or null if every check passed
+jstring report(JNIEnv* env, const char* backend, const ConformanceResult& result, jdoubleArray metrics) {
+    if (metrics && env->GetArrayLength(metrics) >= kMetricCount) {
+        jdouble values[kMetricCount];
+        values[kMetricFrames] = result.frames;
+        values[kMetricFps] = result.fps;
+        values[kMetricWallFps] = result.wallFps;
+        values[kMetricMeanLeaseUs] = result.meanLeaseUs;
+        values[kMetricMaxLeaseUs] = result.maxLeaseUs;
+        values[kMetricDropped] = static_cast<jdouble>(result.dropped);
+        values[kMetricTimeouts] = static_cast<jdouble>(result.timeouts);
+        env->SetDoubleArrayRegion(metrics, 0, kMetricCount, values);
+    }
+
+    if (result.passed) {
+        LOGI("%s: %d frames, %.1f fps, lease mean %.1f us max %.1f us, %llu dropped",
+             backend, result.frames, result.fps, result.meanLeaseUs, result.maxLeaseUs,
+             static_cast<unsigned long long>(result.dropped));
+        return nullptr;
+    }
+    LOGE("%s failed: %s", backend, result.failure.c_str());
+    return env->NewStringUTF(result.failure.c_str());
+}
+
+FrameFormat yuyv(int width, int height) {
+    return FrameFormat(width, height, kFourccYUYV);
+}
+
+jstring nativeRunSynthetic(JNIEnv* env, jclass clazz, jint width, jint height, jint fps,
+                           jint frames, jdoubleArray metrics) {
+    SyntheticSource::OpenArgs args;
+    args.fps = fps;
+    ConformanceResult result = runConformance<SyntheticSource>(args, yuyv(width, height), frames, kLeaseTimeoutMs);
+    return report(env, SyntheticSource::name(), result, metrics);
+}
+
+jstring nativeRunReplay(JNIEnv* env, jclass clazz, jstring path, jint width, jint height, jint fps,
+                        jint frames, jdoubleArray metrics) {
+    const char* file = env->GetStringUTFChars(path, nullptr);
+    ReplaySource::OpenArgs args;
+    args.path = file;
+    args.fps = fps;
+    args.loop = true;
+    ConformanceResult result = runConformance<ReplaySource>(args, yuyv(width, height), frames, kLeaseTimeoutMs);
+    env->ReleaseStringUTFChars(path, file);
+    return report(env, ReplaySource::name(), result, metrics);
+}
+
+// memory is a V4L2_MEMORY_* type; USERPTR and DMABUF capture into a pool the camera allocates
+jstring nativeRunV4L2(JNIEnv* env, jclass clazz, jstring device_path, jint width, jint height,
+                      jint pixel_format, jint memory, jint frames, jdoubleArray metrics) {
+    const char* path = env->GetStringUTFChars(device_path, nullptr);
+    V4L2Camera::OpenArgs args =
+        V4L2Camera::OpenArgs::fromPath(path).withMemory(static_cast<uint32_t>(memory), nullptr);
+    FrameFormat requested(width, height, static_cast<uint32_t>(pixel_format));
+    ConformanceResult result = runConformance<V4L2Camera>(args, requested, frames, kLeaseTimeoutMs);
+    env->ReleaseStringUTFChars(device_path, path);
+    return report(env, V4L2Camera::name(), result, metrics);
+}
+
+jstring nativeRunUsbHost(JNIEnv* env, jclass clazz, jobject connection, jobject device,
+                         jint width, jint height, jint frames, jdoubleArray metrics) {
+    UVCCamera::OpenArgs args;
+    args.usbConnection = connection;
+    args.usbDevice = device;
+    ConformanceResult result = runConformance<UVCCamera>(args, yuyv(width, height), frames, kLeaseTimeoutMs);
+    return report(env, UVCCamera::name(), result, metrics);
+}
+
+// Writes synthetic frames back to back, producing a recording ReplaySource can play
+jboolean nativeRecordSynthetic(JNIEnv* env, jclass clazz, jstring path, jint width, jint height, jint frames) {
+    FrameSource<SyntheticSource> source;
+    SyntheticSource::OpenArgs args;
+    args.fps = 0;
+    if (!source.open(args) || !source.negotiate(yuyv(width, height)) || !source.start()) {
+        return JNI_FALSE;
+    }
+
+    const char* file = env->GetStringUTFChars(path, nullptr);
+    FILE* out = fopen(file, "wb");
+    if (!out) {
+        LOGE("Failed to create %s", file);
+        env->ReleaseStringUTFChars(path, file);
+        return JNI_FALSE;
+    }
+
+    bool ok = true;
+    for (int i = 0; i < frames && ok; i++) {
+        FrameLease<FrameSource<SyntheticSource> > lease(source, kLeaseTimeoutMs);
+        ok = lease.ok() &&
+             fwrite(lease.frame().data, 1, lease.frame().size, out) == static_cast<size_t>(lease.frame().size);
+    }
+    ok = fclose(out) == 0 && ok;
+    env->ReleaseStringUTFChars(path, file);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+const JNINativeMethod kMethods[] = {
+    {"nativeRunSynthetic", "(IIII[D)Ljava/lang/String;", reinterpret_cast<void*>(nativeRunSynthetic)},
+    {"nativeRunReplay", "(Ljava/lang/String;IIII[D)Ljava/lang/String;", reinterpret_cast<void*>(nativeRunReplay)},
+    {"nativeRunV4L2", "(Ljava/lang/String;IIIII[D)Ljava/lang/String;", reinterpret_cast<void*>(nativeRunV4L2)},
+    {"nativeRunUsbHost",
+     "(Landroid/hardware/usb/UsbDeviceConnection;Landroid/hardware/usb/UsbDevice;III[D)Ljava/lang/String;",
+     reinterpret_cast<void*>(nativeRunUsbHost)},
+    {"nativeRecordSynthetic", "(Ljava/lang/String;III)Z", reinterpret_cast<void*>(nativeRecordSynthetic)},
+};
+
+} // namespace
+
+bool registerCaptureConformanceNatives(JNIEnv* env) {
+    return jni::registerNatives(env, kClassName, kMethods, jni::arraySize(kMethods));
+}
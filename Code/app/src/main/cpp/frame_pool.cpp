@@ -0,0 +1,122 @@
+#include "frame_pool.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/dma-buf.h>
+#include <linux/dma-heap.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <android/log.h>
+
+#define LOG_TAG "FramePool"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+const char* const kDmaHeapPath = "/dev/dma_heap/system";
+
+size_t pageAlign(size_t size) {
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return (size + page - 1) / page * page;
+}
+
+void syncDmabuf(int fd, uint64_t flags) {
+    struct dma_buf_sync sync;
+    sync.flags = flags;
+    while (ioctl(fd, DMA_BUF_IOCTL_SYNC, &sync) < 0 && errno == EINTR) {
+    }
+}
+
+} // namespace
+
+FramePool::FramePool(Kind kind) : kind_(kind), size_(0) {
+}
+
+FramePool::~FramePool() {
+    free();
+}
+
+bool FramePool::allocate(int count, size_t size) {
+    free();
+    if (count <= 0 || size == 0) {
+        return false;
+    }
+    size_ = pageAlign(size);
+
+    int heap = -1;
+    if (kind_ == kDmabuf) {
+        heap = ::open(kDmaHeapPath, O_RDONLY | O_CLOEXEC);
+        if (heap < 0) {
+            LOGE("Failed to open %s: %s", kDmaHeapPath, strerror(errno));
+            return false;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        Buffer buffer = {nullptr, -1};
+        if (kind_ == kHeap) {
+            void* data = nullptr;
+            if (posix_memalign(&data, static_cast<size_t>(sysconf(_SC_PAGESIZE)), size_) != 0) {
+                LOGE("Failed to allocate %zu byte buffer", size_);
+                break;
+            }
+            buffer.data = static_cast<uint8_t*>(data);
+        } else {
+            struct dma_heap_allocation_data alloc;
+            memset(&alloc, 0, sizeof(alloc));
+            alloc.len = size_;
+            alloc.fd_flags = O_RDWR | O_CLOEXEC;
+            if (ioctl(heap, DMA_HEAP_IOCTL_ALLOC, &alloc) < 0) {
+                LOGE("dma-heap allocation of %zu bytes failed: %s", size_, strerror(errno));
+                break;
+            }
+            buffer.fd = static_cast<int>(alloc.fd);
+            void* data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, buffer.fd, 0);
+            if (data == MAP_FAILED) {
+                LOGE("Failed to map dma-buf: %s", strerror(errno));
+                ::close(buffer.fd);
+                break;
+            }
+            buffer.data = static_cast<uint8_t*>(data);
+        }
+        buffers_.push_back(buffer);
+    }
+
+    if (heap >= 0) {
+        ::close(heap);
+    }
+    if (count != this->count()) {
+        free();
+        return false;
+    }
+    LOGI("Allocated %d %s buffers of %zu bytes", count, kind_ == kHeap ? "heap" : "dma-buf", size_);
+    return true;
+}
+
+void FramePool::free() {
+    for (size_t i = 0; i < buffers_.size(); i++) {
+        if (buffers_[i].fd >= 0) {
+            munmap(buffers_[i].data, size_);
+            ::close(buffers_[i].fd);
+        } else {
+            ::free(buffers_[i].data);
+        }
+    }
+    buffers_.clear();
+    size_ = 0;
+}
+
+void FramePool::beginCpuAccess(int index) const {
+    if (buffers_[index].fd >= 0) {
+        syncDmabuf(buffers_[index].fd, DMA_BUF_SYNC_START | DMA_BUF_SYNC_READ);
+    }
+}
+
+void FramePool::endCpuAccess(int index) const {
+    if (buffers_[index].fd >= 0) {
+        syncDmabuf(buffers_[index].fd, DMA_BUF_SYNC_END | DMA_BUF_SYNC_READ);
+    }
+}
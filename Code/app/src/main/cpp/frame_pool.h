@@ -0,0 +1,56 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Fixed set of equally sized, page-aligned capture buffers owned by the
+ * caller. V4L2Camera captures straight into them with V4L2_MEMORY_USERPTR
+ * (heap buffers) or V4L2_MEMORY_DMABUF (dma-heap buffers), so frames land
+ * in memory the pipeline already owns instead of being copied out of the
+ * driver's mmap buffers.
+ *
+ * DMABUF buffers are also mapped for CPU access; reads must be bracketed
+ * with beginCpuAccess / endCpuAccess so caches are kept coherent with the
+ * device's writes.
+ */
+class FramePool {
+public:
+    enum Kind {
+        kHeap,    // posix_memalign, for USERPTR
+        kDmabuf,  // /dev/dma_heap/system, for DMABUF
+    };
+
+    explicit FramePool(Kind kind);
+    ~FramePool();
+
+    // Replace the pool with count buffers of at least size bytes (rounded up to pages)
+    bool allocate(int count, size_t size);
+    void free();
+
+    Kind kind() const { return kind_; }
+    int count() const { return static_cast<int>(buffers_.size()); }
+    size_t bufferSize() const { return size_; }
+    uint8_t* data(int index) const { return buffers_[index].data; }
+    int fd(int index) const { return buffers_[index].fd; }  // -1 for heap buffers
+
+    void beginCpuAccess(int index) const;
+    void endCpuAccess(int index) const;
+
+private:
+    struct Buffer {
+        uint8_t* data;
+        int fd;
+    };
+
+    Kind kind_;
+    size_t size_;
+    std::vector<Buffer> buffers_;
+
+    FramePool(const FramePool&);
+    FramePool& operator=(const FramePool&);
+};
+
+#endif // FRAME_POOL_H
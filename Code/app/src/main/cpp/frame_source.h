@@ -0,0 +1,334 @@
+#ifndef FRAME_SOURCE_H
+#define FRAME_SOURCE_H
+
+#include <cstdint>
+#include <time.h>
+
+/**
+ * Common capture interface over the native frame backends.
+ *
+ * A backend is any class with the members below; FrameSource<Backend>
+ * layers the lifecycle checks and statistics on top. Backends are chosen
+ * through the template argument, so lease/release compile to direct
+ * (inlinable) calls with no virtual dispatch on the per-frame path.
+ *
+ *   typedef ... OpenArgs;                       // how to reach the device
+ *   static const int kMaxLeases;                // frames that may be held at once
+ *   static const char* name();
+ *   bool open(const OpenArgs& args);
+ *   void close();
+ *   bool negotiate(const FrameFormat& requested, FrameFormat* actual);
+ *   bool start();
+ *   void stop();                                // reclaims outstanding leases
+ *   LeaseResult lease(FrameDescriptor* frame, int timeout_ms);
+ *   void release(const FrameDescriptor& frame);
+ *
+ * Backends: V4L2Camera (v4l2_camera.h), UVCCamera over the USB Host API
+ * (uvc_camera.h), ReplaySource (replay_source.h), SyntheticSource
+ * (synthetic_source.h).
+ */
+
+constexpr uint32_t makeFourcc(char a, char b, char c, char d) {
+    return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+           (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+// Same values as V4L2_PIX_FMT_*, so formats pass between backends unchanged
+const uint32_t kFourccYUYV = makeFourcc('Y', 'U', 'Y', 'V');
+const uint32_t kFourccMJPEG = makeFourcc('M', 'J', 'P', 'G');
+
+inline int64_t monotonicNowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+// Memory planes a frame can span (V4L2 multi-planar formats such as NV12M)
+const int kMaxFramePlanes = 3;
+
+struct FrameFormat {
+    int width;
+    int height;
+    uint32_t pixelFormat;  // fourcc
+    int bytesPerLine;      // 0 for compressed formats; first plane for multi-planar formats
+    int planes;            // separate memory planes, 1 for packed and compressed formats
+
+    FrameFormat() : width(0), height(0), pixelFormat(0), bytesPerLine(0), planes(1) {}
+    FrameFormat(int w, int h, uint32_t fourcc)
+        : width(w), height(h), pixelFormat(fourcc), bytesPerLine(0), planes(1) {}
+
+    // Bytes of one uncompressed frame, 0 if compressed or unknown
+    int imageSize() const { return bytesPerLine > 0 ? bytesPerLine * height : 0; }
+};
+
+struct FramePlane {
+    const uint8_t* data;
+    int size;              // bytes used
+    int bytesPerLine;
+
+    FramePlane() : data(nullptr), size(0), bytesPerLine(0) {}
+};
+
+/**
+ * One leased frame. data stays valid until the frame is released.
+ *
+ * data/size always describe the first plane. Frames from multi-planar
+ * buffers also list every plane in planes[0..format.planes); other
+ * backends leave planes empty.
+ */
+struct FrameDescriptor {
+    const uint8_t* data;
+    int size;              // bytes used
+    FrameFormat format;
+    int64_t timestampNs;   // capture time, CLOCK_MONOTONIC
+    uint32_t sequence;     // backend frame counter; gaps are dropped frames
+    int slot;              // backend buffer index, handed back on release
+    FramePlane planes[kMaxFramePlanes];
+
+    FrameDescriptor() : data(nullptr), size(0), timestampNs(0), sequence(0), slot(-1) {}
+};
+
+enum LeaseResult {
+    kLeaseOk,
+    kLeaseTimeout,      // no frame within the timeout; try again
+    kLeaseBusy,         // kMaxLeases frames are already held
+    kLeaseEndOfStream,  // finite source exhausted
+    kLeaseError,
+};
+
+struct FrameSourceStats {
+    uint64_t framesLeased;
+    uint64_t framesDropped;    // sequence gaps
+    uint64_t timeouts;
+    uint64_t errors;
+    uint64_t bytesLeased;
+    int64_t firstTimestampNs;
+    int64_t lastTimestampNs;
+    int64_t maxIntervalNs;     // longest gap between consecutive frames
+
+    FrameSourceStats()
+        : framesLeased(0), framesDropped(0), timeouts(0), errors(0), bytesLeased(0),
+          firstTimestampNs(0), lastTimestampNs(0), maxIntervalNs(0) {}
+
+    // Delivered rate from capture timestamps
+    double fps() const {
+        if (framesLeased < 2 || lastTimestampNs <= firstTimestampNs) {
+            return 0.0;
+        }
+        return (framesLeased - 1) * 1e9 / static_cast<double>(lastTimestampNs - firstTimestampNs);
+    }
+};
+
+/**
+ * Paces generated frames at a fixed rate on the monotonic clock. fps <= 0
+ * delivers frames as fast as they are leased.
+ */
+class FramePacer {
+public:
+    FramePacer() : period_ns_(0), start_ns_(0), last_ns_(0) {}
+
+    void start(int fps) {
+        period_ns_ = fps > 0 ? 1000000000LL / fps : 0;
+        start_ns_ = monotonicNowNs();
+        last_ns_ = 0;
+    }
+
+    // Wait for frame `sequence`'s slot; false if that is further away than timeout_ms
+    bool wait(uint32_t sequence, int timeout_ms, int64_t* timestamp_ns) {
+        int64_t now = monotonicNowNs();
+        if (period_ns_ == 0) {
+            // Unpaced frames can land within one clock tick; keep them ordered
+            *timestamp_ns = now > last_ns_ ? now : last_ns_ + 1;
+            last_ns_ = *timestamp_ns;
+            return true;
+        }
+        int64_t due = start_ns_ + static_cast<int64_t>(sequence) * period_ns_;
+        if (due - now > static_cast<int64_t>(timeout_ms) * 1000000LL) {
+            return false;
+        }
+        if (due > now) {
+            struct timespec ts;
+            ts.tv_sec = static_cast<time_t>(due / 1000000000LL);
+            ts.tv_nsec = static_cast<long>(due % 1000000000LL);
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) != 0) {
+            }
+        }
+        *timestamp_ns = due > now ? due : now;
+        return true;
+    }
+
+    // Newest slot whose time has come; a live sensor would be exposing this one
+    uint32_t latestSlot() const {
+        if (period_ns_ == 0) {
+            return 0;
+        }
+        int64_t elapsed = monotonicNowNs() - start_ns_;
+        return elapsed > 0 ? static_cast<uint32_t>(elapsed / period_ns_) : 0;
+    }
+
+private:
+    int64_t period_ns_;
+    int64_t start_ns_;
+    int64_t last_ns_;
+};
+
+template <typename Backend>
+class FrameSource {
+public:
+    typedef typename Backend::OpenArgs OpenArgs;
+
+    enum State { kClosed, kOpened, kNegotiated, kStreaming };
+
+    FrameSource() : state_(kClosed), outstanding_(0), has_sequence_(false), last_sequence_(0) {}
+    ~FrameSource() { close(); }
+
+    static const char* backendName() { return Backend::name(); }
+
+    bool open(const OpenArgs& args) {
+        close();
+        if (!backend_.open(args)) {
+            return false;
+        }
+        state_ = kOpened;
+        return true;
+    }
+
+    // Request a format; format() holds what the backend actually chose
+    bool negotiate(const FrameFormat& requested) {
+        if (state_ != kOpened && state_ != kNegotiated) {
+            return false;
+        }
+        FrameFormat actual;
+        if (!backend_.negotiate(requested, &actual)) {
+            return false;
+        }
+        format_ = actual;
+        state_ = kNegotiated;
+        return true;
+    }
+
+    bool start() {
+        if (state_ != kNegotiated || !backend_.start()) {
+            return false;
+        }
+        stats_ = FrameSourceStats();
+        has_sequence_ = false;
+        outstanding_ = 0;
+        state_ = kStreaming;
+        return true;
+    }
+
+    void stop() {
+        if (state_ != kStreaming) {
+            return;
+        }
+        backend_.stop();
+        outstanding_ = 0;
+        state_ = kNegotiated;
+    }
+
+    void close() {
+        if (state_ == kClosed) {
+            return;
+        }
+        stop();
+        backend_.close();
+        state_ = kClosed;
+    }
+
+    LeaseResult lease(FrameDescriptor* frame, int timeout_ms) {
+        if (state_ != kStreaming) {
+            return kLeaseError;
+        }
+        if (outstanding_ >= Backend::kMaxLeases) {
+            return kLeaseBusy;
+        }
+        LeaseResult result = backend_.lease(frame, timeout_ms);
+        switch (result) {
+            case kLeaseOk:
+                ++outstanding_;
+                account(*frame);
+                break;
+            case kLeaseTimeout:
+                ++stats_.timeouts;
+                break;
+            case kLeaseEndOfStream:
+                break;
+            default:
+                ++stats_.errors;
+                break;
+        }
+        return result;
+    }
+
+    void release(const FrameDescriptor& frame) {
+        if (state_ != kStreaming || outstanding_ == 0) {
+            return;
+        }
+        backend_.release(frame);
+        --outstanding_;
+    }
+
+    State state() const { return state_; }
+    const FrameFormat& format() const { return format_; }
+    const FrameSourceStats& stats() const { return stats_; }
+    int outstanding() const { return outstanding_; }
+    Backend& backend() { return backend_; }
+    const Backend& backend() const { return backend_; }
+
+private:
+    Backend backend_;
+    State state_;
+    FrameFormat format_;
+    FrameSourceStats stats_;
+    int outstanding_;
+    bool has_sequence_;
+    uint32_t last_sequence_;
+
+    void account(const FrameDescriptor& frame) {
+        if (has_sequence_ && frame.sequence > last_sequence_ + 1) {
+            stats_.framesDropped += frame.sequence - last_sequence_ - 1;
+        }
+        has_sequence_ = true;
+        last_sequence_ = frame.sequence;
+
+        if (stats_.framesLeased == 0) {
+            stats_.firstTimestampNs = frame.timestampNs;
+        } else if (frame.timestampNs - stats_.lastTimestampNs > stats_.maxIntervalNs) {
+            stats_.maxIntervalNs = frame.timestampNs - stats_.lastTimestampNs;
+        }
+        stats_.lastTimestampNs = frame.timestampNs;
+        stats_.bytesLeased += static_cast<uint64_t>(frame.size);
+        ++stats_.framesLeased;
+    }
+};
+
+/**
+ * Scoped lease: releases the frame when it goes out of scope.
+ */
+template <typename Source>
+class FrameLease {
+public:
+    FrameLease(Source& source, int timeout_ms)
+        : source_(source), result_(source.lease(&frame_, timeout_ms)) {}
+
+    ~FrameLease() {
+        if (result_ == kLeaseOk) {
+            source_.release(frame_);
+        }
+    }
+
+    bool ok() const { return result_ == kLeaseOk; }
+    LeaseResult result() const { return result_; }
+    const FrameDescriptor& frame() const { return frame_; }
+
+private:
+    FrameLease(const FrameLease&);
+    FrameLease& operator=(const FrameLease&);
+
+    Source& source_;
+    FrameDescriptor frame_;
+    LeaseResult result_;
+};
+
+#endif // FRAME_SOURCE_H
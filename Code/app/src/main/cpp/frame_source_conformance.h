@@ -0,0 +1,249 @@
+#ifndef FRAME_SOURCE_CONFORMANCE_H
+#define FRAME_SOURCE_CONFORMANCE_H
+
+#include <string>
+#include "frame_source.h"
+
+/**
+ * Conformance and throughput checks shared by every capture backend.
+ *
+ * runConformance drives one FrameSource<Backend> through its whole
+ * lifecycle and checks the contract in frame_source.h: ordering of
+ * open/negotiate/start, well-formed descriptors with increasing timestamps
+ * and sequence numbers, the lease limit, restart after stop, and
+ * renegotiating a larger format between stop and start. It also
+ * measures delivered fps and the time spent inside lease().
+ */
+
+struct ConformanceResult {
+    bool passed;
+    std::string failure;    // first failed check, empty when passed
+    int frames;             // frames leased in the throughput pass
+    double fps;             // from capture timestamps
+    double wallFps;         // from the caller's clock
+    double meanLeaseUs;
+    double maxLeaseUs;
+    uint64_t dropped;
+    uint64_t timeouts;
+
+    ConformanceResult()
+        : passed(false), frames(0), fps(0.0), wallFps(0.0), meanLeaseUs(0.0),
+          maxLeaseUs(0.0), dropped(0), timeouts(0) {}
+};
+
+namespace conformance {
+
+inline bool fail(ConformanceResult* result, const char* check) {
+    result->passed = false;
+    result->failure = check;
+    return false;
+}
+
+inline bool checkDescriptor(const FrameDescriptor& frame, const FrameFormat& format,
+                            ConformanceResult* result) {
+    if (!frame.data || frame.size <= 0) {
+        return fail(result, "leased frame has no data");
+    }
+    if (frame.format.width != format.width || frame.format.height != format.height ||
+        frame.format.pixelFormat != format.pixelFormat) {
+        return fail(result, "descriptor format differs from the negotiated format");
+    }
+    if (format.imageSize() > 0 && frame.size < format.imageSize()) {
+        return fail(result, "uncompressed frame is shorter than bytesPerLine * height");
+    }
+    if (format.planes > 1) {
+        if (format.planes > kMaxFramePlanes || frame.planes[0].data != frame.data) {
+            return fail(result, "multi-planar frame does not list its planes");
+        }
+        for (int i = 0; i < format.planes; i++) {
+            if (!frame.planes[i].data || frame.planes[i].size <= 0) {
+                return fail(result, "multi-planar frame has an empty plane");
+            }
+        }
+    }
+    if (frame.timestampNs <= 0) {
+        return fail(result, "frame has no timestamp");
+    }
+    return true;
+}
+
+} // namespace conformance
+
+template <typename Backend>
+ConformanceResult runConformance(const typename Backend::OpenArgs& args,
+                                 const FrameFormat& requested, int frames, int timeout_ms) {
+    ConformanceResult result;
+    FrameSource<Backend> source;
+    FrameDescriptor frame;
+
+    // Lifecycle order
+    if (source.lease(&frame, timeout_ms) != kLeaseError) {
+        conformance::fail(&result, "lease succeeded before open");
+        return result;
+    }
+    if (!source.open(args)) {
+        conformance::fail(&result, "open failed");
+        return result;
+    }
+    if (source.start()) {
+        conformance::fail(&result, "start succeeded before negotiate");
+        return result;
+    }
+    if (!source.negotiate(requested)) {
+        conformance::fail(&result, "negotiate failed");
+        return result;
+    }
+    const FrameFormat format = source.format();
+    if (format.width <= 0 || format.height <= 0 || format.pixelFormat == 0) {
+        conformance::fail(&result, "negotiate returned an empty format");
+        return result;
+    }
+    if (source.lease(&frame, timeout_ms) != kLeaseError) {
+        conformance::fail(&result, "lease succeeded before start");
+        return result;
+    }
+    if (!source.start()) {
+        conformance::fail(&result, "start failed");
+        return result;
+    }
+
+    // Throughput: lease/release back to back, as the capture thread does
+    int64_t last_timestamp = 0;
+    uint32_t last_sequence = 0;
+    double total_lease_us = 0.0;
+    int attempts = 0;
+    int64_t wall_start = monotonicNowNs();
+    while (result.frames < frames) {
+        if (++attempts > frames * 4) {
+            conformance::fail(&result, "too many timeouts");
+            return result;
+        }
+        int64_t before = monotonicNowNs();
+        LeaseResult lease = source.lease(&frame, timeout_ms);
+        double lease_us = (monotonicNowNs() - before) / 1000.0;
+        if (lease == kLeaseTimeout) {
+            continue;
+        }
+        if (lease != kLeaseOk) {
+            conformance::fail(&result, "lease failed while streaming");
+            return result;
+        }
+        bool valid = conformance::checkDescriptor(frame, format, &result);
+        if (valid && result.frames > 0 && frame.timestampNs <= last_timestamp) {
+            valid = conformance::fail(&result, "timestamps not increasing");
+        }
+        if (valid && result.frames > 0 && frame.sequence <= last_sequence) {
+            valid = conformance::fail(&result, "sequence numbers not increasing");
+        }
+        last_timestamp = frame.timestampNs;
+        last_sequence = frame.sequence;
+        source.release(frame);
+        if (!valid) {
+            return result;
+        }
+        total_lease_us += lease_us;
+        if (lease_us > result.maxLeaseUs) {
+            result.maxLeaseUs = lease_us;
+        }
+        result.frames++;
+    }
+    int64_t wall_ns = monotonicNowNs() - wall_start;
+    result.meanLeaseUs = result.frames > 0 ? total_lease_us / result.frames : 0.0;
+    result.wallFps = wall_ns > 0 ? (result.frames - 1) * 1e9 / wall_ns : 0.0;
+    result.fps = source.stats().fps();
+    result.dropped = source.stats().framesDropped;
+    result.timeouts = source.stats().timeouts;
+    if (source.outstanding() != 0) {
+        conformance::fail(&result, "released frames still counted as outstanding");
+        return result;
+    }
+
+    // Lease limit: hold kMaxLeases frames at once, then one more is refused
+    FrameDescriptor held[Backend::kMaxLeases];
+    int holding = 0;
+    for (int tries = 0; holding < Backend::kMaxLeases && tries < Backend::kMaxLeases * 4; tries++) {
+        LeaseResult lease = source.lease(&held[holding], timeout_ms);
+        if (lease == kLeaseOk) {
+            holding++;
+        } else if (lease != kLeaseTimeout) {
+            break;
+        }
+    }
+    if (holding != Backend::kMaxLeases) {
+        conformance::fail(&result, "could not hold kMaxLeases frames at once");
+        return result;
+    }
+    for (int i = 1; i < holding; i++) {
+        if (held[i].data == held[i - 1].data && held[i].slot == held[i - 1].slot) {
+            conformance::fail(&result, "concurrent leases share a buffer");
+            return result;
+        }
+    }
+    if (source.lease(&frame, timeout_ms) != kLeaseBusy) {
+        conformance::fail(&result, "lease beyond kMaxLeases was not refused");
+        return result;
+    }
+    for (int i = 0; i < holding; i++) {
+        source.release(held[i]);
+    }
+
+    // Restart: stop reclaims leases, lease fails until start, then frames flow again
+    {
+        FrameLease<FrameSource<Backend> > lease(source, timeout_ms);
+        source.stop();
+    }
+    if (source.lease(&frame, timeout_ms) != kLeaseError) {
+        conformance::fail(&result, "lease succeeded after stop");
+        return result;
+    }
+    if (!source.start()) {
+        conformance::fail(&result, "restart failed");
+        return result;
+    }
+    bool restarted = false;
+    for (int tries = 0; tries < 4 && !restarted; tries++) {
+        FrameLease<FrameSource<Backend> > lease(source, timeout_ms);
+        restarted = lease.ok() && conformance::checkDescriptor(lease.frame(), format, &result);
+    }
+    if (!restarted) {
+        if (result.failure.empty()) {
+            conformance::fail(&result, "no frames after restart");
+        }
+        return result;
+    }
+
+    // Renegotiate larger: buffers sized for the first format (a camera-owned
+    // USERPTR/DMABUF pool) have to grow, and frames flow in the new format
+    source.stop();
+    if (!source.negotiate(FrameFormat(format.width * 2, format.height * 2, format.pixelFormat))) {
+        conformance::fail(&result, "renegotiating a larger format failed");
+        return result;
+    }
+    const FrameFormat larger = source.format();
+    if (!source.start()) {
+        conformance::fail(&result, "start after renegotiating failed");
+        return result;
+    }
+    bool renegotiated = false;
+    for (int tries = 0; tries < 4 && !renegotiated; tries++) {
+        FrameLease<FrameSource<Backend> > lease(source, timeout_ms);
+        renegotiated = lease.ok() && conformance::checkDescriptor(lease.frame(), larger, &result);
+    }
+    if (!renegotiated) {
+        if (result.failure.empty()) {
+            conformance::fail(&result, "no frames after renegotiating");
+        }
+        return result;
+    }
+
+    source.close();
+    if (source.state() != FrameSource<Backend>::kClosed) {
+        conformance::fail(&result, "close did not reach the closed state");
+        return result;
+    }
+
+    result.passed = true;
+    return result;
+}
+
+#endif // FRAME_SOURCE_CONFORMANCE_H
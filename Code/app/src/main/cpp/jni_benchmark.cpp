@@ -0,0 +1,48 @@
+#include <jni.h>
+#include "jni_support.h"
+
+// No-op natives used by JniBenchmark to measure per-call transition cost for
+// each calling convention. The bodies are identical on purpose.
+
+namespace {
+
+const char* const kClassName = "com/esw/postureanalyzer/vision/JniBenchmark";
+
+jint nativeNoopRegular(JNIEnv* env, jclass clazz, jint value) {
+    return value + 1;
+}
+
+// @FastNative keeps the JNIEnv / jclass parameters
+jint nativeNoopFast(JNIEnv* env, jclass clazz, jint value) {
+    return value + 1;
+}
+
+jint criticalNoop(jint value) {
+    return value + 1;
+}
+
+const JNINativeMethod kMethods[] = {
+    {"nativeNoopRegular", "(I)I", reinterpret_cast<void*>(nativeNoopRegular)},
+    {"nativeNoopFast", "(I)I", reinterpret_cast<void*>(nativeNoopFast)},
+};
+
+const JNINativeMethod kCriticalMethods[] = {
+    {"nativeNoopCritical", "(I)I", reinterpret_cast<void*>(criticalNoop)},
+};
+
+// Before API 26 @CriticalNative is ignored, so the regular signature is bound
+const JNINativeMethod kRegularFallback[] = {
+    {"nativeNoopCritical", "(I)I", reinterpret_cast<void*>(nativeNoopRegular)},
+};
+
+} // namespace
+
+bool registerJniBenchmarkNatives(JNIEnv* env) {
+    if (!jni::registerNatives(env, kClassName, kMethods, jni::arraySize(kMethods))) {
+        return false;
+    }
+    if (jni::criticalNativeSupported()) {
+        return jni::registerNatives(env, kClassName, kCriticalMethods, jni::arraySize(kCriticalMethods));
+    }
+    return jni::registerNatives(env, kClassName, kRegularFallback, jni::arraySize(kRegularFallback));
+}
@@ -0,0 +1,132 @@
+#include "jni_support.h"
+#include <android/log.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/system_properties.h>
+
+#define LOG_TAG "JNI-OnLoad"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+JavaVM* g_vm = nullptr;
+pthread_key_t g_detach_key;
+pthread_once_t g_detach_key_once = PTHREAD_ONCE_INIT;
+
+void detachCurrentThread(void*) {
+    if (g_vm) {
+        g_vm->DetachCurrentThread();
+    }
+}
+
+void createDetachKey() {
+    pthread_key_create(&g_detach_key, detachCurrentThread);
+}
+
+} // namespace
+
+namespace jni {
+
+JavaVM* vm() {
+    return g_vm;
+}
+
+JNIEnv* getEnv() {
+    if (!g_vm) {
+        LOGE("getEnv called before JNI_OnLoad");
+        return nullptr;
+    }
+
+    JNIEnv* env = nullptr;
+    jint status = g_vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6);
+    if (status == JNI_OK) {
+        return env;
+    }
+    if (status != JNI_EDETACHED) {
+        LOGE("GetEnv failed: %d", status);
+        return nullptr;
+    }
+
+    if (g_vm->AttachCurrentThread(&env, nullptr) != JNI_OK) {
+        LOGE("AttachCurrentThread failed");
+        return nullptr;
+    }
+
+    // A non-null value makes the key's destructor detach the thread on exit
+    pthread_once(&g_detach_key_once, createDetachKey);
+    pthread_setspecific(g_detach_key, env);
+    return env;
+}
+
+int apiLevel() {
+    static int level = -1;
+    if (level < 0) {
+        char value[PROP_VALUE_MAX] = {0};
+        __system_property_get("ro.build.version.sdk", value);
+        level = atoi(value);
+    }
+    return level;
+}
+
+bool registerNatives(JNIEnv* env, const char* className,
+                     const JNINativeMethod* methods, int count) {
+    jclass clazz = env->FindClass(className);
+    if (!clazz) {
+        env->ExceptionClear();
+        LOGE("Class not found: %s", className);
+        return false;
+    }
+
+    bool ok = env->RegisterNatives(clazz, methods, count) == JNI_OK;
+    if (!ok) {
+        env->ExceptionClear();
+        LOGE("RegisterNatives failed for %s", className);
+    }
+    env->DeleteLocalRef(clazz);
+    return ok;
+}
+
+} // namespace jni
+
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* /* reserved */) {
+    g_vm = vm;
+
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) {
+        LOGE("JNI_OnLoad: GetEnv failed");
+        return JNI_ERR;
+    }
+
+    // Registering every class up front replaces the lazy dlsym lookup of
+    // Java_* symbol names on first call and fails fast on signature mismatches
+    if (!registerUVCCameraManagerNatives(env) ||
+        !registerMotionGateNatives(env) ||
+        !registerLandmarkFilterNatives(env)) {
+        return JNI_ERR;
+    }
+
+    // Benchmark and test harness classes may be stripped from a release
+    // build; without them only their own entry points are missing.
+    // registerNatives has already logged and cleared the exception.
+    // Each is attempted on its own so one missing class doesn't skip the rest.
+    bool (*const harness[])(JNIEnv*) = {
+        registerJniBenchmarkNatives,
+        registerCaptureConformanceNatives,
+        registerSyntheticSourceNatives,
+        registerV4L2MemoryBenchmarkNatives,
+    };
+    int missing = 0;
+    for (auto registerHarness : harness) {
+        if (!registerHarness(env)) {
+            missing++;
+        }
+    }
+    if (missing > 0) {
+        LOGE("%d harness classes not registered, continuing without them", missing);
+    }
+
+    LOGI("Natives registered (API %d, critical natives %s)",
+         jni::apiLevel(), jni::criticalNativeSupported() ? "on" : "off");
+    return JNI_VERSION_1_6;
+}
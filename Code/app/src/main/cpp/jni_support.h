@@ -0,0 +1,41 @@
+#ifndef JNI_SUPPORT_H
+#define JNI_SUPPORT_H
+
+#include <jni.h>
+#include <stddef.h>
+
+namespace jni {
+
+// JavaVM captured in JNI_OnLoad
+JavaVM* vm();
+
+// JNIEnv for the calling thread. Native threads are attached on first use
+// and detached automatically when they exit.
+JNIEnv* getEnv();
+
+// Device API level (ro.build.version.sdk), cached after the first call
+int apiLevel();
+
+// @CriticalNative / @FastNative take effect from Android 8.0 (API 26); on older
+// releases the annotations are ignored and the regular JNI convention is used
+inline bool criticalNativeSupported() { return apiLevel() >= 26; }
+
+// RegisterNatives with logging; returns false if the class or a method is missing
+bool registerNatives(JNIEnv* env, const char* className,
+                     const JNINativeMethod* methods, int count);
+
+template <typename T, size_t N>
+constexpr int arraySize(const T (&)[N]) { return static_cast<int>(N); }
+
+} // namespace jni
+
+// Per-class registration, called from JNI_OnLoad
+bool registerUVCCameraManagerNatives(JNIEnv* env);
+bool registerMotionGateNatives(JNIEnv* env);
+bool registerLandmarkFilterNatives(JNIEnv* env);
+bool registerJniBenchmarkNatives(JNIEnv* env);
+bool registerCaptureConformanceNatives(JNIEnv* env);
+bool registerSyntheticSourceNatives(JNIEnv* env);
+bool registerV4L2MemoryBenchmarkNatives(JNIEnv* env);
+
+#endif // JNI_SUPPORT_H
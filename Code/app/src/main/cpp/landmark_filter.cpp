@@ -0,0 +1,206 @@
+#include "landmark_filter.h"
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define LANDMARK_FILTER_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define LANDMARK_FILTER_SSE2 1
+#endif
+
+namespace {
+
+const float kTwoPi = 6.2831853f;
+const int kGroups = LandmarkFilter::kPadded / LandmarkFilter::kLanes;
+const int kValues = LandmarkFilter::kLandmarks * LandmarkFilter::kChannels;
+const int kPaddedValues = LandmarkFilter::kPadded * LandmarkFilter::kChannels;
+
+// Four lanes of one channel. loadGroup / storeGroup convert between four
+// interleaved landmarks (x y z v x y z v ...) and one vector per channel.
+#if defined(LANDMARK_FILTER_NEON)
+typedef float32x4_t Vec;
+inline Vec splat(float v) { return vdupq_n_f32(v); }
+inline Vec load(const float* p) { return vld1q_f32(p); }
+inline void store(float* p, Vec v) { vst1q_f32(p, v); }
+inline Vec add(Vec a, Vec b) { return vaddq_f32(a, b); }
+inline Vec sub(Vec a, Vec b) { return vsubq_f32(a, b); }
+inline Vec mul(Vec a, Vec b) { return vmulq_f32(a, b); }
+inline Vec mulAdd(Vec acc, Vec a, Vec b) { return vmlaq_f32(acc, a, b); }
+inline Vec absVec(Vec a) { return vabsq_f32(a); }
+inline Vec div(Vec a, Vec b) {
+#if defined(__aarch64__)
+    return vdivq_f32(a, b);
+#else
+    // ARMv7 has no vector divide: reciprocal estimate plus two Newton steps
+    Vec r = vrecpeq_f32(b);
+    r = vmulq_f32(vrecpsq_f32(b, r), r);
+    r = vmulq_f32(vrecpsq_f32(b, r), r);
+    return vmulq_f32(a, r);
+#endif
+}
+inline void loadGroup(const float* p, Vec* ch) {
+    float32x4x4_t t = vld4q_f32(p);
+    ch[0] = t.val[0]; ch[1] = t.val[1]; ch[2] = t.val[2]; ch[3] = t.val[3];
+}
+inline void storeGroup(float* p, const Vec* ch) {
+    float32x4x4_t t;
+    t.val[0] = ch[0]; t.val[1] = ch[1]; t.val[2] = ch[2]; t.val[3] = ch[3];
+    vst4q_f32(p, t);
+}
+#elif defined(LANDMARK_FILTER_SSE2)
+typedef __m128 Vec;
+inline Vec splat(float v) { return _mm_set1_ps(v); }
+inline Vec load(const float* p) { return _mm_load_ps(p); }
+inline void store(float* p, Vec v) { _mm_store_ps(p, v); }
+inline Vec add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+inline Vec sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+inline Vec mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+inline Vec mulAdd(Vec acc, Vec a, Vec b) { return _mm_add_ps(acc, _mm_mul_ps(a, b)); }
+inline Vec absVec(Vec a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline Vec div(Vec a, Vec b) { return _mm_div_ps(a, b); }
+inline void loadGroup(const float* p, Vec* ch) {
+    ch[0] = _mm_load_ps(p);
+    ch[1] = _mm_load_ps(p + 4);
+    ch[2] = _mm_load_ps(p + 8);
+    ch[3] = _mm_load_ps(p + 12);
+    _MM_TRANSPOSE4_PS(ch[0], ch[1], ch[2], ch[3]);
+}
+inline void storeGroup(float* p, const Vec* ch) {
+    Vec r0 = ch[0], r1 = ch[1], r2 = ch[2], r3 = ch[3];
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_store_ps(p, r0);
+    _mm_store_ps(p + 4, r1);
+    _mm_store_ps(p + 8, r2);
+    _mm_store_ps(p + 12, r3);
+}
+#else
+struct Vec {
+    float v[4];
+};
+inline Vec splat(float s) { Vec r = {{s, s, s, s}}; return r; }
+inline Vec load(const float* p) { Vec r; memcpy(r.v, p, sizeof(r.v)); return r; }
+inline void store(float* p, Vec a) { memcpy(p, a.v, sizeof(a.v)); }
+inline Vec add(Vec a, Vec b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+inline Vec sub(Vec a, Vec b) { for (int i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+inline Vec mul(Vec a, Vec b) { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+inline Vec mulAdd(Vec acc, Vec a, Vec b) { for (int i = 0; i < 4; ++i) acc.v[i] += a.v[i] * b.v[i]; return acc; }
+inline Vec absVec(Vec a) { for (int i = 0; i < 4; ++i) a.v[i] = a.v[i] < 0.0f ? -a.v[i] : a.v[i]; return a; }
+inline Vec div(Vec a, Vec b) { for (int i = 0; i < 4; ++i) a.v[i] /= b.v[i]; return a; }
+inline void loadGroup(const float* p, Vec* ch) {
+    for (int l = 0; l < 4; ++l)
+        for (int c = 0; c < 4; ++c) ch[c].v[l] = p[l * 4 + c];
+}
+inline void storeGroup(float* p, const Vec* ch) {
+    for (int l = 0; l < 4; ++l)
+        for (int c = 0; c < 4; ++c) p[l * 4 + c] = ch[c].v[l];
+}
+#endif
+
+} // namespace
+
+LandmarkFilter::LandmarkFilter()
+    : d_cutoff_(1.0f), reset_gap_ns_(1000000000LL), last_ns_(0), initialized_(false) {
+    memset(value_, 0, sizeof(value_));
+    memset(deriv_, 0, sizeof(deriv_));
+    // Positions: steady at rest, follows a 1 frame-width/s move at ~6 Hz
+    for (int c = 0; c < 3; ++c) {
+        min_cutoff_[c] = 1.0f;
+        beta_[c] = 5.0f;
+    }
+    // Visibility only needs de-flickering
+    min_cutoff_[3] = 1.0f;
+    beta_[3] = 0.0f;
+}
+
+void LandmarkFilter::reset() {
+    initialized_ = false;
+}
+
+void LandmarkFilter::setParams(int channel, float min_cutoff, float beta) {
+    if (channel < 0 || channel >= kChannels) {
+        return;
+    }
+    min_cutoff_[channel] = min_cutoff;
+    beta_[channel] = beta;
+}
+
+bool LandmarkFilter::filter(float* landmarks, int64_t timestamp_ns) {
+    int64_t dt_ns = timestamp_ns - last_ns_;
+
+    if (!initialized_ || dt_ns > reset_gap_ns_ || dt_ns < 0) {
+        // Seed the state in channel-major order; padding lanes stay zero
+        memset(value_, 0, sizeof(value_));
+        memset(deriv_, 0, sizeof(deriv_));
+        for (int l = 0; l < kLandmarks; ++l) {
+            for (int c = 0; c < kChannels; ++c) {
+                value_[c][l] = landmarks[l * kChannels + c];
+            }
+        }
+        last_ns_ = timestamp_ns;
+        initialized_ = true;
+        return false;
+    }
+
+    // Work on a padded copy so the last group of four needs no tail loop
+    alignas(16) float frame[kPaddedValues];
+    memcpy(frame, landmarks, kValues * sizeof(float));
+    memset(frame + kValues, 0, (kPaddedValues - kValues) * sizeof(float));
+
+    if (dt_ns == 0) {
+        // Same frame delivered twice: hand back the current estimate
+        for (int g = 0; g < kGroups; ++g) {
+            Vec ch[kChannels];
+            for (int c = 0; c < kChannels; ++c) {
+                ch[c] = load(&value_[c][g * kLanes]);
+            }
+            storeGroup(frame + g * kLanes * kChannels, ch);
+        }
+        memcpy(landmarks, frame, kValues * sizeof(float));
+        return true;
+    }
+    last_ns_ = timestamp_ns;
+
+    const float dt = static_cast<float>(dt_ns) * 1e-9f;
+    const Vec inv_dt = splat(1.0f / dt);
+    const Vec omega = splat(kTwoPi * dt);  // alpha(fc) = r / (r + 1) with r = 2*pi*fc*dt
+    const Vec one = splat(1.0f);
+    const float rd = kTwoPi * d_cutoff_ * dt;
+    const Vec alpha_d = splat(rd / (rd + 1.0f));
+
+    Vec min_cutoff[kChannels];
+    Vec beta[kChannels];
+    for (int c = 0; c < kChannels; ++c) {
+        min_cutoff[c] = splat(min_cutoff_[c]);
+        beta[c] = splat(beta_[c]);
+    }
+
+    for (int g = 0; g < kGroups; ++g) {
+        float* group = frame + g * kLanes * kChannels;
+        Vec ch[kChannels];
+        loadGroup(group, ch);
+
+        for (int c = 0; c < kChannels; ++c) {
+            float* value = &value_[c][g * kLanes];
+            float* deriv = &deriv_[c][g * kLanes];
+            Vec x = ch[c];
+            Vec prev = load(value);
+
+            // Smoothed speed, then a cutoff that opens up with it
+            Vec d = load(deriv);
+            d = mulAdd(d, alpha_d, sub(mul(sub(x, prev), inv_dt), d));
+            Vec r = mul(omega, mulAdd(min_cutoff[c], beta[c], absVec(d)));
+            Vec alpha = div(r, add(r, one));
+            Vec out = mulAdd(prev, alpha, sub(x, prev));
+
+            store(deriv, d);
+            store(value, out);
+            ch[c] = out;
+        }
+
+        storeGroup(group, ch);
+    }
+
+    memcpy(landmarks, frame, kValues * sizeof(float));
+    return true;
+}
@@ -0,0 +1,53 @@
+#ifndef LANDMARK_FILTER_H
+#define LANDMARK_FILTER_H
+
+#include <cstdint>
+
+/**
+ * One-Euro low-pass filter over one person's 33 pose landmarks.
+ *
+ * Every value (x, y, z, visibility of each landmark) is smoothed with a
+ * cutoff that rises with its own speed: still landmarks are filtered hard
+ * to remove jitter, fast ones barely lag. State is kept channel-major
+ * (structure of arrays) so four landmarks of one channel are updated per
+ * SIMD step; input and output stay in MediaPipe's [33][4] order.
+ */
+class LandmarkFilter {
+public:
+    static const int kLandmarks = 33;
+    static const int kChannels = 4;  // x, y, z, visibility
+    static const int kLanes = 4;
+    static const int kPadded = 36;   // kLandmarks rounded up to kLanes
+
+    LandmarkFilter();
+
+    // Forget the history; the next frame passes through unfiltered
+    void reset();
+
+    // Cutoff (Hz) at rest and its gain per unit/s of speed, for one channel
+    void setParams(int channel, float min_cutoff, float beta);
+
+    // Cutoff (Hz) of the speed estimate itself
+    void setDerivativeCutoff(float d_cutoff) { d_cutoff_ = d_cutoff; }
+
+    // Frames further apart than this restart the filter (person lost and found again)
+    void setResetGapNs(int64_t gap_ns) { reset_gap_ns_ = gap_ns; }
+
+    /**
+     * Filter one frame in place. landmarks holds kLandmarks * kChannels floats.
+     * Returns false when the frame restarted the filter and was passed through.
+     */
+    bool filter(float* landmarks, int64_t timestamp_ns);
+
+private:
+    alignas(16) float value_[kChannels][kPadded];
+    alignas(16) float deriv_[kChannels][kPadded];
+    float min_cutoff_[kChannels];
+    float beta_[kChannels];
+    float d_cutoff_;
+    int64_t reset_gap_ns_;
+    int64_t last_ns_;
+    bool initialized_;
+};
+
+#endif // LANDMARK_FILTER_H
@@ -0,0 +1,92 @@
+#include <jni.h>
+#include <android/log.h>
+#include "jni_support.h"
+#include "landmark_filter.h"
+
+#define LOG_TAG "LandmarkFilter-JNI"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+// Bindings for com.esw.postureanalyzer.vision.LandmarkFilter, registered from
+// JNI_OnLoad
+
+namespace {
+
+const char* const kClassName = "com/esw/postureanalyzer/vision/LandmarkFilter";
+const jsize kValues = LandmarkFilter::kLandmarks * LandmarkFilter::kChannels;
+
+jlong nativeCreate(JNIEnv* env, jobject thiz) {
+    return reinterpret_cast<jlong>(new LandmarkFilter());
+}
+
+void nativeDestroy(JNIEnv* env, jobject thiz, jlong native_ptr) {
+    delete reinterpret_cast<LandmarkFilter*>(native_ptr);
+}
+
+// @FastNative on API 26+; the signature is the same as regular JNI
+jboolean nativeFilter(JNIEnv* env, jobject thiz, jlong native_ptr,
+                      jfloatArray landmarks, jlong timestamp_ns) {
+    LandmarkFilter* filter = reinterpret_cast<LandmarkFilter*>(native_ptr);
+    if (!filter || env->GetArrayLength(landmarks) < kValues) {
+        return JNI_FALSE;
+    }
+
+    // Critical access pins the array instead of copying it; the filter is a
+    // few hundred arithmetic ops and never calls back into the VM
+    float* values = static_cast<float*>(env->GetPrimitiveArrayCritical(landmarks, nullptr));
+    if (!values) {
+        LOGE("Failed to access landmark array");
+        return JNI_FALSE;
+    }
+    bool filtered = filter->filter(values, timestamp_ns);
+    env->ReleasePrimitiveArrayCritical(landmarks, values, 0);
+    return filtered ? JNI_TRUE : JNI_FALSE;
+}
+
+void nativeSetParams(JNIEnv* env, jobject thiz, jlong native_ptr,
+                     jint channel, jfloat min_cutoff, jfloat beta, jfloat d_cutoff) {
+    LandmarkFilter* filter = reinterpret_cast<LandmarkFilter*>(native_ptr);
+    if (filter) {
+        filter->setParams(channel, min_cutoff, beta);
+        filter->setDerivativeCutoff(d_cutoff);
+    }
+}
+
+// @CriticalNative on API 26+: no JNIEnv / jclass parameters
+void criticalReset(jlong native_ptr) {
+    LandmarkFilter* filter = reinterpret_cast<LandmarkFilter*>(native_ptr);
+    if (filter) {
+        filter->reset();
+    }
+}
+
+// Regular-convention wrapper for API 24-25
+void nativeReset(JNIEnv* env, jclass clazz, jlong native_ptr) {
+    criticalReset(native_ptr);
+}
+
+const JNINativeMethod kMethods[] = {
+    {"nativeCreate", "()J", reinterpret_cast<void*>(nativeCreate)},
+    {"nativeDestroy", "(J)V", reinterpret_cast<void*>(nativeDestroy)},
+    {"nativeFilter", "(J[FJ)Z", reinterpret_cast<void*>(nativeFilter)},
+    {"nativeSetParams", "(JIFFF)V", reinterpret_cast<void*>(nativeSetParams)},
+};
+
+const JNINativeMethod kCriticalReset[] = {
+    {"nativeReset", "(J)V", reinterpret_cast<void*>(criticalReset)},
+};
+
+const JNINativeMethod kRegularReset[] = {
+    {"nativeReset", "(J)V", reinterpret_cast<void*>(nativeReset)},
+};
+
+} // namespace
+
+bool registerLandmarkFilterNatives(JNIEnv* env) {
+    if (!jni::registerNatives(env, kClassName, kMethods, jni::arraySize(kMethods))) {
+        return false;
+    }
+    if (jni::criticalNativeSupported()) {
+        return jni::registerNatives(env, kClassName, kCriticalReset, jni::arraySize(kCriticalReset));
+    }
+    return jni::registerNatives(env, kClassName, kRegularReset, jni::arraySize(kRegularReset));
+}
@@ -0,0 +1,355 @@
+#include "mjpeg_encoder.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+const uint8_t kZigzag[64] = {
+    0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+// ITU T.81 Annex K.1, natural order
+const uint8_t kLumaQuant[64] = {
+    16, 11, 10, 16, 24, 40, 51, 61,
+    12, 12, 14, 19, 26, 58, 60, 55,
+    14, 13, 16, 24, 40, 57, 69, 56,
+    14, 17, 22, 29, 51, 87, 80, 62,
+    18, 22, 37, 56, 68, 109, 103, 77,
+    24, 35, 55, 64, 81, 104, 113, 92,
+    49, 64, 78, 87, 103, 121, 120, 101,
+    72, 92, 95, 98, 112, 100, 103, 99,
+};
+
+const uint8_t kChromaQuant[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99,
+    18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99,
+    47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+};
+
+// Annex K.3 Huffman tables: code counts per length 1..16, then symbols
+const uint8_t kDcLumaBits[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+const uint8_t kDcChromaBits[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+const uint8_t kDcValues[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+const uint8_t kAcLumaBits[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+const uint8_t kAcLumaValues[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa,
+};
+
+const uint8_t kAcChromaBits[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+const uint8_t kAcChromaValues[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa,
+};
+
+struct HuffmanTable {
+    uint16_t code[256];
+    uint8_t length[256];
+
+    HuffmanTable(const uint8_t* bits, const uint8_t* values) {
+        memset(code, 0, sizeof(code));
+        memset(length, 0, sizeof(length));
+        uint16_t next = 0;
+        int k = 0;
+        for (int len = 1; len <= 16; len++) {
+            for (int i = 0; i < bits[len - 1]; i++) {
+                code[values[k]] = next++;
+                length[values[k]] = static_cast<uint8_t>(len);
+                k++;
+            }
+            next <<= 1;
+        }
+    }
+};
+
+const HuffmanTable& dcLuma() { static const HuffmanTable t(kDcLumaBits, kDcValues); return t; }
+const HuffmanTable& dcChroma() { static const HuffmanTable t(kDcChromaBits, kDcValues); return t; }
+const HuffmanTable& acLuma() { static const HuffmanTable t(kAcLumaBits, kAcLumaValues); return t; }
+const HuffmanTable& acChroma() { static const HuffmanTable t(kAcChromaBits, kAcChromaValues); return t; }
+
+// cos((2x + 1) u pi / 16) scaled by C(u) / 2
+struct DctTable {
+    float c[8][8];
+
+    DctTable() {
+        for (int u = 0; u < 8; u++) {
+            float scale = u == 0 ? 0.5f / std::sqrt(2.0f) : 0.5f;
+            for (int x = 0; x < 8; x++) {
+                c[u][x] = scale * std::cos((2 * x + 1) * u * 3.14159265358979f / 16.0f);
+            }
+        }
+    }
+};
+
+const DctTable& dct() { static const DctTable t; return t; }
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>* out) : out_(out), buffer_(0), count_(0) {}
+
+    void write(uint32_t bits, int length) {
+        for (int i = length - 1; i >= 0; i--) {
+            buffer_ = static_cast<uint8_t>((buffer_ << 1) | ((bits >> i) & 1));
+            if (++count_ == 8) {
+                emit();
+            }
+        }
+    }
+
+    // Pad the last byte with 1 bits, as T.81 F.1.2.3 requires
+    void flush() {
+        while (count_ != 0) {
+            write(1, 1);
+        }
+    }
+
+private:
+    std::vector<uint8_t>* out_;
+    uint8_t buffer_;
+    int count_;
+
+    void emit() {
+        out_->push_back(buffer_);
+        if (buffer_ == 0xFF) {
+            out_->push_back(0x00);  // byte stuffing
+        }
+        buffer_ = 0;
+        count_ = 0;
+    }
+};
+
+int bitLength(int value) {
+    int magnitude = value < 0 ? -value : value;
+    int length = 0;
+    while (magnitude) {
+        length++;
+        magnitude >>= 1;
+    }
+    return length;
+}
+
+void encodeBlock(BitWriter* writer, const float* samples, const uint8_t* quant, int* previous_dc,
+                 const HuffmanTable& dc, const HuffmanTable& ac) {
+    const DctTable& t = dct();
+
+    // Separable 2D DCT-II
+    float rows[64];
+    for (int y = 0; y < 8; y++) {
+        for (int u = 0; u < 8; u++) {
+            float sum = 0.0f;
+            for (int x = 0; x < 8; x++) {
+                sum += t.c[u][x] * samples[y * 8 + x];
+            }
+            rows[y * 8 + u] = sum;
+        }
+    }
+    int coefficients[64];
+    for (int u = 0; u < 8; u++) {
+        for (int v = 0; v < 8; v++) {
+            float sum = 0.0f;
+            for (int y = 0; y < 8; y++) {
+                sum += t.c[v][y] * rows[y * 8 + u];
+            }
+            coefficients[v * 8 + u] = static_cast<int>(std::lround(sum / quant[v * 8 + u]));
+        }
+    }
+
+    int diff = coefficients[0] - *previous_dc;
+    *previous_dc = coefficients[0];
+    int size = bitLength(diff);
+    writer->write(dc.code[size], dc.length[size]);
+    if (size) {
+        writer->write(static_cast<uint32_t>(diff < 0 ? diff + (1 << size) - 1 : diff), size);
+    }
+
+    int run = 0;
+    for (int k = 1; k < 64; k++) {
+        int value = coefficients[kZigzag[k]];
+        if (value == 0) {
+            run++;
+            continue;
+        }
+        while (run >= 16) {
+            writer->write(ac.code[0xF0], ac.length[0xF0]);
+            run -= 16;
+        }
+        size = bitLength(value);
+        int symbol = (run << 4) | size;
+        writer->write(ac.code[symbol], ac.length[symbol]);
+        writer->write(static_cast<uint32_t>(value < 0 ? value + (1 << size) - 1 : value), size);
+        run = 0;
+    }
+    if (run > 0) {
+        writer->write(ac.code[0x00], ac.length[0x00]);  // EOB
+    }
+}
+
+void put16(std::vector<uint8_t>* out, int value) {
+    out->push_back(static_cast<uint8_t>(value >> 8));
+    out->push_back(static_cast<uint8_t>(value & 0xFF));
+}
+
+void putMarker(std::vector<uint8_t>* out, uint8_t marker, int length) {
+    out->push_back(0xFF);
+    out->push_back(marker);
+    put16(out, length);
+}
+
+void putHuffman(std::vector<uint8_t>* out, uint8_t table_class_id, const uint8_t* bits,
+                const uint8_t* values, int count) {
+    putMarker(out, 0xC4, 2 + 1 + 16 + count);
+    out->push_back(table_class_id);
+    out->insert(out->end(), bits, bits + 16);
+    out->insert(out->end(), values, values + count);
+}
+
+} // namespace
+
+MjpegEncoder::MjpegEncoder(int quality) {
+    if (quality < 1) quality = 1;
+    if (quality > 100) quality = 100;
+    int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+    for (int i = 0; i < 64; i++) {
+        int luma = (kLumaQuant[i] * scale + 50) / 100;
+        int chroma = (kChromaQuant[i] * scale + 50) / 100;
+        luma_quant_[i] = static_cast<uint8_t>(luma < 1 ? 1 : (luma > 255 ? 255 : luma));
+        chroma_quant_[i] = static_cast<uint8_t>(chroma < 1 ? 1 : (chroma > 255 ? 255 : chroma));
+    }
+}
+
+bool MjpegEncoder::encodeYUYV(const uint8_t* yuyv, int width, int height, int stride,
+                              std::vector<uint8_t>* out) const {
+    if (!yuyv || width <= 0 || height <= 0 || width % 2 != 0 || width > 65535 || height > 65535) {
+        return false;
+    }
+    out->clear();
+    out->reserve(static_cast<size_t>(width) * height / 4);
+
+    // SOI, JFIF APP0
+    out->push_back(0xFF);
+    out->push_back(0xD8);
+    static const uint8_t kJfif[] = {'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0};
+    putMarker(out, 0xE0, 2 + sizeof(kJfif));
+    out->insert(out->end(), kJfif, kJfif + sizeof(kJfif));
+
+    // DQT, zigzag order
+    putMarker(out, 0xDB, 2 + 2 * 65);
+    out->push_back(0x00);
+    for (int k = 0; k < 64; k++) out->push_back(luma_quant_[kZigzag[k]]);
+    out->push_back(0x01);
+    for (int k = 0; k < 64; k++) out->push_back(chroma_quant_[kZigzag[k]]);
+
+    // SOF0: Y sampled 2x1, Cb and Cr 1x1 (4:2:2 like the source)
+    putMarker(out, 0xC0, 2 + 6 + 3 * 3);
+    out->push_back(8);
+    put16(out, height);
+    put16(out, width);
+    out->push_back(3);
+    static const uint8_t kComponents[] = {1, 0x21, 0, 2, 0x11, 1, 3, 0x11, 1};
+    out->insert(out->end(), kComponents, kComponents + sizeof(kComponents));
+
+    putHuffman(out, 0x00, kDcLumaBits, kDcValues, 12);
+    putHuffman(out, 0x10, kAcLumaBits, kAcLumaValues, 162);
+    putHuffman(out, 0x01, kDcChromaBits, kDcValues, 12);
+    putHuffman(out, 0x11, kAcChromaBits, kAcChromaValues, 162);
+
+    // SOS
+    putMarker(out, 0xDA, 2 + 1 + 3 * 2 + 3);
+    static const uint8_t kScan[] = {3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0};
+    out->insert(out->end(), kScan, kScan + sizeof(kScan));
+
+    BitWriter writer(out);
+    int dc_y = 0, dc_cb = 0, dc_cr = 0;
+    float y_block[2][64];
+    float cb_block[64];
+    float cr_block[64];
+    const int chroma_width = width / 2;
+
+    // 16x8 MCUs; edge samples are replicated past the frame border
+    for (int mcu_y = 0; mcu_y < height; mcu_y += 8) {
+        for (int mcu_x = 0; mcu_x < width; mcu_x += 16) {
+            for (int y = 0; y < 8; y++) {
+                int sy = mcu_y + y < height ? mcu_y + y : height - 1;
+                const uint8_t* row = yuyv + static_cast<size_t>(sy) * stride;
+                for (int x = 0; x < 16; x++) {
+                    int sx = mcu_x + x < width ? mcu_x + x : width - 1;
+                    y_block[x / 8][y * 8 + (x % 8)] = row[sx * 2] - 128.0f;
+                }
+                for (int x = 0; x < 8; x++) {
+                    int cx = mcu_x / 2 + x < chroma_width ? mcu_x / 2 + x : chroma_width - 1;
+                    cb_block[y * 8 + x] = row[cx * 4 + 1] - 128.0f;
+                    cr_block[y * 8 + x] = row[cx * 4 + 3] - 128.0f;
+                }
+            }
+            encodeBlock(&writer, y_block[0], luma_quant_, &dc_y, dcLuma(), acLuma());
+            encodeBlock(&writer, y_block[1], luma_quant_, &dc_y, dcLuma(), acLuma());
+            encodeBlock(&writer, cb_block, chroma_quant_, &dc_cb, dcChroma(), acChroma());
+            encodeBlock(&writer, cr_block, chroma_quant_, &dc_cr, dcChroma(), acChroma());
+        }
+    }
+    writer.flush();
+
+    // EOI
+    out->push_back(0xFF);
+    out->push_back(0xD9);
+    return true;
+}
+
+bool MjpegEncoder::dimensions(const uint8_t* data, int size, int* width, int* height) {
+    if (!data || size < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+        return false;
+    }
+    int pos = 2;
+    while (pos + 4 <= size) {
+        if (data[pos] != 0xFF) {
+            return false;
+        }
+        uint8_t marker = data[pos + 1];
+        if (marker == 0xFF) {
+            pos++;  // fill byte
+            continue;
+        }
+        int length = (data[pos + 2] << 8) | data[pos + 3];
+        bool sof = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if (sof) {
+            if (pos + 9 > size) {
+                return false;
+            }
+            *height = (data[pos + 5] << 8) | data[pos + 6];
+            *width = (data[pos + 7] << 8) | data[pos + 8];
+            return *width > 0 && *height > 0;
+        }
+        if (marker == 0xDA || marker == 0xD9) {
+            return false;  // reached the scan without a frame header
+        }
+        pos += 2 + length;
+    }
+    return false;
+}
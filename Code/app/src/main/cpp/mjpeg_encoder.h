@@ -0,0 +1,30 @@
+#ifndef MJPEG_ENCODER_H
+#define MJPEG_ENCODER_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Minimal baseline JPEG encoder for YUYV frames (4:2:2, standard Annex K
+ * quantization and Huffman tables), enough to produce MJPEG test streams
+ * that BitmapFactory and libjpeg decode. Not tuned for speed: callers
+ * encode a few frames up front and reuse them.
+ */
+class MjpegEncoder {
+public:
+    // quality 1..100, scaled as in libjpeg
+    explicit MjpegEncoder(int quality = 80);
+
+    // Encode one YUYV frame (stride in bytes) into out; width must be even
+    bool encodeYUYV(const uint8_t* yuyv, int width, int height, int stride,
+                    std::vector<uint8_t>* out) const;
+
+    // Size of a baseline or progressive JPEG from its SOF segment
+    static bool dimensions(const uint8_t* data, int size, int* width, int* height);
+
+private:
+    uint8_t luma_quant_[64];    // natural order
+    uint8_t chroma_quant_[64];
+};
+
+#endif // MJPEG_ENCODER_H
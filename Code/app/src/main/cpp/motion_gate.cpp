@@ -0,0 +1,167 @@
+#include "motion_gate.h"
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MOTION_GATE_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define MOTION_GATE_SSE2 1
+#endif
+
+namespace {
+
+const int kBlocksPerRow = MotionGate::kGridWidth / MotionGate::kBlockSize;
+const int kBlockRows = MotionGate::kGridHeight / MotionGate::kBlockSize;
+const int kGridSize = MotionGate::kGridWidth * MotionGate::kGridHeight;
+
+// Per-block SAD over one row of blocks (kBlockSize grid rows)
+void blockRowSad(const uint8_t* cur, const uint8_t* bg, uint32_t* sad) {
+#if defined(MOTION_GATE_NEON)
+    uint16x8_t acc[kBlocksPerRow];
+    for (int b = 0; b < kBlocksPerRow; ++b) {
+        acc[b] = vdupq_n_u16(0);
+    }
+    for (int y = 0; y < MotionGate::kBlockSize; ++y) {
+        const uint8_t* c = cur + y * MotionGate::kGridWidth;
+        const uint8_t* g = bg + y * MotionGate::kGridWidth;
+        for (int b = 0; b < kBlocksPerRow; ++b) {
+            acc[b] = vabal_u8(acc[b], vld1_u8(c + b * 8), vld1_u8(g + b * 8));
+        }
+    }
+    for (int b = 0; b < kBlocksPerRow; ++b) {
+        uint64x2_t s = vpaddlq_u32(vpaddlq_u16(acc[b]));
+        sad[b] = static_cast<uint32_t>(vgetq_lane_u64(s, 0) + vgetq_lane_u64(s, 1));
+    }
+#elif defined(MOTION_GATE_SSE2)
+    // _mm_sad_epu8 sums each 8-byte half separately: one half per block
+    __m128i acc[kBlocksPerRow / 2];
+    for (int c = 0; c < kBlocksPerRow / 2; ++c) {
+        acc[c] = _mm_setzero_si128();
+    }
+    for (int y = 0; y < MotionGate::kBlockSize; ++y) {
+        const uint8_t* c = cur + y * MotionGate::kGridWidth;
+        const uint8_t* g = bg + y * MotionGate::kGridWidth;
+        for (int k = 0; k < kBlocksPerRow / 2; ++k) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + k * 16));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(g + k * 16));
+            acc[k] = _mm_add_epi64(acc[k], _mm_sad_epu8(a, b));
+        }
+    }
+    for (int k = 0; k < kBlocksPerRow / 2; ++k) {
+        sad[2 * k] = static_cast<uint32_t>(_mm_cvtsi128_si32(acc[k]));
+        sad[2 * k + 1] = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(acc[k], 8)));
+    }
+#else
+    for (int b = 0; b < kBlocksPerRow; ++b) {
+        sad[b] = 0;
+    }
+    for (int y = 0; y < MotionGate::kBlockSize; ++y) {
+        const uint8_t* c = cur + y * MotionGate::kGridWidth;
+        const uint8_t* g = bg + y * MotionGate::kGridWidth;
+        for (int x = 0; x < MotionGate::kGridWidth; ++x) {
+            int d = c[x] - g[x];
+            sad[x / 8] += static_cast<uint32_t>(d < 0 ? -d : d);
+        }
+    }
+#endif
+}
+
+// background += (cur - background) / 8, as three rounding halvings
+void blendBackground(const uint8_t* cur, uint8_t* bg) {
+#if defined(MOTION_GATE_NEON)
+    for (int i = 0; i < kGridSize; i += 16) {
+        uint8x16_t g = vld1q_u8(bg + i);
+        uint8x16_t t = vrhaddq_u8(g, vld1q_u8(cur + i));
+        t = vrhaddq_u8(g, t);
+        t = vrhaddq_u8(g, t);
+        vst1q_u8(bg + i, t);
+    }
+#elif defined(MOTION_GATE_SSE2)
+    for (int i = 0; i < kGridSize; i += 16) {
+        __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bg + i));
+        __m128i t = _mm_avg_epu8(g, _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + i)));
+        t = _mm_avg_epu8(g, t);
+        t = _mm_avg_epu8(g, t);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(bg + i), t);
+    }
+#else
+    for (int i = 0; i < kGridSize; ++i) {
+        bg[i] = static_cast<uint8_t>((bg[i] * 7 + cur[i] + 4) >> 3);
+    }
+#endif
+}
+
+} // namespace
+
+MotionGate::MotionGate()
+    : has_background_(false), block_threshold_(12), last_score_(1.0f) {
+    memset(luma_, 0, sizeof(luma_));
+    memset(background_, 0, sizeof(background_));
+}
+
+void MotionGate::reset() {
+    has_background_ = false;
+    last_score_ = 1.0f;
+}
+
+float MotionGate::updateYUYV(const uint8_t* data, int width, int height, int stride) {
+    if (!data || width < kGridWidth || height < kGridHeight) {
+        return last_score_ = 1.0f;
+    }
+
+    // Sample one macropixel per grid cell and average its two Y values
+    for (int gy = 0; gy < kGridHeight; ++gy) {
+        const uint8_t* row = data + (gy * height / kGridHeight) * stride;
+        uint8_t* out = luma_ + gy * kGridWidth;
+        for (int gx = 0; gx < kGridWidth; ++gx) {
+            const uint8_t* px = row + ((gx * width / kGridWidth) & ~1) * 2;
+            out[gx] = static_cast<uint8_t>((px[0] + px[2] + 1) >> 1);
+        }
+    }
+    return evaluate();
+}
+
+float MotionGate::updateRGBA(const uint8_t* data, int width, int height, int stride) {
+    if (!data || width < kGridWidth || height < kGridHeight) {
+        return last_score_ = 1.0f;
+    }
+
+    // BT.601 luma in 8.8 fixed point
+    for (int gy = 0; gy < kGridHeight; ++gy) {
+        const uint8_t* row = data + (gy * height / kGridHeight) * stride;
+        uint8_t* out = luma_ + gy * kGridWidth;
+        for (int gx = 0; gx < kGridWidth; ++gx) {
+            const uint8_t* px = row + (gx * width / kGridWidth) * 4;
+            out[gx] = static_cast<uint8_t>((77 * px[0] + 150 * px[1] + 29 * px[2]) >> 8);
+        }
+    }
+    return evaluate();
+}
+
+float MotionGate::evaluate() {
+    if (!has_background_) {
+        memcpy(background_, luma_, sizeof(background_));
+        has_background_ = true;
+        return last_score_ = 1.0f;
+    }
+
+    const uint32_t sad_threshold = static_cast<uint32_t>(block_threshold_ * kBlockSize * kBlockSize);
+    uint32_t sad[kBlocksPerRow];
+    int changed = 0;
+
+    for (int by = 0; by < kBlockRows; ++by) {
+        int offset = by * kBlockSize * kGridWidth;
+        blockRowSad(luma_ + offset, background_ + offset, sad);
+        for (int b = 0; b < kBlocksPerRow; ++b) {
+            if (sad[b] > sad_threshold) {
+                ++changed;
+            }
+        }
+    }
+
+    blendBackground(luma_, background_);
+
+    last_score_ = static_cast<float>(changed) / kBlockCount;
+    return last_score_;
+}
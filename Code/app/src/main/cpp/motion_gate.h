@@ -0,0 +1,46 @@
+#ifndef MOTION_GATE_H
+#define MOTION_GATE_H
+
+#include <cstdint>
+
+/**
+ * Cheap frame-difference motion detector.
+ *
+ * Frames are sampled into a small luma grid, compared block-by-block (SAD)
+ * against a running background and the fraction of changed blocks is
+ * returned as the motion score (0 = static, 1 = everything changed).
+ */
+class MotionGate {
+public:
+    static const int kGridWidth = 64;
+    static const int kGridHeight = 48;
+    static const int kBlockSize = 8;
+    static const int kBlockCount = (kGridWidth / kBlockSize) * (kGridHeight / kBlockSize);
+
+    MotionGate();
+
+    // Forget the background; the next frame is reported as full motion
+    void reset();
+
+    // Mean absolute luma difference per pixel above which a block counts as changed
+    void setBlockThreshold(int threshold) { block_threshold_ = threshold; }
+
+    // Score a packed YUYV frame (stride in bytes)
+    float updateYUYV(const uint8_t* data, int width, int height, int stride);
+
+    // Score an RGBA_8888 frame (stride in bytes)
+    float updateRGBA(const uint8_t* data, int width, int height, int stride);
+
+    float lastScore() const { return last_score_; }
+
+private:
+    uint8_t luma_[kGridWidth * kGridHeight];
+    uint8_t background_[kGridWidth * kGridHeight];
+    bool has_background_;
+    int block_threshold_;
+    float last_score_;
+
+    float evaluate();
+};
+
+#endif // MOTION_GATE_H
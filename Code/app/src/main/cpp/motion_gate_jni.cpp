@@ -0,0 +1,103 @@
+#include <jni.h>
+#include <android/bitmap.h>
+#include <android/log.h>
+#include "jni_support.h"
+#include "motion_gate.h"
+
+#define LOG_TAG "MotionGate-JNI"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+// Bindings for com.esw.postureanalyzer.vision.MotionGate, registered from
+// JNI_OnLoad
+
+namespace {
+
+const char* const kClassName = "com/esw/postureanalyzer/vision/MotionGate";
+
+jlong nativeCreate(JNIEnv* env, jobject thiz) {
+    return reinterpret_cast<jlong>(new MotionGate());
+}
+
+void nativeDestroy(JNIEnv* env, jobject thiz, jlong native_ptr) {
+    delete reinterpret_cast<MotionGate*>(native_ptr);
+}
+
+jfloat nativeUpdateRgba(JNIEnv* env, jobject thiz, jlong native_ptr,
+                        jobject buffer, jint width, jint height, jint row_stride) {
+    MotionGate* gate = reinterpret_cast<MotionGate*>(native_ptr);
+    if (!gate) {
+        return -1.0f;
+    }
+
+    const uint8_t* pixels = static_cast<const uint8_t*>(env->GetDirectBufferAddress(buffer));
+    if (!pixels || env->GetDirectBufferCapacity(buffer) < static_cast<jlong>(row_stride) * height) {
+        LOGE("RGBA buffer is not direct or too small");
+        return -1.0f;
+    }
+
+    return gate->updateRGBA(pixels, width, height, row_stride);
+}
+
+jfloat nativeUpdateBitmap(JNIEnv* env, jobject thiz, jlong native_ptr, jobject bitmap) {
+    MotionGate* gate = reinterpret_cast<MotionGate*>(native_ptr);
+    if (!gate) {
+        return -1.0f;
+    }
+
+    AndroidBitmapInfo info;
+    if (AndroidBitmap_getInfo(env, bitmap, &info) != ANDROID_BITMAP_RESULT_SUCCESS ||
+        info.format != ANDROID_BITMAP_FORMAT_RGBA_8888) {
+        return -1.0f;
+    }
+
+    void* pixels = nullptr;
+    if (AndroidBitmap_lockPixels(env, bitmap, &pixels) != ANDROID_BITMAP_RESULT_SUCCESS) {
+        LOGE("Failed to lock bitmap pixels");
+        return -1.0f;
+    }
+
+    float score = gate->updateRGBA(static_cast<const uint8_t*>(pixels),
+                                   info.width, info.height, info.stride);
+    AndroidBitmap_unlockPixels(env, bitmap);
+    return score;
+}
+
+// @CriticalNative on API 26+: no JNIEnv / jclass parameters
+void criticalReset(jlong native_ptr) {
+    MotionGate* gate = reinterpret_cast<MotionGate*>(native_ptr);
+    if (gate) {
+        gate->reset();
+    }
+}
+
+// Regular-convention wrapper for API 24-25
+void nativeReset(JNIEnv* env, jclass clazz, jlong native_ptr) {
+    criticalReset(native_ptr);
+}
+
+const JNINativeMethod kMethods[] = {
+    {"nativeCreate", "()J", reinterpret_cast<void*>(nativeCreate)},
+    {"nativeDestroy", "(J)V", reinterpret_cast<void*>(nativeDestroy)},
+    {"nativeUpdateRgba", "(JLjava/nio/ByteBuffer;III)F", reinterpret_cast<void*>(nativeUpdateRgba)},
+    {"nativeUpdateBitmap", "(JLandroid/graphics/Bitmap;)F", reinterpret_cast<void*>(nativeUpdateBitmap)},
+};
+
+const JNINativeMethod kCriticalReset[] = {
+    {"nativeReset", "(J)V", reinterpret_cast<void*>(criticalReset)},
+};
+
+const JNINativeMethod kRegularReset[] = {
+    {"nativeReset", "(J)V", reinterpret_cast<void*>(nativeReset)},
+};
+
+} // namespace
+
+bool registerMotionGateNatives(JNIEnv* env) {
+    if (!jni::registerNatives(env, kClassName, kMethods, jni::arraySize(kMethods))) {
+        return false;
+    }
+    if (jni::criticalNativeSupported()) {
+        return jni::registerNatives(env, kClassName, kCriticalReset, jni::arraySize(kCriticalReset));
+    }
+    return jni::registerNatives(env, kClassName, kRegularReset, jni::arraySize(kRegularReset));
+}
@@ -0,0 +1,141 @@
+#include "replay_source.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+#include <android/log.h>
+
+#define LOG_TAG "ReplaySource"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+ReplaySource::ReplaySource()
+    : fd_(-1), map_(nullptr), map_size_(0), fps_(0), loop_(false),
+      frame_size_(0), frame_count_(0), streaming_(false), next_frame_(0), sequence_(0) {
+}
+
+ReplaySource::~ReplaySource() {
+    close();
+}
+
+bool ReplaySource::open(const OpenArgs& args) {
+    if (!args.path) {
+        LOGE("No recording path given");
+        return false;
+    }
+
+    fd_ = ::open(args.path, O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        LOGE("Failed to open %s: %s", args.path, strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) < 0 || st.st_size <= 0) {
+        LOGE("Recording %s is empty or unreadable", args.path);
+        close();
+        return false;
+    }
+
+    map_size_ = static_cast<size_t>(st.st_size);
+    void* map = mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (map == MAP_FAILED) {
+        LOGE("Failed to mmap %s: %s", args.path, strerror(errno));
+        map_size_ = 0;
+        close();
+        return false;
+    }
+    madvise(map, map_size_, MADV_SEQUENTIAL);
+    map_ = static_cast<const uint8_t*>(map);
+
+    fps_ = args.fps;
+    loop_ = args.loop;
+    LOGI("Opened recording %s (%zu bytes)", args.path, map_size_);
+    return true;
+}
+
+void ReplaySource::close() {
+    stop();
+    if (map_) {
+        munmap(const_cast<uint8_t*>(map_), map_size_);
+        map_ = nullptr;
+        map_size_ = 0;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    frame_count_ = 0;
+}
+
+bool ReplaySource::negotiate(const FrameFormat& requested, FrameFormat* actual) {
+    if (requested.pixelFormat != kFourccYUYV || requested.width <= 0 || requested.height <= 0) {
+        LOGE("Replay supports raw YUYV recordings only");
+        return false;
+    }
+
+    FrameFormat format(requested.width, requested.height, kFourccYUYV);
+    format.bytesPerLine = requested.width * 2;
+    int frame_size = format.imageSize();
+    int frame_count = static_cast<int>(map_size_ / static_cast<size_t>(frame_size));
+    if (frame_count == 0) {
+        LOGE("Recording holds no complete %dx%d frame", format.width, format.height);
+        return false;
+    }
+    if (map_size_ % static_cast<size_t>(frame_size) != 0) {
+        LOGI("Ignoring %zu trailing bytes", map_size_ % static_cast<size_t>(frame_size));
+    }
+
+    format_ = format;
+    frame_size_ = frame_size;
+    frame_count_ = frame_count;
+    *actual = format_;
+    LOGI("Replaying %d frames of %dx%d at %d fps", frame_count_, format_.width, format_.height, fps_);
+    return true;
+}
+
+bool ReplaySource::start() {
+    if (frame_count_ == 0) {
+        return false;
+    }
+    next_frame_ = 0;
+    sequence_ = 0;
+    pacer_.start(fps_);
+    streaming_ = true;
+    return true;
+}
+
+void ReplaySource::stop() {
+    streaming_ = false;
+}
+
+LeaseResult ReplaySource::lease(FrameDescriptor* frame, int timeout_ms) {
+    if (!streaming_) {
+        return kLeaseError;
+    }
+    if (next_frame_ >= frame_count_) {
+        if (!loop_) {
+            return kLeaseEndOfStream;
+        }
+        next_frame_ = 0;
+    }
+
+    int64_t timestamp_ns = 0;
+    if (!pacer_.wait(sequence_, timeout_ms, &timestamp_ns)) {
+        return kLeaseTimeout;
+    }
+
+    frame->data = map_ + static_cast<size_t>(next_frame_) * frame_size_;
+    frame->size = frame_size_;
+    frame->format = format_;
+    frame->timestampNs = timestamp_ns;
+    frame->sequence = sequence_++;
+    frame->slot = next_frame_++;
+    return kLeaseOk;
+}
+
+void ReplaySource::release(const FrameDescriptor& /* frame */) {
+    // Nothing to do: the mapping outlives every lease
+}
@@ -0,0 +1,56 @@
+#ifndef REPLAY_SOURCE_H
+#define REPLAY_SOURCE_H
+
+#include <cstddef>
+#include "frame_source.h"
+
+/**
+ * Capture backend that plays back a recording of raw YUYV frames (the
+ * frames written back to back, no header) at a fixed rate. The file is
+ * mmap'd, so leased frames point into the page cache with no copy.
+ */
+class ReplaySource {
+public:
+    struct OpenArgs {
+        const char* path;
+        int fps;    // <= 0 replays as fast as frames are leased
+        bool loop;  // restart at the end instead of reporting end of stream
+    };
+
+    // Frames are read-only views of the mapping
+    static const int kMaxLeases = 4;
+
+    static const char* name() { return "replay"; }
+
+    ReplaySource();
+    ~ReplaySource();
+
+    bool open(const OpenArgs& args);
+    void close();
+    // The recording has no header, so the requested YUYV size is trusted
+    bool negotiate(const FrameFormat& requested, FrameFormat* actual);
+    bool start();
+    void stop();
+    LeaseResult lease(FrameDescriptor* frame, int timeout_ms);
+    void release(const FrameDescriptor& frame);
+
+    int frameCount() const { return frame_count_; }
+
+private:
+    int fd_;
+    const uint8_t* map_;
+    size_t map_size_;
+    int fps_;
+    bool loop_;
+
+    FrameFormat format_;
+    int frame_size_;
+    int frame_count_;
+
+    bool streaming_;
+    int next_frame_;
+    uint32_t sequence_;
+    FramePacer pacer_;
+};
+
+#endif // REPLAY_SOURCE_H
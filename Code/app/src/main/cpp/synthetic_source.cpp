@@ -0,0 +1,252 @@
+#include "synthetic_source.h"
+#include <cstring>
+#include <android/log.h>
+#include "mjpeg_encoder.h"
+
+#define LOG_TAG "SyntheticSource"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+// Bar width in pixels
+const int kBarWidth = 16;
+
+// COM segment carrying the stamp: marker, length (includes itself), stamp
+const int kStampSegmentSize = 4 + SyntheticStamp::kSize;
+
+} // namespace
+
+void SyntheticStamp::write(uint8_t* dst, uint32_t sequence, int64_t timestamp_ns) {
+    uint64_t timestamp = static_cast<uint64_t>(timestamp_ns);
+    for (int i = 0; i < 4; i++) {
+        dst[i] = static_cast<uint8_t>(kMagic >> (8 * i));
+        dst[4 + i] = static_cast<uint8_t>(sequence >> (8 * i));
+    }
+    for (int i = 0; i < 8; i++) {
+        dst[8 + i] = static_cast<uint8_t>(timestamp >> (8 * i));
+    }
+}
+
+bool SyntheticStamp::read(const uint8_t* src, int size, uint32_t* sequence, int64_t* timestamp_ns) {
+    if (size >= kMjpegOffset + kSize && src[0] == 0xFF && src[1] == 0xD8) {
+        src += kMjpegOffset;
+    } else if (size < kSize) {
+        return false;
+    }
+    uint32_t magic = 0;
+    uint32_t seq = 0;
+    uint64_t timestamp = 0;
+    for (int i = 0; i < 4; i++) {
+        magic |= static_cast<uint32_t>(src[i]) << (8 * i);
+        seq |= static_cast<uint32_t>(src[4 + i]) << (8 * i);
+    }
+    for (int i = 0; i < 8; i++) {
+        timestamp |= static_cast<uint64_t>(src[8 + i]) << (8 * i);
+    }
+    if (magic != kMagic) {
+        return false;
+    }
+    *sequence = seq;
+    *timestamp_ns = static_cast<int64_t>(timestamp);
+    return true;
+}
+
+SyntheticSource::SyntheticSource()
+    : opened_(false), streaming_(false), sequence_(0) {
+    memset(leased_, 0, sizeof(leased_));
+}
+
+bool SyntheticSource::open(const OpenArgs& args) {
+    args_ = args;
+    template_.clear();
+    if (args.mjpegTemplate && args.mjpegTemplateSize > 0) {
+        template_.assign(args.mjpegTemplate, args.mjpegTemplate + args.mjpegTemplateSize);
+    }
+    // Only a view of the caller's bytes; the copy above is what is kept
+    args_.mjpegTemplate = nullptr;
+    opened_ = true;
+    return true;
+}
+
+void SyntheticSource::close() {
+    stop();
+    for (int i = 0; i < kMaxLeases; i++) {
+        std::vector<uint8_t>().swap(buffers_[i]);
+    }
+    std::vector<std::vector<uint8_t> >().swap(encoded_);
+    std::vector<uint8_t>().swap(template_);
+    opened_ = false;
+}
+
+bool SyntheticSource::negotiate(const FrameFormat& requested, FrameFormat* actual) {
+    if (!opened_) {
+        return false;
+    }
+
+    FrameFormat format;
+    if (requested.pixelFormat == kFourccMJPEG && !template_.empty()) {
+        int width = 0;
+        int height = 0;
+        if (!MjpegEncoder::dimensions(template_.data(), static_cast<int>(template_.size()), &width, &height)) {
+            LOGE("MJPEG template is not a JPEG");
+            return false;
+        }
+        format = FrameFormat(width, height, kFourccMJPEG);
+    } else if ((requested.pixelFormat == kFourccYUYV || requested.pixelFormat == kFourccMJPEG) &&
+               requested.width > 0 && requested.height > 0 && requested.width % 2 == 0) {
+        format = FrameFormat(requested.width, requested.height, requested.pixelFormat);
+        if (format.pixelFormat == kFourccYUYV) {
+            format.bytesPerLine = requested.width * 2;
+        }
+    } else {
+        LOGE("Unsupported synthetic format %dx%d fourcc=0x%08x",
+             requested.width, requested.height, requested.pixelFormat);
+        return false;
+    }
+
+    format_ = format;
+    size_t buffer_size = static_cast<size_t>(format_.imageSize());
+    std::vector<std::vector<uint8_t> >().swap(encoded_);
+    if (format_.pixelFormat == kFourccMJPEG) {
+        if (!template_.empty()) {
+            encoded_.push_back(template_);
+        } else if (!encodePattern()) {
+            return false;
+        }
+        buffer_size = 0;
+        for (size_t i = 0; i < encoded_.size(); i++) {
+            if (encoded_[i].size() > buffer_size) {
+                buffer_size = encoded_[i].size();
+            }
+        }
+        buffer_size += kStampSegmentSize;
+    }
+    for (int i = 0; i < kMaxLeases; i++) {
+        buffers_[i].assign(buffer_size, 0);
+    }
+
+    *actual = format_;
+    LOGI("Synthetic %dx%d %s at %d fps%s", format_.width, format_.height,
+         format_.pixelFormat == kFourccMJPEG ? "MJPEG" : "YUYV", args_.fps,
+         args_.dropLate ? ", dropping late frames" : "");
+    return true;
+}
+
+bool SyntheticSource::encodePattern() {
+    const int stride = format_.width * 2;
+    std::vector<uint8_t> yuyv(static_cast<size_t>(stride) * format_.height);
+    MjpegEncoder encoder(args_.mjpegQuality);
+
+    encoded_.resize(kPatternFrames);
+    for (int i = 0; i < kPatternFrames; i++) {
+        render(yuyv.data(), format_.width, format_.height, stride, static_cast<uint32_t>(i));
+        if (!encoder.encodeYUYV(yuyv.data(), format_.width, format_.height, stride, &encoded_[i])) {
+            LOGE("Failed to encode the MJPEG pattern");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SyntheticSource::start() {
+    if (buffers_[0].empty()) {
+        return false;
+    }
+    memset(leased_, 0, sizeof(leased_));
+    sequence_ = 0;
+    pacer_.start(args_.fps);
+    streaming_ = true;
+    return true;
+}
+
+void SyntheticSource::stop() {
+    streaming_ = false;
+    memset(leased_, 0, sizeof(leased_));
+}
+
+LeaseResult SyntheticSource::lease(FrameDescriptor* frame, int timeout_ms) {
+    if (!streaming_) {
+        return kLeaseError;
+    }
+
+    int slot = -1;
+    for (int i = 0; i < kMaxLeases; i++) {
+        if (!leased_[i]) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        return kLeaseBusy;
+    }
+
+    // A sensor keeps exposing while the consumer is busy: jump to the newest
+    // frame and leave the gap in the sequence numbers
+    if (args_.dropLate) {
+        uint32_t latest = pacer_.latestSlot();
+        if (latest > sequence_) {
+            sequence_ = latest;
+        }
+    }
+
+    int64_t timestamp_ns = 0;
+    if (!pacer_.wait(sequence_, timeout_ms, &timestamp_ns)) {
+        return kLeaseTimeout;
+    }
+
+    uint8_t* dst = buffers_[slot].data();
+    int size = 0;
+    if (format_.pixelFormat == kFourccMJPEG) {
+        const std::vector<uint8_t>& jpeg = encoded_[sequence_ % encoded_.size()];
+        dst[0] = 0xFF;
+        dst[1] = 0xD8;
+        dst[2] = 0xFF;
+        dst[3] = 0xFE;
+        dst[4] = 0;
+        dst[5] = static_cast<uint8_t>(kStampSegmentSize - 2);
+        SyntheticStamp::write(dst + SyntheticStamp::kMjpegOffset, sequence_, timestamp_ns);
+        memcpy(dst + kStampSegmentSize + 2, jpeg.data() + 2, jpeg.size() - 2);
+        size = static_cast<int>(jpeg.size()) + kStampSegmentSize;
+    } else {
+        render(dst, format_.width, format_.height, format_.bytesPerLine, sequence_);
+        SyntheticStamp::write(dst, sequence_, timestamp_ns);
+        size = format_.imageSize();
+    }
+    leased_[slot] = true;
+
+    frame->data = dst;
+    frame->size = size;
+    frame->format = format_;
+    frame->timestampNs = timestamp_ns;
+    frame->sequence = sequence_++;
+    frame->slot = slot;
+    return kLeaseOk;
+}
+
+void SyntheticSource::release(const FrameDescriptor& frame) {
+    if (frame.slot >= 0 && frame.slot < kMaxLeases) {
+        leased_[frame.slot] = false;
+    }
+}
+
+void SyntheticSource::render(uint8_t* dst, int width, int height, int stride, uint32_t phase) const {
+    const int bar = static_cast<int>((phase % kPatternFrames) * width / kPatternFrames);
+
+    // Every row is identical: render one, then copy it down
+    uint8_t* row = dst;
+    for (int x = 0; x < width; x += 2) {
+        int y0 = 16 + (x * 219) / width;
+        int y1 = 16 + ((x + 1) * 219) / width;
+        int d0 = (x - bar + width) % width;
+        int d1 = (x + 1 - bar + width) % width;
+        uint8_t* px = row + x * 2;
+        px[0] = static_cast<uint8_t>(d0 < kBarWidth ? 235 : y0);
+        px[1] = 128;
+        px[2] = static_cast<uint8_t>(d1 < kBarWidth ? 235 : y1);
+        px[3] = 128;
+    }
+    for (int y = 1; y < height; y++) {
+        memcpy(dst + static_cast<size_t>(y) * stride, row, static_cast<size_t>(width) * 2);
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef SYNTHETIC_SOURCE_H
+#define SYNTHETIC_SOURCE_H
+
+#include <vector>
+#include "frame_source.h"
+
+/**
+ * Capture backend that renders a moving test pattern (a bright vertical bar
+ * over a horizontal ramp) as YUYV or MJPEG at any size and rate. Needs no
+ * hardware, so it backs tests, stands in for a camera on the emulator and
+ * drives the pipeline past what real webcams deliver.
+ *
+ * Every frame carries a SyntheticStamp so consumers can count lost frames
+ * and measure latency after decoding.
+ */
+class SyntheticSource {
+public:
+    struct OpenArgs {
+        int fps;                       // <= 0 renders as fast as frames are leased
+        bool dropLate;                 // skip frames the consumer was too slow for, like a sensor
+        int mjpegQuality;
+        const uint8_t* mjpegTemplate;  // optional JPEG streamed instead of the pattern
+        int mjpegTemplateSize;
+
+        OpenArgs()
+            : fps(0), dropLate(false), mjpegQuality(80), mjpegTemplate(nullptr), mjpegTemplateSize(0) {}
+    };
+
+    static const int kMaxLeases = 2;
+
+    // Distinct pattern frames; the bar sweeps the width once per cycle
+    static const int kPatternFrames = 30;
+
+    static const char* name() { return "synthetic"; }
+
+    SyntheticSource();
+
+    bool open(const OpenArgs& args);
+    void close();
+    // YUYV at any even size, or MJPEG (a template JPEG fixes the size)
+    bool negotiate(const FrameFormat& requested, FrameFormat* actual);
+    bool start();
+    void stop();
+    LeaseResult lease(FrameDescriptor* frame, int timeout_ms);
+    void release(const FrameDescriptor& frame);
+
+    // Largest frame lease() can return for the negotiated format
+    int maxFrameSize() const { return static_cast<int>(buffers_[0].size()); }
+
+private:
+    OpenArgs args_;
+    std::vector<uint8_t> template_;
+    bool opened_;
+    bool streaming_;
+    FrameFormat format_;
+
+    // MJPEG: the pattern cycle, encoded once in negotiate()
+    std::vector<std::vector<uint8_t> > encoded_;
+
+    // One buffer per lease so held frames are never overwritten
+    std::vector<uint8_t> buffers_[kMaxLeases];
+    bool leased_[kMaxLeases];
+
+    uint32_t sequence_;
+    FramePacer pacer_;
+
+    void render(uint8_t* dst, int width, int height, int stride, uint32_t phase) const;
+    bool encodePattern();
+};
+
+/**
+ * 16-byte frame stamp: magic 'SYNF', sequence (u32) and capture timestamp
+ * (CLOCK_MONOTONIC ns, i64), little-endian. YUYV frames carry it in their
+ * first 16 bytes; MJPEG frames in a COM segment right after SOI, which
+ * decoders skip. Parsed on the Java side by FrameStamp.
+ */
+struct SyntheticStamp {
+    static const uint32_t kMagic = makeFourcc('S', 'Y', 'N', 'F');
+    static const int kSize = 16;
+    // SOI + COM marker + COM length
+    static const int kMjpegOffset = 6;
+
+    static void write(uint8_t* dst, uint32_t sequence, int64_t timestamp_ns);
+    static bool read(const uint8_t* src, int size, uint32_t* sequence, int64_t* timestamp_ns);
+};
+
+#endif // SYNTHETIC_SOURCE_H
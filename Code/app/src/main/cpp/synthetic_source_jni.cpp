@@ -0,0 +1,121 @@
+#include <jni.h>
+#include <android/log.h>
+#include <vector>
+#include "jni_support.h"
+#include "synthetic_source.h"
+
+#define LOG_TAG "SyntheticSource-JNI"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+// Bindings for com.esw.postureanalyzer.vision.SyntheticFrameSource, registered
+// from JNI_OnLoad
+
+namespace {
+
+typedef FrameSource<SyntheticSource> Source;
+
+const char* const kClassName = "com/esw/postureanalyzer/vision/SyntheticFrameSource";
+
+jlong nativeCreate(JNIEnv* env, jclass clazz, jint width, jint height, jint pixel_format,
+                   jint fps, jboolean drop_late, jbyteArray mjpeg_template) {
+    std::vector<uint8_t> jpeg;
+    if (mjpeg_template) {
+        jpeg.resize(static_cast<size_t>(env->GetArrayLength(mjpeg_template)));
+        env->GetByteArrayRegion(mjpeg_template, 0, static_cast<jsize>(jpeg.size()),
+                                reinterpret_cast<jbyte*>(jpeg.data()));
+    }
+
+    SyntheticSource::OpenArgs args;
+    args.fps = fps;
+    args.dropLate = drop_late == JNI_TRUE;
+    args.mjpegTemplate = jpeg.empty() ? nullptr : jpeg.data();
+    args.mjpegTemplateSize = static_cast<int>(jpeg.size());
+
+    Source* source = new Source();
+    if (!source->open(args) ||
+        !source->negotiate(FrameFormat(width, height, static_cast<uint32_t>(pixel_format))) ||
+        !source->start()) {
+        LOGE("Failed to start synthetic source %dx%d fourcc=0x%08x", width, height, pixel_format);
+        delete source;
+        return 0;
+    }
+    return reinterpret_cast<jlong>(source);
+}
+
+void nativeDestroy(JNIEnv* env, jclass clazz, jlong native_ptr) {
+    delete reinterpret_cast<Source*>(native_ptr);
+}
+
+// @FastNative on API 26+. Returns the frame size, 0 on timeout, -1 on error
+jint nativeRead(JNIEnv* env, jclass clazz, jlong native_ptr, jbyteArray dst, jint timeout_ms) {
+    Source* source = reinterpret_cast<Source*>(native_ptr);
+    if (!source) {
+        return -1;
+    }
+
+    FrameLease<Source> lease(*source, timeout_ms);
+    if (lease.result() == kLeaseTimeout) {
+        return 0;
+    }
+    if (!lease.ok() || lease.frame().size > env->GetArrayLength(dst)) {
+        return -1;
+    }
+    env->SetByteArrayRegion(dst, 0, lease.frame().size, reinterpret_cast<const jbyte*>(lease.frame().data));
+    return lease.frame().size;
+}
+
+// {width, height, fourcc, max frame size}
+jintArray nativeGetFormat(JNIEnv* env, jclass clazz, jlong native_ptr) {
+    Source* source = reinterpret_cast<Source*>(native_ptr);
+    if (!source) {
+        return nullptr;
+    }
+    const FrameFormat& format = source->format();
+    jint values[] = {
+        format.width,
+        format.height,
+        static_cast<jint>(format.pixelFormat),
+        source->backend().maxFrameSize(),
+    };
+    jintArray result = env->NewIntArray(jni::arraySize(values));
+    if (result) {
+        env->SetIntArrayRegion(result, 0, jni::arraySize(values), values);
+    }
+    return result;
+}
+
+// {frames leased, dropped, timeouts, errors, last timestamp ns} since start
+jlongArray nativeGetStats(JNIEnv* env, jclass clazz, jlong native_ptr) {
+    Source* source = reinterpret_cast<Source*>(native_ptr);
+    if (!source) {
+        return nullptr;
+    }
+    const FrameSourceStats& stats = source->stats();
+    jlong values[] = {
+        static_cast<jlong>(stats.framesLeased),
+        static_cast<jlong>(stats.framesDropped),
+        static_cast<jlong>(stats.timeouts),
+        static_cast<jlong>(stats.errors),
+        static_cast<jlong>(stats.lastTimestampNs),
+    };
+    jlongArray result = env->NewLongArray(jni::arraySize(values));
+    if (result) {
+        env->SetLongArrayRegion(result, 0, jni::arraySize(values), values);
+    }
+    return result;
+}
+
+const JNINativeMethod kMethods[] = {
+    {"nativeCreate", "(IIIIZ[B)J", reinterpret_cast<void*>(nativeCreate)},
+    {"nativeDestroy", "(J)V", reinterpret_cast<void*>(nativeDestroy)},
+    {"nativeRead", "(J[BI)I", reinterpret_cast<void*>(nativeRead)},
+    {"nativeGetFormat", "(J)[I", reinterpret_cast<void*>(nativeGetFormat)},
+    {"nativeGetStats", "(J)[J", reinterpret_cast<void*>(nativeGetStats)},
+};
+
+} // namespace
+
+bool registerSyntheticSourceNatives(JNIEnv* env) {
+    return jni::registerNatives(env, kClassName, kMethods, jni::arraySize(kMethods));
+}
@@ -1,150 +1,337 @@
 #include <jni.h>
 #include <android/log.h>
+#include "jni_support.h"
+#include "frame_source.h"
+#include "replay_source.h"
+#include "synthetic_source.h"
 #include "v4l2_camera.h"
+#include "v4l2_discovery.h"
 #include <linux/videodev2.h>
 
 #define LOG_TAG "UVCCamera-JNI"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
-extern "C" {
+// Bindings for com.esw.postureanalyzer.vision.UVCCameraManager, registered
+// from JNI_OnLoad
 
-JNIEXPORT jlong JNICALL
-Java_com_esw_postureanalyzer_vision_UVCCameraManager_nativeCreate(
-        JNIEnv* env, jobject thiz) {
-    LOGI("Creating native V4L2 camera instance");
-    V4L2Camera* camera = new V4L2Camera();
+// Backend behind UVCCameraManager, chosen by the CAPTURE_BACKEND CMake option
+#if defined(CAPTURE_BACKEND_SYNTHETIC)
+typedef SyntheticSource ActiveBackend;
+#elif defined(CAPTURE_BACKEND_REPLAY)
+typedef ReplaySource ActiveBackend;
+#else
+typedef V4L2Camera ActiveBackend;
+#endif
+
+namespace {
+
+typedef FrameSource<ActiveBackend> Camera;
+
+const char* const kClassName = "com/esw/postureanalyzer/vision/UVCCameraManager";
+
+// Rate of the generated backends, matching the webcams they stand in for
+const int kStandInFps = 30;
+
+// nativeGetFrame is polled from the capture handler and must not block
+const int kGetFrameTimeoutMs = 0;
+
+// Maps UVCCameraManager's device path / fd onto each backend's OpenArgs
+template <typename Backend>
+struct OpenArgsFor;
+
+template <>
+struct OpenArgsFor<V4L2Camera> {
+    static bool fromPath(const char* path, V4L2Camera::OpenArgs* args) {
+        *args = V4L2Camera::OpenArgs::fromPath(path);
+        return true;
+    }
+    static bool fromFd(int fd, V4L2Camera::OpenArgs* args) {
+        *args = V4L2Camera::OpenArgs::fromFd(fd);
+        return true;
+    }
+};
+
+template <>
+struct OpenArgsFor<ReplaySource> {
+    // The path names the recording instead of a device node
+    static bool fromPath(const char* path, ReplaySource::OpenArgs* args) {
+        args->path = path;
+        args->fps = kStandInFps;
+        args->loop = true;
+        return true;
+    }
+    static bool fromFd(int /* fd */, ReplaySource::OpenArgs* /* args */) {
+        return false;
+    }
+};
+
+template <>
+struct OpenArgsFor<SyntheticSource> {
+    // Any device path opens the generator, paced and dropping like a webcam
+    static bool fromPath(const char* /* path */, SyntheticSource::OpenArgs* args) {
+        args->fps = kStandInFps;
+        args->dropLate = true;
+        return true;
+    }
+    static bool fromFd(int /* fd */, SyntheticSource::OpenArgs* args) {
+        return fromPath(nullptr, args);
+    }
+};
+
+// Only V4L2 scores YUYV motion natively; elsewhere Java scores the bitmap
+inline float motionScore(const V4L2Camera& backend) {
+    return backend.lastMotionScore();
+}
+
+template <typename Backend>
+inline float motionScore(const Backend&) {
+    return -1.0f;
+}
+
+jlong nativeCreate(JNIEnv* env, jobject thiz) {
+    LOGI("Creating native %s camera instance", Camera::backendName());
+    Camera* camera = new Camera();
     return reinterpret_cast<jlong>(camera);
 }
 
-JNIEXPORT void JNICALL
-Java_com_esw_postureanalyzer_vision_UVCCameraManager_nativeDestroy(
-        JNIEnv* env, jobject thiz, jlong native_ptr) {
-    LOGI("Destroying native V4L2 camera instance");
-    V4L2Camera* camera = reinterpret_cast<V4L2Camera*>(native_ptr);
+void nativeDestroy(JNIEnv* env, jobject thiz, jlong native_ptr) {
+    LOGI("Destroying native %s camera instance", Camera::backendName());
+    Camera* camera = reinterpret_cast<Camera*>(native_ptr);
     if (camera) {
         delete camera;
     }
 }
 
-JNIEXPORT jboolean JNICALL
-Java_com_esw_postureanalyzer_vision_UVCCameraManager_nativeOpen(
-        JNIEnv* env, jobject thiz, jlong native_ptr, jstring device_path) {
-    V4L2Camera* camera = reinterpret_cast<V4L2Camera*>(native_ptr);
+jboolean nativeOpen(JNIEnv* env, jobject thiz, jlong native_ptr, jstring device_path) {
+    Camera* camera = reinterpret_cast<Camera*>(native_ptr);
     if (!camera) {
         LOGE("Invalid camera pointer");
         return JNI_FALSE;
     }
-    
+
     const char* path = env->GetStringUTFChars(device_path, nullptr);
-    LOGI("Opening V4L2 camera: %s", path);
-    
-    bool result = camera->open(path);
-    
+    LOGI("Opening %s camera: %s", Camera::backendName(), path);
+
+    Camera::OpenArgs args;
+    bool result = OpenArgsFor<ActiveBackend>::fromPath(path, &args) && camera->open(args);
+
     env->ReleaseStringUTFChars(device_path, path);
-    
+
     return result ? JNI_TRUE : JNI_FALSE;
 }
 
-JNIEXPORT jboolean JNICALL
-Java_com_esw_postureanalyzer_vision_UVCCameraManager_nativeOpenByFd(
-        JNIEnv* env, jobject thiz, jlong native_ptr, jint fd) {
-    V4L2Camera* camera = reinterpret_cast<V4L2Camera*>(native_ptr);
+jboolean nativeOpenByFd(JNIEnv* env, jobject thiz, jlong native_ptr, jint fd) {
+    Camera* camera = reinterpret_cast<Camera*>(native_ptr);
     if (!camera) {
         LOGE("Invalid camera pointer");
         return JNI_FALSE;
     }
-    
-    LOGI("Opening V4L2 camera by file descriptor: %d", fd);
-    bool result = camera->openByFd(fd);
-    
+
+    LOGI("Opening %s camera by file descriptor: %d", Camera::backendName(), fd);
+    Camera::OpenArgs args;
+    bool result = OpenArgsFor<ActiveBackend>::fromFd(fd, &args) && camera->open(args);
+
     return result ? JNI_TRUE : JNI_FALSE;
 }
 
-JNIEXPORT void JNICALL
-Java_com_esw_postureanalyzer_vision_UVCCameraManager_nativeClose(
-        JNIEnv* env, jobject thiz, jlong native_ptr) {
-    V4L2Camera* camera = reinterpret_cast<V4L2Camera*>(native_ptr);
+void nativeClose(JNIEnv* env, jobject thiz, jlong native_ptr) {
+    Camera* camera = reinterpret_cast<Camera*>(native_ptr);
     if (camera) {
         camera->close();
     }
 }
 
-JNIEXPORT jboolean JNICALL
-Java_com_esw_postureanalyzer_vision_UVCCameraManager_nativeSetFormat(
-        JNIEnv* env, jobject thiz, jlong native_ptr, 
-        jint width, jint height, jint pixel_format) {
-    V4L2Camera* camera = reinterpret_cast<V4L2Camera*>(native_ptr);
+jboolean nativeSetFormat(JNIEnv* env, jobject thiz, jlong native_ptr,
+                         jint width, jint height, jint pixel_format) {
+    Camera* camera = reinterpret_cast<Camera*>(native_ptr);
     if (!camera) {
         LOGE("Invalid camera pointer");
         return JNI_FALSE;
     }
-    
-    bool result = camera->setFormat(width, height, pixel_format);
+
+    FrameFormat requested(width, height, static_cast<uint32_t>(pixel_format));
+    bool result = camera->negotiate(requested);
     return result ? JNI_TRUE : JNI_FALSE;
 }
 
-JNIEXPORT jboolean JNICALL
-Java_com_esw_postureanalyzer_vision_UVCCameraManager_nativeStartStreaming(
-        JNIEnv* env, jobject thiz, jlong native_ptr) {
-    V4L2Camera* camera = reinterpret_cast<V4L2Camera*>(native_ptr);
+jboolean nativeStartStreaming(JNIEnv* env, jobject thiz, jlong native_ptr) {
+    Camera* camera = reinterpret_cast<Camera*>(native_ptr);
     if (!camera) {
         LOGE("Invalid camera pointer");
         return JNI_FALSE;
     }
-    
-    bool result = camera->startStreaming();
+
+    bool result = camera->start();
     return result ? JNI_TRUE : JNI_FALSE;
 }
 
-JNIEXPORT void JNICALL
-Java_com_esw_postureanalyzer_vision_UVCCameraManager_nativeStopStreaming(
-        JNIEnv* env, jobject thiz, jlong native_ptr) {
-    V4L2Camera* camera = reinterpret_cast<V4L2Camera*>(native_ptr);
+void nativeStopStreaming(JNIEnv* env, jobject thiz, jlong native_ptr) {
+    Camera* camera = reinterpret_cast<Camera*>(native_ptr);
     if (camera) {
-        camera->stopStreaming();
+        camera->stop();
     }
 }
 
-JNIEXPORT jbyteArray JNICALL
-Java_com_esw_postureanalyzer_vision_UVCCameraManager_nativeGetFrame(
-        JNIEnv* env, jobject thiz, jlong native_ptr) {
-    V4L2Camera* camera = reinterpret_cast<V4L2Camera*>(native_ptr);
+jbyteArray nativeGetFrame(JNIEnv* env, jobject thiz, jlong native_ptr) {
+    Camera* camera = reinterpret_cast<Camera*>(native_ptr);
     if (!camera) {
         LOGE("Invalid camera pointer");
         return nullptr;
     }
-    
-    unsigned char* buffer = nullptr;
-    int buffer_size = 0;
-    
-    if (!camera->getFrame(&buffer, &buffer_size)) {
+
+    // Released on return, after the copy into the Java array
+    FrameLease<Camera> lease(*camera, kGetFrameTimeoutMs);
+    if (!lease.ok()) {
         return nullptr; // No frame available
     }
-    
-    // Create Java byte array and copy frame data
-    jbyteArray result = env->NewByteArray(buffer_size);
+
+    const FrameDescriptor& frame = lease.frame();
+    jbyteArray result = env->NewByteArray(frame.size);
+    if (result) {
+        env->SetByteArrayRegion(result, 0, frame.size,
+                                reinterpret_cast<const jbyte*>(frame.data));
+    }
+
+    return result;
+}
+
+// {frames leased, dropped, timeouts, errors, last timestamp ns} since start
+jlongArray nativeGetStats(JNIEnv* env, jobject thiz, jlong native_ptr) {
+    Camera* camera = reinterpret_cast<Camera*>(native_ptr);
+    if (!camera) {
+        return nullptr;
+    }
+
+    const FrameSourceStats& stats = camera->stats();
+    jlong values[] = {
+        static_cast<jlong>(stats.framesLeased),
+        static_cast<jlong>(stats.framesDropped),
+        static_cast<jlong>(stats.timeouts),
+        static_cast<jlong>(stats.errors),
+        static_cast<jlong>(stats.lastTimestampNs),
+    };
+    jlongArray result = env->NewLongArray(jni::arraySize(values));
     if (result) {
-        env->SetByteArrayRegion(result, 0, buffer_size, 
-                                reinterpret_cast<jbyte*>(buffer));
+        env->SetLongArrayRegion(result, 0, jni::arraySize(values), values);
+    }
+    return result;
+}
+
+jstring nativeGetBackendName(JNIEnv* env, jclass clazz) {
+    return env->NewStringUTF(Camera::backendName());
+}
+
+jstring nativeDiscover(JNIEnv* env, jclass clazz, jint vendor_id, jint product_id) {
+    V4L2NodeInfo node;
+    bool cache_hit = false;
+    if (!V4L2Discovery::find(vendor_id, product_id, &node, &cache_hit)) {
+        return nullptr;
+    }
+    return env->NewStringUTF(node.devicePath.c_str());
+}
+
+// Flattened {fourcc, width, height} triples for the discovered node
+jintArray nativeDiscoveredFormats(JNIEnv* env, jclass clazz, jint vendor_id, jint product_id) {
+    V4L2NodeInfo node;
+    bool cache_hit = false;
+    if (!V4L2Discovery::find(vendor_id, product_id, &node, &cache_hit)) {
+        return nullptr;
+    }
+
+    jsize length = static_cast<jsize>(node.formats.size() * 3);
+    jintArray result = env->NewIntArray(length);
+    if (!result) {
+        return nullptr;
     }
-    
-    // Release the frame
-    camera->releaseFrame();
-    
+    jint* values = env->GetIntArrayElements(result, nullptr);
+    if (!values) {
+        // Out of memory; an OutOfMemoryError is pending for the caller
+        env->DeleteLocalRef(result);
+        return nullptr;
+    }
+    for (size_t i = 0; i < node.formats.size(); i++) {
+        values[i * 3] = static_cast<jint>(node.formats[i].pixelFormat);
+        values[i * 3 + 1] = node.formats[i].width;
+        values[i * 3 + 2] = node.formats[i].height;
+    }
+    env->ReleaseIntArrayElements(result, values, 0);
     return result;
 }
 
-JNIEXPORT jint JNICALL
-Java_com_esw_postureanalyzer_vision_UVCCameraManager_getYUYVFormat(
-        JNIEnv* env, jobject thiz) {
+void nativeInvalidateDiscovery(JNIEnv* env, jclass clazz, jint vendor_id, jint product_id) {
+    V4L2Discovery::invalidate(vendor_id, product_id);
+}
+
+// Tiny getters: @CriticalNative on API 26+, so no JNIEnv / jclass parameters
+
+jfloat criticalGetMotionScore(jlong native_ptr) {
+    Camera* camera = reinterpret_cast<Camera*>(native_ptr);
+    if (!camera) {
+        return -1.0f;
+    }
+    return motionScore(camera->backend());
+}
+
+jint criticalGetYUYVFormat() {
     return V4L2_PIX_FMT_YUYV;
 }
 
-JNIEXPORT jint JNICALL
-Java_com_esw_postureanalyzer_vision_UVCCameraManager_getMJPEGFormat(
-        JNIEnv* env, jobject thiz) {
+jint criticalGetMJPEGFormat() {
     return V4L2_PIX_FMT_MJPEG;
 }
 
-} // extern "C"
+// Regular-convention wrappers for API 24-25, where the annotation is ignored
+
+jfloat nativeGetMotionScore(JNIEnv* env, jclass clazz, jlong native_ptr) {
+    return criticalGetMotionScore(native_ptr);
+}
+
+jint getYUYVFormat(JNIEnv* env, jclass clazz) {
+    return criticalGetYUYVFormat();
+}
+
+jint getMJPEGFormat(JNIEnv* env, jclass clazz) {
+    return criticalGetMJPEGFormat();
+}
+
+const JNINativeMethod kMethods[] = {
+    {"nativeCreate", "()J", reinterpret_cast<void*>(nativeCreate)},
+    {"nativeDestroy", "(J)V", reinterpret_cast<void*>(nativeDestroy)},
+    {"nativeOpen", "(JLjava/lang/String;)Z", reinterpret_cast<void*>(nativeOpen)},
+    {"nativeOpenByFd", "(JI)Z", reinterpret_cast<void*>(nativeOpenByFd)},
+    {"nativeClose", "(J)V", reinterpret_cast<void*>(nativeClose)},
+    {"nativeSetFormat", "(JIII)Z", reinterpret_cast<void*>(nativeSetFormat)},
+    {"nativeStartStreaming", "(J)Z", reinterpret_cast<void*>(nativeStartStreaming)},
+    {"nativeStopStreaming", "(J)V", reinterpret_cast<void*>(nativeStopStreaming)},
+    {"nativeGetFrame", "(J)[B", reinterpret_cast<void*>(nativeGetFrame)},
+    {"nativeGetStats", "(J)[J", reinterpret_cast<void*>(nativeGetStats)},
+    {"nativeGetBackendName", "()Ljava/lang/String;", reinterpret_cast<void*>(nativeGetBackendName)},
+    {"nativeDiscover", "(II)Ljava/lang/String;", reinterpret_cast<void*>(nativeDiscover)},
+    {"nativeDiscoveredFormats", "(II)[I", reinterpret_cast<void*>(nativeDiscoveredFormats)},
+    {"nativeInvalidateDiscovery", "(II)V", reinterpret_cast<void*>(nativeInvalidateDiscovery)},
+};
+
+const JNINativeMethod kCriticalMethods[] = {
+    {"nativeGetMotionScore", "(J)F", reinterpret_cast<void*>(criticalGetMotionScore)},
+    {"getYUYVFormat", "()I", reinterpret_cast<void*>(criticalGetYUYVFormat)},
+    {"getMJPEGFormat", "()I", reinterpret_cast<void*>(criticalGetMJPEGFormat)},
+};
+
+const JNINativeMethod kRegularGetters[] = {
+    {"nativeGetMotionScore", "(J)F", reinterpret_cast<void*>(nativeGetMotionScore)},
+    {"getYUYVFormat", "()I", reinterpret_cast<void*>(getYUYVFormat)},
+    {"getMJPEGFormat", "()I", reinterpret_cast<void*>(getMJPEGFormat)},
+};
+
+} // namespace
+
+bool registerUVCCameraManagerNatives(JNIEnv* env) {
+    if (!jni::registerNatives(env, kClassName, kMethods, jni::arraySize(kMethods))) {
+        return false;
+    }
+    if (jni::criticalNativeSupported()) {
+        return jni::registerNatives(env, kClassName, kCriticalMethods, jni::arraySize(kCriticalMethods));
+    }
+    return jni::registerNatives(env, kClassName, kRegularGetters, jni::arraySize(kRegularGetters));
+}
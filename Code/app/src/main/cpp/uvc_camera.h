@@ -3,38 +3,46 @@
 
 #include <jni.h>
 #include <string>
+#include "frame_source.h"
 
+/**
+ * Capture backend that reads YUYV frames over the USB Host API
+ * (UsbDeviceConnection.bulkTransfer), for devices without a kernel V4L2 node.
+ */
 class UVCCamera {
 public:
+    struct OpenArgs {
+        jobject usbConnection;  // android.hardware.usb.UsbDeviceConnection
+        jobject usbDevice;      // android.hardware.usb.UsbDevice
+    };
+
+    // Frames are copied into a single buffer
+    static const int kMaxLeases = 1;
+
+    static const char* name() { return "uvc-usbhost"; }
+
     UVCCamera();
     ~UVCCamera();
 
-    // Open camera using USB file descriptor from Java
-    bool open(JNIEnv* env, jobject usbConnection, jobject usbDevice);
-    
-    // Close camera
+    // Open camera using the USB connection from Java
+    bool open(const OpenArgs& args);
     void close();
     
-    // Set camera format
-    bool setFormat(int width, int height);
-    
-    // Start streaming
-    bool startStreaming();
-    
-    // Stop streaming
-    void stopStreaming();
-    
-    // Get next frame (blocks until frame available)
-    bool getFrame(uint8_t** data, int* size);
+    // YUYV only; the requested size is taken as-is
+    bool negotiate(const FrameFormat& requested, FrameFormat* actual);
+    bool start();
+    void stop();
     
-    // Release frame
-    void releaseFrame();
+    // Blocks in bulkTransfer for up to timeout_ms
+    LeaseResult lease(FrameDescriptor* frame, int timeout_ms);
+    void release(const FrameDescriptor& frame);
     
     // Check if streaming
     bool isStreaming() const { return streaming_; }
 
 private:
-    JNIEnv* env_;
+    // JNIEnv is per-thread, so methods fetch it via jni::getEnv() instead of
+    // caching the one passed to open()
     jobject usbConnection_;
     jobject usbDevice_;
     jobject bulkEndpoint_;
@@ -42,9 +50,11 @@ private:
     int width_;
     int height_;
     bool streaming_;
+    uint32_t sequence_;
     
     uint8_t* frameBuffer_;
     int frameBufferSize_;
+    jbyteArray transferBuffer_;  // Global ref, reused by every bulkTransfer
     
     // Helper methods
     bool findStreamingInterface();
@@ -1,28 +1,112 @@
 #include "uvc_camera.h"
 #include "uvc_protocol.h"
+#include "jni_support.h"
 #include <android/log.h>
 #include <cstring>
+#include <mutex>
 
 #define LOG_TAG "UVCCamera"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
+namespace {
+
+// android.hardware.usb classes and method IDs, resolved once per process
+struct UsbJni {
+    jclass deviceClass;
+    jmethodID getInterfaceCount;
+    jmethodID getInterface;
+
+    jclass interfaceClass;
+    jmethodID getInterfaceClass;
+    jmethodID getInterfaceSubclass;
+    jmethodID getEndpointCount;
+    jmethodID getEndpoint;
+
+    jclass endpointClass;
+    jmethodID getType;
+    jmethodID getDirection;
+
+    jclass connectionClass;
+    jmethodID claimInterface;
+    jmethodID bulkTransfer;
+
+    bool valid;
+};
+
+UsbJni g_usb;
+std::once_flag g_usb_once;
+
+jclass globalClass(JNIEnv* env, const char* name) {
+    jclass local = env->FindClass(name);
+    if (!local) {
+        env->ExceptionClear();
+        LOGE("Failed to find %s", name);
+        return nullptr;
+    }
+    jclass global = static_cast<jclass>(env->NewGlobalRef(local));
+    env->DeleteLocalRef(local);
+    return global;
+}
+
+const UsbJni* usbJni(JNIEnv* env) {
+    std::call_once(g_usb_once, [env]() {
+        UsbJni& u = g_usb;
+        u.deviceClass = globalClass(env, "android/hardware/usb/UsbDevice");
+        u.interfaceClass = globalClass(env, "android/hardware/usb/UsbInterface");
+        u.endpointClass = globalClass(env, "android/hardware/usb/UsbEndpoint");
+        u.connectionClass = globalClass(env, "android/hardware/usb/UsbDeviceConnection");
+        if (!u.deviceClass || !u.interfaceClass || !u.endpointClass || !u.connectionClass) {
+            u.valid = false;
+            return;
+        }
+
+        u.getInterfaceCount = env->GetMethodID(u.deviceClass, "getInterfaceCount", "()I");
+        u.getInterface = env->GetMethodID(u.deviceClass, "getInterface",
+                                          "(I)Landroid/hardware/usb/UsbInterface;");
+        u.getInterfaceClass = env->GetMethodID(u.interfaceClass, "getInterfaceClass", "()I");
+        u.getInterfaceSubclass = env->GetMethodID(u.interfaceClass, "getInterfaceSubclass", "()I");
+        u.getEndpointCount = env->GetMethodID(u.interfaceClass, "getEndpointCount", "()I");
+        u.getEndpoint = env->GetMethodID(u.interfaceClass, "getEndpoint",
+                                         "(I)Landroid/hardware/usb/UsbEndpoint;");
+        u.getType = env->GetMethodID(u.endpointClass, "getType", "()I");
+        u.getDirection = env->GetMethodID(u.endpointClass, "getDirection", "()I");
+        u.claimInterface = env->GetMethodID(u.connectionClass, "claimInterface",
+                                            "(Landroid/hardware/usb/UsbInterface;Z)Z");
+        u.bulkTransfer = env->GetMethodID(u.connectionClass, "bulkTransfer",
+                                          "(Landroid/hardware/usb/UsbEndpoint;[BII)I");
+
+        u.valid = !env->ExceptionCheck();
+        if (!u.valid) {
+            env->ExceptionClear();
+            LOGE("Failed to resolve USB method IDs");
+        }
+    });
+    return g_usb.valid ? &g_usb : nullptr;
+}
+
+} // namespace
+
 UVCCamera::UVCCamera() 
-    : env_(nullptr), usbConnection_(nullptr), usbDevice_(nullptr),
-      bulkEndpoint_(nullptr), width_(640), height_(480), streaming_(false),
-      frameBuffer_(nullptr), frameBufferSize_(0) {
+    : usbConnection_(nullptr), usbDevice_(nullptr),
+      bulkEndpoint_(nullptr), width_(640), height_(480), streaming_(false), sequence_(0),
+      frameBuffer_(nullptr), frameBufferSize_(0), transferBuffer_(nullptr) {
 }
 
 UVCCamera::~UVCCamera() {
     close();
 }
 
-bool UVCCamera::open(JNIEnv* env, jobject usbConnection, jobject usbDevice) {
+bool UVCCamera::open(const OpenArgs& args) {
     LOGI("Opening UVC camera via USB Host API");
     
-    env_ = env;
-    usbConnection_ = env->NewGlobalRef(usbConnection);
-    usbDevice_ = env->NewGlobalRef(usbDevice);
+    JNIEnv* env = jni::getEnv();
+    if (!env || !usbJni(env) || !args.usbConnection || !args.usbDevice) {
+        return false;
+    }
+
+    usbConnection_ = env->NewGlobalRef(args.usbConnection);
+    usbDevice_ = env->NewGlobalRef(args.usbDevice);
     
     if (!findStreamingInterface()) {
         LOGE("Failed to find streaming interface");
@@ -39,9 +123,7 @@ bool UVCCamera::open(JNIEnv* env, jobject usbConnection, jobject usbDevice) {
 }
 
 void UVCCamera::close() {
-    if (streaming_) {
-        stopStreaming();
-    }
+    stop();
     
     if (frameBuffer_) {
         delete[] frameBuffer_;
@@ -49,50 +131,45 @@ void UVCCamera::close() {
         frameBufferSize_ = 0;
     }
     
-    if (env_) {
+    JNIEnv* env = jni::getEnv();
+    if (env) {
         if (usbConnection_) {
-            env_->DeleteGlobalRef(usbConnection_);
+            env->DeleteGlobalRef(usbConnection_);
             usbConnection_ = nullptr;
         }
         if (usbDevice_) {
-            env_->DeleteGlobalRef(usbDevice_);
+            env->DeleteGlobalRef(usbDevice_);
             usbDevice_ = nullptr;
         }
         if (bulkEndpoint_) {
-            env_->DeleteGlobalRef(bulkEndpoint_);
+            env->DeleteGlobalRef(bulkEndpoint_);
             bulkEndpoint_ = nullptr;
         }
+        if (transferBuffer_) {
+            env->DeleteGlobalRef(transferBuffer_);
+            transferBuffer_ = nullptr;
+        }
     }
-    
-    env_ = nullptr;
 }
 
 bool UVCCamera::findStreamingInterface() {
-    // Get UsbDevice class
-    jclass usbDeviceClass = env_->FindClass("android/hardware/usb/UsbDevice");
-    if (!usbDeviceClass) {
-        LOGE("Failed to find UsbDevice class");
+    JNIEnv* env = jni::getEnv();
+    const UsbJni* usb = env ? usbJni(env) : nullptr;
+    if (!usb) {
         return false;
     }
     
     // Get interface count
-    jmethodID getInterfaceCountMethod = env_->GetMethodID(usbDeviceClass, "getInterfaceCount", "()I");
-    int interfaceCount = env_->CallIntMethod(usbDevice_, getInterfaceCountMethod);
+    int interfaceCount = env->CallIntMethod(usbDevice_, usb->getInterfaceCount);
     
     LOGI("Device has %d interfaces", interfaceCount);
     
     // Find Video Streaming interface
-    jmethodID getInterfaceMethod = env_->GetMethodID(usbDeviceClass, "getInterface", "(I)Landroid/hardware/usb/UsbInterface;");
-    
     for (int i = 0; i < interfaceCount; i++) {
-        jobject usbInterface = env_->CallObjectMethod(usbDevice_, getInterfaceMethod, i);
-        
-        jclass usbInterfaceClass = env_->FindClass("android/hardware/usb/UsbInterface");
-        jmethodID getInterfaceClassMethod = env_->GetMethodID(usbInterfaceClass, "getInterfaceClass", "()I");
-        jmethodID getInterfaceSubclassMethod = env_->GetMethodID(usbInterfaceClass, "getInterfaceSubclass", "()I");
+        jobject usbInterface = env->CallObjectMethod(usbDevice_, usb->getInterface, i);
         
-        int interfaceClass = env_->CallIntMethod(usbInterface, getInterfaceClassMethod);
-        int interfaceSubclass = env_->CallIntMethod(usbInterface, getInterfaceSubclassMethod);
+        int interfaceClass = env->CallIntMethod(usbInterface, usb->getInterfaceClass);
+        int interfaceSubclass = env->CallIntMethod(usbInterface, usb->getInterfaceSubclass);
         
         LOGI("Interface %d: class=%d, subclass=%d", i, interfaceClass, interfaceSubclass);
         
@@ -101,83 +178,101 @@ bool UVCCamera::findStreamingInterface() {
             LOGI("Found UVC streaming interface at index %d", i);
             
             // Claim interface
-            jclass usbConnectionClass = env_->FindClass("android/hardware/usb/UsbDeviceConnection");
-            jmethodID claimInterfaceMethod = env_->GetMethodID(usbConnectionClass, 
-                "claimInterface", "(Landroid/hardware/usb/UsbInterface;Z)Z");
-            
-            jboolean claimed = env_->CallBooleanMethod(usbConnection_, claimInterfaceMethod, usbInterface, JNI_TRUE);
+            jboolean claimed = env->CallBooleanMethod(usbConnection_, usb->claimInterface,
+                                                      usbInterface, JNI_TRUE);
             
             if (claimed) {
                 LOGI("Successfully claimed interface");
-                env_->DeleteLocalRef(usbInterface);
+                env->DeleteLocalRef(usbInterface);
                 return true;
             } else {
                 LOGE("Failed to claim interface");
             }
         }
         
-        env_->DeleteLocalRef(usbInterface);
+        env->DeleteLocalRef(usbInterface);
     }
     
     return false;
 }
 
 bool UVCCamera::findBulkEndpoint() {
-    // Get UsbDevice class
-    jclass usbDeviceClass = env_->FindClass("android/hardware/usb/UsbDevice");
-    jmethodID getInterfaceCountMethod = env_->GetMethodID(usbDeviceClass, "getInterfaceCount", "()I");
-    jmethodID getInterfaceMethod = env_->GetMethodID(usbDeviceClass, "getInterface", "(I)Landroid/hardware/usb/UsbInterface;");
+    JNIEnv* env = jni::getEnv();
+    const UsbJni* usb = env ? usbJni(env) : nullptr;
+    if (!usb) {
+        return false;
+    }
     
-    int interfaceCount = env_->CallIntMethod(usbDevice_, getInterfaceCountMethod);
+    int interfaceCount = env->CallIntMethod(usbDevice_, usb->getInterfaceCount);
     
     for (int i = 0; i < interfaceCount; i++) {
-        jobject usbInterface = env_->CallObjectMethod(usbDevice_, getInterfaceMethod, i);
-        
-        jclass usbInterfaceClass = env_->FindClass("android/hardware/usb/UsbInterface");
-        jmethodID getEndpointCountMethod = env_->GetMethodID(usbInterfaceClass, "getEndpointCount", "()I");
-        jmethodID getEndpointMethod = env_->GetMethodID(usbInterfaceClass, "getEndpoint", "(I)Landroid/hardware/usb/UsbEndpoint;");
+        jobject usbInterface = env->CallObjectMethod(usbDevice_, usb->getInterface, i);
         
-        int endpointCount = env_->CallIntMethod(usbInterface, getEndpointCountMethod);
+        int endpointCount = env->CallIntMethod(usbInterface, usb->getEndpointCount);
         
         for (int j = 0; j < endpointCount; j++) {
-            jobject endpoint = env_->CallObjectMethod(usbInterface, getEndpointMethod, j);
+            jobject endpoint = env->CallObjectMethod(usbInterface, usb->getEndpoint, j);
             
-            jclass endpointClass = env_->FindClass("android/hardware/usb/UsbEndpoint");
-            jmethodID getTypeMethod = env_->GetMethodID(endpointClass, "getType", "()I");
-            jmethodID getDirectionMethod = env_->GetMethodID(endpointClass, "getDirection", "()I");
-            
-            int type = env_->CallIntMethod(endpoint, getTypeMethod);
-            int direction = env_->CallIntMethod(endpoint, getDirectionMethod);
+            int type = env->CallIntMethod(endpoint, usb->getType);
+            int direction = env->CallIntMethod(endpoint, usb->getDirection);
             
             // USB_ENDPOINT_XFER_BULK = 2, UsbConstants.USB_DIR_IN = 128
             if (type == 2 && direction == 128) {
                 LOGI("Found bulk IN endpoint");
-                bulkEndpoint_ = env_->NewGlobalRef(endpoint);
-                env_->DeleteLocalRef(endpoint);
-                env_->DeleteLocalRef(usbInterface);
+                bulkEndpoint_ = env->NewGlobalRef(endpoint);
+                env->DeleteLocalRef(endpoint);
+                env->DeleteLocalRef(usbInterface);
                 return true;
             }
             
-            env_->DeleteLocalRef(endpoint);
+            env->DeleteLocalRef(endpoint);
         }
         
-        env_->DeleteLocalRef(usbInterface);
+        env->DeleteLocalRef(usbInterface);
     }
     
     return false;
 }
 
-bool UVCCamera::setFormat(int width, int height) {
-    width_ = width;
-    height_ = height;
+bool UVCCamera::negotiate(const FrameFormat& requested, FrameFormat* actual) {
+    if (requested.pixelFormat != kFourccYUYV || requested.width <= 0 || requested.height <= 0) {
+        LOGE("Only YUYV is supported over the USB Host API");
+        return false;
+    }
+    width_ = requested.width;
+    height_ = requested.height;
     
     LOGI("Setting format to %dx%d", width_, height_);
     
     // Allocate frame buffer (YUYV = 2 bytes per pixel)
+    delete[] frameBuffer_;
     frameBufferSize_ = width_ * height_ * 2;
     frameBuffer_ = new uint8_t[frameBufferSize_];
+
+    // One Java array for all transfers instead of NewByteArray per frame
+    JNIEnv* env = jni::getEnv();
+    if (!env) {
+        return false;
+    }
+    if (transferBuffer_) {
+        env->DeleteGlobalRef(transferBuffer_);
+        transferBuffer_ = nullptr;
+    }
+    jbyteArray local = env->NewByteArray(frameBufferSize_);
+    if (!local) {
+        env->ExceptionClear();
+        LOGE("Failed to allocate %d byte transfer buffer", frameBufferSize_);
+        return false;
+    }
+    transferBuffer_ = static_cast<jbyteArray>(env->NewGlobalRef(local));
+    env->DeleteLocalRef(local);
     
-    return negotiateFormat();
+    if (!negotiateFormat()) {
+        return false;
+    }
+    *actual = FrameFormat(width_, height_, kFourccYUYV);
+    actual->bytesPerLine = width_ * 2;
+    return true;
 }
 
 bool UVCCamera::negotiateFormat() {
@@ -190,7 +285,7 @@ bool UVCCamera::negotiateFormat() {
     return true;
 }
 
-bool UVCCamera::startStreaming() {
+bool UVCCamera::start() {
     LOGI("Starting UVC streaming");
     
     if (!bulkEndpoint_) {
@@ -198,59 +293,66 @@ bool UVCCamera::startStreaming() {
         return false;
     }
     
+    sequence_ = 0;
     streaming_ = true;
     LOGI("Streaming started");
     return true;
 }
 
-void UVCCamera::stopStreaming() {
+void UVCCamera::stop() {
+    if (!streaming_) {
+        return;
+    }
     streaming_ = false;
     LOGI("Streaming stopped");
 }
 
-bool UVCCamera::getFrame(uint8_t** data, int* size) {
+LeaseResult UVCCamera::lease(FrameDescriptor* frame, int timeout_ms) {
     if (!streaming_ || !frameBuffer_) {
-        return false;
+        return kLeaseError;
     }
     
     // Read frame from bulk endpoint
-    int bytesRead = bulkTransfer(frameBuffer_, frameBufferSize_, 1000);
+    int bytesRead = bulkTransfer(frameBuffer_, frameBufferSize_, timeout_ms);
     
-    if (bytesRead > 0) {
-        *data = frameBuffer_;
-        *size = bytesRead;
-        return true;
+    if (bytesRead <= 0) {
+        // bulkTransfer reports timeouts and disconnects alike as -1
+        return kLeaseTimeout;
     }
     
-    return false;
+    frame->data = frameBuffer_;
+    frame->size = bytesRead;
+    frame->format = FrameFormat(width_, height_, kFourccYUYV);
+    frame->format.bytesPerLine = width_ * 2;
+    frame->timestampNs = monotonicNowNs();
+    frame->sequence = sequence_++;
+    frame->slot = 0;
+    return kLeaseOk;
 }
 
-void UVCCamera::releaseFrame() {
-    // Nothing to do for now
+void UVCCamera::release(const FrameDescriptor& /* frame */) {
+    // Nothing to do: the buffer is reused by the next lease
 }
 
 int UVCCamera::bulkTransfer(uint8_t* data, int length, int timeout) {
-    if (!usbConnection_ || !bulkEndpoint_) {
+    if (!usbConnection_ || !bulkEndpoint_ || !transferBuffer_ || length > frameBufferSize_) {
+        return -1;
+    }
+
+    // Attaches the capture thread on first use
+    JNIEnv* env = jni::getEnv();
+    const UsbJni* usb = env ? usbJni(env) : nullptr;
+    if (!usb) {
         return -1;
     }
     
-    // Create Java byte array
-    jbyteArray buffer = env_->NewByteArray(length);
-    
-    // Call bulkTransfer
-    jclass connectionClass = env_->FindClass("android/hardware/usb/UsbDeviceConnection");
-    jmethodID bulkTransferMethod = env_->GetMethodID(connectionClass, 
-        "bulkTransfer", "(Landroid/hardware/usb/UsbEndpoint;[BII)I");
-    
-    int result = env_->CallIntMethod(usbConnection_, bulkTransferMethod, 
-                                     bulkEndpoint_, buffer, length, timeout);
+    int result = env->CallIntMethod(usbConnection_, usb->bulkTransfer,
+                                    bulkEndpoint_, transferBuffer_, length, timeout);
     
     if (result > 0) {
         // Copy data from Java array to C array
-        env_->GetByteArrayRegion(buffer, 0, result, reinterpret_cast<jbyte*>(data));
+        env->GetByteArrayRegion(transferBuffer_, 0, result, reinterpret_cast<jbyte*>(data));
     }
     
-    env_->DeleteLocalRef(buffer);
-    
     return result;
 }
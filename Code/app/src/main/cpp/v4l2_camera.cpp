@@ -3,6 +3,8 @@
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <poll.h>
+#include <cerrno>
 #include <cstring>
 #include <android/log.h>
 
@@ -11,16 +13,33 @@
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
 V4L2Camera::V4L2Camera() 
-    : fd_(-1), buffers_(nullptr), buffer_start_(nullptr), 
-      buffer_count_(0), streaming_(false) {
-    memset(&current_buffer_, 0, sizeof(current_buffer_));
+    : fd_(-1), buffers_(nullptr), buffer_count_(0), streaming_(false),
+      buf_type_(V4L2_BUF_TYPE_VIDEO_CAPTURE), memory_(V4L2_MEMORY_MMAP),
+      pool_(nullptr), owned_pool_(nullptr),
+      last_motion_score_(-1.0f) {
+    memset(plane_sizes_, 0, sizeof(plane_sizes_));
+    memset(plane_strides_, 0, sizeof(plane_strides_));
 }
 
 V4L2Camera::~V4L2Camera() {
     close();
 }
 
-bool V4L2Camera::open(const char* device_path) {
+bool V4L2Camera::open(const OpenArgs& args) {
+    if (!setMemory(args)) {
+        return false;
+    }
+    if (args.fd >= 0) {
+        return openFd(args.fd);
+    }
+    if (!args.path) {
+        LOGE("No device path or file descriptor given");
+        return false;
+    }
+    return openPath(args.path);
+}
+
+bool V4L2Camera::openPath(const char* device_path) {
     LOGI("Opening camera device: %s", device_path);
     
     // Use O_RDWR for read/write, O_NONBLOCK for non-blocking, O_EXCL for exclusive access
@@ -42,7 +61,7 @@ bool V4L2Camera::open(const char* device_path) {
     return true;
 }
 
-bool V4L2Camera::openByFd(int fd) {
+bool V4L2Camera::openFd(int fd) {
     LOGI("Opening camera by file descriptor: %d", fd);
     
     if (fd < 0) {
@@ -61,13 +80,37 @@ bool V4L2Camera::openByFd(int fd) {
     return true;
 }
 
-void V4L2Camera::close() {
-    LOGI("Closing camera (fd=%d, streaming=%d)", fd_, streaming_);
+bool V4L2Camera::setMemory(const OpenArgs& args) {
+    delete owned_pool_;
+    owned_pool_ = nullptr;
+    pool_ = nullptr;
+    memory_ = args.memory;
+    
+    if (memory_ == V4L2_MEMORY_MMAP) {
+        return true;
+    }
+    if (memory_ != V4L2_MEMORY_USERPTR && memory_ != V4L2_MEMORY_DMABUF) {
+        LOGE("Unsupported memory type %u", memory_);
+        return false;
+    }
     
-    if (streaming_) {
-        stopStreaming();
+    // USERPTR takes plain heap pages, DMABUF takes dma-buf fds
+    FramePool::Kind kind = memory_ == V4L2_MEMORY_USERPTR ? FramePool::kHeap : FramePool::kDmabuf;
+    if (args.pool && args.pool->kind() != kind) {
+        LOGE("Frame pool kind does not match memory type %u", memory_);
+        return false;
+    }
+    if (!args.pool) {
+        owned_pool_ = new FramePool(kind);
     }
+    pool_ = args.pool ? args.pool : owned_pool_;
+    return true;
+}
+
+void V4L2Camera::close() {
+    LOGI("Closing camera (fd=%d, streaming=%d)", fd_, streaming_);
     
+    stop();
     freeBuffers();
     
     if (fd_ >= 0) {
@@ -75,6 +118,10 @@ void V4L2Camera::close() {
         ::close(fd_);
         fd_ = -1;
     }
+    
+    delete owned_pool_;
+    owned_pool_ = nullptr;
+    pool_ = nullptr;
 }
 
 bool V4L2Camera::queryCapabilities() {
@@ -90,12 +137,21 @@ bool V4L2Camera::queryCapabilities() {
     LOGI("Card: %s", cap.card);
     LOGI("Bus info: %s", cap.bus_info);
     
-    if (!(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE)) {
+    // device_caps describes this node; capabilities covers the whole device
+    uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+    
+    // Prefer the single-planar API; ISP and bridge nodes often only offer MPLANE
+    if (caps & V4L2_CAP_VIDEO_CAPTURE) {
+        buf_type_ = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    } else if (caps & V4L2_CAP_VIDEO_CAPTURE_MPLANE) {
+        buf_type_ = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+        LOGI("Using the multi-planar API");
+    } else {
         LOGE("Device does not support video capture");
         return false;
     }
     
-    if (!(cap.capabilities & V4L2_CAP_STREAMING)) {
+    if (!(caps & V4L2_CAP_STREAMING)) {
         LOGE("Device does not support streaming");
         return false;
     }
@@ -103,26 +159,66 @@ bool V4L2Camera::queryCapabilities() {
     return true;
 }
 
-bool V4L2Camera::setFormat(int width, int height, int pixelFormat) {
+bool V4L2Camera::negotiate(const FrameFormat& requested, FrameFormat* actual) {
     struct v4l2_format fmt;
     memset(&fmt, 0, sizeof(fmt));
     
-    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    fmt.fmt.pix.width = width;
-    fmt.fmt.pix.height = height;
-    fmt.fmt.pix.pixelformat = pixelFormat;
-    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+    fmt.type = buf_type_;
+    if (multiPlanar()) {
+        fmt.fmt.pix_mp.width = requested.width;
+        fmt.fmt.pix_mp.height = requested.height;
+        fmt.fmt.pix_mp.pixelformat = requested.pixelFormat;
+        fmt.fmt.pix_mp.field = V4L2_FIELD_NONE;
+    } else {
+        fmt.fmt.pix.width = requested.width;
+        fmt.fmt.pix.height = requested.height;
+        fmt.fmt.pix.pixelformat = requested.pixelFormat;
+        fmt.fmt.pix.field = V4L2_FIELD_NONE;
+    }
     
-    LOGI("Attempting to set format: %dx%d, fourcc=0x%08x", width, height, pixelFormat);
+    LOGI("Attempting to set format: %dx%d, fourcc=0x%08x",
+         requested.width, requested.height, requested.pixelFormat);
     
     if (ioctl(fd_, VIDIOC_S_FMT, &fmt) < 0) {
         LOGE("Failed to set format %dx%d fourcc=0x%08x: %s (errno=%d)", 
-             width, height, pixelFormat, strerror(errno), errno);
+             requested.width, requested.height, requested.pixelFormat, strerror(errno), errno);
         return false;
     }
     
-    LOGI("Format successfully set to %dx%d, fourcc=0x%08x", 
-         fmt.fmt.pix.width, fmt.fmt.pix.height, fmt.fmt.pix.pixelformat);
+    memset(plane_sizes_, 0, sizeof(plane_sizes_));
+    memset(plane_strides_, 0, sizeof(plane_strides_));
+    if (multiPlanar()) {
+        if (fmt.fmt.pix_mp.num_planes < 1 || fmt.fmt.pix_mp.num_planes > kMaxFramePlanes) {
+            LOGE("Unsupported plane count %d", fmt.fmt.pix_mp.num_planes);
+            return false;
+        }
+        format_.width = fmt.fmt.pix_mp.width;
+        format_.height = fmt.fmt.pix_mp.height;
+        format_.pixelFormat = fmt.fmt.pix_mp.pixelformat;
+        format_.planes = fmt.fmt.pix_mp.num_planes;
+        for (int i = 0; i < format_.planes; ++i) {
+            plane_sizes_[i] = fmt.fmt.pix_mp.plane_fmt[i].sizeimage;
+            plane_strides_[i] = fmt.fmt.pix_mp.plane_fmt[i].bytesperline;
+        }
+    } else {
+        format_.width = fmt.fmt.pix.width;
+        format_.height = fmt.fmt.pix.height;
+        format_.pixelFormat = fmt.fmt.pix.pixelformat;
+        format_.planes = 1;
+        plane_sizes_[0] = fmt.fmt.pix.sizeimage;
+        plane_strides_[0] = fmt.fmt.pix.bytesperline;
+    }
+    
+    LOGI("Format successfully set to %dx%d, fourcc=0x%08x, %d plane(s)", 
+         format_.width, format_.height, format_.pixelFormat, format_.planes);
+    
+    if (format_.pixelFormat == V4L2_PIX_FMT_YUYV) {
+        format_.bytesPerLine = plane_strides_[0] > 0 ? plane_strides_[0] : format_.width * 2;
+    } else {
+        format_.bytesPerLine = 0;
+    }
+    *actual = format_;
+    motion_gate_.reset();
     return true;
 }
 
@@ -130,99 +226,226 @@ bool V4L2Camera::initBuffers() {
     struct v4l2_requestbuffers req;
     memset(&req, 0, sizeof(req));
     
-    req.count = 4;
-    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    req.memory = V4L2_MEMORY_MMAP;
+    req.count = kBufferCount;
+    req.type = buf_type_;
+    req.memory = memory_;
+    
+    // A pool the caller already filled fixes the buffer count; our own pool
+    // is resized to whatever the driver grants
+    if (memory_ != V4L2_MEMORY_MMAP && pool_ != owned_pool_ && pool_->count() > 0) {
+        req.count = pool_->count() / format_.planes;
+    }
     
     if (ioctl(fd_, VIDIOC_REQBUFS, &req) < 0) {
         LOGE("Failed to request buffers: %s", strerror(errno));
         return false;
     }
     
+    buffer_count_ = req.count;
     if (req.count < 2) {
         LOGE("Insufficient buffer memory");
+        freeBuffers();
         return false;
     }
     
-    buffer_count_ = req.count;
-    buffers_ = new v4l2_buffer[buffer_count_];
-    buffer_start_ = new void*[buffer_count_];
+    buffers_ = new Buffer[buffer_count_];
+    memset(buffers_, 0, sizeof(Buffer) * buffer_count_);
     
+    bool ok = memory_ == V4L2_MEMORY_MMAP ? mapBuffers() : attachPool();
+    if (!ok) {
+        freeBuffers();
+        return false;
+    }
+    
+    LOGI("Initialized %d buffers", buffer_count_);
+    return true;
+}
+
+bool V4L2Camera::mapBuffers() {
     for (int i = 0; i < buffer_count_; ++i) {
         struct v4l2_buffer buf;
+        struct v4l2_plane planes[VIDEO_MAX_PLANES];
         memset(&buf, 0, sizeof(buf));
+        memset(planes, 0, sizeof(planes));
         
-        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.type = buf_type_;
         buf.memory = V4L2_MEMORY_MMAP;
         buf.index = i;
+        if (multiPlanar()) {
+            buf.m.planes = planes;
+            buf.length = VIDEO_MAX_PLANES;
+        }
         
         if (ioctl(fd_, VIDIOC_QUERYBUF, &buf) < 0) {
             LOGE("Failed to query buffer: %s", strerror(errno));
-            freeBuffers();
             return false;
         }
         
-        buffer_start_[i] = mmap(nullptr, buf.length, 
-                                PROT_READ | PROT_WRITE, 
-                                MAP_SHARED, 
-                                fd_, buf.m.offset);
-        
-        if (buffer_start_[i] == MAP_FAILED) {
-            LOGE("Failed to mmap buffer: %s", strerror(errno));
-            freeBuffers();
+        // Each plane of a multi-planar buffer has its own offset and mapping
+        for (int p = 0; p < format_.planes; ++p) {
+            uint32_t length = multiPlanar() ? planes[p].length : buf.length;
+            off_t offset = multiPlanar() ? planes[p].m.mem_offset : buf.m.offset;
+            
+            void* start = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, offset);
+            if (start == MAP_FAILED) {
+                LOGE("Failed to mmap buffer: %s", strerror(errno));
+                return false;
+            }
+            
+            buffers_[i].planes[p] = static_cast<uint8_t*>(start);
+            buffers_[i].lengths[p] = length;
+        }
+    }
+    return true;
+}
+
+bool V4L2Camera::attachPool() {
+    uint32_t needed = 0;
+    for (int p = 0; p < format_.planes; ++p) {
+        needed = plane_sizes_[p] > needed ? plane_sizes_[p] : needed;
+    }
+    if (needed == 0) {
+        LOGE("Driver reported no frame size for user buffers");
+        return false;
+    }
+    
+    // One pool buffer per plane: buffer i, plane p uses pool slot i * planes + p.
+    // Our own pool follows the negotiated format, so a renegotiation to larger
+    // frames or another plane count reallocates it; a caller's pool is fixed.
+    int slots = buffer_count_ * format_.planes;
+    if (pool_ == owned_pool_) {
+        if ((pool_->count() != slots || pool_->bufferSize() < needed) && !pool_->allocate(slots, needed)) {
             return false;
         }
-        
-        buffers_[i] = buf;
+    } else if (pool_->count() == 0 && !pool_->allocate(slots, needed)) {
+        return false;
+    }
+    if (pool_->bufferSize() < needed) {
+        LOGE("Pool buffers of %zu bytes are smaller than the %u byte frames", pool_->bufferSize(), needed);
+        return false;
     }
     
-    LOGI("Initialized %d buffers", buffer_count_);
+    // The driver may offer more buffers than the pool holds; the rest stay unqueued
+    if (pool_->count() < slots) {
+        buffer_count_ = pool_->count() / format_.planes;
+        if (buffer_count_ < 2) {
+            LOGE("Frame pool holds fewer than two frames");
+            return false;
+        }
+    }
+    
+    for (int i = 0; i < buffer_count_; ++i) {
+        for (int p = 0; p < format_.planes; ++p) {
+            buffers_[i].planes[p] = pool_->data(i * format_.planes + p);
+            buffers_[i].lengths[p] = static_cast<uint32_t>(pool_->bufferSize());
+        }
+    }
     return true;
 }
 
-void V4L2Camera::freeBuffers() {
-    if (buffer_start_) {
-        for (int i = 0; i < buffer_count_; ++i) {
-            if (buffer_start_[i] && buffer_start_[i] != MAP_FAILED) {
-                munmap(buffer_start_[i], buffers_[i].length);
+bool V4L2Camera::queueBuffer(int index) {
+    struct v4l2_buffer buf;
+    struct v4l2_plane planes[VIDEO_MAX_PLANES];
+    memset(&buf, 0, sizeof(buf));
+    memset(planes, 0, sizeof(planes));
+    
+    buf.type = buf_type_;
+    buf.memory = memory_;
+    buf.index = index;
+    if (multiPlanar()) {
+        buf.m.planes = planes;
+        buf.length = format_.planes;
+    }
+    
+    // User memory has to be handed over again on every QBUF
+    if (memory_ != V4L2_MEMORY_MMAP) {
+        for (int p = 0; p < format_.planes; ++p) {
+            int slot = index * format_.planes + p;
+            uint32_t length = buffers_[index].lengths[p];
+            if (multiPlanar()) {
+                if (memory_ == V4L2_MEMORY_USERPTR) {
+                    planes[p].m.userptr = reinterpret_cast<unsigned long>(pool_->data(slot));
+                } else {
+                    planes[p].m.fd = pool_->fd(slot);
+                }
+                planes[p].length = length;
+            } else {
+                if (memory_ == V4L2_MEMORY_USERPTR) {
+                    buf.m.userptr = reinterpret_cast<unsigned long>(pool_->data(slot));
+                } else {
+                    buf.m.fd = pool_->fd(slot);
+                }
+                buf.length = length;
             }
         }
-        delete[] buffer_start_;
-        buffer_start_ = nullptr;
     }
     
+    return ioctl(fd_, VIDIOC_QBUF, &buf) == 0;
+}
+
+void V4L2Camera::freeBuffers() {
     if (buffers_) {
+        // Pool buffers outlive the stream; only driver mappings are undone here
+        if (memory_ == V4L2_MEMORY_MMAP) {
+            for (int i = 0; i < buffer_count_; ++i) {
+                for (int p = 0; p < format_.planes; ++p) {
+                    if (buffers_[i].planes[p]) {
+                        munmap(buffers_[i].planes[p], buffers_[i].lengths[p]);
+                    }
+                }
+            }
+        }
         delete[] buffers_;
         buffers_ = nullptr;
     }
     
+    // Hand the buffers back so the next start() can request them again
+    if (buffer_count_ > 0 && fd_ >= 0) {
+        struct v4l2_requestbuffers req;
+        memset(&req, 0, sizeof(req));
+        req.count = 0;
+        req.type = buf_type_;
+        req.memory = memory_;
+        ioctl(fd_, VIDIOC_REQBUFS, &req);
+    }
     buffer_count_ = 0;
 }
 
-bool V4L2Camera::startStreaming() {
+void V4L2Camera::beginCpuAccess(int index) {
+    if (memory_ == V4L2_MEMORY_DMABUF) {
+        for (int p = 0; p < format_.planes; ++p) {
+            pool_->beginCpuAccess(index * format_.planes + p);
+        }
+    }
+}
+
+void V4L2Camera::endCpuAccess(int index) {
+    if (memory_ == V4L2_MEMORY_DMABUF) {
+        for (int p = 0; p < format_.planes; ++p) {
+            pool_->endCpuAccess(index * format_.planes + p);
+        }
+    }
+}
+
+bool V4L2Camera::start() {
     if (!initBuffers()) {
         return false;
     }
     
     // Queue all buffers
     for (int i = 0; i < buffer_count_; ++i) {
-        struct v4l2_buffer buf;
-        memset(&buf, 0, sizeof(buf));
-        
-        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory = V4L2_MEMORY_MMAP;
-        buf.index = i;
-        
-        if (ioctl(fd_, VIDIOC_QBUF, &buf) < 0) {
+        if (!queueBuffer(i)) {
             LOGE("Failed to queue buffer: %s", strerror(errno));
+            freeBuffers();
             return false;
         }
     }
     
     // Start streaming
-    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    enum v4l2_buf_type type = static_cast<enum v4l2_buf_type>(buf_type_);
     if (ioctl(fd_, VIDIOC_STREAMON, &type) < 0) {
         LOGE("Failed to start streaming: %s", strerror(errno));
+        freeBuffers();
         return false;
     }
     
@@ -231,48 +454,110 @@ bool V4L2Camera::startStreaming() {
     return true;
 }
 
-bool V4L2Camera::stopStreaming() {
+void V4L2Camera::stop() {
     if (!streaming_) {
-        return true;
+        return;
     }
     
-    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    // STREAMOFF also dequeues every buffer, leased or not
+    enum v4l2_buf_type type = static_cast<enum v4l2_buf_type>(buf_type_);
     if (ioctl(fd_, VIDIOC_STREAMOFF, &type) < 0) {
         LOGE("Failed to stop streaming: %s", strerror(errno));
-        return false;
     }
     
     streaming_ = false;
+    freeBuffers();
     LOGI("Streaming stopped");
-    return true;
 }
 
-bool V4L2Camera::getFrame(unsigned char** buffer, int* buffer_size) {
+LeaseResult V4L2Camera::lease(FrameDescriptor* frame, int timeout_ms) {
     if (!streaming_) {
         LOGE("Camera is not streaming");
-        return false;
+        return kLeaseError;
+    }
+    
+    struct pollfd pfd;
+    pfd.fd = fd_;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int ready = poll(&pfd, 1, timeout_ms);
+    if (ready == 0 || (ready < 0 && errno == EINTR)) {
+        return kLeaseTimeout;
+    }
+    if (ready < 0 || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) {
+        LOGE("Device not readable (revents=0x%x): %s", pfd.revents, strerror(errno));
+        return kLeaseError;
     }
     
-    memset(&current_buffer_, 0, sizeof(current_buffer_));
-    current_buffer_.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    current_buffer_.memory = V4L2_MEMORY_MMAP;
+    struct v4l2_buffer buf;
+    struct v4l2_plane planes[VIDEO_MAX_PLANES];
+    memset(&buf, 0, sizeof(buf));
+    memset(planes, 0, sizeof(planes));
+    buf.type = buf_type_;
+    buf.memory = memory_;
+    if (multiPlanar()) {
+        buf.m.planes = planes;
+        buf.length = format_.planes;
+    }
     
-    if (ioctl(fd_, VIDIOC_DQBUF, &current_buffer_) < 0) {
+    if (ioctl(fd_, VIDIOC_DQBUF, &buf) < 0) {
         if (errno == EAGAIN) {
-            return false; // No frame available yet
+            return kLeaseTimeout;
         }
         LOGE("Failed to dequeue buffer: %s", strerror(errno));
-        return false;
+        return kLeaseError;
     }
     
-    *buffer = (unsigned char*)buffer_start_[current_buffer_.index];
-    *buffer_size = current_buffer_.bytesused;
+    // A corrupted transfer: give the buffer straight back and let the caller retry
+    if (buf.flags & V4L2_BUF_FLAG_ERROR) {
+        queueBuffer(buf.index);
+        return kLeaseTimeout;
+    }
     
-    return true;
+    const Buffer& buffer = buffers_[buf.index];
+    beginCpuAccess(buf.index);
+    if (multiPlanar()) {
+        for (int p = 0; p < format_.planes; ++p) {
+            // data_offset counts toward bytesused; the payload starts after it
+            uint32_t offset = planes[p].data_offset < planes[p].bytesused ? planes[p].data_offset : 0;
+            frame->planes[p].data = buffer.planes[p] + offset;
+            frame->planes[p].size = planes[p].bytesused - offset;
+            frame->planes[p].bytesPerLine = plane_strides_[p];
+        }
+        frame->data = frame->planes[0].data;
+        frame->size = frame->planes[0].size;
+    } else {
+        frame->data = buffer.planes[0];
+        frame->size = buf.bytesused;
+    }
+    frame->format = format_;
+    frame->sequence = buf.sequence;
+    frame->slot = buf.index;
+    if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+        frame->timestampNs = static_cast<int64_t>(buf.timestamp.tv_sec) * 1000000000LL +
+                             static_cast<int64_t>(buf.timestamp.tv_usec) * 1000LL;
+    } else {
+        frame->timestampNs = monotonicNowNs();
+    }
+    
+    // Score motion on the capture buffer itself; MJPEG is scored after decode on the Java side
+    if (format_.pixelFormat == V4L2_PIX_FMT_YUYV && frame->size >= format_.imageSize()) {
+        last_motion_score_ = motion_gate_.updateYUYV(frame->data, format_.width, format_.height,
+                                                     format_.bytesPerLine);
+    } else {
+        last_motion_score_ = -1.0f;
+    }
+    
+    return kLeaseOk;
 }
 
-void V4L2Camera::releaseFrame() {
-    if (ioctl(fd_, VIDIOC_QBUF, &current_buffer_) < 0) {
+void V4L2Camera::release(const FrameDescriptor& frame) {
+    if (!streaming_ || frame.slot < 0 || frame.slot >= buffer_count_) {
+        return;
+    }
+    
+    endCpuAccess(frame.slot);
+    if (!queueBuffer(frame.slot)) {
         LOGE("Failed to requeue buffer: %s", strerror(errno));
     }
 }
@@ -3,51 +3,110 @@
 
 #include <linux/videodev2.h>
 #include <string>
+#include "frame_pool.h"
+#include "frame_source.h"
+#include "motion_gate.h"
 
+/**
+ * Capture backend for kernel V4L2 nodes (/dev/videoN): UVC webcams through
+ * the single-planar API and MPLANE-only ISP/bridge nodes through the
+ * multi-planar one, picked from the node's caps.
+ *
+ * Buffers are the driver's own, mmap'd per plane (V4L2_MEMORY_MMAP), or
+ * caller-owned FramePool buffers the driver writes into directly
+ * (V4L2_MEMORY_USERPTR with a heap pool, V4L2_MEMORY_DMABUF with a dma-buf
+ * pool). Either way leased frames point straight into the capture buffer.
+ */
 class V4L2Camera {
 public:
+    struct OpenArgs {
+        const char* path;  // device node, used when fd < 0
+        int fd;            // already-open descriptor (e.g. from the USB Host API)
+        uint32_t memory;   // V4L2_MEMORY_MMAP, _USERPTR or _DMABUF
+        FramePool* pool;   // USERPTR/DMABUF buffers; null lets the camera allocate its own
+
+        static OpenArgs fromPath(const char* path) { OpenArgs a = {path, -1, V4L2_MEMORY_MMAP, nullptr}; return a; }
+        static OpenArgs fromFd(int fd) { OpenArgs a = {nullptr, fd, V4L2_MEMORY_MMAP, nullptr}; return a; }
+
+        // USERPTR/DMABUF capture into buffers; an empty pool is sized on start()
+        OpenArgs withMemory(uint32_t mem, FramePool* buffers) const {
+            OpenArgs a = *this;
+            a.memory = mem;
+            a.pool = buffers;
+            return a;
+        }
+    };
+
+    // Keep at least two of the requested buffers queued with the driver
+    static const int kMaxLeases = 2;
+
+    static const char* name() { return "v4l2"; }
+
     V4L2Camera();
     ~V4L2Camera();
 
-    // Open camera device by path
-    bool open(const char* device_path);
-    
-    // Open camera device by file descriptor (from USB Host API)
-    bool openByFd(int fd);
-    
-    // Close camera device
+    bool open(const OpenArgs& args);
     void close();
-    
-    // Set camera format
-    bool setFormat(int width, int height, int pixelFormat);
-    
-    // Start streaming
-    bool startStreaming();
-    
-    // Stop streaming
-    bool stopStreaming();
-    
-    // Get next frame
-    bool getFrame(unsigned char** buffer, int* buffer_size);
-    
-    // Release frame buffer
-    void releaseFrame();
-    
+    bool negotiate(const FrameFormat& requested, FrameFormat* actual);
+    bool start();
+    void stop();
+    LeaseResult lease(FrameDescriptor* frame, int timeout_ms);
+    void release(const FrameDescriptor& frame);
+
     // Check if camera is open
     bool isOpen() const { return fd_ >= 0; }
 
+    // Motion score of the last leased frame (-1 if the format is not scored natively)
+    float lastMotionScore() const { return last_motion_score_; }
+
+    // Reset the motion background (e.g. after a format change)
+    void resetMotion() { motion_gate_.reset(); }
+
+    // V4L2_BUF_TYPE_VIDEO_CAPTURE or V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE, known after open
+    uint32_t bufferType() const { return buf_type_; }
+    uint32_t memory() const { return memory_; }
+
 private:
+    // One capture buffer; planes are mmap'd driver memory or FramePool buffers
+    struct Buffer {
+        uint8_t* planes[VIDEO_MAX_PLANES];
+        uint32_t lengths[VIDEO_MAX_PLANES];
+    };
+
+    // Buffers requested from the driver (or sized into an empty pool)
+    static const int kBufferCount = 4;
+
     int fd_;
-    struct v4l2_buffer current_buffer_;
-    struct v4l2_buffer* buffers_;
-    void** buffer_start_;
+    Buffer* buffers_;
     int buffer_count_;
     bool streaming_;
-    
+
+    uint32_t buf_type_;
+    uint32_t memory_;
+    FramePool* pool_;
+    FramePool* owned_pool_;  // allocated here when OpenArgs gave no pool
+
+    FrameFormat format_;
+    uint32_t plane_sizes_[VIDEO_MAX_PLANES];  // sizeimage per plane from S_FMT
+    int plane_strides_[VIDEO_MAX_PLANES];
+
+    MotionGate motion_gate_;
+    float last_motion_score_;
+
+    bool multiPlanar() const { return buf_type_ == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE; }
+
     // Helper methods
+    bool openPath(const char* device_path);
+    bool openFd(int fd);
+    bool setMemory(const OpenArgs& args);
     bool initBuffers();
+    bool mapBuffers();
+    bool attachPool();
+    bool queueBuffer(int index);
     void freeBuffers();
     bool queryCapabilities();
+    void beginCpuAccess(int index);
+    void endCpuAccess(int index);
 };
 
 #endif // V4L2_CAMERA_H
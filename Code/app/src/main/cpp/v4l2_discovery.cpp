@@ -0,0 +1,216 @@
+#include "v4l2_discovery.h"
+#include <android/log.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/videodev2.h>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+#define LOG_TAG "V4L2Discovery"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+namespace {
+
+const char* const kSysfsRoot = "/sys/class/video4linux";
+
+std::mutex g_cache_mutex;
+std::map<uint32_t, V4L2NodeInfo> g_cache;
+
+uint32_t cacheKey(int vendorId, int productId) {
+    return (static_cast<uint32_t>(vendorId & 0xffff) << 16) | static_cast<uint32_t>(productId & 0xffff);
+}
+
+double nowMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Reads a sysfs attribute holding a hex number (idVendor, idProduct)
+bool readHex(const std::string& path, int* value) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (!file) {
+        return false;
+    }
+    unsigned int parsed = 0;
+    bool ok = fscanf(file, "%x", &parsed) == 1;
+    fclose(file);
+    if (ok) {
+        *value = static_cast<int>(parsed);
+    }
+    return ok;
+}
+
+// Node names sorted by number so video2 comes before video10
+bool byNodeNumber(const std::string& a, const std::string& b) {
+    int na = atoi(a.c_str() + 5);
+    int nb = atoi(b.c_str() + 5);
+    return na < nb;
+}
+
+void enumerateFormats(int fd, uint32_t type, std::vector<V4L2FormatInfo>* formats) {
+    struct v4l2_fmtdesc desc;
+    memset(&desc, 0, sizeof(desc));
+    desc.type = type;
+
+    for (desc.index = 0; ioctl(fd, VIDIOC_ENUM_FMT, &desc) == 0; desc.index++) {
+        struct v4l2_frmsizeenum size;
+        memset(&size, 0, sizeof(size));
+        size.pixel_format = desc.pixelformat;
+
+        for (size.index = 0; ioctl(fd, VIDIOC_ENUM_FRAMESIZES, &size) == 0; size.index++) {
+            // Stepwise ranges are left to the caller's S_FMT fallback
+            if (size.type != V4L2_FRMSIZE_TYPE_DISCRETE) {
+                break;
+            }
+            V4L2FormatInfo info;
+            info.pixelFormat = desc.pixelformat;
+            info.width = static_cast<int>(size.discrete.width);
+            info.height = static_cast<int>(size.discrete.height);
+            formats->push_back(info);
+        }
+    }
+}
+
+} // namespace
+
+bool V4L2Discovery::find(int vendorId, int productId, V4L2NodeInfo* out, bool* cacheHit) {
+    double start = nowMs();
+    uint32_t key = cacheKey(vendorId, productId);
+
+    {
+        std::lock_guard<std::mutex> lock(g_cache_mutex);
+        std::map<uint32_t, V4L2NodeInfo>::const_iterator it = g_cache.find(key);
+        // Node numbers change across replugs, so re-check the sysfs link (no open)
+        if (it != g_cache.end() && stillMatches(it->second, vendorId, productId)) {
+            *out = it->second;
+            *cacheHit = true;
+            LOGI("Cached %04x:%04x -> %s (%.2f ms)", vendorId, productId,
+                 out->devicePath.c_str(), nowMs() - start);
+            return true;
+        }
+        g_cache.erase(key);
+    }
+
+    *cacheHit = false;
+    V4L2NodeInfo node;
+    if (!scan(vendorId, productId, &node)) {
+        LOGE("No capture node for %04x:%04x (%.2f ms)", vendorId, productId, nowMs() - start);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_cache_mutex);
+        g_cache[key] = node;
+    }
+    *out = node;
+    LOGI("Discovered %04x:%04x -> %s with %zu formats (%.2f ms)", vendorId, productId,
+         node.devicePath.c_str(), node.formats.size(), nowMs() - start);
+    return true;
+}
+
+void V4L2Discovery::invalidate(int vendorId, int productId) {
+    std::lock_guard<std::mutex> lock(g_cache_mutex);
+    g_cache.erase(cacheKey(vendorId, productId));
+}
+
+bool V4L2Discovery::scan(int vendorId, int productId, V4L2NodeInfo* out) {
+    DIR* dir = opendir(kSysfsRoot);
+    if (!dir) {
+        LOGE("Cannot read %s: %s", kSysfsRoot, strerror(errno));
+        return false;
+    }
+
+    std::vector<std::string> names;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (strncmp(entry->d_name, "video", 5) == 0) {
+            names.push_back(entry->d_name);
+        }
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end(), byNodeNumber);
+
+    for (size_t i = 0; i < names.size(); i++) {
+        int vid = 0;
+        int pid = 0;
+        if (!usbIds(names[i], &vid, &pid) || vid != vendorId || pid != productId) {
+            continue;
+        }
+
+        // Same USB device can expose capture and metadata nodes; only QUERYCAP tells them apart
+        std::string devicePath = "/dev/" + names[i];
+        std::vector<V4L2FormatInfo> formats;
+        if (probeCapture(devicePath, &formats)) {
+            out->devicePath = devicePath;
+            out->sysfsName = names[i];
+            out->formats.swap(formats);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool V4L2Discovery::stillMatches(const V4L2NodeInfo& node, int vendorId, int productId) {
+    int vid = 0;
+    int pid = 0;
+    return usbIds(node.sysfsName, &vid, &pid) && vid == vendorId && pid == productId;
+}
+
+bool V4L2Discovery::usbIds(const std::string& sysfsName, int* vendorId, int* productId) {
+    // videoN/device points at the USB interface (e.g. .../1-1/1-1:1.0); the
+    // idVendor / idProduct attributes live on the USB device above it
+    std::string link = std::string(kSysfsRoot) + "/" + sysfsName + "/device";
+    char resolved[PATH_MAX];
+    if (!realpath(link.c_str(), resolved)) {
+        return false;
+    }
+
+    std::string path(resolved);
+    for (int depth = 0; depth < 4 && path.size() > 1; depth++) {
+        if (readHex(path + "/idVendor", vendorId) && readHex(path + "/idProduct", productId)) {
+            return true;
+        }
+        path = path.substr(0, path.rfind('/'));
+    }
+    return false;
+}
+
+bool V4L2Discovery::probeCapture(const std::string& devicePath, std::vector<V4L2FormatInfo>* formats) {
+    int fd = ::open(devicePath.c_str(), O_RDWR | O_NONBLOCK);
+    if (fd < 0) {
+        LOGE("Failed to open %s: %s", devicePath.c_str(), strerror(errno));
+        return false;
+    }
+
+    struct v4l2_capability cap;
+    memset(&cap, 0, sizeof(cap));
+    bool capture = false;
+    uint32_t type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (ioctl(fd, VIDIOC_QUERYCAP, &cap) == 0) {
+        // device_caps describes this node; capabilities covers the whole device
+        uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+        // MPLANE-only nodes (ISPs, bridges) are capture nodes too
+        if (!(caps & V4L2_CAP_VIDEO_CAPTURE) && (caps & V4L2_CAP_VIDEO_CAPTURE_MPLANE)) {
+            type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+        }
+        capture = (caps & (V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_VIDEO_CAPTURE_MPLANE)) &&
+                  (caps & V4L2_CAP_STREAMING);
+    }
+
+    if (capture) {
+        enumerateFormats(fd, type, formats);
+    }
+    ::close(fd);
+    return capture;
+}
@@ -0,0 +1,45 @@
+#ifndef V4L2_DISCOVERY_H
+#define V4L2_DISCOVERY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Finds the V4L2 capture node for a USB camera without probing /dev/video*.
+ *
+ * /sys/class/video4linux is scanned and each node's parent USB device is
+ * matched on VID/PID. Only nodes whose device caps report video capture
+ * (single- or multi-planar) and streaming are kept, which drops the UVC
+ * metadata node that shares the same VID/PID. The result and its discrete
+ * formats are cached per VID/PID for the life of the process.
+ */
+struct V4L2FormatInfo {
+    uint32_t pixelFormat;
+    int width;
+    int height;
+};
+
+struct V4L2NodeInfo {
+    std::string devicePath;   // e.g. /dev/video2
+    std::string sysfsName;    // e.g. video2
+    std::vector<V4L2FormatInfo> formats;
+};
+
+class V4L2Discovery {
+public:
+    // Look up (or scan for) the capture node of vendorId:productId.
+    // Returns false if no matching capture node is found.
+    static bool find(int vendorId, int productId, V4L2NodeInfo* out, bool* cacheHit);
+
+    // Drop the cached node, e.g. after the device was unplugged
+    static void invalidate(int vendorId, int productId);
+
+private:
+    static bool scan(int vendorId, int productId, V4L2NodeInfo* out);
+    static bool stillMatches(const V4L2NodeInfo& node, int vendorId, int productId);
+    static bool usbIds(const std::string& sysfsName, int* vendorId, int* productId);
+    static bool probeCapture(const std::string& devicePath, std::vector<V4L2FormatInfo>* formats);
+};
+
+#endif // V4L2_DISCOVERY_H
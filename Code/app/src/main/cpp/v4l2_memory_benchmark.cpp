@@ -0,0 +1,238 @@
+#include <jni.h>
+#include <android/log.h>
+#include <sys/resource.h>
+#include <cstring>
+#include <string>
+#include "jni_support.h"
+#include "frame_pool.h"
+#include "frame_source.h"
+#include "v4l2_camera.h"
+
+#define LOG_TAG "V4L2MemoryBenchmark"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+// Compares V4L2 buffer memory types end to end for V4L2MemoryBenchmark: the
+// capture thread leases each frame, gets it into memory the pipeline owns
+// and reads it once, as the frame consumers do.
+//
+//   MMAP     driver buffer -> memcpy into a pool buffer (one copy per frame)
+//   USERPTR  driver writes into the pool buffer (no copy)
+//   DMABUF   driver writes into a dma-buf from the pool (no copy, cache
+//            maintenance around the CPU read)
+//
+// CPU time is the capture thread's own (RUSAGE_THREAD), so ioctl and cache
+// maintenance cost lands in sys time. The frame generation done by the
+// driver (vivid's kernel thread) is not charged to it.
+
+namespace {
+
+const char* const kClassName = "com/esw/postureanalyzer/vision/V4L2MemoryBenchmark";
+
+const int kLeaseTimeoutMs = 2000;
+
+// Frames leased before measuring, so buffer setup and first-touch faults are excluded
+const int kWarmupFrames = 10;
+
+// Layout of the metrics array shared with V4L2MemoryBenchmark.Result
+enum Metric {
+    kMetricFrames,
+    kMetricFps,
+    kMetricUserMsPerFrame,
+    kMetricSysMsPerFrame,
+    kMetricCopiesPerFrame,
+    kMetricBytesCopiedPerFrame,
+    kMetricCount,
+};
+
+struct BenchmarkResult {
+    std::string failure;
+    int frames;
+    double fps;
+    double userMsPerFrame;
+    double sysMsPerFrame;
+    double copiesPerFrame;
+    double bytesCopiedPerFrame;
+
+    BenchmarkResult()
+        : frames(0), fps(0.0), userMsPerFrame(0.0), sysMsPerFrame(0.0),
+          copiesPerFrame(0.0), bytesCopiedPerFrame(0.0) {}
+};
+
+const char* memoryName(uint32_t memory) {
+    switch (memory) {
+        case V4L2_MEMORY_MMAP: return "mmap";
+        case V4L2_MEMORY_USERPTR: return "userptr";
+        case V4L2_MEMORY_DMABUF: return "dmabuf";
+        default: return "unknown";
+    }
+}
+
+double timevalMs(const struct timeval& tv) {
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+// One read per cache line, standing in for the consumer's pass over the frame
+uint32_t touch(const uint8_t* data, int size) {
+    uint32_t sum = 0;
+    for (int i = 0; i < size; i += 64) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+uint32_t touchFrame(const FrameDescriptor& frame) {
+    if (frame.format.planes <= 1) {
+        return touch(frame.data, frame.size);
+    }
+    uint32_t sum = 0;
+    for (int p = 0; p < frame.format.planes; p++) {
+        sum += touch(frame.planes[p].data, frame.planes[p].size);
+    }
+    return sum;
+}
+
+int frameBytes(const FrameDescriptor& frame) {
+    if (frame.format.planes <= 1) {
+        return frame.size;
+    }
+    int bytes = 0;
+    for (int p = 0; p < frame.format.planes; p++) {
+        bytes += frame.planes[p].size;
+    }
+    return bytes;
+}
+
+// MMAP frames are copied out so the driver buffer can go straight back
+bool copyOut(const FrameDescriptor& frame, FramePool* consumer, uint64_t* copies, uint64_t* bytes) {
+    int size = frameBytes(frame);
+    if (consumer->bufferSize() < static_cast<size_t>(size) && !consumer->allocate(1, size)) {
+        return false;
+    }
+    uint8_t* dst = consumer->data(0);
+    if (frame.format.planes <= 1) {
+        memcpy(dst, frame.data, frame.size);
+    } else {
+        for (int p = 0; p < frame.format.planes; p++) {
+            memcpy(dst, frame.planes[p].data, frame.planes[p].size);
+            dst += frame.planes[p].size;
+        }
+    }
+    ++*copies;
+    *bytes += static_cast<uint64_t>(size);
+    return true;
+}
+
+BenchmarkResult run(const char* path, uint32_t memory, const FrameFormat& requested, int frames) {
+    BenchmarkResult result;
+    FramePool capture(memory == V4L2_MEMORY_DMABUF ? FramePool::kDmabuf : FramePool::kHeap);
+    FramePool consumer(FramePool::kHeap);
+
+    V4L2Camera::OpenArgs args = V4L2Camera::OpenArgs::fromPath(path);
+    if (memory != V4L2_MEMORY_MMAP) {
+        args = args.withMemory(memory, &capture);
+    }
+
+    FrameSource<V4L2Camera> source;
+    if (!source.open(args)) {
+        result.failure = "open failed";
+        return result;
+    }
+    if (!source.negotiate(requested)) {
+        result.failure = "negotiate failed";
+        return result;
+    }
+    if (!source.start()) {
+        result.failure = "start failed (memory type or buffer allocation unsupported)";
+        return result;
+    }
+
+    uint64_t copies = 0;
+    uint64_t bytes_copied = 0;
+    uint32_t checksum = 0;
+    for (int i = 0, tries = 0; i < kWarmupFrames && tries < kWarmupFrames * 4; tries++) {
+        FrameLease<FrameSource<V4L2Camera> > lease(source, kLeaseTimeoutMs);
+        if (lease.ok()) {
+            checksum += touchFrame(lease.frame());
+            i++;
+        }
+    }
+
+    struct rusage before;
+    struct rusage after;
+    getrusage(RUSAGE_THREAD, &before);
+    int attempts = 0;
+    while (result.frames < frames) {
+        if (++attempts > frames * 4) {
+            result.failure = "too many timeouts";
+            return result;
+        }
+        FrameLease<FrameSource<V4L2Camera> > lease(source, kLeaseTimeoutMs);
+        if (lease.result() == kLeaseTimeout) {
+            continue;
+        }
+        if (!lease.ok()) {
+            result.failure = "lease failed while streaming";
+            return result;
+        }
+        if (memory == V4L2_MEMORY_MMAP) {
+            if (!copyOut(lease.frame(), &consumer, &copies, &bytes_copied)) {
+                result.failure = "consumer buffer allocation failed";
+                return result;
+            }
+            checksum += touch(consumer.data(0), frameBytes(lease.frame()));
+        } else {
+            checksum += touchFrame(lease.frame());
+        }
+        result.frames++;
+    }
+    getrusage(RUSAGE_THREAD, &after);
+
+    result.fps = source.stats().fps();
+    result.userMsPerFrame = (timevalMs(after.ru_utime) - timevalMs(before.ru_utime)) / result.frames;
+    result.sysMsPerFrame = (timevalMs(after.ru_stime) - timevalMs(before.ru_stime)) / result.frames;
+    result.copiesPerFrame = static_cast<double>(copies) / result.frames;
+    result.bytesCopiedPerFrame = static_cast<double>(bytes_copied) / result.frames;
+    LOGI("%s: %d frames, %.1f fps, user %.3f ms sys %.3f ms per frame, %.1f copies (%.0f bytes) per frame "
+         "(checksum %u)", memoryName(memory), result.frames, result.fps, result.userMsPerFrame,
+         result.sysMsPerFrame, result.copiesPerFrame, result.bytesCopiedPerFrame, checksum);
+    return result;
+}
+
+jstring nativeRun(JNIEnv* env, jclass clazz, jstring device_path, jint width, jint height,
+                  jint pixel_format, jint memory, jint frames, jdoubleArray metrics) {
+    if (frames <= 0) {
+        return env->NewStringUTF("frame count must be positive");
+    }
+    const char* path = env->GetStringUTFChars(device_path, nullptr);
+    FrameFormat requested(width, height, static_cast<uint32_t>(pixel_format));
+    BenchmarkResult result = run(path, static_cast<uint32_t>(memory), requested, frames);
+    env->ReleaseStringUTFChars(device_path, path);
+
+    if (metrics && env->GetArrayLength(metrics) >= kMetricCount) {
+        jdouble values[kMetricCount];
+        values[kMetricFrames] = result.frames;
+        values[kMetricFps] = result.fps;
+        values[kMetricUserMsPerFrame] = result.userMsPerFrame;
+        values[kMetricSysMsPerFrame] = result.sysMsPerFrame;
+        values[kMetricCopiesPerFrame] = result.copiesPerFrame;
+        values[kMetricBytesCopiedPerFrame] = result.bytesCopiedPerFrame;
+        env->SetDoubleArrayRegion(metrics, 0, kMetricCount, values);
+    }
+
+    if (result.failure.empty()) {
+        return nullptr;
+    }
+    LOGE("%s failed: %s", memoryName(static_cast<uint32_t>(memory)), result.failure.c_str());
+    return env->NewStringUTF(result.failure.c_str());
+}
+
+const JNINativeMethod kMethods[] = {
+    {"nativeRun", "(Ljava/lang/String;IIIII[D)Ljava/lang/String;", reinterpret_cast<void*>(nativeRun)},
+};
+
+} // namespace
+
+bool registerV4L2MemoryBenchmarkNatives(JNIEnv* env) {
+    return jni::registerNatives(env, kClassName, kMethods, jni::arraySize(kMethods));
+}
@@ -1,6 +1,8 @@
 package com.esw.postureanalyzer;
 
+import android.content.Context;
 import android.content.Intent;
+import android.content.SharedPreferences;
 import android.os.Bundle;
 import android.util.Log;
 import android.view.View;
@@ -23,6 +25,8 @@ import java.util.Map;
 
 public class DashboardActivity extends AppCompatActivity {
     private static final String TAG = "DashboardActivity";
+    private static final String PREFS_NAME = "DashboardPrefs";
+    private static final String KEY_STATE_MIGRATED = "posture_state_migrated";
     
     private TextView totalSessionsText;
     private TextView goodPosturePercentText;
@@ -48,6 +52,29 @@ public class DashboardActivity extends AppCompatActivity {
     private long endTime;
     private boolean isActivityRunning = false;
 
+    /**
+     * Rewrite old label-based posture logs to packed state codes (runs once per install)
+     */
+    private void migrateLegacyRecordsOnce() {
+        SharedPreferences prefs = getSharedPreferences(PREFS_NAME, Context.MODE_PRIVATE);
+        if (prefs.getBoolean(KEY_STATE_MIGRATED, false)) {
+            return;
+        }
+
+        dataRetriever.migrateLegacyRecords(new FirebaseDataRetriever.MigrationCallback() {
+            @Override
+            public void onMigrationComplete(int migratedCount) {
+                Log.d(TAG, "Legacy posture records migrated: " + migratedCount);
+                prefs.edit().putBoolean(KEY_STATE_MIGRATED, true).apply();
+            }
+
+            @Override
+            public void onError(String error) {
+                Log.e(TAG, "Legacy migration failed: " + error);
+            }
+        });
+    }
+
     @Override
     protected void onCreate(Bundle savedInstanceState) {
         super.onCreate(savedInstanceState);
@@ -68,6 +95,8 @@ public class DashboardActivity extends AppCompatActivity {
                 return;
             }
             
+            migrateLegacyRecordsOnce();
+
             // Default to today
             setTimePeriod(TimePeriod.TODAY);
             loadDashboardData();
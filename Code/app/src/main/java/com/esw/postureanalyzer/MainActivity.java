@@ -23,16 +23,32 @@ import com.esw.postureanalyzer.vision.UnifiedCameraManager;
 import com.esw.postureanalyzer.vision.DelegateType;
 import com.esw.postureanalyzer.vision.EvaluationMetrics;
 import com.esw.postureanalyzer.vision.FirebaseManager;
+import com.esw.postureanalyzer.vision.LandmarkFilter;
 import com.esw.postureanalyzer.vision.OverlayView;
+import com.esw.postureanalyzer.vision.PersonTracker;
 import com.esw.postureanalyzer.vision.PoseLandmarkerHelper;
+import com.esw.postureanalyzer.vision.PoseModelCascade;
 import com.esw.postureanalyzer.vision.PostureClassifier;
+import com.esw.postureanalyzer.vision.PostureState;
+import com.esw.postureanalyzer.vision.ShadowEvaluator;
 import com.esw.postureanalyzer.managers.PostureTimerManager;
 import com.esw.postureanalyzer.managers.PresenceDetector;
 import com.esw.postureanalyzer.managers.BreakReminderManager;
 import com.esw.postureanalyzer.managers.StretchSuggestionManager;
 import com.esw.postureanalyzer.performance.PerformanceTracker;
+import com.esw.postureanalyzer.performance.ResourceSampler;
+import com.esw.postureanalyzer.performance.ThermalGovernor;
+import com.google.mediapipe.tasks.components.containers.NormalizedLandmark;
 import com.google.mediapipe.tasks.vision.poselandmarker.PoseLandmarkerResult;
 
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.List;
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
+
 public class MainActivity extends AppCompatActivity implements PoseLandmarkerHelper.LandmarkerListener, RadioGroup.OnCheckedChangeListener {
     private static final int CAMERA_PERMISSION_CODE = 100;
 
@@ -54,9 +70,23 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
     private PostureClassifier postureClassifier;
     private FirebaseManager firebaseManager;
     private PerformanceTracker performanceTracker;
+    private ThermalGovernor thermalGovernor;
+    private PoseModelCascade modelCascade;
+    private ResourceSampler resourceSampler;
+    
+    // Thermal tier state
+    private int classifyCounter = 0;
+    // Last result per tracked person, reused on frames the tier skips
+    private final Map<Integer, PostureClassifier.ClassificationResult> lastClassificationResults =
+            new ConcurrentHashMap<>();
+    private int userDelegateRadioId = -1; // Restored when a tier stops forcing a delegate
+    private boolean settingDelegateRadio = false; // check() calls made by the app, not the user
     
     // New managers for enhanced features
-    private PostureTimerManager postureTimerManager;
+    private final PersonTracker personTracker = new PersonTracker();
+    private final Map<Integer, PostureTimerManager> postureTimers = new ConcurrentHashMap<>();
+    private final Map<Integer, LandmarkFilter> landmarkFilters = new ConcurrentHashMap<>();
+    private volatile int primaryPersonId = 0; // Person shown in the status panel
     private PresenceDetector presenceDetector;
     private BreakReminderManager breakReminderManager;
     private StretchSuggestionManager stretchSuggestionManager;
@@ -133,6 +163,28 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
         
         firebaseManager = new FirebaseManager();
         performanceTracker = new PerformanceTracker(this);
+        
+        thermalGovernor = new ThermalGovernor();
+        thermalGovernor.setTierListener(transition -> runOnUiThread(() -> applyThermalTier(transition.to)));
+        performanceTracker.setThermalGovernor(thermalGovernor);
+        if (LandmarkFilter.isAvailable()) {
+            // Smoothed landmarks stay stable at a lower pose rate
+            thermalGovernor.setPoseFpsLimit(LandmarkFilter.SMOOTHED_POSE_FPS);
+        }
+
+        List<String> assets = listAssets();
+        if (assets.containsAll(Arrays.asList(PostureClassifier.CANDIDATE_MODELS))) {
+            // A retrained model set is bundled: compare it against production on live frames
+            postureClassifier.startShadow(PostureClassifier.CANDIDATE_MODELS,
+                    ShadowEvaluator.DEFAULT_SAMPLE_FRACTION, ShadowEvaluator.DEFAULT_CPU_BUDGET);
+        }
+
+        modelCascade = new PoseModelCascade(PoseModelCascade.availableLevels(assets));
+        modelCascade.setLevelListener(change -> runOnUiThread(() -> applyCascadeLevel(change)));
+        Log.i("MainActivity", "Pose model cascade levels: " + modelCascade.getLevels());
+        
+        resourceSampler = new ResourceSampler();
+        performanceTracker.setResourceSampler(resourceSampler);
 
         // Initialize UI with default values
         initializeUI();
@@ -144,9 +196,12 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
         testFirebaseConnection();
 
         // Initialize unified camera manager
-        unifiedCameraManager = new UnifiedCameraManager(this, (bitmap, rotationDegrees) -> {
+        unifiedCameraManager = new UnifiedCameraManager(this, (image, rotationDegrees) -> {
+            if (!thermalGovernor.admitFrame(android.os.SystemClock.elapsedRealtime())) {
+                return; // Over the current tier's frame-rate cap
+            }
             if (poseLandmarkerHelper != null) {
-                poseLandmarkerHelper.detectLiveStream(bitmap, rotationDegrees);
+                poseLandmarkerHelper.detectLiveStream(image, rotationDegrees);
             }
         });
 
@@ -195,11 +250,12 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
         });
 
         // Keep legacy camera manager for compatibility
-        cameraXManager = new CameraXManager(this, previewView, (bitmap, rotationDegrees) -> {
+        cameraXManager = new CameraXManager(this, previewView, (image, rotationDegrees) -> {
             if (poseLandmarkerHelper != null) {
-                poseLandmarkerHelper.detectLiveStream(bitmap, rotationDegrees);
+                poseLandmarkerHelper.detectLiveStream(image, rotationDegrees);
             }
         });
+        cameraXManager.setMotionGate(unifiedCameraManager.getMotionGate());
         
         delegateRadioGroup.setOnCheckedChangeListener(this);
         
@@ -310,32 +366,7 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
      * Initialize all feature managers
      */
     private void initializeManagers() {
-        // Posture Timer Manager
-        postureTimerManager = new PostureTimerManager(this);
-        postureTimerManager.setAlertCallback(new PostureTimerManager.AlertCallback() {
-            @Override
-            public void onSlouchAlert(long slouchDurationMs) {
-                runOnUiThread(() -> {
-                    Toast.makeText(MainActivity.this, 
-                        "Slouch Alert: You've been slouching for " + (slouchDurationMs / 1000) + " seconds", 
-                        Toast.LENGTH_SHORT).show();
-                    
-                    // Show stretch suggestion when slouch alert triggers
-                    if (!hasShownSlouchStretch && stretchSuggestionManager != null) {
-                        stretchSuggestionManager.showChestOpenerStretch();
-                        hasShownSlouchStretch = true;
-                    }
-                });
-            }
-
-            @Override
-            public void onSlouchCorrected(long slouchDurationMs) {
-                runOnUiThread(() -> {
-                    Log.d("MainActivity", "Posture corrected after " + (slouchDurationMs / 1000) + " seconds");
-                    hasShownSlouchStretch = false; // Reset so we can show again next time
-                });
-            }
-        });
+        // Posture timers are created per tracked person, see timerForPerson
 
         // Presence Detector
         presenceDetector = new PresenceDetector();
@@ -348,7 +379,7 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
                         presenceStatusText.setTextColor(getColor(android.R.color.holo_orange_light));
                         
                         // Pause all timers when away
-                        postureTimerManager.pauseTimers();
+                        pauseAllPostureTimers();
                         breakReminderManager.pauseTracking();
                         
                         Toast.makeText(MainActivity.this, "Away mode - Timers paused", Toast.LENGTH_SHORT).show();
@@ -447,24 +478,143 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
         });
     }
 
+    /**
+     * Slouch timer for one tracked person, created on first use
+     */
+    private PostureTimerManager timerForPerson(int personId) {
+        PostureTimerManager timer = postureTimers.get(personId);
+        if (timer != null) {
+            return timer;
+        }
+        timer = new PostureTimerManager(this, personId);
+        timer.setAlertCallback(new PostureTimerManager.AlertCallback() {
+            @Override
+            public void onSlouchAlert(long slouchDurationMs) {
+                runOnUiThread(() -> {
+                    String who = postureTimers.size() > 1 ? "Person " + personId + " has" : "You've";
+                    Toast.makeText(MainActivity.this, 
+                        "Slouch Alert: " + who + " been slouching for " + (slouchDurationMs / 1000) + " seconds", 
+                        Toast.LENGTH_SHORT).show();
+                    
+                    // Show stretch suggestion when slouch alert triggers
+                    if (!hasShownSlouchStretch && stretchSuggestionManager != null) {
+                        stretchSuggestionManager.showChestOpenerStretch();
+                        hasShownSlouchStretch = true;
+                    }
+                });
+            }
+
+            @Override
+            public void onSlouchCorrected(long slouchDurationMs) {
+                runOnUiThread(() -> {
+                    Log.d("MainActivity", "Person " + personId + " corrected posture after "
+                            + (slouchDurationMs / 1000) + " seconds");
+                    hasShownSlouchStretch = false; // Reset so we can show again next time
+                });
+            }
+        });
+        postureTimers.put(personId, timer);
+        return timer;
+    }
+
+    private void pauseAllPostureTimers() {
+        for (PostureTimerManager timer : postureTimers.values()) {
+            timer.pauseTimers();
+        }
+    }
+
+    /**
+     * Drop timers and cached results of people who left the frame
+     */
+    private void releaseExpiredPeople() {
+        for (int personId : personTracker.drainExpired()) {
+            PostureTimerManager timer = postureTimers.remove(personId);
+            if (timer != null) {
+                timer.cleanup();
+            }
+            lastClassificationResults.remove(personId);
+            LandmarkFilter filter = landmarkFilters.remove(personId);
+            if (filter != null) {
+                filter.release();
+            }
+            Log.d("MainActivity", "Person " + personId + " left the frame");
+        }
+    }
+
     @Override
     public void onResults(PoseLandmarkerHelper.ResultBundle resultBundle) {
         PostureClassifier.ClassificationResult classificationResult = null;
         String metricsString = "PDJ / OKS: N/A";
 
-        if (resultBundle.getResults().landmarks().size() > 0) {
+        if (unifiedCameraManager != null) {
+            unifiedCameraManager.getMotionGate().recordInferenceTime(resultBundle.getInferenceTime());
+        }
+        if (modelCascade != null) {
+            // The landmarker has to keep up with the frames the governor admits
+            if (thermalGovernor != null) {
+                modelCascade.setLatencyBudgetMs(thermalGovernor.getMinFrameIntervalMs());
+            }
+            modelCascade.record(PoseModelCascade.qualityScore(resultBundle.getLandmarks()),
+                    resultBundle.getInferenceTime() / 1000.0, android.os.SystemClock.elapsedRealtime());
+        }
+
+        List<List<NormalizedLandmark>> people = resultBundle.getLandmarks();
+        List<float[]> centroids = new ArrayList<>(people.size());
+        for (List<NormalizedLandmark> pose : people) {
+            centroids.add(PersonTracker.centroid(pose));
+        }
+        int[] personIds = personTracker.update(centroids, System.currentTimeMillis());
+        releaseExpiredPeople();
+
+        if (people.size() > 0) {
             // Person detected - notify presence detector
             if (presenceDetector != null) {
                 presenceDetector.onPersonDetected();
-                Log.d("MainActivity", "Person detected - State: " + presenceDetector.getCurrentState());
+                Log.d("MainActivity", people.size() + " person(s) detected - State: " + presenceDetector.getCurrentState());
             }
 
-            // Classify posture using TFLite
-            classificationResult = postureClassifier.classify(
-                    resultBundle.getResults(),
-                    resultBundle.getInputImageWidth(),
-                    resultBundle.getInputImageHeight()
-            );
+            // The longest-tracked person in view drives the status panel
+            int primary = 0;
+            for (int i = 1; i < personIds.length; i++) {
+                if (personIds[i] < personIds[primary]) {
+                    primary = i;
+                }
+            }
+            primaryPersonId = personIds[primary];
+
+            // Smooth each person's landmarks with their own filter before feature extraction
+            long frameTimestampNs = resultBundle.getResults().timestampMs() * 1_000_000L;
+            List<List<NormalizedLandmark>> smoothed = new ArrayList<>(people.size());
+            for (int i = 0; i < people.size(); i++) {
+                LandmarkFilter filter = landmarkFilters.get(personIds[i]);
+                if (filter == null) {
+                    filter = new LandmarkFilter();
+                    landmarkFilters.put(personIds[i], filter);
+                }
+                smoothed.add(filter.filter(people.get(i), frameTimestampNs));
+            }
+
+            // Classify everyone in one batched call (hot tiers reuse the last results on skipped frames)
+            int classifyEvery = thermalGovernor != null ? thermalGovernor.getTier().classifyEvery : 1;
+            boolean newPerson = false;
+            for (int personId : personIds) {
+                newPerson |= !lastClassificationResults.containsKey(personId);
+            }
+            boolean reclassified = newPerson || ++classifyCounter >= classifyEvery;
+            if (reclassified) {
+                classifyCounter = 0;
+                List<PostureClassifier.ClassificationResult> results = postureClassifier.classifyBatch(
+                        smoothed,
+                        resultBundle.getInputImageWidth(),
+                        resultBundle.getInputImageHeight()
+                );
+                for (int i = 0; i < results.size(); i++) {
+                    if (results.get(i) != null) {
+                        lastClassificationResults.put(personIds[i], results.get(i));
+                    }
+                }
+            }
+            classificationResult = lastClassificationResults.get(primaryPersonId);
             
             // Track and upload performance data with throttling
             if (performanceTracker != null && classificationResult != null) {
@@ -483,31 +633,45 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
                 uploadPerformanceData();
             }
 
-            // Handle posture timer based on slouching status
-            if (classificationResult != null && postureTimerManager != null) {
-                String slouchStatus = classificationResult.getSlouchStatus();
-                if ("Slouching".equals(slouchStatus)) {
-                    postureTimerManager.onSlouchingDetected();
-                } else if ("Good Posture".equals(slouchStatus)) {
-                    postureTimerManager.onGoodPostureDetected();
+            boolean active = presenceDetector != null && presenceDetector.isActive();
+            for (int i = 0; i < people.size(); i++) {
+                int personId = personIds[i];
+                PostureClassifier.ClassificationResult result = lastClassificationResults.get(personId);
+                if (result == null) {
+                    continue;
                 }
-            }
 
-            // Calculate evaluation metrics
-            metricsString = EvaluationMetrics.getQualityMetrics(
-                    resultBundle.getResults().landmarks().get(0)
-            );
+                // Handle this person's posture timer based on slouching status
+                byte state = result.getStateCode();
+                if (PostureState.isSlouching(state)) {
+                    timerForPerson(personId).onSlouchingDetected();
+                } else if (PostureState.isGoodPosture(state)) {
+                    timerForPerson(personId).onGoodPostureDetected();
+                }
 
-            // Log data to Firebase only when active
-            if (presenceDetector != null && presenceDetector.isActive()) {
-                firebaseManager.logDataWithMetrics(
-                        classificationResult, 
-                        resultBundle.getResults().landmarks().get(0),
-                        metricsString,
-                        resultBundle.getInferenceTime()
-                );
+                // Calculate evaluation metrics
+                String personMetrics = EvaluationMetrics.getQualityMetrics(people.get(i));
+                if (i == primary) {
+                    metricsString = personMetrics;
+                }
+
+                // Log data to Firebase only when active, and only fresh results
+                // (frames that reused the last result would duplicate it against new landmarks)
+                if (active && reclassified) {
+                    firebaseManager.logDataWithMetrics(
+                            result, 
+                            people.get(i),
+                            personMetrics,
+                            resultBundle.getInferenceTime(),
+                            resultBundle.getInputImageWidth(),
+                            resultBundle.getInputImageHeight(),
+                            personId
+                    );
+                }
             }
         } else {
+            primaryPersonId = 0;
+            
             // No person detected - notify presence detector
             if (presenceDetector != null) {
                 presenceDetector.onNoPersonDetected();
@@ -517,6 +681,8 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
 
         final PostureClassifier.ClassificationResult finalResult = classificationResult;
         final String finalMetrics = metricsString;
+        final int peopleInView = people.size();
+        final PostureTimerManager primaryTimer = postureTimers.get(primaryPersonId);
 
         runOnUiThread(() -> {
             // Convert from microseconds to milliseconds
@@ -538,7 +704,9 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
             // Always update presence status to reflect current state
             if (presenceDetector != null && presenceStatusText != null) {
                 if (presenceDetector.isActive()) {
-                    presenceStatusText.setText("Status: Active");
+                    presenceStatusText.setText(peopleInView > 1
+                            ? String.format("Status: Active (%d people)", peopleInView)
+                            : "Status: Active");
                     presenceStatusText.setTextColor(getColor(android.R.color.holo_green_light));
                 } else {
                     presenceStatusText.setText("Status: Away");
@@ -552,8 +720,8 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
                 leanStatusText.setText(String.format("Lean: %s", finalResult.getLeanStatus()));
                 
                 // Update slouch timer display
-                if (postureTimerManager != null && postureTimerManager.isTrackingSlouch()) {
-                    long slouchSeconds = postureTimerManager.getCurrentSlouchDurationSeconds();
+                if (primaryTimer != null && primaryTimer.isTrackingSlouch()) {
+                    long slouchSeconds = primaryTimer.getCurrentSlouchDurationSeconds();
                     slouchTimerText.setVisibility(View.VISIBLE);
                     slouchTimerText.setText(String.format("Slouching: %ds", slouchSeconds));
                 } else {
@@ -568,13 +736,99 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
 
             // Always update overlay - it will handle empty results
             overlayView.setResults(
-                    resultBundle.getResults(),
+                    resultBundle.getLandmarks(),
+                    personIds,
                     resultBundle.getInputImageHeight(),
                     resultBundle.getInputImageWidth()
             );
         });
     }
 
+    /**
+     * Apply a thermal tier: analysis resolution and forced delegate.
+     * Frame-rate cap and classification skipping are read from the tier per frame.
+     */
+    private void applyThermalTier(ThermalGovernor.Tier tier) {
+        Log.i("MainActivity", "Applying thermal tier " + tier.name());
+        
+        applyAnalysisResolution();
+        
+        if (delegateRadioGroup == null) {
+            return;
+        }
+        if (tier.delegate == DelegateType.CPU) {
+            if (userDelegateRadioId == -1) {
+                userDelegateRadioId = delegateRadioGroup.getCheckedRadioButtonId();
+            }
+            if (delegateRadioGroup.getCheckedRadioButtonId() != R.id.delegate_cpu) {
+                setDelegateRadio(R.id.delegate_cpu);
+            }
+        } else if (userDelegateRadioId != -1) {
+            int restoreId = userDelegateRadioId;
+            userDelegateRadioId = -1;
+            if (delegateRadioGroup.getCheckedRadioButtonId() != restoreId) {
+                setDelegateRadio(restoreId);
+            }
+        }
+    }
+
+    /**
+     * Check a delegate radio button on the app's behalf (thermal tier, failed swap)
+     */
+    private void setDelegateRadio(int radioId) {
+        settingDelegateRadio = true;
+        try {
+            delegateRadioGroup.check(radioId);
+        } finally {
+            settingDelegateRadio = false;
+        }
+    }
+
+    /**
+     * Apply a pose cascade level: landmarker model and analysis resolution
+     */
+    private void applyCascadeLevel(PoseModelCascade.Switch change) {
+        Log.i("MainActivity", "Pose cascade " + change);
+        if (poseLandmarkerHelper != null) {
+            poseLandmarkerHelper.setModelPath(change.to.modelAsset);
+        }
+        applyAnalysisResolution();
+    }
+
+    /**
+     * Analysis resolution is the smaller of the thermal tier's and the pose cascade level's
+     */
+    private void applyAnalysisResolution() {
+        if (unifiedCameraManager == null) {
+            return;
+        }
+        int width = thermalGovernor != null ? thermalGovernor.getTier().inputWidth : 1280;
+        int height = thermalGovernor != null ? thermalGovernor.getTier().inputHeight : 720;
+        if (modelCascade != null) {
+            PoseModelCascade.Level level = modelCascade.getLevel();
+            if (level.inputWidth * level.inputHeight < width * height) {
+                width = level.inputWidth;
+                height = level.inputHeight;
+            }
+        }
+        unifiedCameraManager.setAnalysisResolution(width, height);
+    }
+
+    /**
+     * Names of the bundled assets, used to find which pose models are installed
+     */
+    private List<String> listAssets() {
+        try {
+            String[] assets = getAssets().list("");
+            if (assets != null) {
+                return Arrays.asList(assets);
+            }
+        } catch (IOException e) {
+            Log.w("MainActivity", "Could not list assets", e);
+        }
+        return Collections.singletonList(PoseLandmarkerHelper.DEFAULT_MODEL_PATH);
+    }
+
     @Override
     public void onError(String error) {
         runOnUiThread(() -> Toast.makeText(this, error, Toast.LENGTH_SHORT).show());
@@ -582,50 +836,57 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
 
     @Override
     public void onCheckedChanged(RadioGroup group, int checkedId) {
-        DelegateType newDelegate = null;
-        
-        // TFLite delegates
+        if (!settingDelegateRadio && userDelegateRadioId != -1) {
+            // A thermal tier is forcing CPU: the pick is restored when it lifts
+            userDelegateRadioId = checkedId;
+            if (checkedId != R.id.delegate_cpu) {
+                Toast.makeText(this, "Device is hot - using CPU until it cools down", Toast.LENGTH_SHORT).show();
+                setDelegateRadio(R.id.delegate_cpu);
+                return;
+            }
+        }
+        // Both switches build in the background; frames keep running on the
+        // current models until the new ones are swapped in
         if (checkedId == R.id.delegate_cpu) {
-            newDelegate = DelegateType.CPU;
             poseLandmarkerHelper.setCurrentDelegate(PoseLandmarkerHelper.DELEGATE_CPU);
-            postureClassifier.setDelegate(DelegateType.CPU);
-            Log.d("MainActivity", "TFLite delegate switched to CPU");
+            postureClassifier.setDelegate(DelegateType.CPU, this::onDelegateSwapped);
+            Log.d("MainActivity", "TFLite delegate switching to CPU");
         } else if (checkedId == R.id.delegate_gpu) {
-            newDelegate = DelegateType.GPU;
             Log.d("MainActivity", "User selected TFLite GPU delegate");
-            try {
-                poseLandmarkerHelper.setCurrentDelegate(PoseLandmarkerHelper.DELEGATE_GPU);
-                postureClassifier.setDelegate(DelegateType.GPU);
-                Log.d("MainActivity", "✓ TFLite GPU delegate set successfully");
-            } catch (Exception e) {
-                Log.e("MainActivity", "✗ Failed to switch to TFLite GPU", e);
-                Toast.makeText(this, "GPU failed - Falling back to CPU", Toast.LENGTH_LONG).show();
-                RadioButton cpuButton = findViewById(R.id.delegate_cpu);
-                if (cpuButton != null) {
-                    cpuButton.setChecked(true);
-                }
-                return;
-            }
+            poseLandmarkerHelper.setCurrentDelegate(PoseLandmarkerHelper.DELEGATE_GPU);
+            postureClassifier.setDelegate(DelegateType.GPU, this::onDelegateSwapped);
         } else if (checkedId == R.id.delegate_nnapi) {
-            newDelegate = DelegateType.NNAPI;
-            postureClassifier.setDelegate(DelegateType.NNAPI);
-            Log.d("MainActivity", "TFLite delegate switched to NNAPI");
+            postureClassifier.setDelegate(DelegateType.NNAPI, this::onDelegateSwapped);
+            Log.d("MainActivity", "TFLite delegate switching to NNAPI");
         }
-        
-        if (newDelegate != null) {
-            
+    }
+
+    /**
+     * Posture models finished switching (on the classifier's swap thread)
+     */
+    private void onDelegateSwapped(DelegateType requested, DelegateType active, long loadTime, long warmupTime) {
+        runOnUiThread(() -> {
+            if (active != requested) {
+                Log.e("MainActivity", "✗ Failed to switch to TFLite " + requested + ", running " + active);
+                Toast.makeText(this, requested.getDisplayName() + " failed - using " + active.getDisplayName(),
+                        Toast.LENGTH_LONG).show();
+                int activeId = active == DelegateType.GPU ? R.id.delegate_gpu
+                        : active == DelegateType.NNAPI ? R.id.delegate_nnapi : R.id.delegate_cpu;
+                if (delegateRadioGroup != null && delegateRadioGroup.getCheckedRadioButtonId() != activeId) {
+                    setDelegateRadio(activeId);
+                }
+            } else {
+                Log.d("MainActivity", "✓ TFLite delegate switched to " + active);
+                Toast.makeText(this, "Switched to " + active.getDisplayName(),
+                              Toast.LENGTH_SHORT).show();
+            }
+
             // Start new tracking session with actual load times
             if (performanceTracker != null) {
-                long loadTime = postureClassifier.getLastModelLoadTimeMs();
-                long warmupTime = postureClassifier.getLastWarmupTimeMs();
                 postureClassifier.resetPerformanceMonitors();
-                
-                performanceTracker.startSession(newDelegate, loadTime, warmupTime);
+                performanceTracker.startSession(active, loadTime, warmupTime);
             }
-            
-            Toast.makeText(this, "Switched to " + newDelegate.getDisplayName(), 
-                          Toast.LENGTH_SHORT).show();
-        }
+        });
     }
 
     @Override
@@ -649,6 +910,12 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
             if (breakReminderManager != null && !breakReminderManager.isTracking()) {
                 breakReminderManager.startTracking();
             }
+            if (thermalGovernor != null) {
+                thermalGovernor.start(this);
+            }
+            if (resourceSampler != null) {
+                resourceSampler.start();
+            }
         }
     }
 
@@ -661,12 +928,16 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
         if (poseLandmarkerHelper != null) {
             poseLandmarkerHelper.clearPoseLandmarker();
         }
-        if (postureTimerManager != null) {
-            postureTimerManager.pauseTimers();
-        }
+        pauseAllPostureTimers();
         if (breakReminderManager != null) {
             breakReminderManager.pauseTracking();
         }
+        if (thermalGovernor != null) {
+            thermalGovernor.stop();
+        }
+        if (resourceSampler != null) {
+            resourceSampler.stop();
+        }
     }
 
     @Override
@@ -678,9 +949,14 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
         if (postureClassifier != null) {
             postureClassifier.close();
         }
-        if (postureTimerManager != null) {
-            postureTimerManager.cleanup();
+        for (PostureTimerManager timer : postureTimers.values()) {
+            timer.cleanup();
         }
+        postureTimers.clear();
+        for (LandmarkFilter filter : landmarkFilters.values()) {
+            filter.release();
+        }
+        landmarkFilters.clear();
         if (presenceDetector != null) {
             presenceDetector.cleanup();
         }
@@ -700,14 +976,24 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
             String postureStats = postureClassifier.getPerformanceStats();
             String landmarkerStats = poseLandmarkerHelper.getPerformanceStats();
             
+            String motionStats = unifiedCameraManager != null ?
+                unifiedCameraManager.getMotionGate().getStats() : "N/A";
+            String cascadeStats = modelCascade != null ? modelCascade.getStats() : "N/A";
+            
             String stats = String.format(
                 "=== PERFORMANCE COMPARISON ===\n\n" +
                 "Current Delegate: %s\n\n" +
                 "POSE LANDMARKER:\n%s\n\n" +
-                "POSTURE CLASSIFIERS:\n%s",
+                "POSE CASCADE:\n%s\n\n" +
+                "MOTION GATE:\n%s\n\n" +
+                "POSTURE CLASSIFIERS:\n%s\n\n" +
+                "OVERLAY:\n%s",
                 postureClassifier.getCurrentDelegate().getDisplayName(),
                 landmarkerStats,
-                postureStats
+                cascadeStats,
+                motionStats,
+                postureStats,
+                overlayView.getDrawStats()
             );
             
             Log.d("MainActivity", "Updating performance display");
@@ -734,6 +1020,11 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
         // Set model info before uploading
         performanceTracker.setModelInfo("posture_models_combined", 21504); // 3.4KB + 5.0KB + 13.1KB
         
+        // Let the motion gate cost skipped frames in energy as well as time
+        if (resourceSampler != null && unifiedCameraManager != null) {
+            unifiedCameraManager.getMotionGate().setInferencePowerMw(resourceSampler.getAvgPowerMw());
+        }
+        
         // Upload session data (runs async)
         performanceTracker.uploadSession();
         
@@ -743,6 +1034,19 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
         Log.d("MainActivity", "Auto-uploading performance data to Firebase");
     }
     
+    /**
+     * App build as "versionName (versionCode)", used by latency_regression.py
+     * to compare sessions between builds
+     */
+    private String getAppVersion() {
+        try {
+            android.content.pm.PackageInfo info = getPackageManager().getPackageInfo(getPackageName(), 0);
+            return info.versionName + " (" + info.versionCode + ")";
+        } catch (android.content.pm.PackageManager.NameNotFoundException e) {
+            return "unknown";
+        }
+    }
+    
     /**
      * Upload all detailed performance stats displayed in UI to Firebase
      */
@@ -774,6 +1078,28 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
             String cameraType = unifiedCameraManager != null ? 
                 unifiedCameraManager.getCurrentCameraType().name() : "UNKNOWN";
             detailedStats.put("cameraType", cameraType);
+            if (modelCascade != null) {
+                detailedStats.put("poseCascade", modelCascade.getMetricsMap());
+            }
+            detailedStats.put("landmarkerSwap", poseLandmarkerHelper.getSwapMetrics());
+            if (unifiedCameraManager != null) {
+                detailedStats.put("motionGate", unifiedCameraManager.getMotionGate().getMetricsMap());
+                java.util.Map<String, Object> reconnect = unifiedCameraManager.getUsbReconnectMetrics();
+                if (reconnect != null) {
+                    detailedStats.put("usbReconnect", reconnect);
+                }
+            }
+            
+            // Process resources for the current session
+            if (resourceSampler != null) {
+                ResourceSampler.SessionStats resources = resourceSampler.getSessionStats(System.currentTimeMillis());
+                java.util.Map<String, Object> resourceMap = new java.util.HashMap<>();
+                resourceMap.put("peakMemoryMb", resources.peakMemoryMb);
+                resourceMap.put("avgCpuPercent", Math.round(resources.avgCpuPercent * 10.0) / 10.0);
+                resourceMap.put("avgPowerMw", Math.round(resources.avgPowerMw * 10.0) / 10.0);
+                resourceMap.put("energyMj", Math.round(resources.energyMj * 10.0) / 10.0);
+                detailedStats.put("resources", resourceMap);
+            }
             
             // Raw stats text (as shown in UI)
             detailedStats.put("postureClassifierStats", postureStats);
@@ -792,6 +1118,7 @@ public class MainActivity extends AppCompatActivity implements PoseLandmarkerHel
             detailedStats.put("deviceManufacturer", deviceManufacturer);
             detailedStats.put("deviceId", deviceId);
             detailedStats.put("androidVersion", android.os.Build.VERSION.RELEASE);
+            detailedStats.put("appVersion", getAppVersion());
             
             Log.d("MainActivity", "Uploading to Firebase for device: " + deviceId);
             Log.d("MainActivity", "Individual models data size: " + individualModels.size());
@@ -17,6 +17,7 @@ import com.esw.postureanalyzer.R;
  * - Starts timer when slouching is detected
  * - Sends gentle alert after 2-3 minutes of continuous slouching
  * - Resets timer when posture is corrected
+ * One instance per tracked person; each posts its own notification.
  */
 public class PostureTimerManager {
     private static final String TAG = "PostureTimerManager";
@@ -25,6 +26,7 @@ public class PostureTimerManager {
     private static final int NOTIFICATION_ID = 1001;
 
     private final Context context;
+    private final int personId;
     private final NotificationManager notificationManager;
     private final Handler handler;
     private Runnable slouchAlertRunnable;
@@ -39,7 +41,15 @@ public class PostureTimerManager {
     }
 
     public PostureTimerManager(Context context) {
+        this(context, 0);
+    }
+
+    /**
+     * @param personId PersonTracker ID, or 0 for the single-person case
+     */
+    public PostureTimerManager(Context context, int personId) {
         this.context = context;
+        this.personId = personId;
         this.handler = new Handler(Looper.getMainLooper());
         this.notificationManager = (NotificationManager) context.getSystemService(Context.NOTIFICATION_SERVICE);
         
@@ -117,12 +127,12 @@ public class PostureTimerManager {
      * Send a gentle notification and play a soft chime
      */
     private void sendGentleAlert() {
-        Log.d(TAG, "Sending gentle slouch alert");
+        Log.d(TAG, "Sending gentle slouch alert for person " + personId);
         
         // Create notification with soft appearance
         NotificationCompat.Builder builder = new NotificationCompat.Builder(context, CHANNEL_ID)
                 .setSmallIcon(android.R.drawable.ic_dialog_info)
-                .setContentTitle("Posture Reminder 🧘")
+                .setContentTitle(personId > 0 ? "Posture Reminder 🧘 (Person " + personId + ")" : "Posture Reminder 🧘")
                 .setContentText("You've been slouching for a while. Time to sit up straight!")
                 .setPriority(NotificationCompat.PRIORITY_DEFAULT)
                 .setAutoCancel(true)
@@ -132,7 +142,7 @@ public class PostureTimerManager {
         Uri defaultSoundUri = RingtoneManager.getDefaultUri(RingtoneManager.TYPE_NOTIFICATION);
         builder.setSound(defaultSoundUri);
         
-        notificationManager.notify(NOTIFICATION_ID, builder.build());
+        notificationManager.notify(NOTIFICATION_ID + personId, builder.build());
     }
 
     /**
@@ -160,6 +170,10 @@ public class PostureTimerManager {
         return isSlouchTimerRunning;
     }
 
+    public int getPersonId() {
+        return personId;
+    }
+
     /**
      * Cleanup resources
      */
@@ -1,6 +1,7 @@
 package com.esw.postureanalyzer.performance;
 
 import java.util.HashMap;
+import java.util.List;
 import java.util.Map;
 
 /**
@@ -38,11 +39,21 @@ public class PerformanceMetrics {
     public String modelName;
     public long modelSizeBytes;
     
-    // Memory Usage (optional - can be added later)
+    // Memory Usage (peak RSS, from ResourceSampler)
     public long peakMemoryMb;
     
-    // Power Consumption (optional - can be added later)
+    // Power Consumption (battery current x voltage, from ResourceSampler)
     public double avgPowerMw;
+    public double energyPerInferenceMj;
+    
+    // CPU usage (from ResourceSampler)
+    public double avgCpuPercent;
+    public Map<String, Long> threadCpuMs; // CPU time per thread name over the session
+    
+    // Thermal state (from ThermalGovernor)
+    public String thermalTier;
+    public double maxTempC;
+    public List<Map<String, Object>> tierTransitions;
     
     // Timestamp
     public long timestamp;
@@ -87,6 +98,12 @@ public class PerformanceMetrics {
         // Optional metrics
         if (peakMemoryMb > 0) map.put("peakMemoryMb", peakMemoryMb);
         if (avgPowerMw > 0) map.put("avgPowerMw", avgPowerMw);
+        if (energyPerInferenceMj > 0) map.put("energyPerInferenceMj", energyPerInferenceMj);
+        if (avgCpuPercent > 0) map.put("avgCpuPercent", avgCpuPercent);
+        if (threadCpuMs != null && !threadCpuMs.isEmpty()) map.put("threadCpuMs", threadCpuMs);
+        if (thermalTier != null) map.put("thermalTier", thermalTier);
+        if (maxTempC > 0) map.put("maxTempC", maxTempC);
+        if (tierTransitions != null && !tierTransitions.isEmpty()) map.put("tierTransitions", tierTransitions);
         
         // Timestamp
         map.put("timestamp", timestamp);
@@ -12,6 +12,7 @@ import com.google.firebase.database.FirebaseDatabase;
 import java.util.ArrayList;
 import java.util.Collections;
 import java.util.List;
+import java.util.Map;
 import java.util.UUID;
 
 /**
@@ -42,6 +43,11 @@ public class PerformanceTracker {
     private String currentModelName;
     private long currentModelSize;
     
+    // Thermal state and process resources
+    private ThermalGovernor thermalGovernor;
+    private ResourceSampler resourceSampler;
+    private final List<Map<String, Object>> tierTransitions = new ArrayList<>();
+    
     public PerformanceTracker(Context context) {
         this.context = context;
         // Use regional database instance with correct reference
@@ -64,6 +70,13 @@ public class PerformanceTracker {
         // Clear previous data
         inferenceTimes.clear();
         fpsValues.clear();
+        tierTransitions.clear();
+        if (thermalGovernor != null) {
+            thermalGovernor.resetMaxTempC();
+        }
+        if (resourceSampler != null) {
+            resourceSampler.beginSession(sessionStartTime);
+        }
         
         Log.d(TAG, "Started new session for " + delegate.getDisplayName() + " (ID: " + sessionId + ")");
     }
@@ -82,6 +95,20 @@ public class PerformanceTracker {
         fpsValues.add(fps);
     }
     
+    /**
+     * Attach the thermal governor whose tier and transitions are uploaded with each session
+     */
+    public void setThermalGovernor(ThermalGovernor governor) {
+        this.thermalGovernor = governor;
+    }
+    
+    /**
+     * Attach the resource sampler whose per-session peaks and energy are uploaded with each session
+     */
+    public void setResourceSampler(ResourceSampler sampler) {
+        this.resourceSampler = sampler;
+    }
+    
     /**
      * Set current model information
      */
@@ -146,6 +173,27 @@ public class PerformanceTracker {
         metrics.modelName = currentModelName != null ? currentModelName : "posture_models";
         metrics.modelSizeBytes = currentModelSize;
         
+        // Memory, CPU and energy
+        if (resourceSampler != null) {
+            ResourceSampler.SessionStats resources = resourceSampler.getSessionStats(System.currentTimeMillis());
+            metrics.peakMemoryMb = resources.peakMemoryMb;
+            metrics.avgPowerMw = Math.round(resources.avgPowerMw * 10.0) / 10.0;
+            metrics.energyPerInferenceMj = Math.round(resources.energyPerInferenceMj(metrics.totalInferences) * 100.0) / 100.0;
+            metrics.avgCpuPercent = Math.round(resources.avgCpuPercent * 10.0) / 10.0;
+            metrics.threadCpuMs = resources.threadCpuMs;
+        }
+        
+        // Thermal state
+        if (thermalGovernor != null) {
+            for (ThermalGovernor.Transition transition : thermalGovernor.drainTransitions()) {
+                tierTransitions.add(transition.toMap());
+            }
+            metrics.thermalTier = thermalGovernor.getTier().name();
+            float maxTemp = thermalGovernor.getMaxTempC();
+            metrics.maxTempC = Float.isNaN(maxTemp) ? 0 : Math.round(maxTemp * 10.0) / 10.0;
+            metrics.tierTransitions = new ArrayList<>(tierTransitions);
+        }
+        
         // Timestamp
         metrics.timestamp = System.currentTimeMillis();
         metrics.sessionId = sessionId;
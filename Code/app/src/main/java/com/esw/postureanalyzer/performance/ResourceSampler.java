@@ -0,0 +1,320 @@
+package com.esw.postureanalyzer.performance;
+
+import java.io.BufferedReader;
+import java.io.File;
+import java.io.FileReader;
+import java.io.IOException;
+import java.util.HashMap;
+import java.util.Map;
+import java.util.concurrent.Executors;
+import java.util.concurrent.ScheduledExecutorService;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * Low-overhead process resource sampler.
+ *
+ * Every SAMPLE_INTERVAL_MS it reads resident memory from statm, process and
+ * per-thread CPU ticks from stat / task/N/stat, and battery current/voltage
+ * from the power_supply class (only while not charging). Per session it
+ * keeps peak RSS, average CPU and average power, and integrates energy so
+ * PerformanceTracker can report energy per inference.
+ *
+ * All paths are constructor arguments so the sampler runs against a fake
+ * procfs/sysfs tree on a host.
+ */
+public class ResourceSampler {
+    public static final String DEFAULT_PROC_SELF = "/proc/self";
+    public static final String DEFAULT_POWER_SUPPLY = "/sys/class/power_supply";
+    public static final long SAMPLE_INTERVAL_MS = 1000;
+    public static final int DEFAULT_PAGE_SIZE = 4096;
+    public static final int DEFAULT_CLOCK_TICKS = 100; // USER_HZ on Android/Linux
+
+    private final File procSelf;
+    private final File powerSupplyRoot;
+    private final int pageSize;
+    private final int clockTicksPerSecond;
+
+    private File batteryDir; // Resolved lazily, may stay null (no battery)
+    private boolean batteryResolved = false;
+
+    // Session accumulators
+    private long sessionStartMs;
+    private long lastSampleMs;
+    private long lastCpuTicks = -1;
+    private final Map<String, Long> threadStartTicks = new HashMap<>();
+    private final Map<String, Long> threadTicks = new HashMap<>();
+    private long peakRssBytes;
+    private long lastRssBytes;
+    private double cpuPercentSum;
+    private int cpuSamples;
+    private double powerMwSum;
+    private int powerSamples;
+    private double energyMj;
+
+    private ScheduledExecutorService executor;
+
+    public ResourceSampler() {
+        this(new File(DEFAULT_PROC_SELF), new File(DEFAULT_POWER_SUPPLY), DEFAULT_PAGE_SIZE, DEFAULT_CLOCK_TICKS);
+    }
+
+    public ResourceSampler(File procSelf, File powerSupplyRoot, int pageSize, int clockTicksPerSecond) {
+        this.procSelf = procSelf;
+        this.powerSupplyRoot = powerSupplyRoot;
+        this.pageSize = pageSize;
+        this.clockTicksPerSecond = clockTicksPerSecond;
+    }
+
+    /**
+     * Per-session summary
+     */
+    public static class SessionStats {
+        public long durationMs;
+        public long peakMemoryMb;
+        public double avgCpuPercent;
+        public double avgPowerMw;     // 0 if no battery readings
+        public double energyMj;       // Integrated over the session
+        public Map<String, Long> threadCpuMs = new HashMap<>(); // By thread name
+
+        public double energyPerInferenceMj(int inferences) {
+            return inferences > 0 ? energyMj / inferences : 0;
+        }
+    }
+
+    /**
+     * Start periodic sampling on a background daemon thread
+     */
+    public synchronized void start() {
+        if (executor != null) {
+            return;
+        }
+        executor = Executors.newSingleThreadScheduledExecutor(r -> {
+            Thread t = new Thread(r, "ResourceSampler");
+            t.setDaemon(true);
+            t.setPriority(Thread.MIN_PRIORITY);
+            return t;
+        });
+        executor.scheduleAtFixedRate(() -> sample(System.currentTimeMillis()),
+                0, SAMPLE_INTERVAL_MS, TimeUnit.MILLISECONDS);
+    }
+
+    public synchronized void stop() {
+        if (executor != null) {
+            executor.shutdownNow();
+            executor = null;
+        }
+    }
+
+    /**
+     * Reset the per-session accumulators
+     */
+    public synchronized void beginSession(long nowMs) {
+        sessionStartMs = nowMs;
+        lastSampleMs = nowMs;
+        peakRssBytes = 0;
+        cpuPercentSum = 0;
+        cpuSamples = 0;
+        powerMwSum = 0;
+        powerSamples = 0;
+        energyMj = 0;
+        lastCpuTicks = readProcessCpuTicks();
+        threadStartTicks.clear();
+        threadTicks.clear();
+        readThreadTicks(threadStartTicks);
+    }
+
+    /**
+     * Take one sample (called by the sampler thread, or directly in tests)
+     */
+    public synchronized void sample(long nowMs) {
+        if (sessionStartMs == 0) {
+            beginSession(nowMs);
+            return;
+        }
+        long elapsedMs = nowMs - lastSampleMs;
+        lastSampleMs = nowMs;
+
+        long rss = readRssBytes();
+        if (rss > 0) {
+            lastRssBytes = rss;
+            peakRssBytes = Math.max(peakRssBytes, rss);
+        }
+
+        long cpuTicks = readProcessCpuTicks();
+        if (cpuTicks >= 0 && lastCpuTicks >= 0 && elapsedMs > 0) {
+            double cpuMs = (cpuTicks - lastCpuTicks) * 1000.0 / clockTicksPerSecond;
+            cpuPercentSum += 100.0 * cpuMs / elapsedMs;
+            cpuSamples++;
+        }
+        lastCpuTicks = cpuTicks;
+
+        readThreadTicks(threadTicks);
+
+        double powerMw = readBatteryPowerMw();
+        if (powerMw > 0) {
+            powerMwSum += powerMw;
+            powerSamples++;
+            if (elapsedMs > 0) {
+                energyMj += powerMw * elapsedMs / 1000.0; // mW * s = mJ
+            }
+        }
+    }
+
+    /**
+     * Snapshot of the current session
+     */
+    public synchronized SessionStats getSessionStats(long nowMs) {
+        SessionStats stats = new SessionStats();
+        stats.durationMs = sessionStartMs > 0 ? nowMs - sessionStartMs : 0;
+        stats.peakMemoryMb = peakRssBytes / (1024 * 1024);
+        stats.avgCpuPercent = cpuSamples > 0 ? cpuPercentSum / cpuSamples : 0;
+        stats.avgPowerMw = powerSamples > 0 ? powerMwSum / powerSamples : 0;
+        stats.energyMj = energyMj;
+        for (Map.Entry<String, Long> entry : threadTicks.entrySet()) {
+            Long start = threadStartTicks.get(entry.getKey());
+            long ticks = entry.getValue() - (start != null ? start : 0);
+            if (ticks <= 0) {
+                continue;
+            }
+            String name = entry.getKey().substring(entry.getKey().indexOf(':') + 1);
+            long ms = ticks * 1000L / clockTicksPerSecond;
+            Long existing = stats.threadCpuMs.get(name);
+            stats.threadCpuMs.put(name, existing != null ? existing + ms : ms);
+        }
+        return stats;
+    }
+
+    public synchronized long getCurrentMemoryMb() {
+        return lastRssBytes / (1024 * 1024);
+    }
+
+    public synchronized double getAvgPowerMw() {
+        return powerSamples > 0 ? powerMwSum / powerSamples : 0;
+    }
+
+    // --- readers ---
+
+    private long readRssBytes() {
+        String line = readFirstLine(new File(procSelf, "statm"));
+        if (line == null) {
+            return -1;
+        }
+        String[] fields = line.trim().split("\\s+");
+        if (fields.length < 2) {
+            return -1;
+        }
+        try {
+            return Long.parseLong(fields[1]) * pageSize;
+        } catch (NumberFormatException e) {
+            return -1;
+        }
+    }
+
+    private long readProcessCpuTicks() {
+        return parseStatCpuTicks(readFirstLine(new File(procSelf, "stat")));
+    }
+
+    /**
+     * Per-thread ticks keyed by "tid:name" so a reused name never merges two threads' deltas
+     */
+    private void readThreadTicks(Map<String, Long> out) {
+        File[] tasks = new File(procSelf, "task").listFiles();
+        if (tasks == null) {
+            return;
+        }
+        for (File task : tasks) {
+            String line = readFirstLine(new File(task, "stat"));
+            long ticks = parseStatCpuTicks(line);
+            if (ticks < 0) {
+                continue;
+            }
+            out.put(task.getName() + ":" + parseStatName(line), ticks);
+        }
+    }
+
+    /**
+     * utime + stime from a stat line (fields 14 and 15, counted after the "(comm)" field)
+     */
+    static long parseStatCpuTicks(String line) {
+        if (line == null) {
+            return -1;
+        }
+        int close = line.lastIndexOf(')');
+        if (close < 0) {
+            return -1;
+        }
+        String[] fields = line.substring(close + 1).trim().split("\\s+");
+        // fields[0] is state (field 3), so utime (14) is fields[11] and stime (15) fields[12]
+        if (fields.length < 13) {
+            return -1;
+        }
+        try {
+            return Long.parseLong(fields[11]) + Long.parseLong(fields[12]);
+        } catch (NumberFormatException e) {
+            return -1;
+        }
+    }
+
+    static String parseStatName(String line) {
+        int open = line.indexOf('(');
+        int close = line.lastIndexOf(')');
+        return open >= 0 && close > open ? line.substring(open + 1, close) : "?";
+    }
+
+    /**
+     * Instantaneous battery power in mW, or 0 if unavailable. While the
+     * battery is charging or full current_now is the charge current, not
+     * what the device draws, so power is unavailable then.
+     */
+    private double readBatteryPowerMw() {
+        File battery = resolveBattery();
+        if (battery == null) {
+            return 0;
+        }
+        String status = readFirstLine(new File(battery, "status"));
+        if (status != null && (status.trim().equalsIgnoreCase("Charging")
+                || status.trim().equalsIgnoreCase("Full"))) {
+            return 0;
+        }
+        String current = readFirstLine(new File(battery, "current_now"));
+        String voltage = readFirstLine(new File(battery, "voltage_now"));
+        if (current == null || voltage == null) {
+            return 0;
+        }
+        try {
+            // µA * µV = pW; sign convention for discharge differs between vendors
+            double microAmps = Math.abs(Double.parseDouble(current.trim()));
+            double microVolts = Double.parseDouble(voltage.trim());
+            return microAmps * microVolts / 1e9;
+        } catch (NumberFormatException e) {
+            return 0;
+        }
+    }
+
+    private File resolveBattery() {
+        if (batteryResolved) {
+            return batteryDir;
+        }
+        batteryResolved = true;
+        File[] supplies = powerSupplyRoot.listFiles();
+        if (supplies == null) {
+            return null;
+        }
+        for (File supply : supplies) {
+            String type = readFirstLine(new File(supply, "type"));
+            if ("Battery".equalsIgnoreCase(type != null ? type.trim() : null)
+                    && new File(supply, "current_now").exists()) {
+                batteryDir = supply;
+                break;
+            }
+        }
+        return batteryDir;
+    }
+
+    private static String readFirstLine(File file) {
+        try (BufferedReader reader = new BufferedReader(new FileReader(file))) {
+            return reader.readLine();
+        } catch (IOException e) {
+            return null;
+        }
+    }
+}
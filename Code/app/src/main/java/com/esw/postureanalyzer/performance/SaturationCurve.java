@@ -0,0 +1,164 @@
+package com.esw.postureanalyzer.performance;
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+import java.util.Locale;
+
+/**
+ * Throughput and latency of the frame pipeline as offered load increases.
+ *
+ * Each point is one load step: frames offered by the source (from stamped
+ * sequence numbers), frames captured by the reader, frames that made it
+ * through classification, and capture-to-classification latency. The
+ * pipeline is saturated once processed/offered falls below KNEE_RATIO.
+ */
+public class SaturationCurve {
+    public static final double KNEE_RATIO = 0.9;
+
+    public static class Point {
+        public final int offeredFps;
+        public final double capturedFps;
+        public final double processedFps;
+        public final double lossPercent;     // offered frames that never reached classification
+        public final double p50LatencyMs;
+        public final double p95LatencyMs;
+        public final double p99LatencyMs;
+        public final double decodeMs;        // means per processed frame
+        public final double poseMs;
+        public final double classifyMs;
+
+        Point(int offeredFps, double capturedFps, double processedFps, double lossPercent,
+              double p50LatencyMs, double p95LatencyMs, double p99LatencyMs,
+              double decodeMs, double poseMs, double classifyMs) {
+            this.offeredFps = offeredFps;
+            this.capturedFps = capturedFps;
+            this.processedFps = processedFps;
+            this.lossPercent = lossPercent;
+            this.p50LatencyMs = p50LatencyMs;
+            this.p95LatencyMs = p95LatencyMs;
+            this.p99LatencyMs = p99LatencyMs;
+            this.decodeMs = decodeMs;
+            this.poseMs = poseMs;
+            this.classifyMs = classifyMs;
+        }
+
+        public boolean isSaturated() {
+            return processedFps < offeredFps * KNEE_RATIO;
+        }
+    }
+
+    /**
+     * Collects one load step. Capture and results may arrive on different threads.
+     */
+    public static class Step {
+        private final int offeredFps;
+        private long firstSequence = -1;
+        private long lastSequence = -1;
+        private int captured;
+        private final List<Long> latenciesNs = new ArrayList<>();
+        private long decodeNs;
+        private long poseNs;
+        private long classifyNs;
+
+        Step(int offeredFps) {
+            this.offeredFps = offeredFps;
+        }
+
+        public synchronized void onCaptured(long sequence) {
+            if (firstSequence < 0) {
+                firstSequence = sequence;
+            }
+            lastSequence = Math.max(lastSequence, sequence);
+            captured++;
+        }
+
+        public synchronized void onProcessed(long latencyNs, long decodeNs, long poseNs, long classifyNs) {
+            latenciesNs.add(latencyNs);
+            this.decodeNs += decodeNs;
+            this.poseNs += poseNs;
+            this.classifyNs += classifyNs;
+        }
+
+        /**
+         * Summarize the step over its wall-clock duration
+         */
+        public synchronized Point finish(long durationNs) {
+            double seconds = durationNs / 1e9;
+            int processed = latenciesNs.size();
+            long offered = firstSequence < 0 ? 0 : lastSequence - firstSequence + 1;
+
+            List<Long> sorted = new ArrayList<>(latenciesNs);
+            Collections.sort(sorted);
+            double perFrame = processed > 0 ? 1e6 * processed : 1;
+
+            return new Point(offeredFps,
+                    seconds > 0 ? captured / seconds : 0,
+                    seconds > 0 ? processed / seconds : 0,
+                    offered > 0 ? 100.0 * (offered - Math.min(processed, offered)) / offered : 0,
+                    percentile(sorted, 50) / 1e6,
+                    percentile(sorted, 95) / 1e6,
+                    percentile(sorted, 99) / 1e6,
+                    decodeNs / perFrame,
+                    poseNs / perFrame,
+                    classifyNs / perFrame);
+        }
+    }
+
+    private final List<Point> points = new ArrayList<>();
+
+    public Step beginStep(int offeredFps) {
+        return new Step(offeredFps);
+    }
+
+    public void add(Point point) {
+        points.add(point);
+    }
+
+    public List<Point> getPoints() {
+        return Collections.unmodifiableList(points);
+    }
+
+    /**
+     * Highest offered rate the pipeline kept up with, or -1 if it saturated at every step
+     */
+    public int getSustainedFps() {
+        int sustained = -1;
+        for (Point point : points) {
+            if (!point.isSaturated()) {
+                sustained = Math.max(sustained, point.offeredFps);
+            }
+        }
+        return sustained;
+    }
+
+    /**
+     * Highest processed rate seen at any step
+     */
+    public double getPeakProcessedFps() {
+        double peak = 0;
+        for (Point point : points) {
+            peak = Math.max(peak, point.processedFps);
+        }
+        return peak;
+    }
+
+    public String toCsv() {
+        StringBuilder sb = new StringBuilder(
+                "offered_fps,captured_fps,processed_fps,loss_pct,p50_ms,p95_ms,p99_ms,decode_ms,pose_ms,classify_ms\n");
+        for (Point p : points) {
+            sb.append(String.format(Locale.US, "%d,%.1f,%.1f,%.1f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f%n",
+                    p.offeredFps, p.capturedFps, p.processedFps, p.lossPercent,
+                    p.p50LatencyMs, p.p95LatencyMs, p.p99LatencyMs, p.decodeMs, p.poseMs, p.classifyMs));
+        }
+        return sb.toString();
+    }
+
+    private static long percentile(List<Long> sorted, int percentile) {
+        if (sorted.isEmpty()) {
+            return 0;
+        }
+        int index = (int) Math.ceil(percentile / 100.0 * sorted.size()) - 1;
+        return sorted.get(Math.max(0, Math.min(index, sorted.size() - 1)));
+    }
+}
@@ -0,0 +1,345 @@
+package com.esw.postureanalyzer.performance;
+
+import android.content.Context;
+import android.os.Build;
+import android.os.Handler;
+import android.os.HandlerThread;
+import android.os.PowerManager;
+import android.os.SystemClock;
+import android.util.Log;
+
+import com.esw.postureanalyzer.vision.DelegateType;
+
+import java.io.BufferedReader;
+import java.io.File;
+import java.io.FileReader;
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * Steps the pipeline down through predefined load tiers as the device heats up.
+ *
+ * Inputs are the hottest zone under /sys/class/thermal and the Android thermal
+ * status (API 29+). The tier rises immediately to whatever the inputs call for
+ * and falls back one tier at a time, only after the inputs have cooled below
+ * the tier's entry point by HYSTERESIS_C and the tier has been held for
+ * MIN_DWELL_MS. Thresholds sit below typical SoC throttling points so the
+ * pipeline sheds load before the kernel does.
+ *
+ * The sampling logic only touches the filesystem root it is given, so it can
+ * be exercised on a host against a fake sysfs tree.
+ */
+public class ThermalGovernor {
+    private static final String TAG = "ThermalGovernor";
+
+    public static final String DEFAULT_THERMAL_ROOT = "/sys/class/thermal";
+    public static final long SAMPLE_INTERVAL_MS = 5000;
+    public static final long MIN_DWELL_MS = 30000;
+    public static final float HYSTERESIS_C = 3f;
+
+    // Android PowerManager.THERMAL_STATUS_* values (kept here so the core has no SDK dependency)
+    public static final int STATUS_UNKNOWN = -1;
+    public static final int STATUS_NONE = 0;
+    public static final int STATUS_LIGHT = 1;
+    public static final int STATUS_MODERATE = 2;
+    public static final int STATUS_SEVERE = 3;
+
+    /**
+     * Load tiers, mildest first
+     */
+    public enum Tier {
+        //          temp C  status            fps  width height delegate         classifyEvery
+        NOMINAL(    0f,     STATUS_NONE,      30,  1280, 720,   null,            1),
+        WARM(       65f,    STATUS_LIGHT,     20,  1280, 720,   null,            1),
+        HOT(        75f,    STATUS_MODERATE,  15,  640,  480,   null,            2),
+        CRITICAL(   85f,    STATUS_SEVERE,    8,   640,  480,   DelegateType.CPU, 4);
+
+        public final float enterTempC;
+        public final int enterStatus;
+        public final int maxFps;
+        public final int inputWidth;
+        public final int inputHeight;
+        public final DelegateType delegate; // null = keep the user's choice
+        public final int classifyEvery;     // run posture models on every Nth pose result
+
+        Tier(float enterTempC, int enterStatus, int maxFps, int inputWidth, int inputHeight,
+             DelegateType delegate, int classifyEvery) {
+            this.enterTempC = enterTempC;
+            this.enterStatus = enterStatus;
+            this.maxFps = maxFps;
+            this.inputWidth = inputWidth;
+            this.inputHeight = inputHeight;
+            this.delegate = delegate;
+            this.classifyEvery = classifyEvery;
+        }
+
+        public long minFrameIntervalMs() {
+            return 1000L / maxFps;
+        }
+    }
+
+    /**
+     * A recorded tier change
+     */
+    public static class Transition {
+        public final long timestamp;
+        public final Tier from;
+        public final Tier to;
+        public final float tempC;
+        public final int thermalStatus;
+
+        Transition(long timestamp, Tier from, Tier to, float tempC, int thermalStatus) {
+            this.timestamp = timestamp;
+            this.from = from;
+            this.to = to;
+            this.tempC = tempC;
+            this.thermalStatus = thermalStatus;
+        }
+
+        public Map<String, Object> toMap() {
+            Map<String, Object> map = new HashMap<>();
+            map.put("timestamp", timestamp);
+            map.put("from", from.name());
+            map.put("to", to.name());
+            map.put("tempC", Math.round(tempC * 10.0) / 10.0);
+            map.put("thermalStatus", thermalStatus);
+            return map;
+        }
+    }
+
+    public interface TierListener {
+        void onTierChanged(Transition transition);
+    }
+
+    private final File thermalRoot;
+    private Tier tier = Tier.NOMINAL;
+    private long tierSinceMs = 0;
+    private float lastTempC = Float.NaN;
+    private float maxTempC = Float.NaN;
+    private int lastStatus = STATUS_UNKNOWN;
+    private long lastFrameMs = 0;
+    private int poseFpsLimit = 0; // 0 = tier cap only
+    private final List<Transition> transitions = new ArrayList<>();
+    private TierListener listener;
+
+    // Android sampling thread
+    private HandlerThread samplerThread;
+    private Handler samplerHandler;
+    private PowerManager powerManager;
+
+    public ThermalGovernor() {
+        this(new File(DEFAULT_THERMAL_ROOT));
+    }
+
+    public ThermalGovernor(File thermalRoot) {
+        this.thermalRoot = thermalRoot;
+    }
+
+    public void setTierListener(TierListener listener) {
+        this.listener = listener;
+    }
+
+    /**
+     * Hottest thermal zone in °C, or NaN if none can be read
+     */
+    public float readMaxZoneTempC() {
+        File[] zones = thermalRoot.listFiles((dir, name) -> name.startsWith("thermal_zone"));
+        if (zones == null) {
+            return Float.NaN;
+        }
+
+        float max = Float.NaN;
+        for (File zone : zones) {
+            String raw = readFirstLine(new File(zone, "temp"));
+            if (raw == null) {
+                continue;
+            }
+            try {
+                long value = Long.parseLong(raw.trim());
+                // Most kernels report millidegrees, a few report degrees
+                float tempC = value > 1000 || value < -1000 ? value / 1000f : value;
+                // Disabled or broken sensors report nonsense; ignore them
+                if (tempC <= 0f || tempC >= 150f) {
+                    continue;
+                }
+                if (Float.isNaN(max) || tempC > max) {
+                    max = tempC;
+                }
+            } catch (NumberFormatException e) {
+                // Unreadable zone, skip
+            }
+        }
+        return max;
+    }
+
+    /**
+     * Take one sample and move between tiers if needed.
+     *
+     * @param thermalStatus Android thermal status, or STATUS_UNKNOWN
+     * @param nowMs         monotonic time in milliseconds
+     * @return the tier in effect after this sample
+     */
+    public synchronized Tier sample(int thermalStatus, long nowMs) {
+        float tempC = readMaxZoneTempC();
+        lastTempC = tempC;
+        lastStatus = thermalStatus;
+        if (!Float.isNaN(tempC) && (Float.isNaN(maxTempC) || tempC > maxTempC)) {
+            maxTempC = tempC;
+        }
+
+        Tier target = targetTier(tempC, thermalStatus, 0f);
+        if (target.ordinal() > tier.ordinal()) {
+            // Heating: jump straight to the required tier
+            changeTier(target, tempC, thermalStatus, nowMs);
+        } else if (tier != Tier.NOMINAL && nowMs - tierSinceMs >= MIN_DWELL_MS
+                && targetTier(tempC, thermalStatus, HYSTERESIS_C).ordinal() < tier.ordinal()) {
+            // Cooling: step back one tier at a time
+            changeTier(Tier.values()[tier.ordinal() - 1], tempC, thermalStatus, nowMs);
+        }
+        return tier;
+    }
+
+    /**
+     * Highest tier whose entry conditions hold, with temperatures lowered by margin
+     */
+    private static Tier targetTier(float tempC, int thermalStatus, float marginC) {
+        Tier[] tiers = Tier.values();
+        for (int i = tiers.length - 1; i > 0; i--) {
+            Tier t = tiers[i];
+            boolean byTemp = !Float.isNaN(tempC) && tempC >= t.enterTempC - marginC;
+            // The framework already debounces the status, so it gets no extra margin
+            boolean byStatus = thermalStatus >= t.enterStatus;
+            if (byTemp || byStatus) {
+                return t;
+            }
+        }
+        return Tier.NOMINAL;
+    }
+
+    private void changeTier(Tier to, float tempC, int thermalStatus, long nowMs) {
+        Transition transition = new Transition(System.currentTimeMillis(), tier, to, tempC, thermalStatus);
+        transitions.add(transition);
+        tier = to;
+        tierSinceMs = nowMs;
+        if (listener != null) {
+            listener.onTierChanged(transition);
+        }
+    }
+
+    /**
+     * Cap the pose rate below the tier's, e.g. when landmark smoothing makes
+     * full-rate detection unnecessary. 0 removes the limit.
+     */
+    public synchronized void setPoseFpsLimit(int fps) {
+        poseFpsLimit = Math.max(0, fps);
+    }
+
+    public synchronized long getMinFrameIntervalMs() {
+        long interval = tier.minFrameIntervalMs();
+        return poseFpsLimit > 0 ? Math.max(interval, 1000L / poseFpsLimit) : interval;
+    }
+
+    /**
+     * Frame-rate cap for the current tier (and pose limit); returns false for frames that arrive too early
+     */
+    public synchronized boolean admitFrame(long nowMs) {
+        if (nowMs - lastFrameMs < getMinFrameIntervalMs()) {
+            return false;
+        }
+        lastFrameMs = nowMs;
+        return true;
+    }
+
+    public synchronized Tier getTier() {
+        return tier;
+    }
+
+    public synchronized float getLastTempC() {
+        return lastTempC;
+    }
+
+    public synchronized float getMaxTempC() {
+        return maxTempC;
+    }
+
+    /**
+     * Start a new peak window (e.g. per performance session)
+     */
+    public synchronized void resetMaxTempC() {
+        maxTempC = lastTempC;
+    }
+
+    public synchronized int getLastThermalStatus() {
+        return lastStatus;
+    }
+
+    /**
+     * Transitions recorded since the last call
+     */
+    public synchronized List<Transition> drainTransitions() {
+        List<Transition> drained = new ArrayList<>(transitions);
+        transitions.clear();
+        return drained;
+    }
+
+    /**
+     * Start periodic sampling on a background thread
+     */
+    public void start(Context context) {
+        if (samplerThread != null) {
+            return;
+        }
+        powerManager = (PowerManager) context.getSystemService(Context.POWER_SERVICE);
+        samplerThread = new HandlerThread("ThermalGovernor");
+        samplerThread.start();
+        samplerHandler = new Handler(samplerThread.getLooper());
+        samplerHandler.post(sampleRunnable);
+        Log.d(TAG, "Thermal sampling started (" + thermalRoot + ")");
+    }
+
+    public void stop() {
+        if (samplerThread == null) {
+            return;
+        }
+        samplerHandler.removeCallbacks(sampleRunnable);
+        samplerThread.quitSafely();
+        samplerThread = null;
+        samplerHandler = null;
+        Log.d(TAG, "Thermal sampling stopped");
+    }
+
+    private final Runnable sampleRunnable = new Runnable() {
+        @Override
+        public void run() {
+            try {
+                int status = STATUS_UNKNOWN;
+                if (powerManager != null && Build.VERSION.SDK_INT >= Build.VERSION_CODES.Q) {
+                    status = powerManager.getCurrentThermalStatus();
+                }
+                Tier before = getTier();
+                Tier after = sample(status, SystemClock.elapsedRealtime());
+                if (before != after) {
+                    Log.i(TAG, String.format("Tier %s -> %s (%.1f°C, status %d)",
+                            before, after, getLastTempC(), status));
+                }
+            } catch (Exception e) {
+                Log.e(TAG, "Thermal sampling failed", e);
+            }
+            Handler handler = samplerHandler;
+            if (handler != null) {
+                handler.postDelayed(this, SAMPLE_INTERVAL_MS);
+            }
+        }
+    };
+
+    private static String readFirstLine(File file) {
+        try (BufferedReader reader = new BufferedReader(new FileReader(file))) {
+            return reader.readLine();
+        } catch (IOException e) {
+            return null;
+        }
+    }
+}
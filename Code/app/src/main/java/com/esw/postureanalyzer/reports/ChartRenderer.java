@@ -0,0 +1,171 @@
+package com.esw.postureanalyzer.reports;
+
+import android.graphics.Bitmap;
+import android.graphics.Canvas;
+import android.graphics.Color;
+import android.graphics.Paint;
+import android.graphics.RectF;
+
+import com.esw.postureanalyzer.vision.FirebaseDataRetriever;
+import com.esw.postureanalyzer.vision.PostureAggregate;
+
+import java.io.ByteArrayOutputStream;
+import java.util.List;
+
+/**
+ * Draws report charts into Bitmaps that are allocated once and reused for
+ * every chart and every report handled by the owning thread.
+ */
+class ChartRenderer {
+    private static final int PIE_WIDTH = 600;
+    private static final int PIE_HEIGHT = 400;
+    private static final int BAR_WIDTH = 700;
+    private static final int BAR_HEIGHT = 320;
+
+    private static final int COLOR_GOOD = Color.rgb(76, 175, 80);
+    private static final int COLOR_SLOUCH = Color.rgb(244, 67, 54);
+    private static final int COLOR_CROSS_LEG = Color.rgb(255, 152, 0);
+    private static final int COLOR_GRID = Color.rgb(224, 224, 224);
+
+    private final Bitmap pieBitmap = Bitmap.createBitmap(PIE_WIDTH, PIE_HEIGHT, Bitmap.Config.ARGB_8888);
+    private final Bitmap barBitmap = Bitmap.createBitmap(BAR_WIDTH, BAR_HEIGHT, Bitmap.Config.ARGB_8888);
+    private final Canvas pieCanvas = new Canvas(pieBitmap);
+    private final Canvas barCanvas = new Canvas(barBitmap);
+    private final ByteArrayOutputStream pngBuffer = new ByteArrayOutputStream(64 * 1024);
+
+    private final Paint paint = new Paint(Paint.ANTI_ALIAS_FLAG);
+    private final Paint textPaint = new Paint(Paint.ANTI_ALIAS_FLAG);
+    private final RectF oval = new RectF(100, 80, 400, 380);
+
+    ChartRenderer() {
+        textPaint.setTextSize(24);
+        textPaint.setColor(Color.BLACK);
+    }
+
+    /**
+     * Bytes held by the reused chart Bitmaps
+     */
+    long getBitmapBytes() {
+        return pieBitmap.getAllocationByteCount() + barBitmap.getAllocationByteCount();
+    }
+
+    /**
+     * Pie chart of the posture distribution, as PNG bytes
+     */
+    byte[] renderPie(FirebaseDataRetriever.PostureStatistics stats) {
+        Canvas canvas = pieCanvas;
+        canvas.drawColor(Color.WHITE);
+        textPaint.setTextAlign(Paint.Align.LEFT);
+        textPaint.setTextSize(24);
+
+        // Calculate percentages
+        float goodPercent = (float) stats.getGoodPosturePercentage();
+        float slouchPercent = (float) stats.getSlouchingPercentage();
+        float crossLegPercent = (float) stats.getCrossLeggedPercentage();
+
+        // Draw title
+        canvas.drawText("Posture Distribution", PIE_WIDTH / 2 - 120, 40, textPaint);
+
+        // Draw pie chart
+        float startAngle = 0;
+
+        paint.setColor(COLOR_GOOD);
+        float goodSweep = goodPercent * 3.6f;
+        canvas.drawArc(oval, startAngle, goodSweep, true, paint);
+        startAngle += goodSweep;
+
+        paint.setColor(COLOR_SLOUCH);
+        float slouchSweep = slouchPercent * 3.6f;
+        canvas.drawArc(oval, startAngle, slouchSweep, true, paint);
+        startAngle += slouchSweep;
+
+        paint.setColor(COLOR_CROSS_LEG);
+        float crossSweep = crossLegPercent * 3.6f;
+        canvas.drawArc(oval, startAngle, crossSweep, true, paint);
+
+        // Draw legend
+        int legendX = 420;
+        int legendY = 120;
+        int legendSpacing = 50;
+        drawLegendEntry(canvas, COLOR_GOOD, String.format("Good: %.1f%%", goodPercent), legendX, legendY);
+        drawLegendEntry(canvas, COLOR_SLOUCH, String.format("Slouch: %.1f%%", slouchPercent),
+                legendX, legendY + legendSpacing);
+        drawLegendEntry(canvas, COLOR_CROSS_LEG, String.format("Cross-leg: %.1f%%", crossLegPercent),
+                legendX, legendY + legendSpacing * 2);
+
+        return encode(pieBitmap);
+    }
+
+    /**
+     * Grouped bars of good / slouching / cross-legged percentages for days[from, to)
+     */
+    byte[] renderDailyBars(List<PostureAggregate> days, int from, int to) {
+        Canvas canvas = barCanvas;
+        canvas.drawColor(Color.WHITE);
+
+        float left = 60f;
+        float top = 50f;
+        float bottom = BAR_HEIGHT - 50f;
+        float graphHeight = bottom - top;
+        float slotWidth = (BAR_WIDTH - left - 20f) / Math.max(1, to - from);
+        float barWidth = slotWidth / 4f;
+
+        // Grid and Y-axis labels
+        textPaint.setTextSize(18);
+        textPaint.setTextAlign(Paint.Align.RIGHT);
+        paint.setColor(COLOR_GRID);
+        for (int i = 0; i <= 4; i++) {
+            float y = top + graphHeight * i / 4f;
+            canvas.drawLine(left, y, BAR_WIDTH - 20f, y, paint);
+            canvas.drawText((100 - i * 25) + "%", left - 8f, y + 6f, textPaint);
+        }
+
+        textPaint.setTextAlign(Paint.Align.CENTER);
+        for (int d = from; d < to; d++) {
+            FirebaseDataRetriever.PostureStatistics stats = days.get(d).toStatistics();
+            float x = left + (d - from) * slotWidth + barWidth / 2f;
+
+            drawBar(canvas, COLOR_GOOD, x, barWidth, bottom, graphHeight, stats.getGoodPosturePercentage());
+            drawBar(canvas, COLOR_SLOUCH, x + barWidth, barWidth, bottom, graphHeight,
+                    stats.getSlouchingPercentage());
+            drawBar(canvas, COLOR_CROSS_LEG, x + barWidth * 2, barWidth, bottom, graphHeight,
+                    stats.getCrossLeggedPercentage());
+
+            // "MM-dd" from the yyyy-MM-dd key
+            String date = days.get(d).date;
+            String label = date != null && date.length() == 10 ? date.substring(5) : "";
+            canvas.drawText(label, x + barWidth * 1.5f, bottom + 26f, textPaint);
+        }
+
+        // Legend
+        textPaint.setTextSize(20);
+        textPaint.setTextAlign(Paint.Align.LEFT);
+        drawLegendEntry(canvas, COLOR_GOOD, "Good", (int) left, 10);
+        drawLegendEntry(canvas, COLOR_SLOUCH, "Slouch", (int) left + 150, 10);
+        drawLegendEntry(canvas, COLOR_CROSS_LEG, "Cross-leg", (int) left + 300, 10);
+        textPaint.setTextSize(24);
+
+        return encode(barBitmap);
+    }
+
+    private void drawBar(Canvas canvas, int color, float x, float width, float bottom, float graphHeight,
+                         double percent) {
+        paint.setColor(color);
+        canvas.drawRect(x, bottom - (float) (percent / 100.0) * graphHeight, x + width, bottom, paint);
+    }
+
+    private void drawLegendEntry(Canvas canvas, int color, String label, int x, int y) {
+        paint.setColor(color);
+        canvas.drawRect(x, y, x + 30, y + 30, paint);
+        canvas.drawText(label, x + 40, y + 22, textPaint);
+    }
+
+    /**
+     * PNG-encode through the shared buffer; iText needs its own copy of the bytes
+     */
+    private byte[] encode(Bitmap bitmap) {
+        pngBuffer.reset();
+        bitmap.compress(Bitmap.CompressFormat.PNG, 100, pngBuffer);
+        return pngBuffer.toByteArray();
+    }
+}
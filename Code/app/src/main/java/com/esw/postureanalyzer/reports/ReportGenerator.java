@@ -1,40 +1,70 @@
 package com.esw.postureanalyzer.reports;
 
 import android.content.Context;
-import android.graphics.Bitmap;
-import android.graphics.Canvas;
-import android.graphics.Color;
-import android.graphics.Paint;
-import android.graphics.RectF;
 import android.util.Log;
 
 import com.esw.postureanalyzer.vision.FirebaseDataRetriever;
+import com.esw.postureanalyzer.vision.PostureAggregate;
 import com.itextpdf.io.image.ImageDataFactory;
 import com.itextpdf.kernel.colors.ColorConstants;
-import com.itextpdf.kernel.colors.DeviceRgb;
 import com.itextpdf.kernel.pdf.PdfDocument;
 import com.itextpdf.kernel.pdf.PdfWriter;
 import com.itextpdf.layout.Document;
+import com.itextpdf.layout.element.AreaBreak;
 import com.itextpdf.layout.element.Image;
 import com.itextpdf.layout.element.Paragraph;
 import com.itextpdf.layout.element.Table;
+import com.itextpdf.layout.properties.AreaBreakType;
+import com.itextpdf.layout.properties.HorizontalAlignment;
 import com.itextpdf.layout.properties.TextAlignment;
 import com.itextpdf.layout.properties.UnitValue;
 
-import java.io.ByteArrayOutputStream;
 import java.io.File;
 import java.text.SimpleDateFormat;
+import java.util.ArrayList;
 import java.util.Calendar;
 import java.util.Date;
+import java.util.List;
 import java.util.Locale;
+import java.util.concurrent.ArrayBlockingQueue;
 import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.RejectedExecutionException;
+import java.util.concurrent.ThreadPoolExecutor;
 import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.concurrent.atomic.AtomicInteger;
 
 /**
- * Generates PDF reports for posture analytics
+ * Generates PDF reports for posture analytics.
+ *
+ * Reports are built from per-day aggregates streamed by FirebaseDataRetriever
+ * rather than the raw records of the whole range. The first page holds the
+ * period summary; multi-day reports add one page per week with a daily bar
+ * chart and table. Charts are drawn into Bitmaps reused by each report thread,
+ * and reports run on a small bounded executor so several can be generated in
+ * parallel without unbounded heap growth. Time and heap usage are recorded
+ * per report.
  */
 public class ReportGenerator {
     private static final String TAG = "ReportGenerator";
+    private static final int DAYS_PER_PAGE = 7;
+    private static final long FETCH_TIMEOUT_SECONDS = 60;
+
+    // At most this many reports render at once; a few more may wait in the queue
+    private static final int MAX_PARALLEL_REPORTS =
+            Math.max(1, Math.min(2, Runtime.getRuntime().availableProcessors() / 2));
+    private static final int MAX_QUEUED_REPORTS = 16;
+    private static final ThreadPoolExecutor EXECUTOR = createExecutor();
+    private static final AtomicInteger REPORT_SEQUENCE = new AtomicInteger();
+
+    // One set of chart Bitmaps per report thread, reused across charts and reports
+    private static final ThreadLocal<ChartRenderer> CHARTS = new ThreadLocal<ChartRenderer>() {
+        @Override
+        protected ChartRenderer initialValue() {
+            return new ChartRenderer();
+        }
+    };
+
     private final Context context;
     private FirebaseDataRetriever dataRetriever;
 
@@ -46,98 +76,247 @@ public class ReportGenerator {
     public interface ReportCallback {
         void onReportGenerated(File pdfFile);
         void onError(String error);
+
+        /**
+         * Called before onReportGenerated with the cost of the report
+         */
+        default void onReportMetrics(ReportMetrics metrics) {
+        }
+    }
+
+    /**
+     * A report to generate in a batch
+     */
+    public static class ReportRequest {
+        public final long startTime;
+        public final long endTime;
+        public final String title;
+
+        public ReportRequest(long startTime, long endTime, String title) {
+            this.startTime = startTime;
+            this.endTime = endTime;
+            this.title = title;
+        }
+    }
+
+    /**
+     * Time and memory spent on one report. Heap figures are process-wide, so
+     * they include any reports rendering in parallel.
+     */
+    public static class ReportMetrics {
+        public final String title;
+        public int days;
+        public int scannedDays;   // Days aggregated from raw records (not cached)
+        public int pages;
+        public long fetchMs;
+        public long renderMs;
+        public long totalMs;
+        public long heapStartKb;
+        public long heapPeakKb;
+        public long chartBitmapKb;
+        public long pdfKb;
+
+        ReportMetrics(String title) {
+            this.title = title;
+        }
+
+        void sampleHeap() {
+            heapPeakKb = Math.max(heapPeakKb, usedHeapKb());
+        }
+
+        @Override
+        public String toString() {
+            return String.format(Locale.US,
+                    "%s: %d days (%d scanned), %d pages, fetch %d ms, render %d ms, total %d ms, " +
+                    "heap %d -> peak %d KB (+%d), charts %d KB, pdf %d KB",
+                    title, days, scannedDays, pages, fetchMs, renderMs, totalMs,
+                    heapStartKb, heapPeakKb, heapPeakKb - heapStartKb, chartBitmapKb, pdfKb);
+        }
+    }
+
+    private static ThreadPoolExecutor createExecutor() {
+        AtomicInteger threadCount = new AtomicInteger();
+        ThreadPoolExecutor executor = new ThreadPoolExecutor(
+                MAX_PARALLEL_REPORTS, MAX_PARALLEL_REPORTS,
+                30, TimeUnit.SECONDS,
+                new ArrayBlockingQueue<>(MAX_QUEUED_REPORTS),
+                r -> {
+                    Thread t = new Thread(r, "ReportGenerator-" + threadCount.incrementAndGet());
+                    t.setPriority(Thread.MIN_PRIORITY);
+                    return t;
+                });
+        // Idle threads exit, releasing their chart Bitmaps
+        executor.allowCoreThreadTimeOut(true);
+        return executor;
     }
 
     /**
      * Generate daily report for yesterday's data
      */
     public void generateDailyReport(ReportCallback callback) {
-        // Get yesterday's data
+        long[] range = completedDays(1);
+        String dateStr = new SimpleDateFormat("yyyy-MM-dd", Locale.getDefault())
+                .format(new Date(range[0]));
+
+        generateReport(range[0], range[1], "Daily Report - " + dateStr, callback);
+    }
+
+    /**
+     * Generate report for the last 7 complete days
+     */
+    public void generateWeeklyReport(ReportCallback callback) {
+        long[] range = completedDays(7);
+        generateReport(range[0], range[1], "Weekly Report", callback);
+    }
+
+    /**
+     * Generate report for the last 30 complete days
+     */
+    public void generateMonthlyReport(ReportCallback callback) {
+        long[] range = completedDays(30);
+        generateReport(range[0], range[1], "Monthly Report", callback);
+    }
+
+    /**
+     * [start of the day N days ago, end of yesterday]
+     */
+    private static long[] completedDays(int days) {
         Calendar calendar = Calendar.getInstance();
-        calendar.add(Calendar.DAY_OF_YEAR, -1);
         calendar.set(Calendar.HOUR_OF_DAY, 0);
         calendar.set(Calendar.MINUTE, 0);
         calendar.set(Calendar.SECOND, 0);
         calendar.set(Calendar.MILLISECOND, 0);
-        long startTime = calendar.getTimeInMillis();
+        long endTime = calendar.getTimeInMillis() - 1;
 
-        calendar.set(Calendar.HOUR_OF_DAY, 23);
-        calendar.set(Calendar.MINUTE, 59);
-        calendar.set(Calendar.SECOND, 59);
-        long endTime = calendar.getTimeInMillis();
-
-        String dateStr = new SimpleDateFormat("yyyy-MM-dd", Locale.getDefault())
-                .format(new Date(startTime));
+        calendar.add(Calendar.DAY_OF_YEAR, -days);
+        return new long[]{calendar.getTimeInMillis(), endTime};
+    }
 
-        generateReport(startTime, endTime, "Daily Report - " + dateStr, callback);
+    /**
+     * Generate several reports in parallel; the callback is invoked once per report
+     */
+    public void generateReports(List<ReportRequest> requests, ReportCallback callback) {
+        for (ReportRequest request : requests) {
+            generateReport(request.startTime, request.endTime, request.title, callback);
+        }
     }
 
     /**
      * Generate report for custom time period
      */
     public void generateReport(long startTime, long endTime, String title, ReportCallback callback) {
-        CountDownLatch latch = new CountDownLatch(1);
-        final FirebaseDataRetriever.PostureStatistics[] statsHolder = new FirebaseDataRetriever.PostureStatistics[1];
-        final String[] errorHolder = new String[1];
-
-        // Fetch data from Firebase
-        dataRetriever.getPostureStatistics(startTime, endTime, new FirebaseDataRetriever.StatisticsCallback() {
-            @Override
-            public void onStatisticsCalculated(FirebaseDataRetriever.PostureStatistics stats) {
-                statsHolder[0] = stats;
-                latch.countDown();
-            }
+        try {
+            EXECUTOR.execute(() -> runReport(startTime, endTime, title, callback));
+        } catch (RejectedExecutionException e) {
+            Log.e(TAG, "Report queue full, rejected: " + title);
+            callback.onError("Too many reports in progress, try again later");
+        }
+    }
 
-            @Override
-            public void onError(String error) {
-                errorHolder[0] = error;
-                latch.countDown();
-            }
-        });
-
-        // Wait for data retrieval (max 30 seconds)
-        new Thread(() -> {
-            try {
-                if (!latch.await(30, TimeUnit.SECONDS)) {
-                    callback.onError("Timeout waiting for data");
-                    return;
+    private void runReport(long startTime, long endTime, String title, ReportCallback callback) {
+        ReportMetrics metrics = new ReportMetrics(title);
+        long reportStart = System.nanoTime();
+        metrics.heapStartKb = usedHeapKb();
+        metrics.heapPeakKb = metrics.heapStartKb;
+
+        try {
+            // Stream per-day aggregates; only these small summaries are kept
+            List<PostureAggregate> days = new ArrayList<>();
+            PostureAggregate total = new PostureAggregate(null);
+            CountDownLatch latch = new CountDownLatch(1);
+            // Set on timeout; late callbacks must not touch days/total after that
+            AtomicBoolean cancelled = new AtomicBoolean();
+            final String[] errorHolder = new String[1];
+            final int[] scannedHolder = new int[1];
+
+            dataRetriever.getDailyAggregates(startTime, endTime, new FirebaseDataRetriever.DailyAggregateCallback() {
+                @Override
+                public void onDayReady(PostureAggregate day) {
+                    if (cancelled.get()) {
+                        return;
+                    }
+                    days.add(day);
+                    total.merge(day);
                 }
 
-                if (errorHolder[0] != null) {
-                    callback.onError(errorHolder[0]);
-                    return;
+                @Override
+                public void onComplete(int scannedDays) {
+                    scannedHolder[0] = scannedDays;
+                    latch.countDown();
                 }
 
-                if (statsHolder[0] == null || statsHolder[0].totalEntries == 0) {
-                    callback.onError("No data available for the selected period");
-                    return;
+                @Override
+                public void onError(String error) {
+                    errorHolder[0] = error;
+                    latch.countDown();
                 }
 
-                // Generate PDF
-                File pdfFile = createPdfReport(statsHolder[0], title, startTime, endTime);
-                if (pdfFile != null) {
-                    callback.onReportGenerated(pdfFile);
-                } else {
-                    callback.onError("Failed to create PDF report");
+                @Override
+                public boolean isCancelled() {
+                    return cancelled.get();
                 }
+            });
 
-            } catch (Exception e) {
-                Log.e(TAG, "Error generating report", e);
-                callback.onError("Error generating report: " + e.getMessage());
+            if (!latch.await(FETCH_TIMEOUT_SECONDS, TimeUnit.SECONDS)) {
+                cancelled.set(true);
+                callback.onError("Timeout waiting for data");
+                return;
             }
-        }).start();
+
+            if (errorHolder[0] != null) {
+                callback.onError(errorHolder[0]);
+                return;
+            }
+
+            if (total.totalEntries == 0) {
+                callback.onError("No data available for the selected period");
+                return;
+            }
+
+            metrics.days = days.size();
+            metrics.scannedDays = scannedHolder[0];
+            metrics.fetchMs = (System.nanoTime() - reportStart) / 1_000_000;
+            metrics.sampleHeap();
+
+            // Generate PDF
+            long renderStart = System.nanoTime();
+            File pdfFile = createPdfReport(total.toStatistics(), days, title, startTime, endTime, metrics);
+            if (pdfFile == null) {
+                callback.onError("Failed to create PDF report");
+                return;
+            }
+
+            metrics.renderMs = (System.nanoTime() - renderStart) / 1_000_000;
+            metrics.totalMs = (System.nanoTime() - reportStart) / 1_000_000;
+            metrics.pdfKb = pdfFile.length() / 1024;
+            Log.d(TAG, "Report metrics: " + metrics);
+
+            callback.onReportMetrics(metrics);
+            callback.onReportGenerated(pdfFile);
+
+        } catch (InterruptedException e) {
+            Thread.currentThread().interrupt();
+            callback.onError("Report generation interrupted");
+        } catch (Exception e) {
+            Log.e(TAG, "Error generating report", e);
+            callback.onError("Error generating report: " + e.getMessage());
+        }
     }
 
     /**
-     * Create PDF document with analytics
+     * Create PDF document with analytics: a summary page, then one page per week of days
      */
-    private File createPdfReport(FirebaseDataRetriever.PostureStatistics stats, String title,
-                                  long startTime, long endTime) {
+    private File createPdfReport(FirebaseDataRetriever.PostureStatistics stats, List<PostureAggregate> days,
+                                 String title, long startTime, long endTime, ReportMetrics metrics) {
         try {
+            ChartRenderer charts = CHARTS.get();
+            metrics.chartBitmapKb = charts.getBitmapBytes() / 1024;
+
             // Create file in cache directory
             String timestamp = new SimpleDateFormat("yyyyMMdd_HHmmss", Locale.getDefault())
                     .format(new Date());
-            File pdfFile = new File(context.getCacheDir(), "posture_report_" + timestamp + ".pdf");
+            File pdfFile = new File(context.getCacheDir(),
+                    "posture_report_" + timestamp + "_" + REPORT_SEQUENCE.incrementAndGet() + ".pdf");
 
             PdfWriter writer = new PdfWriter(pdfFile);
             PdfDocument pdf = new PdfDocument(writer);
@@ -178,18 +357,11 @@ public class ReportGenerator {
             document.add(summaryTable);
 
             // Add chart
-            Bitmap chartBitmap = createPostureChart(stats);
-            if (chartBitmap != null) {
-                ByteArrayOutputStream stream = new ByteArrayOutputStream();
-                chartBitmap.compress(Bitmap.CompressFormat.PNG, 100, stream);
-                byte[] chartBytes = stream.toByteArray();
-                
-                Image chartImage = new Image(ImageDataFactory.create(chartBytes));
-                chartImage.setWidth(UnitValue.createPercentValue(80));
-                chartImage.setHorizontalAlignment(com.itextpdf.layout.properties.HorizontalAlignment.CENTER);
-                chartImage.setMarginTop(20);
-                document.add(chartImage);
-            }
+            Image chartImage = new Image(ImageDataFactory.create(charts.renderPie(stats)));
+            chartImage.setWidth(UnitValue.createPercentValue(80));
+            chartImage.setHorizontalAlignment(HorizontalAlignment.CENTER);
+            chartImage.setMarginTop(20);
+            document.add(chartImage);
 
             // Detailed Statistics
             document.add(new Paragraph("Detailed Statistics")
@@ -208,6 +380,16 @@ public class ReportGenerator {
             addTableRow(detailTable, "Avg Inference Time", String.format("%.0f ms", stats.avgInferenceTime));
 
             document.add(detailTable);
+            metrics.sampleHeap();
+
+            // Daily breakdown, one page per week; each page is flushed as the next one starts
+            if (days.size() > 1) {
+                for (int from = 0; from < days.size(); from += DAYS_PER_PAGE) {
+                    int to = Math.min(from + DAYS_PER_PAGE, days.size());
+                    addDailyPage(document, charts, days, from, to);
+                    metrics.sampleHeap();
+                }
+            }
 
             // Add footer
             document.add(new Paragraph("\nGenerated by Posture Analyzer on " + 
@@ -218,6 +400,7 @@ public class ReportGenerator {
                     .setMarginTop(30)
                     .setFontColor(ColorConstants.GRAY));
 
+            metrics.pages = pdf.getNumberOfPages();
             document.close();
             Log.d(TAG, "PDF created successfully: " + pdfFile.getAbsolutePath());
             return pdfFile;
@@ -228,6 +411,43 @@ public class ReportGenerator {
         }
     }
 
+    private void addDailyPage(Document document, ChartRenderer charts, List<PostureAggregate> days,
+                              int from, int to) {
+        document.add(new AreaBreak(AreaBreakType.NEXT_PAGE));
+        document.add(new Paragraph("Daily Breakdown: " + days.get(from).date + " - " + days.get(to - 1).date)
+                .setFontSize(16)
+                .setBold()
+                .setMarginBottom(10));
+
+        Image chartImage = new Image(ImageDataFactory.create(charts.renderDailyBars(days, from, to)));
+        chartImage.setWidth(UnitValue.createPercentValue(100));
+        chartImage.setHorizontalAlignment(HorizontalAlignment.CENTER);
+        document.add(chartImage);
+
+        Table dayTable = new Table(UnitValue.createPercentArray(new float[]{2, 1, 1, 1, 1}))
+                .setWidth(UnitValue.createPercentValue(100))
+                .setMarginTop(20);
+        addHeaderRow(dayTable, "Date", "Sessions", "Good", "Slouching", "Cross-legged");
+        for (int d = from; d < to; d++) {
+            FirebaseDataRetriever.PostureStatistics day = days.get(d).toStatistics();
+            if (day.totalEntries == 0) {
+                addRow(dayTable, days.get(d).date, "0", "-", "-", "-");
+            } else {
+                addRow(dayTable, days.get(d).date,
+                        String.valueOf(day.totalEntries),
+                        String.format("%.1f%%", day.getGoodPosturePercentage()),
+                        String.format("%.1f%%", day.getSlouchingPercentage()),
+                        String.format("%.1f%%", day.getCrossLeggedPercentage()));
+            }
+        }
+        document.add(dayTable);
+    }
+
+    private static long usedHeapKb() {
+        Runtime runtime = Runtime.getRuntime();
+        return (runtime.totalMemory() - runtime.freeMemory()) / 1024;
+    }
+
     /**
      * Helper method to add row to table
      */
@@ -236,80 +456,15 @@ public class ReportGenerator {
         table.addCell(new Paragraph(value).setPadding(5).setBold());
     }
 
-    /**
-     * Create a pie chart showing posture distribution
-     */
-    private Bitmap createPostureChart(FirebaseDataRetriever.PostureStatistics stats) {
-        try {
-            int width = 600;
-            int height = 400;
-            Bitmap bitmap = Bitmap.createBitmap(width, height, Bitmap.Config.ARGB_8888);
-            Canvas canvas = new Canvas(bitmap);
-            canvas.drawColor(Color.WHITE);
-
-            Paint paint = new Paint(Paint.ANTI_ALIAS_FLAG);
-            Paint textPaint = new Paint(Paint.ANTI_ALIAS_FLAG);
-            textPaint.setTextSize(24);
-            textPaint.setColor(Color.BLACK);
-
-            // Calculate percentages
-            float goodPercent = (float) stats.getGoodPosturePercentage();
-            float slouchPercent = (float) stats.getSlouchingPercentage();
-            float crossLegPercent = (float) stats.getCrossLeggedPercentage();
-
-            // Draw title
-            canvas.drawText("Posture Distribution", width / 2 - 120, 40, textPaint);
-
-            // Draw pie chart
-            RectF oval = new RectF(100, 80, 400, 380);
-            
-            float startAngle = 0;
-            
-            // Good posture (green)
-            paint.setColor(Color.rgb(76, 175, 80));
-            float goodSweep = goodPercent * 3.6f;
-            canvas.drawArc(oval, startAngle, goodSweep, true, paint);
-            startAngle += goodSweep;
-            
-            // Slouching (red)
-            paint.setColor(Color.rgb(244, 67, 54));
-            float slouchSweep = slouchPercent * 3.6f;
-            canvas.drawArc(oval, startAngle, slouchSweep, true, paint);
-            startAngle += slouchSweep;
-            
-            // Cross-legged (orange)
-            paint.setColor(Color.rgb(255, 152, 0));
-            float crossSweep = crossLegPercent * 3.6f;
-            canvas.drawArc(oval, startAngle, crossSweep, true, paint);
-
-            // Draw legend
-            int legendX = 420;
-            int legendY = 120;
-            int legendSpacing = 50;
-
-            // Good posture
-            paint.setColor(Color.rgb(76, 175, 80));
-            canvas.drawRect(legendX, legendY, legendX + 30, legendY + 30, paint);
-            canvas.drawText(String.format("Good: %.1f%%", goodPercent), legendX + 40, legendY + 22, textPaint);
-
-            // Slouching
-            paint.setColor(Color.rgb(244, 67, 54));
-            canvas.drawRect(legendX, legendY + legendSpacing, legendX + 30, 
-                          legendY + legendSpacing + 30, paint);
-            canvas.drawText(String.format("Slouch: %.1f%%", slouchPercent), 
-                          legendX + 40, legendY + legendSpacing + 22, textPaint);
-
-            // Cross-legged
-            paint.setColor(Color.rgb(255, 152, 0));
-            canvas.drawRect(legendX, legendY + legendSpacing * 2, legendX + 30, 
-                          legendY + legendSpacing * 2 + 30, paint);
-            canvas.drawText(String.format("Cross-leg: %.1f%%", crossLegPercent), 
-                          legendX + 40, legendY + legendSpacing * 2 + 22, textPaint);
-
-            return bitmap;
-        } catch (Exception e) {
-            Log.e(TAG, "Error creating chart", e);
-            return null;
+    private void addHeaderRow(Table table, String... labels) {
+        for (String label : labels) {
+            table.addHeaderCell(new Paragraph(label).setPadding(5).setBold());
+        }
+    }
+
+    private void addRow(Table table, String... values) {
+        for (String value : values) {
+            table.addCell(new Paragraph(value).setPadding(5));
         }
     }
 }
@@ -4,21 +4,20 @@ import android.content.Context;
 import android.graphics.Canvas;
 import android.graphics.Color;
 import android.graphics.Paint;
-import android.graphics.Path;
 import android.graphics.RectF;
 import android.util.AttributeSet;
-import android.view.View;
 import androidx.annotation.Nullable;
 
 /**
  * Displays a body position heatmap showing which areas have posture issues
  * Based on pose landmark analysis
  */
-public class BodyPositionHeatmapView extends View {
+public class BodyPositionHeatmapView extends CachedLayerView {
     
     private Paint bodyPaint;
     private Paint textPaint;
     private Paint heatPaint;
+    private final RectF rect = new RectF();
     
     // Body part heat values (0-100, higher = more issues)
     private float headHeat = 0;
@@ -29,6 +28,15 @@ public class BodyPositionHeatmapView extends View {
     private float backLowerHeat = 0;
     private float hipHeat = 0;
 
+    // "NN%" labels, formatted once per setBodyHeatData
+    private String headLabel = "0%";
+    private String neckLabel = "0%";
+    private String shoulderLeftLabel = "0%";
+    private String shoulderRightLabel = "0%";
+    private String backUpperLabel = "0%";
+    private String backLowerLabel = "0%";
+    private String hipLabel = "0%";
+
     public BodyPositionHeatmapView(Context context, @Nullable AttributeSet attrs) {
         super(context, attrs);
         init();
@@ -65,14 +73,23 @@ public class BodyPositionHeatmapView extends View {
         this.backUpperHeat = backUpper;
         this.backLowerHeat = backLower;
         this.hipHeat = hip;
-        invalidate();
+        headLabel = formatHeat(head);
+        neckLabel = formatHeat(neck);
+        shoulderLeftLabel = formatHeat(shoulderL);
+        shoulderRightLabel = formatHeat(shoulderR);
+        backUpperLabel = formatHeat(backUpper);
+        backLowerLabel = formatHeat(backLower);
+        hipLabel = formatHeat(hip);
+        invalidateLayer();
+    }
+
+    private static String formatHeat(float heat) {
+        return String.format("%.0f%%", heat);
     }
 
     @Override
-    protected void onDraw(Canvas canvas) {
-        super.onDraw(canvas);
-        
-        float centerX = getWidth() / 2f;
+    protected void drawLayer(Canvas canvas, int width, int height) {
+        float centerX = width / 2f;
         float startY = 80f;
         
         // Draw title
@@ -82,29 +99,30 @@ public class BodyPositionHeatmapView extends View {
         textPaint.setTextSize(28f);
 
         // Head
-        drawHeatCircle(canvas, centerX, startY, 40f, headHeat, "Head");
+        drawHeatCircle(canvas, centerX, startY, 40f, headHeat, headLabel, "Head");
         
         // Neck
-        drawHeatCircle(canvas, centerX, startY + 80f, 30f, neckHeat, "Neck");
+        drawHeatCircle(canvas, centerX, startY + 80f, 30f, neckHeat, neckLabel, "Neck");
         
         // Shoulders
-        drawHeatCircle(canvas, centerX - 80f, startY + 140f, 35f, shoulderLeftHeat, "L.Shoulder");
-        drawHeatCircle(canvas, centerX + 80f, startY + 140f, 35f, shoulderRightHeat, "R.Shoulder");
+        drawHeatCircle(canvas, centerX - 80f, startY + 140f, 35f, shoulderLeftHeat, shoulderLeftLabel, "L.Shoulder");
+        drawHeatCircle(canvas, centerX + 80f, startY + 140f, 35f, shoulderRightHeat, shoulderRightLabel, "R.Shoulder");
         
         // Upper Back
-        drawHeatRect(canvas, centerX - 60f, startY + 160f, 120f, 60f, backUpperHeat, "Upper Back");
+        drawHeatRect(canvas, centerX - 60f, startY + 160f, 120f, 60f, backUpperHeat, backUpperLabel, "Upper Back");
         
         // Lower Back
-        drawHeatRect(canvas, centerX - 50f, startY + 230f, 100f, 60f, backLowerHeat, "Lower Back");
+        drawHeatRect(canvas, centerX - 50f, startY + 230f, 100f, 60f, backLowerHeat, backLowerLabel, "Lower Back");
         
         // Hips
-        drawHeatRect(canvas, centerX - 70f, startY + 300f, 140f, 50f, hipHeat, "Hips");
+        drawHeatRect(canvas, centerX - 70f, startY + 300f, 140f, 50f, hipHeat, hipLabel, "Hips");
         
         // Draw legend
-        drawLegend(canvas, startY + 400f);
+        drawLegend(canvas, centerX, startY + 400f);
     }
 
-    private void drawHeatCircle(Canvas canvas, float x, float y, float radius, float heat, String label) {
+    private void drawHeatCircle(Canvas canvas, float x, float y, float radius, float heat,
+                                String value, String label) {
         // Draw heat circle
         heatPaint.setColor(getColorForHeat(heat));
         canvas.drawCircle(x, y, radius, heatPaint);
@@ -119,15 +137,15 @@ public class BodyPositionHeatmapView extends View {
         
         // Draw heat value
         textPaint.setTextSize(18f);
-        canvas.drawText(String.format("%.0f%%", heat), x, y + 8f, textPaint);
+        canvas.drawText(value, x, y + 8f, textPaint);
         textPaint.setTextSize(28f);
     }
 
     private void drawHeatRect(Canvas canvas, float x, float y, float width, float height, 
-                              float heat, String label) {
+                              float heat, String value, String label) {
         // Draw heat rectangle
         heatPaint.setColor(getColorForHeat(heat));
-        RectF rect = new RectF(x, y, x + width, y + height);
+        rect.set(x, y, x + width, y + height);
         canvas.drawRoundRect(rect, 10f, 10f, heatPaint);
         
         // Draw border
@@ -140,13 +158,12 @@ public class BodyPositionHeatmapView extends View {
         
         // Draw heat value
         textPaint.setTextSize(18f);
-        canvas.drawText(String.format("%.0f%%", heat), x + width / 2, y + height / 2 + 8f, textPaint);
+        canvas.drawText(value, x + width / 2, y + height / 2 + 8f, textPaint);
         textPaint.setTextSize(28f);
     }
 
-    private void drawLegend(Canvas canvas, float y) {
+    private void drawLegend(Canvas canvas, float centerX, float y) {
         textPaint.setTextSize(24f);
-        float centerX = getWidth() / 2f;
         
         canvas.drawText("Issue Frequency", centerX, y, textPaint);
         
@@ -163,8 +180,7 @@ public class BodyPositionHeatmapView extends View {
         }
         
         bodyPaint.setStrokeWidth(2f);
-        RectF legendRect = new RectF(startX, legendY, startX + legendWidth, legendY + legendHeight);
-        canvas.drawRect(legendRect, bodyPaint);
+        canvas.drawRect(startX, legendY, startX + legendWidth, legendY + legendHeight, bodyPaint);
         
         // Labels
         textPaint.setTextSize(20f);
@@ -182,15 +198,15 @@ public class BodyPositionHeatmapView extends View {
      */
     private int getColorForHeat(float heat) {
         if (heat >= 80) {
-            return Color.parseColor("#D32F2F"); // Dark Red - Critical
+            return 0xFFD32F2F; // Dark Red - Critical
         } else if (heat >= 60) {
-            return Color.parseColor("#F44336"); // Red - High
+            return 0xFFF44336; // Red - High
         } else if (heat >= 40) {
-            return Color.parseColor("#FF9800"); // Orange - Medium
+            return 0xFFFF9800; // Orange - Medium
         } else if (heat >= 20) {
-            return Color.parseColor("#FFC107"); // Amber - Low
+            return 0xFFFFC107; // Amber - Low
         } else {
-            return Color.parseColor("#4CAF50"); // Green - Minimal
+            return 0xFF4CAF50; // Green - Minimal
         }
     }
 
@@ -0,0 +1,81 @@
+package com.esw.postureanalyzer.views;
+
+import android.content.Context;
+import android.graphics.Canvas;
+import android.graphics.Picture;
+import android.util.AttributeSet;
+import android.util.Log;
+import android.view.View;
+import androidx.annotation.Nullable;
+
+/**
+ * Base for dashboard views whose content only changes with their data.
+ *
+ * Subclasses draw into a Picture once per data or size change; later onDraw
+ * calls replay that recording. A Picture is used rather than a Bitmap so a
+ * tall view (a year of days) holds no pixel memory and is not limited by the
+ * GPU's maximum texture size, and only the visible part is rasterised while
+ * scrolling.
+ */
+public abstract class CachedLayerView extends View {
+    private static final String TAG = "CachedLayerView";
+
+    private Picture layer;
+    private boolean layerDirty = true;
+
+    public CachedLayerView(Context context, @Nullable AttributeSet attrs) {
+        super(context, attrs);
+    }
+
+    /**
+     * Draw the full content. Only called when the layer must be re-recorded.
+     */
+    protected abstract void drawLayer(Canvas canvas, int width, int height);
+
+    /**
+     * Discard the recorded layer and redraw; call after changing data
+     */
+    protected void invalidateLayer() {
+        layerDirty = true;
+        invalidate();
+    }
+
+    @Override
+    protected void onSizeChanged(int w, int h, int oldw, int oldh) {
+        super.onSizeChanged(w, h, oldw, oldh);
+        layerDirty = true;
+    }
+
+    @Override
+    protected void onDetachedFromWindow() {
+        super.onDetachedFromWindow();
+        layer = null;
+        layerDirty = true;
+    }
+
+    @Override
+    protected void onDraw(Canvas canvas) {
+        super.onDraw(canvas);
+
+        int width = getWidth();
+        int height = getHeight();
+        if (width == 0 || height == 0) {
+            return;
+        }
+
+        if (layerDirty || layer == null) {
+            long start = System.nanoTime();
+            if (layer == null) {
+                layer = new Picture();
+            }
+            Canvas recording = layer.beginRecording(width, height);
+            drawLayer(recording, width, height);
+            layer.endRecording();
+            layerDirty = false;
+            Log.d(TAG, String.format("%s layer recorded in %.2f ms (%dx%d)",
+                    getClass().getSimpleName(), (System.nanoTime() - start) / 1e6, width, height));
+        }
+
+        canvas.drawPicture(layer);
+    }
+}
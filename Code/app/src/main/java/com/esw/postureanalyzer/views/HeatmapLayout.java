@@ -0,0 +1,114 @@
+package com.esw.postureanalyzer.views;
+
+/**
+ * Cell geometry and colours for the calendar and hourly heatmaps.
+ *
+ * Plain Java with no android.graphics types: the views build one of these per
+ * data or size change, the geometry is unit tested on the host, and the
+ * on-device HeatmapRenderBenchmarkTest checks rendered pixels against it.
+ */
+public final class HeatmapLayout {
+    // Calendar heatmap
+    public static final int CALENDAR_COLS = 7; // Days per week
+    public static final float CELL_PADDING = 4f;
+    public static final float CALENDAR_HEADER = 50f; // Day labels
+    public static final float CALENDAR_FOOTER = 100f; // Legend
+
+    // Hourly heatmap
+    public static final int HOURS = 24;
+    public static final float BAR_PADDING = 4f;
+    public static final float HOURLY_TOP = 50f;
+    public static final float HOURLY_MARGIN = 100f; // Top + hour labels
+
+    public final int count;
+    public final float[] rects; // left, top, right, bottom per cell
+    public final int[] colors;
+    public final float cellSize; // Calendar cell side, or hourly bar width
+    public final float contentBottom;
+
+    private HeatmapLayout(int count, float cellSize, float contentBottom) {
+        this.count = count;
+        this.rects = new float[count * 4];
+        this.colors = new int[count];
+        this.cellSize = cellSize;
+        this.contentBottom = contentBottom;
+    }
+
+    public static float calendarCellSize(int width) {
+        return (width - (CALENDAR_COLS + 1) * CELL_PADDING) / CALENDAR_COLS;
+    }
+
+    /**
+     * Measured height of a calendar showing the given number of days
+     */
+    public static int calendarHeight(int width, int days) {
+        int rows = (int) Math.ceil(days / (float) CALENDAR_COLS);
+        return (int) (CALENDAR_HEADER + rows * (calendarCellSize(width) + CELL_PADDING) + CALENDAR_FOOTER);
+    }
+
+    /**
+     * One square per day, seven per row
+     */
+    public static HeatmapLayout calendar(int width, float[] scores) {
+        float cellSize = calendarCellSize(width);
+        int rows = (int) Math.ceil(scores.length / (float) CALENDAR_COLS);
+        HeatmapLayout cells = new HeatmapLayout(scores.length, cellSize,
+                CALENDAR_HEADER + rows * (cellSize + CELL_PADDING));
+
+        for (int i = 0; i < scores.length; i++) {
+            int row = i / CALENDAR_COLS;
+            int col = i % CALENDAR_COLS;
+            float x = CELL_PADDING + col * (cellSize + CELL_PADDING);
+            float y = CALENDAR_HEADER + row * (cellSize + CELL_PADDING);
+            cells.setRect(i, x, y, x + cellSize, y + cellSize);
+            cells.colors[i] = colorForScore(scores[i]);
+        }
+        return cells;
+    }
+
+    /**
+     * One bar per hour, height proportional to the score
+     */
+    public static HeatmapLayout hourly(int width, int height, float[] scores) {
+        float graphHeight = height - HOURLY_MARGIN;
+        float barWidth = (width - (HOURS + 1) * BAR_PADDING) / HOURS;
+        float bottom = HOURLY_TOP + graphHeight;
+        HeatmapLayout bars = new HeatmapLayout(scores.length, barWidth, bottom);
+
+        for (int i = 0; i < scores.length; i++) {
+            float x = BAR_PADDING + i * (barWidth + BAR_PADDING);
+            float barHeight = (scores[i] / 100f) * graphHeight;
+            bars.setRect(i, x, bottom - barHeight, x + barWidth, bottom);
+            bars.colors[i] = colorForScore(scores[i]);
+        }
+        return bars;
+    }
+
+    private void setRect(int i, float left, float top, float right, float bottom) {
+        rects[i * 4] = left;
+        rects[i * 4 + 1] = top;
+        rects[i * 4 + 2] = right;
+        rects[i * 4 + 3] = bottom;
+    }
+
+    /**
+     * Get color based on posture score
+     * @param score 0-100 (higher is better)
+     * @return ARGB color int
+     */
+    public static int colorForScore(float score) {
+        if (score >= 90) {
+            return 0xFF00C853; // Excellent - Dark Green
+        } else if (score >= 75) {
+            return 0xFF64DD17; // Good - Light Green
+        } else if (score >= 60) {
+            return 0xFFFFEB3B; // Fair - Yellow
+        } else if (score >= 40) {
+            return 0xFFFF9800; // Poor - Orange
+        } else if (score >= 20) {
+            return 0xFFFF5722; // Bad - Red
+        } else {
+            return 0xFFE0E0E0; // No data - Gray
+        }
+    }
+}
@@ -4,9 +4,7 @@ import android.content.Context;
 import android.graphics.Canvas;
 import android.graphics.Color;
 import android.graphics.Paint;
-import android.graphics.Path;
 import android.util.AttributeSet;
-import android.view.View;
 import androidx.annotation.Nullable;
 
 import java.util.ArrayList;
@@ -15,15 +13,16 @@ import java.util.List;
 /**
  * Displays an hourly heatmap showing posture quality throughout the day
  */
-public class HourlyPostureHeatmapView extends View {
-    private static final int HOURS = 24;
-    private static final float BAR_PADDING = 4f;
-    
+public class HourlyPostureHeatmapView extends CachedLayerView {
+    private static final String[] Y_LABELS = {"100%", "75%", "50%", "25%", "0%"};
+
     private Paint barPaint;
     private Paint textPaint;
     private Paint linePaint;
-    
+
     private List<HourData> hourlyData = new ArrayList<>();
+    private float[] scores = new float[0];
+    private String[] hourLabels = new String[0];
 
     public HourlyPostureHeatmapView(Context context, @Nullable AttributeSet attrs) {
         super(context, attrs);
@@ -54,48 +53,46 @@ public class HourlyPostureHeatmapView extends View {
      */
     public void setHourlyData(List<HourData> data) {
         this.hourlyData = data;
-        invalidate();
+        scores = new float[data.size()];
+        hourLabels = new String[data.size()];
+        for (int i = 0; i < scores.length; i++) {
+            scores[i] = data.get(i).postureScore;
+            hourLabels[i] = String.format("%02d", data.get(i).hour);
+        }
+        invalidateLayer();
     }
 
     @Override
-    protected void onDraw(Canvas canvas) {
-        super.onDraw(canvas);
-        
-        if (hourlyData.isEmpty()) {
-            drawEmptyState(canvas);
+    protected void drawLayer(Canvas canvas, int width, int height) {
+        if (scores.length == 0) {
+            drawEmptyState(canvas, width, height);
             return;
         }
 
-        float startY = 50f;
-        float graphHeight = getHeight() - 100f;
-        float barWidth = (getWidth() - (HOURS + 1) * BAR_PADDING) / HOURS;
-        
+        float startY = HeatmapLayout.HOURLY_TOP;
+        float graphHeight = height - HeatmapLayout.HOURLY_MARGIN;
+        HeatmapLayout layout = HeatmapLayout.hourly(width, height, scores);
+        float barWidth = layout.cellSize;
+
         // Draw grid lines
         for (int i = 0; i <= 4; i++) {
             float y = startY + (graphHeight / 4) * i;
-            canvas.drawLine(0, y, getWidth(), y, linePaint);
+            canvas.drawLine(0, y, width, y, linePaint);
         }
 
         // Draw bars
-        for (int i = 0; i < hourlyData.size(); i++) {
-            HourData data = hourlyData.get(i);
-            float x = BAR_PADDING + i * (barWidth + BAR_PADDING);
-            
-            // Bar height based on score (0-100)
-            float barHeight = (data.postureScore / 100f) * graphHeight;
-            float y = startY + graphHeight - barHeight;
-            
-            barPaint.setColor(getColorForScore(data.postureScore));
-            canvas.drawRect(x, y, x + barWidth, startY + graphHeight, barPaint);
+        float[] rects = layout.rects;
+        for (int i = 0; i < layout.count; i++) {
+            barPaint.setColor(layout.colors[i]);
+            canvas.drawRect(rects[i * 4], rects[i * 4 + 1], rects[i * 4 + 2], rects[i * 4 + 3], barPaint);
         }
 
         // Draw hour labels
         textPaint.setTextSize(20f);
-        for (int i = 0; i < hourlyData.size(); i++) {
+        for (int i = 0; i < hourLabels.length; i++) {
             if (i % 2 == 0) { // Show every other hour
-                float x = BAR_PADDING + i * (barWidth + BAR_PADDING) + barWidth / 2;
-                String label = String.format("%02d", hourlyData.get(i).hour);
-                canvas.drawText(label, x, startY + graphHeight + 30f, textPaint);
+                float x = rects[i * 4] + barWidth / 2;
+                canvas.drawText(hourLabels[i], x, layout.contentBottom + 30f, textPaint);
             }
         }
 
@@ -103,28 +100,18 @@ public class HourlyPostureHeatmapView extends View {
         textPaint.setTextAlign(Paint.Align.RIGHT);
         for (int i = 0; i <= 4; i++) {
             float y = startY + (graphHeight / 4) * i;
-            int value = 100 - (i * 25);
-            canvas.drawText(value + "%", 50f, y + 8f, textPaint);
+            canvas.drawText(Y_LABELS[i], 50f, y + 8f, textPaint);
         }
         textPaint.setTextAlign(Paint.Align.CENTER);
         textPaint.setTextSize(24f);
     }
 
-    private void drawEmptyState(Canvas canvas) {
+    private void drawEmptyState(Canvas canvas, int width, int height) {
         textPaint.setTextSize(28f);
-        canvas.drawText("No hourly data available", getWidth() / 2f, getHeight() / 2f, textPaint);
+        canvas.drawText("No hourly data available", width / 2f, height / 2f, textPaint);
         textPaint.setTextSize(24f);
     }
 
-    private int getColorForScore(float score) {
-        if (score >= 90) return Color.parseColor("#00C853");
-        else if (score >= 75) return Color.parseColor("#64DD17");
-        else if (score >= 60) return Color.parseColor("#FFEB3B");
-        else if (score >= 40) return Color.parseColor("#FF9800");
-        else if (score >= 20) return Color.parseColor("#FF5722");
-        else return Color.parseColor("#E0E0E0");
-    }
-
     @Override
     protected void onMeasure(int widthMeasureSpec, int heightMeasureSpec) {
         int width = MeasureSpec.getSize(widthMeasureSpec);
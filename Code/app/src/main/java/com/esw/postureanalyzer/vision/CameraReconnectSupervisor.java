@@ -0,0 +1,226 @@
+package com.esw.postureanalyzer.vision;
+
+import java.util.HashMap;
+import java.util.Map;
+
+/**
+ * Decides when a USB camera stream needs reopening and measures how long
+ * each recovery took.
+ *
+ * Faults are a stall (no frame for the stall timeout while streaming) or a
+ * detach. A stall asks for a reopen right away; a detach waits for the
+ * device to come back. Failed reopens are retried with backoff. Recovery
+ * time runs from the fault to the first frame after reopening; a stall's
+ * fault starts at the last frame delivered, so the time spent waiting out
+ * the stall timeout is counted. If nothing comes back within the give-up
+ * window the supervisor gives up and the caller falls back to a full stop.
+ *
+ * Times are caller-supplied milliseconds on a monotonic clock
+ * (SystemClock.elapsedRealtime on the device).
+ */
+public class CameraReconnectSupervisor {
+    public static final long DEFAULT_STALL_TIMEOUT_MS = 1500;
+    public static final long DEFAULT_GIVE_UP_MS = 10_000;
+
+    private static final long[] RETRY_BACKOFF_MS = {100, 250, 500, 1000};
+
+    public enum State {
+        IDLE,               // not streaming
+        STREAMING,
+        RECOVERING,         // reopening, or reopened and waiting for the first frame
+        WAITING_FOR_DEVICE, // detached, waiting for the attach broadcast
+        FAILED,             // gave up; the caller stops the camera
+    }
+
+    public enum Fault {
+        STALL,
+        DETACH,
+    }
+
+    private final long stallTimeoutMs;
+    private final long giveUpMs;
+
+    private State state = State.IDLE;
+    private Fault fault;
+    private long lastFrameMs;
+    private long faultMs;
+    private long reopenedMs = -1;
+    private int attempt;
+
+    private int stalls;
+    private int detaches;
+    private int recoveries;
+    private int failures;
+    private int reopenAttempts;
+    private long lastRecoveryMs = -1;
+    private long maxRecoveryMs;
+    private long totalRecoveryMs;
+
+    public CameraReconnectSupervisor() {
+        this(DEFAULT_STALL_TIMEOUT_MS, DEFAULT_GIVE_UP_MS);
+    }
+
+    public CameraReconnectSupervisor(long stallTimeoutMs, long giveUpMs) {
+        this.stallTimeoutMs = stallTimeoutMs;
+        this.giveUpMs = giveUpMs;
+    }
+
+    public synchronized void onStreamStarted(long nowMs) {
+        state = State.STREAMING;
+        lastFrameMs = nowMs;
+        reopenedMs = -1;
+    }
+
+    /**
+     * A frame arrived. Returns true if it completes a recovery.
+     */
+    public synchronized boolean onFrame(long nowMs) {
+        lastFrameMs = nowMs;
+        if (state != State.RECOVERING || reopenedMs < 0) {
+            return false;
+        }
+        lastRecoveryMs = nowMs - faultMs;
+        maxRecoveryMs = Math.max(maxRecoveryMs, lastRecoveryMs);
+        totalRecoveryMs += lastRecoveryMs;
+        recoveries++;
+        state = State.STREAMING;
+        reopenedMs = -1;
+        return true;
+    }
+
+    /**
+     * Returns true if a reopen should start now: the stream stalled, or a
+     * reopened stream still delivers nothing (until the give-up window ends).
+     */
+    public synchronized boolean checkStall(long nowMs) {
+        if (state == State.STREAMING && nowMs - lastFrameMs > stallTimeoutMs) {
+            stalls++;
+            // The stream went quiet after the last frame, not when we noticed
+            beginFault(Fault.STALL, lastFrameMs, State.RECOVERING);
+            return true;
+        }
+        if (state == State.RECOVERING && reopenedMs >= 0 && nowMs - reopenedMs > stallTimeoutMs) {
+            // Opened fine but silent; go again unless it is time to give up
+            reopenedMs = -1;
+            return !giveUpIfExpired(nowMs);
+        }
+        return false;
+    }
+
+    public synchronized void onDetached(long nowMs) {
+        if (state == State.IDLE || state == State.FAILED) {
+            return;
+        }
+        detaches++;
+        reopenedMs = -1;
+        beginFault(Fault.DETACH, nowMs, State.WAITING_FOR_DEVICE);
+    }
+
+    /**
+     * The device is back. Returns true if a reopen should start.
+     */
+    public synchronized boolean onAttached(long nowMs) {
+        if (state != State.WAITING_FOR_DEVICE) {
+            return false;
+        }
+        state = State.RECOVERING;
+        return true;
+    }
+
+    public synchronized void onReopened(long nowMs) {
+        reopenAttempts++;
+        if (state == State.RECOVERING) {
+            reopenedMs = nowMs;
+        }
+    }
+
+    /**
+     * A reopen attempt failed. Returns the delay before the next attempt,
+     * or -1 once the give-up window has passed.
+     */
+    public synchronized long onReopenFailed(long nowMs) {
+        reopenAttempts++;
+        if (giveUpIfExpired(nowMs)) {
+            return -1;
+        }
+        long delay = RETRY_BACKOFF_MS[Math.min(attempt, RETRY_BACKOFF_MS.length - 1)];
+        attempt++;
+        return delay;
+    }
+
+    /**
+     * Moves to FAILED if the fault has lasted past the give-up window
+     */
+    public synchronized boolean giveUpIfExpired(long nowMs) {
+        if ((state == State.RECOVERING || state == State.WAITING_FOR_DEVICE) && nowMs - faultMs >= giveUpMs) {
+            state = State.FAILED;
+            failures++;
+            return true;
+        }
+        return state == State.FAILED;
+    }
+
+    /**
+     * Back to IDLE (camera stopped). Metrics are kept.
+     */
+    public synchronized void reset() {
+        state = State.IDLE;
+        fault = null;
+        reopenedMs = -1;
+        attempt = 0;
+    }
+
+    private void beginFault(Fault newFault, long startMs, State next) {
+        // A stall that turns out to be a detach keeps the original fault time
+        if (state == State.STREAMING) {
+            faultMs = startMs;
+            attempt = 0;
+        }
+        fault = newFault;
+        state = next;
+    }
+
+    public synchronized State getState() {
+        return state;
+    }
+
+    public synchronized Fault getFault() {
+        return fault;
+    }
+
+    public synchronized boolean isRecovering() {
+        return state == State.RECOVERING || state == State.WAITING_FOR_DEVICE;
+    }
+
+    public synchronized long getGiveUpMs() {
+        return giveUpMs;
+    }
+
+    /**
+     * Fault-to-first-frame time of the last recovery, or -1
+     */
+    public synchronized long getLastRecoveryMs() {
+        return lastRecoveryMs;
+    }
+
+    public synchronized int getRecoveries() {
+        return recoveries;
+    }
+
+    public synchronized int getFailures() {
+        return failures;
+    }
+
+    public synchronized Map<String, Object> getMetricsMap() {
+        Map<String, Object> metrics = new HashMap<>();
+        metrics.put("stalls", stalls);
+        metrics.put("detaches", detaches);
+        metrics.put("recoveries", recoveries);
+        metrics.put("failedRecoveries", failures);
+        metrics.put("reopenAttempts", reopenAttempts);
+        metrics.put("lastRecoveryMs", lastRecoveryMs);
+        metrics.put("maxRecoveryMs", maxRecoveryMs);
+        metrics.put("meanRecoveryMs", recoveries > 0 ? totalRecoveryMs / recoveries : 0);
+        return metrics;
+    }
+}
@@ -1,17 +1,18 @@
 package com.esw.postureanalyzer.vision;
 
-import android.graphics.Bitmap;
-import android.graphics.Matrix;
 import android.util.Size;
 import androidx.appcompat.app.AppCompatActivity;
-import androidx.camera.core.AspectRatio;
 import androidx.camera.core.CameraSelector;
 import androidx.camera.core.ImageAnalysis;
+import androidx.camera.core.ImageProxy;
 import androidx.camera.core.Preview;
 import androidx.camera.lifecycle.ProcessCameraProvider;
 import androidx.camera.view.PreviewView;
 import androidx.core.content.ContextCompat;
 import com.google.common.util.concurrent.ListenableFuture;
+import com.google.mediapipe.framework.image.ByteBufferImageBuilder;
+import com.google.mediapipe.framework.image.MPImage;
+import java.nio.ByteBuffer;
 import java.util.concurrent.ExecutorService;
 import java.util.concurrent.Executors;
 
@@ -21,9 +22,16 @@ public class CameraXManager {
     private final FrameListener listener;
     private final ExecutorService cameraExecutor;
     private ProcessCameraProvider cameraProvider; // Store for explicit unbinding
+    private ByteBuffer packedBuffer; // Reused when the RGBA plane has row padding
+    private volatile MotionGate motionGate; // Optional, skips static frames
+    private Size targetResolution = new Size(1280, 720); // 720p for better quality
 
+    /**
+     * Receives frames in sensor orientation; the image is only valid for the
+     * duration of the call.
+     */
     public interface FrameListener {
-        void onFrame(Bitmap bitmap, int rotationDegrees);
+        void onFrame(MPImage image, int rotationDegrees);
     }
 
     public CameraXManager(AppCompatActivity activity, PreviewView previewView, FrameListener listener) {
@@ -44,18 +52,30 @@ public class CameraXManager {
                         .requireLensFacing(CameraSelector.LENS_FACING_BACK)
                         .build();
 
+                // RGBA output is converted from YUV natively by CameraX into its own
+                // pooled buffers, so frames go to MediaPipe without a Bitmap copy
                 ImageAnalysis imageAnalysis = new ImageAnalysis.Builder()
-                        .setTargetResolution(new Size(1280, 720))  // 720p for better quality
+                        .setTargetResolution(targetResolution)
                         .setBackpressureStrategy(ImageAnalysis.STRATEGY_KEEP_ONLY_LATEST)
+                        .setOutputImageFormat(ImageAnalysis.OUTPUT_IMAGE_FORMAT_RGBA_8888)
                         .build();
 
                 imageAnalysis.setAnalyzer(cameraExecutor, image -> {
-                    Bitmap bitmap = image.toBitmap();
-                    int rotation = image.getImageInfo().getRotationDegrees();
-                    if (bitmap != null) {
-                        listener.onFrame(bitmap, rotation);
+                    try {
+                        MotionGate gate = motionGate;
+                        if (gate != null) {
+                            ImageProxy.PlaneProxy plane = image.getPlanes()[0];
+                            float motion = gate.measureRgba(plane.getBuffer(),
+                                    image.getWidth(), image.getHeight(), plane.getRowStride());
+                            if (!gate.shouldProcess(motion)) {
+                                return;
+                            }
+                        }
+                        int rotation = image.getImageInfo().getRotationDegrees();
+                        listener.onFrame(toMPImage(image), rotation);
+                    } finally {
+                        image.close();
                     }
-                    image.close();
                 });
 
                 cameraProvider.unbindAll();
@@ -66,6 +86,49 @@ public class CameraXManager {
         }, ContextCompat.getMainExecutor(activity));
     }
     
+    /**
+     * Analysis resolution used on the next startCamera()
+     */
+    public void setTargetResolution(int width, int height) {
+        targetResolution = new Size(width, height);
+    }
+
+    public void setMotionGate(MotionGate gate) {
+        this.motionGate = gate;
+    }
+
+    /**
+     * Wrap the RGBA plane of an analysis frame. The plane is used in place when
+     * rows are tightly packed; otherwise rows are copied into a reused buffer.
+     */
+    private MPImage toMPImage(ImageProxy image) {
+        ImageProxy.PlaneProxy plane = image.getPlanes()[0];
+        ByteBuffer pixels = plane.getBuffer();
+        int width = image.getWidth();
+        int height = image.getHeight();
+        int packedStride = width * 4;
+        int rowStride = plane.getRowStride();
+
+        if (rowStride != packedStride) {
+            int size = packedStride * height;
+            if (packedBuffer == null || packedBuffer.capacity() != size) {
+                packedBuffer = ByteBuffer.allocateDirect(size);
+            }
+            packedBuffer.clear();
+            for (int row = 0; row < height; row++) {
+                pixels.limit(row * rowStride + packedStride);
+                pixels.position(row * rowStride);
+                packedBuffer.put(pixels);
+            }
+            packedBuffer.rewind();
+            pixels = packedBuffer;
+        } else {
+            pixels.rewind();
+        }
+
+        return new ByteBufferImageBuilder(pixels, width, height, MPImage.IMAGE_FORMAT_RGBA).build();
+    }
+
     /**
      * Stop the CameraX camera explicitly
      */
@@ -0,0 +1,148 @@
+package com.esw.postureanalyzer.vision;
+
+import android.hardware.usb.UsbDevice;
+import android.hardware.usb.UsbDeviceConnection;
+import android.util.Log;
+
+import java.util.Locale;
+
+/**
+ * Runs the shared capture conformance and throughput suite
+ * (frame_source_conformance.h) against one native backend.
+ *
+ * Every backend goes through the same checks: lifecycle order, descriptor
+ * contents, increasing timestamps and sequence numbers, the lease limit
+ * and restart after stop.
+ */
+public final class CaptureConformance {
+    private static final String TAG = "CaptureConformance";
+
+    private static final int METRIC_COUNT = 7;
+
+    private static boolean nativeAvailable = false;
+
+    static {
+        try {
+            System.loadLibrary("uvccamera");
+            nativeAvailable = true;
+        } catch (UnsatisfiedLinkError e) {
+            Log.e(TAG, "Native library unavailable", e);
+        }
+    }
+
+    private static native String nativeRunSynthetic(int width, int height, int fps, int frames, double[] metrics);
+    private static native String nativeRunReplay(String path, int width, int height, int fps, int frames,
+                                                 double[] metrics);
+    private static native String nativeRunV4L2(String devicePath, int width, int height, int pixelFormat,
+                                               int memory, int frames, double[] metrics);
+    private static native String nativeRunUsbHost(UsbDeviceConnection connection, UsbDevice device,
+                                                  int width, int height, int frames, double[] metrics);
+    private static native boolean nativeRecordSynthetic(String path, int width, int height, int frames);
+
+    /**
+     * Outcome of one backend run. failure is null when every check passed.
+     */
+    public static class Result {
+        public final String backend;
+        public final String failure;
+        public final int frames;
+        public final double fps;
+        public final double wallFps;
+        public final double meanLeaseUs;
+        public final double maxLeaseUs;
+        public final long dropped;
+        public final long timeouts;
+
+        Result(String backend, String failure, double[] metrics) {
+            this.backend = backend;
+            this.failure = failure;
+            this.frames = (int) metrics[0];
+            this.fps = metrics[1];
+            this.wallFps = metrics[2];
+            this.meanLeaseUs = metrics[3];
+            this.maxLeaseUs = metrics[4];
+            this.dropped = (long) metrics[5];
+            this.timeouts = (long) metrics[6];
+        }
+
+        public boolean passed() {
+            return failure == null;
+        }
+
+        @Override
+        public String toString() {
+            if (!passed()) {
+                return backend + " FAILED: " + failure;
+            }
+            return String.format(Locale.US,
+                    "%s: %d frames, %.1f fps (wall %.1f), lease mean %.1fus max %.1fus, %d dropped, %d timeouts",
+                    backend, frames, fps, wallFps, meanLeaseUs, maxLeaseUs, dropped, timeouts);
+        }
+    }
+
+    private CaptureConformance() {
+    }
+
+    public static boolean isAvailable() {
+        return nativeAvailable;
+    }
+
+    /**
+     * Generated YUYV pattern; fps <= 0 measures the unpaced ceiling
+     */
+    public static Result runSynthetic(int width, int height, int fps, int frames) {
+        double[] metrics = new double[METRIC_COUNT];
+        return log(new Result("synthetic", nativeRunSynthetic(width, height, fps, frames, metrics), metrics));
+    }
+
+    /**
+     * Raw YUYV recording, e.g. one written by recordSynthetic
+     */
+    public static Result runReplay(String path, int width, int height, int fps, int frames) {
+        double[] metrics = new double[METRIC_COUNT];
+        return log(new Result("replay", nativeRunReplay(path, width, height, fps, frames, metrics), metrics));
+    }
+
+    /**
+     * Kernel V4L2 node with mmap'd driver buffers; pixelFormat is a V4L2 fourcc
+     */
+    public static Result runV4L2(String devicePath, int width, int height, int pixelFormat, int frames) {
+        return runV4L2(devicePath, width, height, pixelFormat, V4L2MemoryBenchmark.MEMORY_MMAP, frames);
+    }
+
+    /**
+     * Kernel V4L2 node with the given buffer memory (V4L2MemoryBenchmark.MEMORY_*)
+     */
+    public static Result runV4L2(String devicePath, int width, int height, int pixelFormat, int memory,
+                                 int frames) {
+        double[] metrics = new double[METRIC_COUNT];
+        return log(new Result("v4l2-" + V4L2MemoryBenchmark.memoryName(memory),
+                nativeRunV4L2(devicePath, width, height, pixelFormat, memory, frames, metrics), metrics));
+    }
+
+    /**
+     * UVC device over the USB Host API (YUYV); needs a connection with permission granted
+     */
+    public static Result runUsbHost(UsbDeviceConnection connection, UsbDevice device,
+                                    int width, int height, int frames) {
+        double[] metrics = new double[METRIC_COUNT];
+        return log(new Result("uvc-usbhost",
+                nativeRunUsbHost(connection, device, width, height, frames, metrics), metrics));
+    }
+
+    /**
+     * Writes frames of the synthetic pattern to a raw file that runReplay can play
+     */
+    public static boolean recordSynthetic(String path, int width, int height, int frames) {
+        return nativeRecordSynthetic(path, width, height, frames);
+    }
+
+    private static Result log(Result result) {
+        if (result.passed()) {
+            Log.i(TAG, result.toString());
+        } else {
+            Log.e(TAG, result.toString());
+        }
+        return result;
+    }
+}
@@ -11,6 +11,18 @@ import java.util.List;
  * confidence-based quality estimates rather than true accuracy metrics.
  */
 public class EvaluationMetrics {
+    // Key body points (excluding face landmarks for simplicity):
+    // shoulders, elbows, wrists, hips, knees, ankles
+    static final int[] KEY_JOINTS = {11, 12, 13, 14, 15, 16, 23, 24, 25, 26, 27, 28};
+
+    // Joint pairs for the OKS consistency check
+    static final int[][] JOINT_PAIRS = {
+            {11, 13}, {13, 15}, // left arm
+            {12, 14}, {14, 16}, // right arm
+            {11, 23}, {12, 24}, // torso
+            {23, 25}, {25, 27}, // left leg
+            {24, 26}, {26, 28}  // right leg
+    };
 
     /**
      * PDJ (Percentage of Detected Joints) - adapted for live inference.
@@ -21,18 +33,24 @@ public class EvaluationMetrics {
      * @return Percentage of confident detections (0-100)
      */
     public static double calculatePDJ(List<NormalizedLandmark> landmarks, double visibilityThreshold) {
+        double pdj = calculatePDJ(landmarks, visibilityThreshold, null);
+        return Double.isNaN(pdj) ? 0.0 : pdj;
+    }
+
+    /**
+     * PDJ over the key joints whose index is set in scored (all when null);
+     * NaN when none of them are scored
+     */
+    static double calculatePDJ(List<NormalizedLandmark> landmarks, double visibilityThreshold, boolean[] scored) {
         if (landmarks == null || landmarks.isEmpty()) {
-            return 0.0;
+            return Double.NaN;
         }
 
         int confidentKeypoints = 0;
         int totalKeypoints = 0;
 
-        // Check key body points (excluding face landmarks for simplicity)
-        int[] keyJoints = {11, 12, 13, 14, 15, 16, 23, 24, 25, 26, 27, 28}; // shoulders, elbows, wrists, hips, knees, ankles
-
-        for (int idx : keyJoints) {
-            if (idx < landmarks.size()) {
+        for (int idx : KEY_JOINTS) {
+            if (idx < landmarks.size() && (scored == null || scored[idx])) {
                 totalKeypoints++;
                 float visibility = landmarks.get(idx).visibility().orElse(0.0f);
                 if (visibility >= visibilityThreshold) {
@@ -41,7 +59,7 @@ public class EvaluationMetrics {
             }
         }
 
-        return totalKeypoints > 0 ? (confidentKeypoints * 100.0 / totalKeypoints) : 0.0;
+        return totalKeypoints > 0 ? (confidentKeypoints * 100.0 / totalKeypoints) : Double.NaN;
     }
 
     /**
@@ -57,24 +75,25 @@ public class EvaluationMetrics {
      * @return Quality score (0-100), higher is better
      */
     public static double calculateOKS(List<NormalizedLandmark> landmarks) {
+        double oks = calculateOKS(landmarks, null);
+        return Double.isNaN(oks) ? 0.0 : oks;
+    }
+
+    /**
+     * OKS over the joint pairs with both indices set in scored (all when
+     * null); NaN when none of them are scored
+     */
+    static double calculateOKS(List<NormalizedLandmark> landmarks, boolean[] scored) {
         if (landmarks == null || landmarks.isEmpty()) {
-            return 0.0;
+            return Double.NaN;
         }
 
         double totalScore = 0.0;
         int numEvaluated = 0;
 
-        // Define joint pairs for consistency check
-        int[][] jointPairs = {
-                {11, 13}, {13, 15}, // left arm
-                {12, 14}, {14, 16}, // right arm
-                {11, 23}, {12, 24}, // torso
-                {23, 25}, {25, 27}, // left leg
-                {24, 26}, {26, 28}  // right leg
-        };
-
-        for (int[] pair : jointPairs) {
-            if (pair[0] < landmarks.size() && pair[1] < landmarks.size()) {
+        for (int[] pair : JOINT_PAIRS) {
+            if (pair[0] < landmarks.size() && pair[1] < landmarks.size()
+                    && (scored == null || (scored[pair[0]] && scored[pair[1]]))) {
                 NormalizedLandmark lm1 = landmarks.get(pair[0]);
                 NormalizedLandmark lm2 = landmarks.get(pair[1]);
 
@@ -100,7 +119,7 @@ public class EvaluationMetrics {
             }
         }
 
-        return numEvaluated > 0 ? (totalScore * 100.0 / numEvaluated) : 0.0;
+        return numEvaluated > 0 ? (totalScore * 100.0 / numEvaluated) : Double.NaN;
     }
 
     /**
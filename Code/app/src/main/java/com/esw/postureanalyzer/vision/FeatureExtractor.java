@@ -7,6 +7,9 @@ import java.util.List;
 public class FeatureExtractor {
     private static final String TAG = "FeatureExtractor";
 
+    public static final int FEATURE_COUNT = 18;
+    public static final int LANDMARK_STRIDE = 4; // x, y, z, visibility
+
     private static float[] toPixel(NormalizedLandmark lm, int width, int height) {
         if (lm == null) return new float[]{0f, 0f};
         return new float[]{lm.x() * width, lm.y() * height};
@@ -47,30 +50,41 @@ public class FeatureExtractor {
 
     // --- SLOUCH MODEL FEATURES ---
     public static float[] getSlouchFeatures(List<NormalizedLandmark> landmarks, int w, int h) {
-        float[] leftShoulder = toPixel(landmarks.get(11), w, h);
-        float[] rightShoulder = toPixel(landmarks.get(12), w, h);
-        float[] leftHip = toPixel(landmarks.get(23), w, h);
-        float[] rightHip = toPixel(landmarks.get(24), w, h);
+        float[] features = slouchFeatures(
+                toPixel(landmarks.get(11), w, h), toPixel(landmarks.get(12), w, h),
+                toPixel(landmarks.get(23), w, h), toPixel(landmarks.get(24), w, h));
+
+        Log.d(TAG, String.format("Slouch features - torsoTilt: %.2f, leftAngle: %.2f, rightAngle: %.2f",
+                features[0], features[1], features[2]));
 
+        return features;
+    }
+
+    private static float[] slouchFeatures(float[] leftShoulder, float[] rightShoulder,
+                                          float[] leftHip, float[] rightHip) {
         float torsoTilt = angle3Pts(leftShoulder, leftHip, rightShoulder);
         float leftAngle = angle3Pts(leftShoulder, leftHip, rightHip);
         float rightAngle = angle3Pts(rightShoulder, rightHip, leftHip);
 
-        Log.d(TAG, String.format("Slouch features - torsoTilt: %.2f, leftAngle: %.2f, rightAngle: %.2f",
-                torsoTilt, leftAngle, rightAngle));
-
         return new float[]{torsoTilt, leftAngle, rightAngle};
     }
 
     // --- CROSS-LEGGED MODEL FEATURES ---
     public static float[] getCrossLeggedFeatures(List<NormalizedLandmark> landmarks, int w, int h) {
-        float[] leftHip = toPixel(landmarks.get(23), w, h);
-        float[] rightHip = toPixel(landmarks.get(24), w, h);
-        float[] leftKnee = toPixel(landmarks.get(25), w, h);
-        float[] rightKnee = toPixel(landmarks.get(26), w, h);
-        float[] leftAnkle = toPixel(landmarks.get(27), w, h);
-        float[] rightAnkle = toPixel(landmarks.get(28), w, h);
+        float[] features = crossLeggedFeatures(
+                toPixel(landmarks.get(23), w, h), toPixel(landmarks.get(24), w, h),
+                toPixel(landmarks.get(25), w, h), toPixel(landmarks.get(26), w, h),
+                toPixel(landmarks.get(27), w, h), toPixel(landmarks.get(28), w, h));
+
+        Log.d(TAG, String.format("CrossLegged features - leftLeg: %.2f, rightLeg: %.2f, kneeDist: %.2f, ankleDist: %.2f, ankleCross: %.0f, kneeCross: %.0f",
+                features[0], features[1], features[2], features[3], features[4], features[5]));
+
+        return features;
+    }
 
+    private static float[] crossLeggedFeatures(float[] leftHip, float[] rightHip,
+                                               float[] leftKnee, float[] rightKnee,
+                                               float[] leftAnkle, float[] rightAnkle) {
         float leftLegAngle = angle3Pts(leftHip, leftKnee, leftAnkle);
         float rightLegAngle = angle3Pts(rightHip, rightKnee, rightAnkle);
 
@@ -84,28 +98,34 @@ public class FeatureExtractor {
         float ankleCross = leftAnkle[0] > rightAnkle[0] ? 1.0f : 0.0f;
         float kneeCross = leftKnee[0] > rightKnee[0] ? 1.0f : 0.0f;
 
-        Log.d(TAG, String.format("CrossLegged features - leftLeg: %.2f, rightLeg: %.2f, kneeDist: %.2f, ankleDist: %.2f, ankleCross: %.0f, kneeCross: %.0f",
-                leftLegAngle, rightLegAngle, kneeDist, ankleDist, ankleCross, kneeCross));
-
         return new float[]{leftLegAngle, rightLegAngle, kneeDist, ankleDist, ankleCross, kneeCross};
     }
 
     // --- LEANING MODEL FEATURES ---
     public static float[] getLeaningFeatures(List<NormalizedLandmark> landmarks, int w, int h) {
-        float[] lsh = toPixel(landmarks.get(11), w, h);
-        float[] rsh = toPixel(landmarks.get(12), w, h);
-        float[] lhip = toPixel(landmarks.get(23), w, h);
-        float[] rhip = toPixel(landmarks.get(24), w, h);
-        float[] lear = toPixel(landmarks.get(7), w, h);
-        float[] rear = toPixel(landmarks.get(8), w, h);
-
-        float lshVis = landmarks.get(11).visibility().orElse(0.0f);
-        float rshVis = landmarks.get(12).visibility().orElse(0.0f);
-        float lhipVis = landmarks.get(23).visibility().orElse(0.0f);
-        float rhipVis = landmarks.get(24).visibility().orElse(0.0f);
-        float learVis = landmarks.get(7).visibility().orElse(0.0f);
-        float rearVis = landmarks.get(8).visibility().orElse(0.0f);
+        float[] visibility = {
+                landmarks.get(11).visibility().orElse(0.0f),
+                landmarks.get(12).visibility().orElse(0.0f),
+                landmarks.get(23).visibility().orElse(0.0f),
+                landmarks.get(24).visibility().orElse(0.0f),
+                landmarks.get(7).visibility().orElse(0.0f),
+                landmarks.get(8).visibility().orElse(0.0f)
+        };
+        float[] features = leaningFeatures(
+                toPixel(landmarks.get(11), w, h), toPixel(landmarks.get(12), w, h),
+                toPixel(landmarks.get(23), w, h), toPixel(landmarks.get(24), w, h),
+                toPixel(landmarks.get(7), w, h), toPixel(landmarks.get(8), w, h),
+                visibility);
+
+        Log.d(TAG, String.format("Lean features - torsoAngle: %.2f, shoulderAngle: %.2f, headTiltAngle: %.2f",
+                features[0], features[1], features[2]));
+
+        return features;
+    }
 
+    // visibility: left/right shoulder, left/right hip, left/right ear
+    private static float[] leaningFeatures(float[] lsh, float[] rsh, float[] lhip, float[] rhip,
+                                           float[] lear, float[] rear, float[] visibility) {
         float[] midSh = midpoint(lsh, rsh);
         float[] midHip = midpoint(lhip, rhip);
 
@@ -114,9 +134,42 @@ public class FeatureExtractor {
         float shoulderAngle = slopeAngle(lsh, rsh);
         float headTiltAngle = slopeAngle(lear, rear);
 
-        Log.d(TAG, String.format("Lean features - torsoAngle: %.2f, shoulderAngle: %.2f, headTiltAngle: %.2f",
-                torsoAngle, shoulderAngle, headTiltAngle));
+        return new float[]{torsoAngle, shoulderAngle, headTiltAngle,
+                visibility[0], visibility[1], visibility[2], visibility[3], visibility[4], visibility[5]};
+    }
+
+    // --- ALL FEATURES FROM A LANDMARK ARRAY ---
+
+    /**
+     * Slouch (3), cross-legged (6) and leaning (9) features from a flat
+     * [33 * 4] array of normalized x, y, z, visibility. Same math as the
+     * List-based getters; used for offline parity checks with
+     * training/posture_features.py.
+     */
+    public static float[] computeFeatures(float[] landmarks, int w, int h) {
+        float[] slouch = slouchFeatures(pixel(landmarks, 11, w, h), pixel(landmarks, 12, w, h),
+                pixel(landmarks, 23, w, h), pixel(landmarks, 24, w, h));
+        float[] crossLegged = crossLeggedFeatures(pixel(landmarks, 23, w, h), pixel(landmarks, 24, w, h),
+                pixel(landmarks, 25, w, h), pixel(landmarks, 26, w, h),
+                pixel(landmarks, 27, w, h), pixel(landmarks, 28, w, h));
+        float[] visibility = {
+                landmarks[11 * LANDMARK_STRIDE + 3], landmarks[12 * LANDMARK_STRIDE + 3],
+                landmarks[23 * LANDMARK_STRIDE + 3], landmarks[24 * LANDMARK_STRIDE + 3],
+                landmarks[7 * LANDMARK_STRIDE + 3], landmarks[8 * LANDMARK_STRIDE + 3]
+        };
+        float[] leaning = leaningFeatures(pixel(landmarks, 11, w, h), pixel(landmarks, 12, w, h),
+                pixel(landmarks, 23, w, h), pixel(landmarks, 24, w, h),
+                pixel(landmarks, 7, w, h), pixel(landmarks, 8, w, h), visibility);
+
+        float[] features = new float[FEATURE_COUNT];
+        System.arraycopy(slouch, 0, features, 0, slouch.length);
+        System.arraycopy(crossLegged, 0, features, slouch.length, crossLegged.length);
+        System.arraycopy(leaning, 0, features, slouch.length + crossLegged.length, leaning.length);
+        return features;
+    }
 
-        return new float[]{torsoAngle, shoulderAngle, headTiltAngle, lshVis, rshVis, lhipVis, rhipVis, learVis, rearVis};
+    private static float[] pixel(float[] landmarks, int index, int width, int height) {
+        int offset = index * LANDMARK_STRIDE;
+        return new float[]{landmarks[offset] * width, landmarks[offset + 1] * height};
     }
-}
\ No newline at end of file
+}
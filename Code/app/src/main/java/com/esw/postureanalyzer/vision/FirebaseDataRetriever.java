@@ -9,6 +9,7 @@ import com.google.firebase.database.FirebaseDatabase;
 import com.google.firebase.database.Query;
 import com.google.firebase.database.ValueEventListener;
 import java.util.ArrayList;
+import java.util.Calendar;
 import java.util.HashMap;
 import java.util.List;
 import java.util.Map;
@@ -20,14 +21,60 @@ import java.util.Map;
 public class FirebaseDataRetriever {
     private static final String TAG = "FirebaseDataRetriever";
     private final DatabaseReference database;
+    private final DatabaseReference dailyAggregates;
+    // Records read and written per migration round trip
+    private static final int MIGRATION_PAGE_SIZE = 500;
     
     // Regional database URL for Asia Southeast
     private static final String DATABASE_URL = "https://postureanalyzer-b24a3-default-rtdb.asia-southeast1.firebasedatabase.app";
 
+    // Lookup tables indexed by PostureState code
+    private static final int BODY_HEAD = 0;
+    private static final int BODY_NECK = 1;
+    private static final int BODY_SHOULDER_LEFT = 2;
+    private static final int BODY_SHOULDER_RIGHT = 3;
+    private static final int BODY_BACK_UPPER = 4;
+    private static final int BODY_BACK_LOWER = 5;
+    private static final int BODY_HIP = 6;
+    private static final int BODY_PART_COUNT = 7;
+
+    private static final int[] GOOD_POSTURE = new int[PostureState.CODE_COUNT];
+    // 1 where the slouch model produced a result; UNKNOWN samples don't count towards scores
+    private static final int[] SLOUCH_KNOWN = new int[PostureState.CODE_COUNT];
+    private static final int[][] BODY_ISSUES = new int[PostureState.CODE_COUNT][BODY_PART_COUNT];
+
+    static {
+        for (int code = 0; code < PostureState.CODE_COUNT; code++) {
+            GOOD_POSTURE[code] = PostureState.isGoodPosture(code) ? 1 : 0;
+            SLOUCH_KNOWN[code] = PostureState.slouch(code) != PostureState.UNKNOWN ? 1 : 0;
+
+            int[] issues = BODY_ISSUES[code];
+            // Upper back is one issue per sample whether from slouching, leaning or both
+            if (PostureState.isSlouching(code)) {
+                issues[BODY_HEAD]++;
+                issues[BODY_NECK]++;
+                issues[BODY_BACK_UPPER] = 1;
+            }
+            int lean = PostureState.lean(code);
+            if (lean == PostureState.LEAN_LEFT) {
+                issues[BODY_SHOULDER_LEFT]++;
+                issues[BODY_BACK_UPPER] = 1;
+            } else if (lean == PostureState.LEAN_RIGHT) {
+                issues[BODY_SHOULDER_RIGHT]++;
+                issues[BODY_BACK_UPPER] = 1;
+            }
+            if (PostureState.legs(code) == PostureState.LEGS_CROSSED) {
+                issues[BODY_HIP]++;
+                issues[BODY_BACK_LOWER]++;
+            }
+        }
+    }
+
     public FirebaseDataRetriever() {
         // Use the regional database instance
         FirebaseDatabase firebaseDatabase = FirebaseDatabase.getInstance(DATABASE_URL);
         database = firebaseDatabase.getReference("posture_logs");
+        dailyAggregates = firebaseDatabase.getReference("daily_aggregates");
     }
 
     /**
@@ -72,10 +119,7 @@ public class FirebaseDataRetriever {
      * @param callback Callback to receive results
      */
     public void getSlouchingData(DataCallback callback) {
-        Query query = database.orderByChild("posture/slouch")
-                .equalTo("Slouching");
-
-        executeQuery(query, callback);
+        executeStateQuery(PostureState::isSlouching, callback);
     }
 
     /**
@@ -84,10 +128,7 @@ public class FirebaseDataRetriever {
      * @param callback Callback to receive results
      */
     public void getCrossLeggedData(DataCallback callback) {
-        Query query = database.orderByChild("posture/legs")
-                .equalTo("Cross-legged");
-
-        executeQuery(query, callback);
+        executeStateQuery(code -> PostureState.legs(code) == PostureState.LEGS_CROSSED, callback);
     }
 
     /**
@@ -97,10 +138,8 @@ public class FirebaseDataRetriever {
      * @param callback Callback to receive results
      */
     public void getLeaningData(String direction, DataCallback callback) {
-        Query query = database.orderByChild("posture/lean")
-                .equalTo(direction);
-
-        executeQuery(query, callback);
+        int lean = PostureState.parseLean(direction);
+        executeStateQuery(code -> PostureState.lean(code) == lean, callback);
     }
 
     /**
@@ -134,7 +173,9 @@ public class FirebaseDataRetriever {
     }
 
     /**
-     * Statistics class holding posture analysis results
+     * Statistics class holding posture analysis results. Percentages are over
+     * the entries where that classifier produced a result; UNKNOWN fields
+     * (landmarks gated off by VisibilityGate) are left out.
      */
     public static class PostureStatistics {
         public int totalEntries;
@@ -149,16 +190,29 @@ public class FirebaseDataRetriever {
         public double avgOks;
         public double avgInferenceTime;
 
+        /** Entries with a slouch result (excludes UNKNOWN, e.g. torso not visible) */
+        public int getSlouchSamples() {
+            return slouchingCount + goodPostureCount;
+        }
+
+        /** Entries with a legs result (excludes UNKNOWN, e.g. legs under the desk) */
+        public int getLegsSamples() {
+            return crossLeggedCount + normalLegsCount;
+        }
+
         public double getSlouchingPercentage() {
-            return totalEntries > 0 ? (slouchingCount * 100.0 / totalEntries) : 0.0;
+            int samples = getSlouchSamples();
+            return samples > 0 ? (slouchingCount * 100.0 / samples) : 0.0;
         }
 
         public double getGoodPosturePercentage() {
-            return totalEntries > 0 ? (goodPostureCount * 100.0 / totalEntries) : 0.0;
+            int samples = getSlouchSamples();
+            return samples > 0 ? (goodPostureCount * 100.0 / samples) : 0.0;
         }
 
         public double getCrossLeggedPercentage() {
-            return totalEntries > 0 ? (crossLeggedCount * 100.0 / totalEntries) : 0.0;
+            int samples = getLegsSamples();
+            return samples > 0 ? (crossLeggedCount * 100.0 / samples) : 0.0;
         }
 
         @Override
@@ -185,81 +239,140 @@ public class FirebaseDataRetriever {
      * Calculate statistics from a list of data entries
      */
     private PostureStatistics calculateStatistics(List<Map<String, Object>> data) {
-        PostureStatistics stats = new PostureStatistics();
-        
-        try {
-            if (data == null || data.isEmpty()) {
-                Log.d(TAG, "No data to calculate statistics");
-                return stats;
+        if (data == null || data.isEmpty()) {
+            Log.d(TAG, "No data to calculate statistics");
+            return new PostureStatistics();
+        }
+
+        // Posture counts are accumulated as a histogram over state codes
+        // and folded into per-field counters once at the end
+        PostureAggregate aggregate = new PostureAggregate(null);
+        for (Map<String, Object> entry : data) {
+            try {
+                aggregate.addRecord(entry);
+            } catch (Exception e) {
+                Log.e(TAG, "Error processing entry in statistics", e);
+                // Continue processing other entries
             }
-            
-            stats.totalEntries = data.size();
+        }
 
-            double totalPdj = 0;
-            double totalOks = 0;
-            double totalInferenceTime = 0;
-            int pdjCount = 0;
-            int oksCount = 0;
-            int inferenceCount = 0;
+        Log.d(TAG, "Statistics calculated: " + aggregate.totalEntries + " entries");
+        return aggregate.toStatistics();
+    }
 
-            for (Map<String, Object> entry : data) {
-                try {
-                    // Posture analysis
-                    @SuppressWarnings("unchecked")
-                    Map<String, String> posture = (Map<String, String>) entry.get("posture");
-                    if (posture != null) {
-                        String slouch = posture.get("slouch");
-                        if ("Slouching".equals(slouch) || "yes".equals(slouch)) stats.slouchingCount++;
-                        if ("Good Posture".equals(slouch) || "no".equals(slouch)) stats.goodPostureCount++;
-
-                        String legs = posture.get("legs");
-                        if ("Cross-legged".equals(legs) || "yes".equals(legs)) stats.crossLeggedCount++;
-                        if ("Normal".equals(legs) || "no".equals(legs)) stats.normalLegsCount++;
-
-                        String lean = posture.get("lean");
-                        if ("Left".equals(lean) || "left".equals(lean)) stats.leanLeftCount++;
-                        if ("Right".equals(lean) || "right".equals(lean)) stats.leanRightCount++;
-                        if ("Upright".equals(lean) || "upright".equals(lean)) stats.uprightCount++;
-                    }
+    /**
+     * Fold a state-code histogram into the per-field counters of PostureStatistics
+     */
+    static void foldStateHistogram(int[] histogram, PostureStatistics stats) {
+        for (int code = 0; code < PostureState.CODE_COUNT; code++) {
+            int count = histogram[code];
+            if (count == 0) continue;
+
+            switch (PostureState.slouch(code)) {
+                case PostureState.SLOUCH_SLOUCHING: stats.slouchingCount += count; break;
+                case PostureState.SLOUCH_GOOD: stats.goodPostureCount += count; break;
+                default: break;
+            }
+            switch (PostureState.legs(code)) {
+                case PostureState.LEGS_CROSSED: stats.crossLeggedCount += count; break;
+                case PostureState.LEGS_NORMAL: stats.normalLegsCount += count; break;
+                default: break;
+            }
+            switch (PostureState.lean(code)) {
+                case PostureState.LEAN_LEFT: stats.leanLeftCount += count; break;
+                case PostureState.LEAN_RIGHT: stats.leanRightCount += count; break;
+                case PostureState.LEAN_UPRIGHT: stats.uprightCount += count; break;
+                default: break;
+            }
+        }
+    }
 
-                    // Metrics analysis
-                    @SuppressWarnings("unchecked")
-                    Map<String, Object> metrics = (Map<String, Object>) entry.get("metrics");
-                    if (metrics != null) {
-                        if (metrics.containsKey("pdj")) {
-                            totalPdj += ((Number) metrics.get("pdj")).doubleValue();
-                            pdjCount++;
-                        }
-                        if (metrics.containsKey("oks")) {
-                            totalOks += ((Number) metrics.get("oks")).doubleValue();
-                            oksCount++;
-                        }
-                    }
+    /**
+     * Decode the state code of a posture_logs snapshot (packed or legacy)
+     */
+    private static byte readState(DataSnapshot child) {
+        Long state = child.child("state").getValue(Long.class);
+        if (state != null) {
+            return (byte) state.intValue();
+        }
+        Object posture = child.child("posture").getValue();
+        return posture instanceof Map ? PostureState.fromLegacy((Map<?, ?>) posture) : PostureState.ABSENT;
+    }
 
-                    // Performance analysis
-                    if (entry.containsKey("inferenceTimeMs")) {
-                        totalInferenceTime += ((Number) entry.get("inferenceTimeMs")).doubleValue();
-                        inferenceCount++;
-                    } else if (entry.containsKey("inferenceTime")) {
-                        totalInferenceTime += ((Number) entry.get("inferenceTime")).doubleValue();
-                        inferenceCount++;
-                    }
-                } catch (Exception e) {
-                    Log.e(TAG, "Error processing entry in statistics", e);
-                    // Continue processing other entries
+    /**
+     * Predicate over state codes used by the filtered queries
+     */
+    private interface StateFilter {
+        boolean accept(int code);
+    }
+
+    /**
+     * Query the entries whose state passes the filter on the server, using
+     * the "state" index. Accepted codes are collapsed into ranges with one
+     * range query each; codes encode() never produces (bit 6 set, slouch or
+     * legs of 3) can't match anything, so they bridge two accepted codes
+     * instead of splitting the range. Lean is the high field, so a lean
+     * filter is a single range; slouch is the low field and takes one query
+     * per lean/legs combination.
+     * Records still carrying only the legacy "posture" map are not matched
+     * until migrateLegacyRecords() has given them a state.
+     */
+    private void executeStateQuery(StateFilter filter, DataCallback callback) {
+        List<int[]> ranges = new ArrayList<>();
+        // Last writable code seen; a range is extended only if nothing
+        // writable and rejected came after its end
+        int lastWritable = -1;
+        for (int code = PostureState.PRESENCE_BIT; code < PostureState.CODE_COUNT; code++) {
+            if (!PostureState.isWritable(code)) {
+                continue;
+            }
+            if (filter.accept(code)) {
+                int[] last = ranges.isEmpty() ? null : ranges.get(ranges.size() - 1);
+                if (last != null && last[1] == lastWritable) {
+                    last[1] = code;
+                } else {
+                    ranges.add(new int[]{code, code});
                 }
             }
+            lastWritable = code;
+        }
+        if (ranges.isEmpty()) {
+            callback.onDataReceived(new ArrayList<>());
+            return;
+        }
 
-            stats.avgPdj = pdjCount > 0 ? totalPdj / pdjCount : 0;
-            stats.avgOks = oksCount > 0 ? totalOks / oksCount : 0;
-            stats.avgInferenceTime = inferenceCount > 0 ? totalInferenceTime / inferenceCount : 0;
+        List<Map<String, Object>> merged = new ArrayList<>();
+        int[] pending = {ranges.size()};
+        boolean[] failed = {false};
+        for (int[] range : ranges) {
+            Query query = database.orderByChild("state").startAt(range[0]).endAt(range[1]);
+            executeQuery(query, new DataCallback() {
+                @Override
+                public void onDataReceived(List<Map<String, Object>> data) {
+                    if (failed[0]) {
+                        return;
+                    }
+                    merged.addAll(data);
+                    if (--pending[0] == 0) {
+                        merged.sort((a, b) -> Long.compare(timestampOf(a), timestampOf(b)));
+                        callback.onDataReceived(merged);
+                    }
+                }
 
-            Log.d(TAG, "Statistics calculated: " + stats.totalEntries + " entries");
-        } catch (Exception e) {
-            Log.e(TAG, "Error calculating statistics", e);
+                @Override
+                public void onError(String error) {
+                    if (!failed[0]) {
+                        failed[0] = true;
+                        callback.onError(error);
+                    }
+                }
+            });
         }
+    }
 
-        return stats;
+    private static long timestampOf(Map<String, Object> entry) {
+        Object timestamp = entry.get("timestamp");
+        return timestamp instanceof Number ? ((Number) timestamp).longValue() : 0L;
     }
 
     /**
@@ -322,7 +435,9 @@ public class FirebaseDataRetriever {
     }
 
     /**
-     * Delete all entries older than a specified time
+     * Delete all entries older than a specified time, together with the
+     * cached daily aggregates of every day they were in (including the
+     * partly deleted day containing olderThan)
      *
      * @param olderThan Timestamp (milliseconds) - delete entries before this time
      */
@@ -337,6 +452,7 @@ public class FirebaseDataRetriever {
                     child.getRef().removeValue();
                     deleteCount++;
                 }
+                deleteAggregatesThrough(PostureAggregate.dayKey(olderThan));
                 callback.onDeleteComplete(deleteCount);
             }
 
@@ -347,11 +463,276 @@ public class FirebaseDataRetriever {
         });
     }
 
+    private void deleteAggregatesThrough(String lastDay) {
+        dailyAggregates.orderByKey().endAt(lastDay).addListenerForSingleValueEvent(new ValueEventListener() {
+            @Override
+            public void onDataChange(@NonNull DataSnapshot snapshot) {
+                for (DataSnapshot child : snapshot.getChildren()) {
+                    child.getRef().removeValue();
+                }
+            }
+
+            @Override
+            public void onCancelled(@NonNull DatabaseError error) {
+                Log.w(TAG, "Could not delete daily aggregates: " + error.getMessage());
+            }
+        });
+    }
+
     public interface DeleteCallback {
         void onDeleteComplete(int count);
         void onError(String error);
     }
 
+    /**
+     * One-time migration of legacy records: gives every record that only has
+     * the "posture" label map its packed "state" code. Runs in pages of
+     * MIGRATION_PAGE_SIZE records by key, one multi-path update per page, and
+     * leaves "posture" in place for readers that have not switched over yet
+     * (see dropLegacyPostureFields()).
+     */
+    public void migrateLegacyRecords(MigrationCallback callback) {
+        migratePage(null, 0, false, callback);
+    }
+
+    /**
+     * Second migration step, once no reader depends on the label map any
+     * more: removes "posture" from records that already carry "state".
+     * Paged the same way as migrateLegacyRecords().
+     */
+    public void dropLegacyPostureFields(MigrationCallback callback) {
+        migratePage(null, 0, true, callback);
+    }
+
+    private void migratePage(String afterKey, int migrated, boolean dropLegacy, MigrationCallback callback) {
+        Query page = database.orderByKey();
+        if (afterKey != null) {
+            page = page.startAfter(afterKey);
+        }
+        page.limitToFirst(MIGRATION_PAGE_SIZE).addListenerForSingleValueEvent(new ValueEventListener() {
+            @Override
+            public void onDataChange(@NonNull DataSnapshot snapshot) {
+                Map<String, Object> updates = new HashMap<>();
+                String lastKey = null;
+                int children = 0;
+                for (DataSnapshot child : snapshot.getChildren()) {
+                    lastKey = child.getKey();
+                    children++;
+                    if (!child.hasChild("posture")) {
+                        continue;
+                    }
+                    if (dropLegacy && child.hasChild("state")) {
+                        updates.put(lastKey + "/posture", null);
+                    } else if (!dropLegacy && !child.hasChild("state")) {
+                        updates.put(lastKey + "/state", PostureState.index(readState(child)));
+                    }
+                }
+
+                int total = migrated + updates.size();
+                boolean lastPage = children < MIGRATION_PAGE_SIZE;
+                if (updates.isEmpty()) {
+                    continuePaging(lastPage, lastKey, total, dropLegacy, callback);
+                    return;
+                }
+                String resumeKey = lastKey;
+                database.updateChildren(updates)
+                    .addOnSuccessListener(aVoid -> continuePaging(lastPage, resumeKey, total, dropLegacy, callback))
+                    .addOnFailureListener(e -> callback.onError("Migration failed: " + e.getMessage()));
+            }
+
+            @Override
+            public void onCancelled(@NonNull DatabaseError error) {
+                callback.onError("Database error: " + error.getMessage());
+            }
+        });
+    }
+
+    private void continuePaging(boolean lastPage, String lastKey, int migrated, boolean dropLegacy,
+                                MigrationCallback callback) {
+        if (lastPage || lastKey == null) {
+            Log.d(TAG, (dropLegacy ? "Dropped legacy posture maps from " : "Migrated ")
+                    + migrated + " legacy posture records");
+            callback.onMigrationComplete(migrated);
+        } else {
+            migratePage(lastKey, migrated, dropLegacy, callback);
+        }
+    }
+
+    public interface MigrationCallback {
+        void onMigrationComplete(int migratedCount);
+        void onError(String error);
+    }
+
+    /**
+     * Receives per-day aggregates in chronological order
+     */
+    public interface DailyAggregateCallback {
+        void onDayReady(PostureAggregate day);
+        void onComplete(int scannedDays);
+        void onError(String error);
+
+        /** Checked before each day; once true no further days are scanned or delivered */
+        default boolean isCancelled() {
+            return false;
+        }
+    }
+
+    /**
+     * Stream per-day aggregates for a time range.
+     *
+     * Cached days come from daily_aggregates in a single query. The remaining
+     * days are scanned from posture_logs one at a time, so at most one day of
+     * raw records is held in memory, and complete days before today are
+     * written back to the cache.
+     */
+    public void getDailyAggregates(long startTime, long endTime, DailyAggregateCallback callback) {
+        List<DayWindow> days = dayWindows(startTime, endTime);
+        if (days.isEmpty()) {
+            callback.onComplete(0);
+            return;
+        }
+
+        dailyAggregates.orderByKey()
+                .startAt(days.get(0).key)
+                .endAt(days.get(days.size() - 1).key)
+                .addListenerForSingleValueEvent(new ValueEventListener() {
+            @Override
+            public void onDataChange(@NonNull DataSnapshot snapshot) {
+                Map<String, PostureAggregate> cached = new HashMap<>();
+                for (DataSnapshot child : snapshot.getChildren()) {
+                    Object value = child.getValue();
+                    if (value instanceof Map) {
+                        cached.put(child.getKey(), PostureAggregate.fromMap(child.getKey(), (Map<?, ?>) value));
+                    }
+                }
+                Log.d(TAG, "Daily aggregates: " + cached.size() + "/" + days.size() + " days cached");
+                streamDays(days, 0, cached, 0, callback);
+            }
+
+            @Override
+            public void onCancelled(@NonNull DatabaseError error) {
+                // Cache unreadable (e.g. rules not deployed yet): scan every day
+                Log.w(TAG, "Daily aggregate cache unavailable: " + error.getMessage());
+                streamDays(days, 0, new HashMap<>(), 0, callback);
+            }
+        });
+    }
+
+    /**
+     * Deliver cached days directly and scan the next uncached day, chaining
+     * the following days from its listener
+     */
+    private void streamDays(List<DayWindow> days, int index, Map<String, PostureAggregate> cached,
+                            int scanned, DailyAggregateCallback callback) {
+        if (callback.isCancelled()) {
+            Log.d(TAG, "Daily aggregates cancelled after " + index + "/" + days.size() + " days");
+            return;
+        }
+        while (index < days.size()) {
+            DayWindow day = days.get(index);
+            PostureAggregate hit = day.cacheable ? cached.get(day.key) : null;
+            if (hit == null) {
+                break;
+            }
+            callback.onDayReady(hit);
+            index++;
+        }
+        if (index == days.size()) {
+            callback.onComplete(scanned);
+            return;
+        }
+
+        DayWindow day = days.get(index);
+        int next = index + 1;
+        Query query = database.orderByChild("timestamp")
+                .startAt(day.start)
+                .endAt(day.end);
+
+        query.addListenerForSingleValueEvent(new ValueEventListener() {
+            @Override
+            public void onDataChange(@NonNull DataSnapshot snapshot) {
+                PostureAggregate aggregate = new PostureAggregate(day.key);
+                try {
+                    for (DataSnapshot child : snapshot.getChildren()) {
+                        try {
+                            Object value = child.getValue();
+                            if (value instanceof Map) {
+                                @SuppressWarnings("unchecked")
+                                Map<String, Object> record = (Map<String, Object>) value;
+                                aggregate.addRecord(record);
+                            }
+                        } catch (Exception e) {
+                            Log.e(TAG, "Error processing entry", e);
+                        }
+                    }
+                    if (day.cacheable) {
+                        dailyAggregates.child(day.key).setValue(aggregate.toMap());
+                    }
+                    callback.onDayReady(aggregate);
+                } catch (Exception e) {
+                    Log.e(TAG, "Error aggregating " + day.key, e);
+                    callback.onError("Error: " + e.getMessage());
+                    return;
+                }
+                streamDays(days, next, cached, scanned + 1, callback);
+            }
+
+            @Override
+            public void onCancelled(@NonNull DatabaseError error) {
+                callback.onError("Database error: " + error.getMessage());
+            }
+        });
+    }
+
+    /**
+     * Local-time day windows covering [startTime, endTime]. Only whole days
+     * that ended before today are cacheable; callers that only zero the time
+     * down to the second still count as covering the whole day.
+     */
+    private static List<DayWindow> dayWindows(long startTime, long endTime) {
+        List<DayWindow> days = new ArrayList<>();
+        Calendar cal = Calendar.getInstance();
+        cal.set(Calendar.HOUR_OF_DAY, 0);
+        cal.set(Calendar.MINUTE, 0);
+        cal.set(Calendar.SECOND, 0);
+        cal.set(Calendar.MILLISECOND, 0);
+        long todayStart = cal.getTimeInMillis();
+
+        cal.setTimeInMillis(startTime);
+        cal.set(Calendar.HOUR_OF_DAY, 0);
+        cal.set(Calendar.MINUTE, 0);
+        cal.set(Calendar.SECOND, 0);
+        cal.set(Calendar.MILLISECOND, 0);
+        while (cal.getTimeInMillis() <= endTime) {
+            long dayStart = cal.getTimeInMillis();
+            String key = PostureAggregate.dayKey(dayStart);
+            cal.add(Calendar.DAY_OF_YEAR, 1);
+            long dayEnd = cal.getTimeInMillis() - 1;
+
+            boolean wholeDay = startTime - dayStart < 1000 && dayEnd - endTime < 1000;
+            if (wholeDay && dayEnd < todayStart) {
+                days.add(new DayWindow(key, dayStart, dayEnd, true));
+            } else {
+                days.add(new DayWindow(key, Math.max(dayStart, startTime), Math.min(dayEnd, endTime), false));
+            }
+        }
+        return days;
+    }
+
+    private static class DayWindow {
+        final String key;
+        final long start;
+        final long end;
+        final boolean cacheable;
+
+        DayWindow(String key, long start, long end, boolean cacheable) {
+            this.key = key;
+            this.start = start;
+            this.end = end;
+            this.cacheable = cacheable;
+        }
+    }
+
     /**
      * Callback interface for heatmap data
      */
@@ -400,9 +781,9 @@ public class FirebaseDataRetriever {
                             int hour = cal.get(java.util.Calendar.HOUR_OF_DAY);
 
                             // Get posture data
-                            DataSnapshot postureSnap = child.child("posture");
-                            String slouch = postureSnap.child("slouch").getValue(String.class);
-                            boolean isGoodPosture = "Good Posture".equals(slouch);
+                            int code = PostureState.index(readState(child));
+                            int good = GOOD_POSTURE[code];
+                            int known = SLOUCH_KNOWN[code];
 
                             // Aggregate by day
                             DayStats dayStats = dayStatsMap.get(dateKey);
@@ -411,7 +792,8 @@ public class FirebaseDataRetriever {
                                 dayStatsMap.put(dateKey, dayStats);
                             }
                             dayStats.totalCount++;
-                            if (isGoodPosture) dayStats.goodCount++;
+                            dayStats.knownCount += known;
+                            dayStats.goodCount += good;
 
                             // Aggregate by hour
                             HourStats hourStats = hourStatsMap.get(hour);
@@ -420,7 +802,8 @@ public class FirebaseDataRetriever {
                                 hourStatsMap.put(hour, hourStats);
                             }
                             hourStats.totalCount++;
-                            if (isGoodPosture) hourStats.goodCount++;
+                            hourStats.knownCount += known;
+                            hourStats.goodCount += good;
 
                         } catch (Exception e) {
                             Log.e(TAG, "Error processing entry", e);
@@ -479,40 +862,38 @@ public class FirebaseDataRetriever {
                         return;
                     }
 
+                    int[] stateHistogram = new int[PostureState.CODE_COUNT];
+
                     for (DataSnapshot child : snapshot.getChildren()) {
                         try {
-                            DataSnapshot postureSnap = child.child("posture");
-                            String slouch = postureSnap.child("slouch").getValue(String.class);
-                            String lean = postureSnap.child("lean").getValue(String.class);
-                            String legs = postureSnap.child("legs").getValue(String.class);
-
-                            stats.totalCount++;
-
-                            // Count issues
-                            if ("Slouching".equals(slouch)) {
-                                stats.headIssues++;
-                                stats.neckIssues++;
-                                stats.backUpperIssues++;
-                            }
-
-                            if ("Left".equals(lean)) {
-                                stats.shoulderLeftIssues++;
-                                stats.backUpperIssues++;
-                            } else if ("Right".equals(lean)) {
-                                stats.shoulderRightIssues++;
-                                stats.backUpperIssues++;
-                            }
-
-                            if ("Cross-legged".equals(legs)) {
-                                stats.hipIssues++;
-                                stats.backLowerIssues++;
-                            }
-
+                            stateHistogram[PostureState.index(readState(child))]++;
                         } catch (Exception e) {
                             Log.e(TAG, "Error processing entry", e);
                         }
                     }
 
+                    // Count issues and, per field, the samples where it is known
+                    for (int code = 0; code < PostureState.CODE_COUNT; code++) {
+                        int count = stateHistogram[code];
+                        if (count == 0 || !PostureState.isPresent(code)) continue;
+                        stats.totalCount += count;
+                        boolean slouchKnown = PostureState.slouch(code) != PostureState.UNKNOWN;
+                        boolean leanKnown = PostureState.lean(code) != PostureState.UNKNOWN;
+                        if (slouchKnown) stats.slouchSamples += count;
+                        if (leanKnown) stats.leanSamples += count;
+                        if (slouchKnown || leanKnown) stats.upperBackSamples += count;
+                        if (PostureState.legs(code) != PostureState.UNKNOWN) stats.legsSamples += count;
+
+                        int[] issues = BODY_ISSUES[code];
+                        stats.headIssues += issues[BODY_HEAD] * count;
+                        stats.neckIssues += issues[BODY_NECK] * count;
+                        stats.shoulderLeftIssues += issues[BODY_SHOULDER_LEFT] * count;
+                        stats.shoulderRightIssues += issues[BODY_SHOULDER_RIGHT] * count;
+                        stats.backUpperIssues += issues[BODY_BACK_UPPER] * count;
+                        stats.backLowerIssues += issues[BODY_BACK_LOWER] * count;
+                        stats.hipIssues += issues[BODY_HIP] * count;
+                    }
+
                     callback.onBodyHeatmapReady(stats);
 
                 } catch (Exception e) {
@@ -537,6 +918,7 @@ public class FirebaseDataRetriever {
     private static class DayStats {
         String date;
         int totalCount = 0;
+        int knownCount = 0; // samples with a slouch result
         int goodCount = 0;
 
         DayStats(String date) {
@@ -544,13 +926,14 @@ public class FirebaseDataRetriever {
         }
 
         float getScore() {
-            return totalCount > 0 ? (goodCount * 100f / totalCount) : 0;
+            return knownCount > 0 ? (goodCount * 100f / knownCount) : 0;
         }
     }
 
     private static class HourStats {
         int hour;
         int totalCount = 0;
+        int knownCount = 0; // samples with a slouch result
         int goodCount = 0;
 
         HourStats(int hour) {
@@ -558,12 +941,22 @@ public class FirebaseDataRetriever {
         }
 
         float getScore() {
-            return totalCount > 0 ? (goodCount * 100f / totalCount) : 0;
+            return knownCount > 0 ? (goodCount * 100f / knownCount) : 0;
         }
     }
 
+    /**
+     * Issue counts per body region. Each region's heat is over the samples
+     * where the field driving it is known: slouch for head and neck, lean
+     * for the shoulders, legs for hips and lower back, and slouch or lean
+     * for the upper back. Absent samples are not counted.
+     */
     public static class BodyHeatStats {
-        public int totalCount = 0;
+        public int totalCount = 0; // samples with a person present
+        public int slouchSamples = 0;
+        public int leanSamples = 0;
+        public int legsSamples = 0;
+        public int upperBackSamples = 0;
         public int headIssues = 0;
         public int neckIssues = 0;
         public int shoulderLeftIssues = 0;
@@ -572,32 +965,36 @@ public class FirebaseDataRetriever {
         public int backLowerIssues = 0;
         public int hipIssues = 0;
 
+        private static float heat(int issues, int samples) {
+            return samples > 0 ? (issues * 100f / samples) : 0;
+        }
+
         public float getHeadHeat() {
-            return totalCount > 0 ? (headIssues * 100f / totalCount) : 0;
+            return heat(headIssues, slouchSamples);
         }
 
         public float getNeckHeat() {
-            return totalCount > 0 ? (neckIssues * 100f / totalCount) : 0;
+            return heat(neckIssues, slouchSamples);
         }
 
         public float getShoulderLeftHeat() {
-            return totalCount > 0 ? (shoulderLeftIssues * 100f / totalCount) : 0;
+            return heat(shoulderLeftIssues, leanSamples);
         }
 
         public float getShoulderRightHeat() {
-            return totalCount > 0 ? (shoulderRightIssues * 100f / totalCount) : 0;
+            return heat(shoulderRightIssues, leanSamples);
         }
 
         public float getBackUpperHeat() {
-            return totalCount > 0 ? (backUpperIssues * 100f / totalCount) : 0;
+            return heat(backUpperIssues, upperBackSamples);
         }
 
         public float getBackLowerHeat() {
-            return totalCount > 0 ? (backLowerIssues * 100f / totalCount) : 0;
+            return heat(backLowerIssues, legsSamples);
         }
 
         public float getHipHeat() {
-            return totalCount > 0 ? (hipIssues * 100f / totalCount) : 0;
+            return heat(hipIssues, legsSamples);
         }
     }
 }
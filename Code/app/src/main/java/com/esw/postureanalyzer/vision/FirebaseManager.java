@@ -14,6 +14,7 @@ import java.util.Map;
 
 public class FirebaseManager {
     private static final String TAG = "FirebaseManager";
+    private final DatabaseReference root;
     private final DatabaseReference database;
     private final boolean storeLandmarks; // Toggle for storing landmark data
     
@@ -22,6 +23,7 @@ public class FirebaseManager {
     
     // Throttle logging to avoid excessive writes
     private long lastLogTime = 0;
+    private final Map<Integer, Long> lastPersonLogTimes = new HashMap<>(); // Per tracked person
     private static final long LOG_INTERVAL_MS = 2000; // Log every 2 seconds
 
     public FirebaseManager() {
@@ -31,7 +33,8 @@ public class FirebaseManager {
     public FirebaseManager(boolean storeLandmarks) {
         // Use the regional database instance
         FirebaseDatabase firebaseDatabase = FirebaseDatabase.getInstance(DATABASE_URL);
-        database = firebaseDatabase.getReference("posture_logs");
+        root = firebaseDatabase.getReference();
+        database = root.child("posture_logs");
         this.storeLandmarks = storeLandmarks;
     }
 
@@ -62,12 +65,8 @@ public class FirebaseManager {
         logEntry.put("timestamp", currentTime);
         logEntry.put("date", new SimpleDateFormat("yyyy-MM-dd HH:mm:ss", Locale.getDefault()).format(new Date(currentTime)));
         
-        // Posture classification results
-        Map<String, String> postureData = new HashMap<>();
-        postureData.put("slouch", result.getSlouchStatus());
-        postureData.put("legs", result.getLegsStatus());
-        postureData.put("lean", result.getLeanStatus());
-        logEntry.put("posture", postureData);
+        // Posture classification results (packed PostureState code)
+        logEntry.put("state", PostureState.index(result.getStateCode()));
         
         // Calculate and store evaluation metrics
         if (landmarks != null && !landmarks.isEmpty()) {
@@ -94,22 +93,43 @@ public class FirebaseManager {
         }
 
         // Write to Firebase
-        database.child(logId).setValue(logEntry);
+        writeLogEntry(logId, logEntry, currentTime);
     }
 
     /**
-     * Log posture data with additional metrics information
+     * Log posture data with additional metrics information. The image size is
+     * stored with the landmarks so archives can be re-scored offline
+     * (training/rescore_archive.py); features are computed in pixels.
      */
     public void logDataWithMetrics(PostureClassifier.ClassificationResult result, 
                                     List<NormalizedLandmark> landmarks,
                                     String metricsString,
-                                    long inferenceTime) {
+                                    long inferenceTime,
+                                    int imageWidth,
+                                    int imageHeight) {
+        logDataWithMetrics(result, landmarks, metricsString, inferenceTime, imageWidth, imageHeight, 0);
+    }
+
+    /**
+     * Log one tracked person's posture. Each person is throttled separately
+     * so a second person in view does not starve the first one's log.
+     *
+     * @param personId PersonTracker ID, or 0 for the single-person case (not stored)
+     */
+    public synchronized void logDataWithMetrics(PostureClassifier.ClassificationResult result,
+                                                List<NormalizedLandmark> landmarks,
+                                                String metricsString,
+                                                long inferenceTime,
+                                                int imageWidth,
+                                                int imageHeight,
+                                                int personId) {
         // Throttle to avoid excessive writes
         long currentTime = System.currentTimeMillis();
-        if (currentTime - lastLogTime < LOG_INTERVAL_MS) {
+        Long personLastLogTime = lastPersonLogTimes.get(personId);
+        if (personLastLogTime != null && currentTime - personLastLogTime < LOG_INTERVAL_MS) {
             return;
         }
-        lastLogTime = currentTime;
+        lastPersonLogTimes.put(personId, currentTime);
 
         if (result == null) {
             return;
@@ -127,12 +147,12 @@ public class FirebaseManager {
         logEntry.put("timestamp", currentTime);
         logEntry.put("date", new SimpleDateFormat("yyyy-MM-dd HH:mm:ss", Locale.getDefault()).format(new Date(currentTime)));
         
-        // Posture classification results
-        Map<String, String> postureData = new HashMap<>();
-        postureData.put("slouch", result.getSlouchStatus());
-        postureData.put("legs", result.getLegsStatus());
-        postureData.put("lean", result.getLeanStatus());
-        logEntry.put("posture", postureData);
+        // Posture classification results (packed PostureState code)
+        logEntry.put("state", PostureState.index(result.getStateCode()));
+        
+        if (personId > 0) {
+            logEntry.put("personId", personId);
+        }
         
         // Performance metrics
         logEntry.put("inferenceTimeMs", inferenceTime);
@@ -159,11 +179,25 @@ public class FirebaseManager {
                     landmarksList.add(landmarkData);
                 }
                 logEntry.put("landmarks", landmarksList);
+                logEntry.put("imageWidth", imageWidth);
+                logEntry.put("imageHeight", imageHeight);
             }
         }
 
         // Write to Firebase
-        database.child(logId).setValue(logEntry);
+        writeLogEntry(logId, logEntry, currentTime);
+    }
+
+    /**
+     * Write a record together with removing the cached aggregate of its day,
+     * in one multi-path update. A record that reaches the server late (queued
+     * offline) then still invalidates a day that was summarised without it.
+     */
+    private void writeLogEntry(String logId, Map<String, Object> logEntry, long timestamp) {
+        Map<String, Object> updates = new HashMap<>();
+        updates.put("posture_logs/" + logId, logEntry);
+        updates.put("daily_aggregates/" + PostureAggregate.dayKey(timestamp), null);
+        root.updateChildren(updates);
     }
 
     /**
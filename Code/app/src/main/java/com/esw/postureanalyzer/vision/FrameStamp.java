@@ -0,0 +1,54 @@
+package com.esw.postureanalyzer.vision;
+
+/**
+ * Sequence number and capture time carried by every synthetic frame
+ * (SyntheticStamp in synthetic_source.h): 'SYNF', u32 sequence and i64
+ * CLOCK_MONOTONIC nanoseconds, little-endian. YUYV frames hold it in their
+ * first 16 bytes, MJPEG frames in a COM segment right after SOI.
+ *
+ * System.nanoTime() reads the same clock on Android, so
+ * System.nanoTime() - timestampNs is the frame's age.
+ */
+public final class FrameStamp {
+    public static final int SIZE = 16;
+
+    private static final int MAGIC = 'S' | ('Y' << 8) | ('N' << 16) | ('F' << 24);
+    private static final int MJPEG_OFFSET = 6;
+
+    public final long sequence;
+    public final long timestampNs;
+
+    FrameStamp(long sequence, long timestampNs) {
+        this.sequence = sequence;
+        this.timestampNs = timestampNs;
+    }
+
+    /**
+     * Read the stamp from the first length bytes of a frame; null if the
+     * frame carries none
+     */
+    public static FrameStamp parse(byte[] data, int length) {
+        if (data == null || length > data.length) {
+            return null;
+        }
+        int offset = 0;
+        if (length >= MJPEG_OFFSET + SIZE && (data[0] & 0xFF) == 0xFF && (data[1] & 0xFF) == 0xD8) {
+            offset = MJPEG_OFFSET;
+        } else if (length < SIZE) {
+            return null;
+        }
+        if (readInt(data, offset) != MAGIC) {
+            return null;
+        }
+        long sequence = readInt(data, offset + 4) & 0xFFFFFFFFL;
+        long timestampNs = (readInt(data, offset + 8) & 0xFFFFFFFFL) | ((long) readInt(data, offset + 12) << 32);
+        return new FrameStamp(sequence, timestampNs);
+    }
+
+    private static int readInt(byte[] data, int offset) {
+        return (data[offset] & 0xFF)
+                | ((data[offset + 1] & 0xFF) << 8)
+                | ((data[offset + 2] & 0xFF) << 16)
+                | ((data[offset + 3] & 0xFF) << 24);
+    }
+}
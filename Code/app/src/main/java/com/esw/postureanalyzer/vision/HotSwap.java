@@ -0,0 +1,306 @@
+package com.esw.postureanalyzer.vision;
+
+import java.util.ArrayDeque;
+import java.util.HashMap;
+import java.util.Locale;
+import java.util.Map;
+import java.util.concurrent.Executor;
+import java.util.concurrent.RejectedExecutionException;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicReference;
+
+/**
+ * Read-copy-update slot for a resource that is slow to build and not safe
+ * to tear down under a reader (interpreter sets, the pose landmarker).
+ *
+ * Readers take a Lease on whatever version is current and use it without
+ * holding any lock the writer needs. A replacement is built elsewhere and
+ * published with one pointer exchange; frames already holding the old
+ * version finish on it, and it is closed on the retire executor once the
+ * last lease is returned.
+ *
+ * The slot also measures what a swap costs the pipeline: frames recorded
+ * from beginSwap() until SETTLE_FRAMES frames after the publish count as
+ * swap frames, and their worst latency is reported next to the worst of
+ * the frames just before the swap.
+ */
+public class HotSwap<T> {
+    /** Frames after a publish still attributed to the swap */
+    public static final int SETTLE_FRAMES = 30;
+    // Frames before a swap the baseline is taken over
+    private static final int BASELINE_FRAMES = 30;
+
+    public interface Closer<T> {
+        void close(T value);
+    }
+
+    /**
+     * One published version; closing the lease returns it
+     */
+    public static final class Lease<T> implements AutoCloseable {
+        private final HotSwap<T> owner;
+        private final T value;
+        // The slot's own reference plus one per reader
+        private final AtomicInteger refs = new AtomicInteger(1);
+
+        Lease(HotSwap<T> owner, T value) {
+            this.owner = owner;
+            this.value = value;
+        }
+
+        public T get() {
+            return value;
+        }
+
+        boolean retain() {
+            for (;;) {
+                int count = refs.get();
+                if (count == 0) {
+                    return false; // Retired and already closing
+                }
+                if (refs.compareAndSet(count, count + 1)) {
+                    return true;
+                }
+            }
+        }
+
+        @Override
+        public void close() {
+            if (refs.decrementAndGet() == 0) {
+                owner.retire(value);
+            }
+        }
+    }
+
+    private final AtomicReference<Lease<T>> current = new AtomicReference<>();
+    private final Closer<T> closer;
+    private final Executor retireExecutor;
+    private volatile boolean closed;
+
+    // Swap accounting, guarded by statsLock
+    private final Object statsLock = new Object();
+    private final ArrayDeque<Double> recentFrameMs = new ArrayDeque<>();
+    private boolean swapping;
+    private int settleFrames;
+    private double swapMaxFrameMs;
+    private double swapBaselineMs;
+    private int swaps;
+    private int failedSwaps;
+    private long lastBuildMs;
+    private long maxBuildMs;
+    private double lastSwapMaxFrameMs;
+    private double lastBaselineMaxFrameMs;
+    private double maxSwapFrameMs;
+
+    /**
+     * @param closer         releases a retired version
+     * @param retireExecutor where closer runs, so the last reader isn't the one paying for it
+     */
+    public HotSwap(Closer<T> closer, Executor retireExecutor) {
+        this.closer = closer;
+        this.retireExecutor = retireExecutor;
+    }
+
+    /**
+     * Lease on the current version, or null if nothing is published
+     */
+    public Lease<T> acquire() {
+        for (;;) {
+            Lease<T> lease = current.get();
+            if (lease == null) {
+                return null;
+            }
+            if (lease.retain()) {
+                return lease;
+            }
+            // Swapped out between the read and the retain; the new one is in place
+        }
+    }
+
+    /**
+     * Current version without taking a lease; only for reading immutable fields
+     */
+    public T peek() {
+        Lease<T> lease = current.get();
+        return lease != null ? lease.value : null;
+    }
+
+    public boolean isEmpty() {
+        return current.get() == null;
+    }
+
+    /**
+     * A replacement has started building; frames from here on count as swap frames
+     */
+    public void beginSwap() {
+        synchronized (statsLock) {
+            if (!swapping) {
+                swapping = true;
+                swapMaxFrameMs = 0;
+                swapBaselineMs = maxOf(recentFrameMs);
+            }
+            settleFrames = 0;
+        }
+    }
+
+    /**
+     * Swap in a new version. The previous one stays usable by the frames
+     * holding it and is closed after the last of them returns its lease.
+     *
+     * @param buildMs time spent building and warming the new version
+     */
+    public void publish(T value, long buildMs) {
+        if (closed) {
+            retire(value);
+            return;
+        }
+        Lease<T> previous = current.getAndSet(new Lease<>(this, value));
+        if (previous != null) {
+            previous.close();
+        }
+        if (closed) {
+            // close() ran between the check above and the exchange and may
+            // have cleared before this version went in; unpublish it again
+            clear();
+            return;
+        }
+        synchronized (statsLock) {
+            lastBuildMs = buildMs;
+            maxBuildMs = Math.max(maxBuildMs, buildMs);
+            if (swapping && previous != null) {
+                swaps++;
+                settleFrames = SETTLE_FRAMES;
+            } else {
+                swapping = false;
+            }
+        }
+    }
+
+    /**
+     * The replacement failed to build; the current version stays
+     */
+    public void abortSwap() {
+        synchronized (statsLock) {
+            if (swapping) {
+                failedSwaps++;
+                swapping = false;
+            }
+        }
+    }
+
+    /**
+     * Unpublish the current version (closed once its readers are done)
+     */
+    public void clear() {
+        Lease<T> previous = current.getAndSet(null);
+        if (previous != null) {
+            previous.close();
+        }
+    }
+
+    /**
+     * Clear, and close anything published from now on straight away
+     */
+    public void close() {
+        closed = true;
+        clear();
+    }
+
+    private void retire(T value) {
+        try {
+            retireExecutor.execute(() -> closer.close(value));
+        } catch (RejectedExecutionException e) {
+            closer.close(value); // Owner already shut its executor down
+        }
+    }
+
+    /**
+     * Latency of one frame through the stage the slot serves
+     */
+    public void recordFrame(double latencyMs) {
+        synchronized (statsLock) {
+            if (swapping) {
+                swapMaxFrameMs = Math.max(swapMaxFrameMs, latencyMs);
+                if (settleFrames > 0 && --settleFrames == 0) {
+                    swapping = false;
+                    lastSwapMaxFrameMs = swapMaxFrameMs;
+                    lastBaselineMaxFrameMs = swapBaselineMs;
+                    maxSwapFrameMs = Math.max(maxSwapFrameMs, swapMaxFrameMs);
+                }
+                return;
+            }
+            recentFrameMs.addLast(latencyMs);
+            if (recentFrameMs.size() > BASELINE_FRAMES) {
+                recentFrameMs.removeFirst();
+            }
+        }
+    }
+
+    private static double maxOf(Iterable<Double> values) {
+        double max = 0;
+        for (double value : values) {
+            max = Math.max(max, value);
+        }
+        return max;
+    }
+
+    public int getSwaps() {
+        synchronized (statsLock) {
+            return swaps;
+        }
+    }
+
+    /**
+     * Worst frame latency of the last completed swap, in milliseconds
+     */
+    public double getLastSwapMaxFrameMs() {
+        synchronized (statsLock) {
+            return lastSwapMaxFrameMs;
+        }
+    }
+
+    /**
+     * Worst frame latency over the frames just before the last completed swap
+     */
+    public double getLastBaselineMaxFrameMs() {
+        synchronized (statsLock) {
+            return lastBaselineMaxFrameMs;
+        }
+    }
+
+    public double getMaxSwapFrameMs() {
+        synchronized (statsLock) {
+            return maxSwapFrameMs;
+        }
+    }
+
+    public boolean isSwapping() {
+        synchronized (statsLock) {
+            return swapping;
+        }
+    }
+
+    public String getStats() {
+        synchronized (statsLock) {
+            return String.format(Locale.US,
+                    "%d swaps (%d failed)%s\nBuild: %d ms last, %d ms max (background)\n"
+                            + "Swap max frame: %.1f ms last (%.1f ms before), %.1f ms worst",
+                    swaps, failedSwaps, swapping ? ", swapping" : "", lastBuildMs, maxBuildMs,
+                    lastSwapMaxFrameMs, lastBaselineMaxFrameMs, maxSwapFrameMs);
+        }
+    }
+
+    public Map<String, Object> getMetricsMap() {
+        synchronized (statsLock) {
+            Map<String, Object> metrics = new HashMap<>();
+            metrics.put("swaps", swaps);
+            metrics.put("failedSwaps", failedSwaps);
+            metrics.put("lastBuildMs", lastBuildMs);
+            metrics.put("maxBuildMs", maxBuildMs);
+            metrics.put("lastSwapMaxFrameMs", Math.round(lastSwapMaxFrameMs * 10.0) / 10.0);
+            metrics.put("lastBaselineMaxFrameMs", Math.round(lastBaselineMaxFrameMs * 10.0) / 10.0);
+            metrics.put("maxSwapFrameMs", Math.round(maxSwapFrameMs * 10.0) / 10.0);
+            return metrics;
+        }
+    }
+}
@@ -0,0 +1,126 @@
+package com.esw.postureanalyzer.vision;
+
+import android.os.Build;
+import android.os.SystemClock;
+import android.util.Log;
+
+import dalvik.annotation.optimization.CriticalNative;
+import dalvik.annotation.optimization.FastNative;
+
+import java.util.Locale;
+
+/**
+ * Measures the per-call cost of the three JNI calling conventions using
+ * identical no-op natives from libuvccamera.
+ *
+ * Before API 26 the annotations are ignored, so all three report the
+ * regular JNI cost.
+ */
+public final class JniBenchmark {
+    private static final String TAG = "JniBenchmark";
+
+    private static boolean nativeAvailable = false;
+
+    static {
+        try {
+            System.loadLibrary("uvccamera");
+            nativeAvailable = true;
+        } catch (UnsatisfiedLinkError e) {
+            Log.e(TAG, "Native library unavailable", e);
+        }
+    }
+
+    private static native int nativeNoopRegular(int value);
+    @FastNative
+    private static native int nativeNoopFast(int value);
+    @CriticalNative
+    private static native int nativeNoopCritical(int value);
+
+    /**
+     * Nanoseconds per call for each convention
+     */
+    public static class Result {
+        public final int iterations;
+        public final double regularNs;
+        public final double fastNs;
+        public final double criticalNs;
+
+        Result(int iterations, double regularNs, double fastNs, double criticalNs) {
+            this.iterations = iterations;
+            this.regularNs = regularNs;
+            this.fastNs = fastNs;
+            this.criticalNs = criticalNs;
+        }
+
+        @Override
+        public String toString() {
+            return String.format(Locale.US,
+                    "JNI per call over %d iterations (API %d): regular=%.1fns fast=%.1fns critical=%.1fns",
+                    iterations, Build.VERSION.SDK_INT, regularNs, fastNs, criticalNs);
+        }
+    }
+
+    private JniBenchmark() {
+    }
+
+    public static boolean isAvailable() {
+        return nativeAvailable;
+    }
+
+    /**
+     * Runs each convention for the given iterations after a warm-up pass.
+     * Returns null if the native library is not loaded.
+     */
+    public static Result run(int iterations) {
+        if (!nativeAvailable || iterations <= 0) {
+            return null;
+        }
+
+        // Warm up so the JIT has compiled the loops and stubs
+        int warmup = Math.min(iterations, 10_000);
+        int sink = loopRegular(warmup) + loopFast(warmup) + loopCritical(warmup);
+
+        long start = SystemClock.elapsedRealtimeNanos();
+        sink += loopRegular(iterations);
+        long regular = SystemClock.elapsedRealtimeNanos() - start;
+
+        start = SystemClock.elapsedRealtimeNanos();
+        sink += loopFast(iterations);
+        long fast = SystemClock.elapsedRealtimeNanos() - start;
+
+        start = SystemClock.elapsedRealtimeNanos();
+        sink += loopCritical(iterations);
+        long critical = SystemClock.elapsedRealtimeNanos() - start;
+
+        Result result = new Result(iterations,
+                (double) regular / iterations,
+                (double) fast / iterations,
+                (double) critical / iterations);
+        Log.d(TAG, result + " (sink " + sink + ")");
+        return result;
+    }
+
+    private static int loopRegular(int iterations) {
+        int value = 0;
+        for (int i = 0; i < iterations; i++) {
+            value = nativeNoopRegular(value);
+        }
+        return value;
+    }
+
+    private static int loopFast(int iterations) {
+        int value = 0;
+        for (int i = 0; i < iterations; i++) {
+            value = nativeNoopFast(value);
+        }
+        return value;
+    }
+
+    private static int loopCritical(int iterations) {
+        int value = 0;
+        for (int i = 0; i < iterations; i++) {
+            value = nativeNoopCritical(value);
+        }
+        return value;
+    }
+}
@@ -0,0 +1,128 @@
+package com.esw.postureanalyzer.vision;
+
+import android.util.Log;
+
+import com.google.mediapipe.tasks.components.containers.NormalizedLandmark;
+
+import dalvik.annotation.optimization.CriticalNative;
+import dalvik.annotation.optimization.FastNative;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Optional;
+
+/**
+ * Temporal smoothing of one person's landmarks before feature extraction.
+ *
+ * Wraps the native One-Euro filter (landmark_filter.cpp): each coordinate is
+ * low-pass filtered with a cutoff that rises with its speed, so per-frame
+ * jitter no longer flips posture decisions and the pose rate can be lowered
+ * to SMOOTHED_POSE_FPS. Without the native library poses pass through
+ * unchanged. Keep one instance per tracked person.
+ */
+public class LandmarkFilter {
+    private static final String TAG = "LandmarkFilter";
+
+    public static final int CHANNEL_X = 0;
+    public static final int CHANNEL_Y = 1;
+    public static final int CHANNEL_Z = 2;
+    public static final int CHANNEL_VISIBILITY = 3;
+
+    /**
+     * Pose rate used while smoothing is on. Check against recorded traces with
+     * training/filter_agreement.py before lowering it further.
+     */
+    public static final int SMOOTHED_POSE_FPS = 15;
+
+    private static final int LANDMARKS = 33;
+    private static final int CHANNELS = 4;
+
+    private static boolean nativeAvailable = false;
+
+    static {
+        try {
+            System.loadLibrary("uvccamera");
+            nativeAvailable = true;
+        } catch (UnsatisfiedLinkError e) {
+            Log.e(TAG, "Native landmark filter unavailable, landmarks will not be smoothed", e);
+        }
+    }
+
+    private native long nativeCreate();
+    private native void nativeDestroy(long nativePtr);
+    @FastNative
+    private native boolean nativeFilter(long nativePtr, float[] landmarks, long timestampNs);
+    private native void nativeSetParams(long nativePtr, int channel, float minCutoff, float beta, float dCutoff);
+    @CriticalNative
+    private static native void nativeReset(long nativePtr);
+
+    private long nativePtr;
+    private final float[] buffer = new float[LANDMARKS * CHANNELS];
+
+    public LandmarkFilter() {
+        nativePtr = nativeAvailable ? nativeCreate() : 0;
+    }
+
+    public static boolean isAvailable() {
+        return nativeAvailable;
+    }
+
+    /**
+     * Smooth one frame. timestampNs must come from a monotonic clock (the
+     * landmarker's frame timestamp). Returns the input list if it cannot be
+     * filtered.
+     */
+    public synchronized List<NormalizedLandmark> filter(List<NormalizedLandmark> pose, long timestampNs) {
+        if (nativePtr == 0 || pose == null || pose.size() != LANDMARKS) {
+            return pose;
+        }
+
+        for (int i = 0; i < LANDMARKS; i++) {
+            NormalizedLandmark lm = pose.get(i);
+            int offset = i * CHANNELS;
+            buffer[offset] = lm.x();
+            buffer[offset + 1] = lm.y();
+            buffer[offset + 2] = lm.z();
+            buffer[offset + 3] = lm.visibility().orElse(0.0f);
+        }
+
+        nativeFilter(nativePtr, buffer, timestampNs);
+
+        List<NormalizedLandmark> smoothed = new ArrayList<>(LANDMARKS);
+        for (int i = 0; i < LANDMARKS; i++) {
+            NormalizedLandmark lm = pose.get(i);
+            int offset = i * CHANNELS;
+            Optional<Float> visibility = lm.visibility().isPresent()
+                    ? Optional.of(buffer[offset + 3]) : lm.visibility();
+            smoothed.add(NormalizedLandmark.create(buffer[offset], buffer[offset + 1], buffer[offset + 2],
+                    visibility, lm.presence()));
+        }
+        return smoothed;
+    }
+
+    /**
+     * Cutoff at rest (Hz) and its gain per unit/s of speed for one channel,
+     * plus the cutoff of the speed estimate
+     */
+    public synchronized void setParams(int channel, float minCutoff, float beta, float dCutoff) {
+        if (nativePtr != 0) {
+            nativeSetParams(nativePtr, channel, minCutoff, beta, dCutoff);
+        }
+    }
+
+    /**
+     * Forget the history, e.g. when the track is re-acquired
+     */
+    public synchronized void reset() {
+        if (nativePtr != 0) {
+            nativeReset(nativePtr);
+        }
+    }
+
+    public synchronized void release() {
+        if (nativePtr != 0) {
+            nativeDestroy(nativePtr);
+            nativePtr = 0;
+        }
+    }
+}
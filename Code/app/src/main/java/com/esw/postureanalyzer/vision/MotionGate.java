@@ -0,0 +1,186 @@
+package com.esw.postureanalyzer.vision;
+
+import android.graphics.Bitmap;
+import android.os.SystemClock;
+import android.util.Log;
+
+import dalvik.annotation.optimization.CriticalNative;
+
+import java.nio.ByteBuffer;
+import java.util.HashMap;
+import java.util.Locale;
+import java.util.Map;
+
+/**
+ * Skips pose inference on frames that have not changed.
+ *
+ * Motion is scored natively (block SAD of a downsampled luma plane against a
+ * running background). YUYV frames from V4L2Camera are scored on the mmap
+ * buffer; RGBA frames (CameraX, decoded MJPEG) are scored through this class.
+ * A frame is forwarded when its score reaches the threshold, or when the last
+ * forwarded frame is older than the refresh interval so that presence and
+ * posture state never go stale.
+ */
+public class MotionGate {
+    private static final String TAG = "MotionGate";
+
+    public static final float DEFAULT_MOTION_THRESHOLD = 0.03f; // Fraction of changed blocks
+    public static final long DEFAULT_REFRESH_INTERVAL_MS = 3000; // Below PresenceDetector's 15s away threshold
+
+    private static boolean nativeAvailable = false;
+
+    static {
+        try {
+            System.loadLibrary("uvccamera");
+            nativeAvailable = true;
+        } catch (UnsatisfiedLinkError e) {
+            Log.e(TAG, "Native motion gate unavailable, all frames will be processed", e);
+        }
+    }
+
+    private native long nativeCreate();
+    private native void nativeDestroy(long nativePtr);
+    @CriticalNative
+    private static native void nativeReset(long nativePtr);
+    private native float nativeUpdateRgba(long nativePtr, ByteBuffer buffer, int width, int height, int rowStride);
+    private native float nativeUpdateBitmap(long nativePtr, Bitmap bitmap);
+
+    private long nativePtr;
+    private volatile boolean enabled = true;
+    private volatile float motionThreshold = DEFAULT_MOTION_THRESHOLD;
+    private volatile long refreshIntervalMs = DEFAULT_REFRESH_INTERVAL_MS;
+
+    // Counters
+    private long lastForwardedMs = 0;
+    private long framesSeen = 0;
+    private long framesSkipped = 0;
+    private double avgInferenceMs = 0;
+    private double inferencePowerMw = 0; // 0 = unknown, energy is then not estimated
+
+    public MotionGate() {
+        nativePtr = nativeAvailable ? nativeCreate() : 0;
+    }
+
+    /**
+     * Score a direct RGBA_8888 buffer. Returns -1 if the frame could not be scored.
+     */
+    public synchronized float measureRgba(ByteBuffer buffer, int width, int height, int rowStride) {
+        if (nativePtr == 0 || buffer == null || !buffer.isDirect()) {
+            return -1f;
+        }
+        return nativeUpdateRgba(nativePtr, buffer, width, height, rowStride);
+    }
+
+    /**
+     * Score an ARGB_8888 Bitmap in place. Returns -1 if the frame could not be scored.
+     */
+    public synchronized float measureBitmap(Bitmap bitmap) {
+        if (nativePtr == 0 || bitmap == null || bitmap.isRecycled()) {
+            return -1f;
+        }
+        return nativeUpdateBitmap(nativePtr, bitmap);
+    }
+
+    /**
+     * Decide whether a frame with the given motion score should go to the
+     * pose landmarker. Negative scores (unmeasured) are always forwarded.
+     */
+    public synchronized boolean shouldProcess(float motionScore) {
+        framesSeen++;
+        long now = SystemClock.elapsedRealtime();
+
+        if (!enabled || motionScore < 0 || motionScore >= motionThreshold
+                || now - lastForwardedMs >= refreshIntervalMs) {
+            lastForwardedMs = now;
+            return true;
+        }
+
+        framesSkipped++;
+        return false;
+    }
+
+    /**
+     * Feed the measured landmarker time (µs) so skipped frames can be costed
+     */
+    public synchronized void recordInferenceTime(long inferenceTimeMicros) {
+        double ms = inferenceTimeMicros / 1000.0;
+        avgInferenceMs = avgInferenceMs == 0 ? ms : avgInferenceMs * 0.95 + ms * 0.05;
+    }
+
+    /**
+     * Average device power while inferring, used to turn saved time into energy
+     */
+    public synchronized void setInferencePowerMw(double powerMw) {
+        inferencePowerMw = powerMw;
+    }
+
+    public void setEnabled(boolean enabled) {
+        this.enabled = enabled;
+    }
+
+    public void setMotionThreshold(float threshold) {
+        this.motionThreshold = threshold;
+    }
+
+    public void setRefreshIntervalMs(long intervalMs) {
+        this.refreshIntervalMs = intervalMs;
+    }
+
+    /**
+     * Forget the background, e.g. after switching cameras. A gate that was
+     * released gets fresh native state here, so a camera manager can start
+     * again after release().
+     */
+    public synchronized void reset() {
+        if (nativePtr != 0) {
+            nativeReset(nativePtr);
+        } else if (nativeAvailable) {
+            nativePtr = nativeCreate();
+        }
+        lastForwardedMs = 0;
+    }
+
+    public synchronized double getSkipRatio() {
+        return framesSeen > 0 ? (double) framesSkipped / framesSeen : 0;
+    }
+
+    public synchronized double getSavedInferenceMs() {
+        return framesSkipped * avgInferenceMs;
+    }
+
+    /**
+     * Estimated energy saved in mJ, or 0 if the inference power is unknown
+     */
+    public synchronized double getEnergySavedMj() {
+        return getSavedInferenceMs() * inferencePowerMw / 1000.0;
+    }
+
+    public synchronized String getStats() {
+        return String.format(Locale.US,
+                "Frames: %d, Skipped: %d (%.1f%%)\nSaved: %.1f s inference, %.1f J",
+                framesSeen, framesSkipped, getSkipRatio() * 100,
+                getSavedInferenceMs() / 1000.0, getEnergySavedMj() / 1000.0);
+    }
+
+    public synchronized Map<String, Object> getMetricsMap() {
+        Map<String, Object> metrics = new HashMap<>();
+        metrics.put("framesSeen", framesSeen);
+        metrics.put("framesSkipped", framesSkipped);
+        metrics.put("skipRatio", getSkipRatio());
+        metrics.put("savedInferenceMs", getSavedInferenceMs());
+        if (inferencePowerMw > 0) {
+            metrics.put("energySavedMj", getEnergySavedMj());
+        }
+        return metrics;
+    }
+
+    /**
+     * Free the native state; frames pass ungated until the next reset()
+     */
+    public synchronized void release() {
+        if (nativePtr != 0) {
+            nativeDestroy(nativePtr);
+            nativePtr = 0;
+        }
+    }
+}
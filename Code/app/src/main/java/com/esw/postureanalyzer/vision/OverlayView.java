@@ -4,32 +4,92 @@ import android.content.Context;
 import android.graphics.Canvas;
 import android.graphics.Color;
 import android.graphics.Paint;
+import android.os.SystemClock;
 import android.util.AttributeSet;
 import android.util.Log;
 import android.view.View;
 import androidx.annotation.Nullable;
 import com.google.mediapipe.tasks.components.containers.NormalizedLandmark;
-import com.google.mediapipe.tasks.vision.poselandmarker.PoseLandmarkerResult;
 import java.util.List;
 
+/**
+ * Skeleton overlay.
+ *
+ * Each pose result is copied into a keyframe; onDraw interpolates between the
+ * last two keyframes and keeps invalidating on animation frames until the
+ * newest one is reached. Poses are matched across keyframes by PersonTracker
+ * ID, since the landmarker's pose order can change between frames, so the skeleton moves at display rate instead of
+ * jumping at inference rate. Vertex arrays are preallocated and submitted
+ * with one drawLines and one drawPoints call.
+ */
 public class OverlayView extends View {
     private static final String TAG = "OverlayView";
-    
-    private PoseLandmarkerResult results;
+
+    private static final int LANDMARK_COUNT = 33;
+    private static final int MAX_POSES = 4;
+
+    // MediaPipe Pose connections as flat (start, end) index pairs
+    private static final int[] CONNECTIONS = {
+            // Face oval
+            0, 1, 1, 2, 2, 3, 3, 7,
+            0, 4, 4, 5, 5, 6, 6, 8,
+            // Mouth
+            9, 10,
+            // Shoulders
+            11, 12,
+            // Left arm
+            11, 13, 13, 15,
+            // Right arm
+            12, 14, 14, 16,
+            // Left hand
+            15, 17, 15, 19, 15, 21, 17, 19,
+            // Right hand
+            16, 18, 16, 20, 16, 22, 18, 20,
+            // Torso
+            11, 23, 12, 24, 23, 24,
+            // Left leg
+            23, 25, 25, 27,
+            // Right leg
+            24, 26, 26, 28,
+            // Left foot
+            27, 29, 27, 31, 29, 31,
+            // Right foot
+            28, 30, 28, 32, 30, 32
+    };
+    private static final int CONNECTION_COUNT = CONNECTIONS.length / 2;
+
     private final Paint pointPaint;
     private final Paint linePaint;
     private int imageWidth = 1;
     private int imageHeight = 1;
     private int logCounter = 0;
 
+    // Keyframes: normalized (x, y) per landmark per pose
+    private final float[] previousKeyframe = new float[MAX_POSES * LANDMARK_COUNT * 2];
+    private final float[] currentKeyframe = new float[MAX_POSES * LANDMARK_COUNT * 2];
+    private final int[] landmarkCounts = new int[MAX_POSES];
+    private final int[] keyframeIds = new int[MAX_POSES];
+    private final boolean[] continuous = new boolean[MAX_POSES];
+    private int poseCount = 0;
+    private long previousKeyframeMs = 0;
+    private long currentKeyframeMs = 0;
+
+    // Vertex arrays in view coordinates, rebuilt in place every draw
+    private final float[] pointVertices = new float[MAX_POSES * LANDMARK_COUNT * 2];
+    private final float[] lineVertices = new float[MAX_POSES * CONNECTION_COUNT * 4];
+    private final float[] interpolated = new float[LANDMARK_COUNT * 2];
+
+    private final PerformanceMonitor drawMonitor = new PerformanceMonitor("Overlay (UI thread)");
+
     public OverlayView(Context context, @Nullable AttributeSet attrs) {
         super(context, attrs);
 
-        // Yellow/Gold points for visibility
+        // Yellow/Gold points for visibility (round caps make drawPoints render discs)
         pointPaint = new Paint();
         pointPaint.setColor(Color.rgb(255, 215, 0)); // Gold color
         pointPaint.setStyle(Paint.Style.FILL);
-        pointPaint.setStrokeWidth(10f);
+        pointPaint.setStrokeWidth(12f);
+        pointPaint.setStrokeCap(Paint.Cap.ROUND);
         pointPaint.setAntiAlias(true);
 
         // White lines for connections
@@ -40,66 +100,132 @@ public class OverlayView extends View {
         linePaint.setAntiAlias(true);
     }
 
-    public void setResults(PoseLandmarkerResult poseLandmarkerResult, int imageHeight, int imageWidth) {
-        results = poseLandmarkerResult;
-        
+    /**
+     * @param personIds PersonTracker ID for each pose, in the same order
+     */
+    public void setResults(List<List<NormalizedLandmark>> poseLandmarks, int[] personIds,
+                           int imageHeight, int imageWidth) {
         // Check for dimension changes that could cause oscillation
         boolean dimensionsChanged = (this.imageWidth != imageWidth || this.imageHeight != imageHeight);
-        
+
         int oldWidth = this.imageWidth;
         int oldHeight = this.imageHeight;
-        
+
         this.imageHeight = imageHeight;
         this.imageWidth = imageWidth;
-        
+
         // Log when dimensions change - this indicates oscillation cause
         if (dimensionsChanged && oldWidth != 1) { // oldWidth != 1 to skip initial set
-            Log.w(TAG, String.format("DIMENSION CHANGE! Image: %dx%d -> %dx%d, View: %dx%d", 
+            Log.w(TAG, String.format("DIMENSION CHANGE! Image: %dx%d -> %dx%d, View: %dx%d",
                 oldWidth, oldHeight, imageWidth, imageHeight, getWidth(), getHeight()));
             logCounter = 0; // Reset counter to log next few frames
         }
-        
+
         if (logCounter++ % 60 == 0) {
-            Log.d(TAG, String.format("Image: %dx%d, View: %dx%d, Aspect: %.2f vs %.2f", 
+            Log.d(TAG, String.format("Image: %dx%d, View: %dx%d, Aspect: %.2f vs %.2f",
                 imageWidth, imageHeight, getWidth(), getHeight(),
                 (float)imageWidth/imageHeight, (float)getWidth()/getHeight()));
         }
-        
-        invalidate();
+
+        pushKeyframe(poseLandmarks, personIds, dimensionsChanged);
+        postInvalidateOnAnimation();
     }
-    
+
+    /**
+     * Move each tracked person's current keyframe into the previous slot of
+     * that person's new index, then copy the new result in. A person starts
+     * without blending when they're new, their landmark count changed or the
+     * frame size changed.
+     */
+    private void pushKeyframe(List<List<NormalizedLandmark>> poseLandmarks, int[] personIds,
+                              boolean dimensionsChanged) {
+        int newPoseCount = poseLandmarks == null ? 0 : Math.min(poseLandmarks.size(), MAX_POSES);
+
+        // Carry each person's last keyframe over to their new index; current
+        // and landmarkCounts are untouched until the next loop
+        for (int p = 0; p < newPoseCount; p++) {
+            int previous = dimensionsChanged ? -1 : slotOf(personIds[p]);
+            int count = Math.min(poseLandmarks.get(p).size(), LANDMARK_COUNT);
+            continuous[p] = previous >= 0 && landmarkCounts[previous] == count;
+            if (continuous[p]) {
+                System.arraycopy(currentKeyframe, previous * LANDMARK_COUNT * 2,
+                        previousKeyframe, p * LANDMARK_COUNT * 2, count * 2);
+            }
+        }
+        previousKeyframeMs = currentKeyframeMs;
+        currentKeyframeMs = SystemClock.uptimeMillis();
+
+        for (int p = 0; p < newPoseCount; p++) {
+            List<NormalizedLandmark> landmarks = poseLandmarks.get(p);
+            int count = Math.min(landmarks.size(), LANDMARK_COUNT);
+            landmarkCounts[p] = count;
+            keyframeIds[p] = personIds[p];
+            int base = p * LANDMARK_COUNT * 2;
+            for (int i = 0; i < count; i++) {
+                NormalizedLandmark landmark = landmarks.get(i);
+                currentKeyframe[base + i * 2] = landmark.x();
+                currentKeyframe[base + i * 2 + 1] = landmark.y();
+            }
+            if (!continuous[p]) {
+                System.arraycopy(currentKeyframe, base, previousKeyframe, base, count * 2);
+            }
+        }
+        poseCount = newPoseCount;
+    }
+
+    /**
+     * Index of a person in the current keyframe, or -1
+     */
+    private int slotOf(int personId) {
+        for (int p = 0; p < poseCount; p++) {
+            if (keyframeIds[p] == personId) {
+                return p;
+            }
+        }
+        return -1;
+    }
+
     /**
      * Clear all landmarks from display
      */
     public void clear() {
-        results = null;
+        poseCount = 0;
         invalidate();
     }
 
+    /**
+     * UI-thread cost of onDraw (total) and of the batched draw calls (inference slot)
+     */
+    public String getDrawStats() {
+        return drawMonitor.getStats();
+    }
+
     @Override
     protected void onDraw(Canvas canvas) {
         super.onDraw(canvas);
-        
-        if (results == null || results.landmarks().isEmpty()) {
+
+        if (poseCount == 0) {
             return;
         }
 
         int viewWidth = getWidth();
         int viewHeight = getHeight();
-        
+
         if (viewWidth == 0 || viewHeight == 0) {
             return;
         }
 
+        drawMonitor.startTotal();
+
         // Calculate scaling to match fitCenter behavior
         // The image is scaled to fit within the view while maintaining aspect ratio
         float imageAspect = (float) imageWidth / imageHeight;
         float viewAspect = (float) viewWidth / viewHeight;
-        
+
         float scaleFactor;
         float offsetX = 0;
         float offsetY = 0;
-        
+
         if (imageAspect > viewAspect) {
             // Image is wider - fit to width, letterbox top/bottom
             scaleFactor = (float) viewWidth / imageWidth;
@@ -109,69 +235,60 @@ public class OverlayView extends View {
             scaleFactor = (float) viewHeight / imageHeight;
             offsetX = (viewWidth - imageWidth * scaleFactor) / 2;
         }
+        float scaleX = imageWidth * scaleFactor;
+        float scaleY = imageHeight * scaleFactor;
+
+        // Progress from the previous keyframe to the current one over one inference interval
+        long interval = currentKeyframeMs - previousKeyframeMs;
+        float t = interval > 0
+                ? Math.min(1f, (float) (SystemClock.uptimeMillis() - currentKeyframeMs) / interval)
+                : 1f;
 
-        for (List<NormalizedLandmark> normalizedLandmarks : results.landmarks()) {
-            // Draw connections first (so they appear behind points)
-            drawPoseConnections(canvas, normalizedLandmarks, scaleFactor, offsetX, offsetY);
-
-            // Draw landmarks on top
-            for (NormalizedLandmark landmark : normalizedLandmarks) {
-                // Convert normalized coordinates to view coordinates
-                float x = landmark.x() * imageWidth * scaleFactor + offsetX;
-                float y = landmark.y() * imageHeight * scaleFactor + offsetY;
-                
-                // Only draw if within view bounds
+        int pointFloats = 0;
+        int lineFloats = 0;
+        for (int p = 0; p < poseCount; p++) {
+            int count = landmarkCounts[p];
+            int base = p * LANDMARK_COUNT * 2;
+
+            // Interpolate and convert normalized coordinates to view coordinates
+            for (int i = 0; i < count * 2; i += 2) {
+                float prevX = previousKeyframe[base + i];
+                float prevY = previousKeyframe[base + i + 1];
+                float x = (prevX + (currentKeyframe[base + i] - prevX) * t) * scaleX + offsetX;
+                float y = (prevY + (currentKeyframe[base + i + 1] - prevY) * t) * scaleY + offsetY;
+                interpolated[i] = x;
+                interpolated[i + 1] = y;
+
+                // Only draw points within view bounds
                 if (x >= 0 && x <= viewWidth && y >= 0 && y <= viewHeight) {
-                    canvas.drawCircle(x, y, 6f, pointPaint);
+                    pointVertices[pointFloats++] = x;
+                    pointVertices[pointFloats++] = y;
                 }
             }
-        }
-    }
 
-    private void drawPoseConnections(Canvas canvas, List<NormalizedLandmark> landmarks, 
-                                    float scaleFactor, float offsetX, float offsetY) {
-        // MediaPipe Pose connections
-        int[][] connections = {
-                // Face oval
-                {0, 1}, {1, 2}, {2, 3}, {3, 7},
-                {0, 4}, {4, 5}, {5, 6}, {6, 8},
-                // Mouth
-                {9, 10},
-                // Shoulders
-                {11, 12},
-                // Left arm
-                {11, 13}, {13, 15},
-                // Right arm
-                {12, 14}, {14, 16},
-                // Left hand
-                {15, 17}, {15, 19}, {15, 21}, {17, 19},
-                // Right hand
-                {16, 18}, {16, 20}, {16, 22}, {18, 20},
-                // Torso
-                {11, 23}, {12, 24}, {23, 24},
-                // Left leg
-                {23, 25}, {25, 27},
-                // Right leg
-                {24, 26}, {26, 28},
-                // Left foot
-                {27, 29}, {27, 31}, {29, 31},
-                // Right foot
-                {28, 30}, {28, 32}, {30, 32}
-        };
-
-        for (int[] connection : connections) {
-            if (connection[0] < landmarks.size() && connection[1] < landmarks.size()) {
-                NormalizedLandmark start = landmarks.get(connection[0]);
-                NormalizedLandmark end = landmarks.get(connection[1]);
-
-                // Convert normalized coordinates to view coordinates
-                float startX = start.x() * imageWidth * scaleFactor + offsetX;
-                float startY = start.y() * imageHeight * scaleFactor + offsetY;
-                float endX = end.x() * imageWidth * scaleFactor + offsetX;
-                float endY = end.y() * imageHeight * scaleFactor + offsetY;
-
-                canvas.drawLine(startX, startY, endX, endY, linePaint);
+            for (int c = 0; c < CONNECTIONS.length; c += 2) {
+                int start = CONNECTIONS[c];
+                int end = CONNECTIONS[c + 1];
+                if (start < count && end < count) {
+                    lineVertices[lineFloats++] = interpolated[start * 2];
+                    lineVertices[lineFloats++] = interpolated[start * 2 + 1];
+                    lineVertices[lineFloats++] = interpolated[end * 2];
+                    lineVertices[lineFloats++] = interpolated[end * 2 + 1];
+                }
             }
         }
+
+        // Draw connections first (so they appear behind points)
+        drawMonitor.startInference();
+        canvas.drawLines(lineVertices, 0, lineFloats, linePaint);
+        canvas.drawPoints(pointVertices, 0, pointFloats, pointPaint);
+        drawMonitor.endInference();
+
+        drawMonitor.endTotal();
+
+        // Keep animating at display rate until the newest keyframe is reached
+        if (t < 1f) {
+            postInvalidateOnAnimation();
+        }
     }
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@ package com.esw.postureanalyzer.vision;
 
 import android.util.Log;
 import java.util.ArrayList;
+import java.util.Collections;
 import java.util.List;
 import java.util.Locale;
 
@@ -145,6 +146,13 @@ public class PerformanceMonitor {
         return max;
     }
 
+    // Nearest-rank percentile, same as PerformanceTracker
+    private long calculatePercentile(List<Long> sortedValues, int percentile) {
+        int index = (int) Math.ceil((percentile / 100.0) * sortedValues.size()) - 1;
+        index = Math.max(0, Math.min(index, sortedValues.size() - 1));
+        return sortedValues.get(index);
+    }
+
     /**
      * Reset all collected statistics
      */
@@ -183,6 +191,11 @@ public class PerformanceMonitor {
         metrics.put("avgInferenceUs", calculateAverage(inferenceTimesMs));
         metrics.put("minInferenceUs", calculateMin(inferenceTimesMs));
         metrics.put("maxInferenceUs", calculateMax(inferenceTimesMs));
+        
+        List<Long> sortedInference = new ArrayList<>(inferenceTimesMs);
+        Collections.sort(sortedInference);
+        metrics.put("p50InferenceUs", calculatePercentile(sortedInference, 50));
+        metrics.put("p95InferenceUs", calculatePercentile(sortedInference, 95));
         metrics.put("avgTotalUs", calculateAverage(totalTimesMs));
         metrics.put("minTotalUs", calculateMin(totalTimesMs));
         metrics.put("maxTotalUs", calculateMax(totalTimesMs));
@@ -0,0 +1,168 @@
+package com.esw.postureanalyzer.vision;
+
+import com.google.mediapipe.tasks.components.containers.NormalizedLandmark;
+
+import java.util.ArrayList;
+import java.util.Iterator;
+import java.util.List;
+
+/**
+ * Keeps a stable ID for each person across frames.
+ *
+ * PoseLandmarker returns poses in no particular order, so each pose is reduced
+ * to a torso centroid and greedily matched to the nearest live track (closest
+ * pair first). Poses that match nothing within the gate start a new track;
+ * tracks that go unseen for longer than the timeout are expired so their
+ * timers can be released. Time is passed in rather than read from the clock
+ * because MotionGate may skip frames.
+ */
+public class PersonTracker {
+    public static final float DEFAULT_MAX_MATCH_DISTANCE = 0.2f; // Normalized image units
+    public static final long DEFAULT_TRACK_TIMEOUT_MS = 5000;
+
+    // Shoulders and hips: steadier than the face or limbs while seated
+    private static final int[] TORSO_LANDMARKS = {11, 12, 23, 24};
+    private static final float MIN_VISIBILITY = 0.5f;
+
+    private static class Track {
+        final int id;
+        float x;
+        float y;
+        long lastSeenMs;
+
+        Track(int id, float x, float y, long lastSeenMs) {
+            this.id = id;
+            this.x = x;
+            this.y = y;
+            this.lastSeenMs = lastSeenMs;
+        }
+    }
+
+    private final float maxMatchDistance;
+    private final long trackTimeoutMs;
+    private final List<Track> tracks = new ArrayList<>();
+    private final List<Integer> expired = new ArrayList<>();
+    private int nextId = 1;
+
+    public PersonTracker() {
+        this(DEFAULT_MAX_MATCH_DISTANCE, DEFAULT_TRACK_TIMEOUT_MS);
+    }
+
+    public PersonTracker(float maxMatchDistance, long trackTimeoutMs) {
+        this.maxMatchDistance = maxMatchDistance;
+        this.trackTimeoutMs = trackTimeoutMs;
+    }
+
+    /**
+     * Assign IDs to this frame's poses.
+     *
+     * @param centroids one {x, y} per pose, see {@link #centroid(List)}
+     * @return track ID per pose, in input order
+     */
+    public synchronized int[] update(List<float[]> centroids, long nowMs) {
+        int n = centroids.size();
+        int[] ids = new int[n];
+        boolean[] trackUsed = new boolean[tracks.size()];
+
+        // Greedy assignment, closest pair first; at most a handful of people so O(n*m) per pass is fine
+        float gate = maxMatchDistance * maxMatchDistance;
+        for (int assigned = 0; assigned < n; assigned++) {
+            int bestPose = -1;
+            int bestTrack = -1;
+            float bestDist = gate;
+            for (int p = 0; p < n; p++) {
+                if (ids[p] != 0) continue;
+                for (int t = 0; t < tracks.size(); t++) {
+                    if (trackUsed[t]) continue;
+                    Track track = tracks.get(t);
+                    float dx = centroids.get(p)[0] - track.x;
+                    float dy = centroids.get(p)[1] - track.y;
+                    float dist = dx * dx + dy * dy;
+                    if (dist <= bestDist) {
+                        bestDist = dist;
+                        bestPose = p;
+                        bestTrack = t;
+                    }
+                }
+            }
+            if (bestPose < 0) break;
+            Track track = tracks.get(bestTrack);
+            track.x = centroids.get(bestPose)[0];
+            track.y = centroids.get(bestPose)[1];
+            track.lastSeenMs = nowMs;
+            trackUsed[bestTrack] = true;
+            ids[bestPose] = track.id;
+        }
+
+        for (int p = 0; p < n; p++) {
+            if (ids[p] == 0) {
+                Track track = new Track(nextId++, centroids.get(p)[0], centroids.get(p)[1], nowMs);
+                tracks.add(track);
+                ids[p] = track.id;
+            }
+        }
+
+        Iterator<Track> it = tracks.iterator();
+        while (it.hasNext()) {
+            Track track = it.next();
+            if (nowMs - track.lastSeenMs > trackTimeoutMs) {
+                expired.add(track.id);
+                it.remove();
+            }
+        }
+        return ids;
+    }
+
+    /**
+     * IDs of tracks expired since the last call
+     */
+    public synchronized List<Integer> drainExpired() {
+        List<Integer> drained = new ArrayList<>(expired);
+        expired.clear();
+        return drained;
+    }
+
+    public synchronized int getTrackCount() {
+        return tracks.size();
+    }
+
+    /**
+     * Forget every track. Live tracks join the expired list rather than
+     * vanishing, and pending expired IDs are kept, so the owner's next
+     * drainExpired() still releases the per-person state of all of them.
+     * IDs are not reused afterwards, so a drained ID never names a new person.
+     */
+    public synchronized void reset() {
+        for (Track track : tracks) {
+            expired.add(track.id);
+        }
+        tracks.clear();
+    }
+
+    /**
+     * Mean position of the visible torso landmarks, or of all landmarks when
+     * the torso is occluded.
+     */
+    public static float[] centroid(List<NormalizedLandmark> pose) {
+        float sx = 0f;
+        float sy = 0f;
+        int count = 0;
+        for (int index : TORSO_LANDMARKS) {
+            if (index >= pose.size()) continue;
+            NormalizedLandmark lm = pose.get(index);
+            if (lm.visibility().orElse(0f) >= MIN_VISIBILITY) {
+                sx += lm.x();
+                sy += lm.y();
+                count++;
+            }
+        }
+        if (count == 0) {
+            for (NormalizedLandmark lm : pose) {
+                sx += lm.x();
+                sy += lm.y();
+                count++;
+            }
+        }
+        return count == 0 ? new float[]{0.5f, 0.5f} : new float[]{sx / count, sy / count};
+    }
+}
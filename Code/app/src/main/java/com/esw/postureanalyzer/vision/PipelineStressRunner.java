@@ -0,0 +1,236 @@
+package com.esw.postureanalyzer.vision;
+
+import android.content.Context;
+import android.graphics.Bitmap;
+import android.graphics.BitmapFactory;
+import android.util.Log;
+
+import com.esw.postureanalyzer.performance.SaturationCurve;
+import com.google.mediapipe.tasks.components.containers.NormalizedLandmark;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.List;
+import java.util.Locale;
+import java.util.Optional;
+import java.util.concurrent.atomic.AtomicReference;
+
+/**
+ * Drives the full decode -> pose -> classify path from a SyntheticFrameSource
+ * at increasing offered rates and records a SaturationCurve.
+ *
+ * Frames are admitted the way the app admits camera frames: one pose
+ * inference in flight, anything arriving meanwhile is dropped. The source
+ * drops frames the reader was too slow for, like a sensor, so loss and
+ * latency both show where the pipeline saturates.
+ *
+ * The test pattern has no person in it, so pose runs detection only and
+ * classification gets a fixed stand-in pose (classifier cost does not depend
+ * on the landmark values). Pass a JPEG of a person with setMjpegTemplate to
+ * measure the landmark stage as well.
+ *
+ * run() blocks; call it off the main thread.
+ */
+public class PipelineStressRunner implements PoseLandmarkerHelper.LandmarkerListener {
+    private static final String TAG = "PipelineStress";
+
+    public static final int[] DEFAULT_OFFERED_FPS = {15, 30, 60, 120, 240, 480};
+    public static final long DEFAULT_STEP_MS = 5000;
+
+    private static final int READ_TIMEOUT_MS = 100;
+    // A result that has not arrived by then is counted as lost
+    private static final long POSE_TIMEOUT_NS = 1_000_000_000L;
+
+    private static final List<NormalizedLandmark> STAND_IN_POSE = standInPose();
+
+    private final int width;
+    private final int height;
+    private final int pixelFormat;
+    private byte[] mjpegTemplate;
+
+    private final PoseLandmarkerHelper poseLandmarkerHelper;
+    private final PostureClassifier postureClassifier;
+
+    private final AtomicReference<InFlight> inFlight = new AtomicReference<>();
+
+    private static final class InFlight {
+        final FrameStamp stamp;
+        final SaturationCurve.Step step;
+        final long decodeNs;
+        final long submittedNs;
+
+        InFlight(FrameStamp stamp, SaturationCurve.Step step, long decodeNs, long submittedNs) {
+            this.stamp = stamp;
+            this.step = step;
+            this.decodeNs = decodeNs;
+            this.submittedNs = submittedNs;
+        }
+    }
+
+    public PipelineStressRunner(Context context, int width, int height, int pixelFormat) {
+        this.width = width;
+        this.height = height;
+        this.pixelFormat = pixelFormat;
+        this.poseLandmarkerHelper = new PoseLandmarkerHelper(context, this);
+        this.poseLandmarkerHelper.setupPoseLandmarker();
+        this.postureClassifier = new PostureClassifier(context);
+    }
+
+    /**
+     * JPEG streamed instead of the test pattern (MJPEG runs only)
+     */
+    public void setMjpegTemplate(byte[] jpeg) {
+        this.mjpegTemplate = jpeg;
+    }
+
+    /**
+     * Run one step per offered rate, each for stepMs. Returns null if the
+     * synthetic source cannot be started.
+     */
+    public SaturationCurve run(int[] offeredFps, long stepMs) {
+        SaturationCurve curve = new SaturationCurve();
+        for (int fps : offeredFps) {
+            SaturationCurve.Point point = runStep(curve, fps, stepMs);
+            if (point == null) {
+                return null;
+            }
+            curve.add(point);
+            Log.i(TAG, String.format(Locale.US,
+                    "offered %d fps: captured %.1f, processed %.1f, loss %.1f%%, latency p50 %.1f ms p95 %.1f ms",
+                    point.offeredFps, point.capturedFps, point.processedFps, point.lossPercent,
+                    point.p50LatencyMs, point.p95LatencyMs));
+        }
+        Log.i(TAG, "Sustained " + curve.getSustainedFps() + " fps, peak "
+                + String.format(Locale.US, "%.1f", curve.getPeakProcessedFps()) + " fps\n" + curve.toCsv());
+        return curve;
+    }
+
+    private SaturationCurve.Point runStep(SaturationCurve curve, int fps, long stepMs) {
+        SyntheticFrameSource source = SyntheticFrameSource.open(width, height, pixelFormat, fps, true,
+                pixelFormat == SyntheticFrameSource.PIXEL_FORMAT_MJPEG ? mjpegTemplate : null);
+        if (source == null) {
+            Log.e(TAG, "Failed to open synthetic source at " + fps + " fps");
+            return null;
+        }
+
+        SaturationCurve.Step step = curve.beginStep(fps);
+        byte[] buffer = source.newFrameBuffer();
+        inFlight.set(null);
+
+        long start = System.nanoTime();
+        long end = start + stepMs * 1_000_000L;
+        try {
+            while (System.nanoTime() < end) {
+                int size = source.read(buffer, READ_TIMEOUT_MS);
+                if (size <= 0) {
+                    continue;
+                }
+                FrameStamp stamp = FrameStamp.parse(buffer, size);
+                if (stamp == null) {
+                    continue;
+                }
+                step.onCaptured(stamp.sequence);
+
+                // Pose busy: this frame is dropped, as the live pipeline would
+                InFlight current = inFlight.get();
+                if (current != null) {
+                    if (System.nanoTime() - current.submittedNs < POSE_TIMEOUT_NS) {
+                        continue;
+                    }
+                    inFlight.compareAndSet(current, null);
+                }
+
+                long decodeStart = System.nanoTime();
+                Bitmap bitmap = decode(buffer, size, source);
+                long decoded = System.nanoTime();
+                if (bitmap == null) {
+                    continue;
+                }
+                inFlight.set(new InFlight(stamp, step, decoded - decodeStart, decoded));
+                poseLandmarkerHelper.detectLiveStream(bitmap, 0);
+                // detectAsync has copied the pixels
+                bitmap.recycle();
+            }
+
+            // Let the last inference finish so it counts toward this step
+            long drainEnd = System.nanoTime() + POSE_TIMEOUT_NS;
+            while (inFlight.get() != null && System.nanoTime() < drainEnd) {
+                Thread.sleep(5);
+            }
+        } catch (InterruptedException e) {
+            Thread.currentThread().interrupt();
+        } finally {
+            source.close();
+        }
+        return step.finish(System.nanoTime() - start);
+    }
+
+    private static Bitmap decode(byte[] buffer, int size, SyntheticFrameSource source) {
+        if (source.getPixelFormat() == SyntheticFrameSource.PIXEL_FORMAT_MJPEG) {
+            return BitmapFactory.decodeByteArray(buffer, 0, size);
+        }
+        byte[] frame = size == buffer.length ? buffer : Arrays.copyOf(buffer, size);
+        return UVCCameraManager.convertYUYVToBitmap(frame, source.getWidth(), source.getHeight());
+    }
+
+    @Override
+    public void onResults(PoseLandmarkerHelper.ResultBundle resultBundle) {
+        InFlight frame = inFlight.getAndSet(null);
+        if (frame == null) {
+            return;
+        }
+        long poseDone = System.nanoTime();
+
+        List<List<NormalizedLandmark>> people = resultBundle.getLandmarks();
+        if (people == null || people.isEmpty()) {
+            people = Collections.singletonList(STAND_IN_POSE);
+        }
+        postureClassifier.classifyBatch(people, resultBundle.getInputImageWidth(),
+                resultBundle.getInputImageHeight());
+        long classified = System.nanoTime();
+
+        frame.step.onProcessed(classified - frame.stamp.timestampNs, frame.decodeNs,
+                poseDone - frame.submittedNs, classified - poseDone);
+    }
+
+    @Override
+    public void onError(String error) {
+        Log.e(TAG, "Pose error during stress run: " + error);
+        inFlight.set(null);
+    }
+
+    public void release() {
+        poseLandmarkerHelper.clearPoseLandmarker();
+        postureClassifier.close();
+    }
+
+    /**
+     * Upright seated figure facing the camera, 33 BlazePose landmarks
+     */
+    private static List<NormalizedLandmark> standInPose() {
+        float[][] xy = {
+                {0.50f, 0.20f},                                                   // nose
+                {0.48f, 0.18f}, {0.47f, 0.18f}, {0.46f, 0.18f},                   // left eye
+                {0.52f, 0.18f}, {0.53f, 0.18f}, {0.54f, 0.18f},                   // right eye
+                {0.44f, 0.19f}, {0.56f, 0.19f},                                   // ears
+                {0.49f, 0.23f}, {0.51f, 0.23f},                                   // mouth
+                {0.40f, 0.32f}, {0.60f, 0.32f},                                   // shoulders
+                {0.37f, 0.45f}, {0.63f, 0.45f},                                   // elbows
+                {0.40f, 0.56f}, {0.60f, 0.56f},                                   // wrists
+                {0.41f, 0.58f}, {0.59f, 0.58f},                                   // pinkies
+                {0.42f, 0.58f}, {0.58f, 0.58f},                                   // index
+                {0.42f, 0.57f}, {0.58f, 0.57f},                                   // thumbs
+                {0.44f, 0.60f}, {0.56f, 0.60f},                                   // hips
+                {0.43f, 0.75f}, {0.57f, 0.75f},                                   // knees
+                {0.43f, 0.90f}, {0.57f, 0.90f},                                   // ankles
+                {0.43f, 0.92f}, {0.57f, 0.92f},                                   // heels
+                {0.45f, 0.93f}, {0.55f, 0.93f},                                   // foot index
+        };
+        List<NormalizedLandmark> pose = new ArrayList<>(xy.length);
+        for (float[] point : xy) {
+            pose.add(NormalizedLandmark.create(point[0], point[1], 0f, Optional.of(1f), Optional.of(1f)));
+        }
+        return Collections.unmodifiableList(pose);
+    }
+}
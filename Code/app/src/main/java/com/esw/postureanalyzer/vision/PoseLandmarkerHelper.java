@@ -2,30 +2,57 @@ package com.esw.postureanalyzer.vision;
 
 import android.content.Context;
 import android.graphics.Bitmap;
-import android.graphics.Matrix;
 import android.os.SystemClock;
 import android.util.Log;
 import com.google.mediapipe.framework.image.BitmapImageBuilder;
 import com.google.mediapipe.framework.image.MPImage;
+import com.google.mediapipe.tasks.components.containers.NormalizedLandmark;
 import com.google.mediapipe.tasks.core.BaseOptions;
 import com.google.mediapipe.tasks.core.Delegate;
+import com.google.mediapipe.tasks.vision.core.ImageProcessingOptions;
 import com.google.mediapipe.tasks.vision.core.RunningMode;
 import com.google.mediapipe.tasks.vision.poselandmarker.PoseLandmarker;
 import com.google.mediapipe.tasks.vision.poselandmarker.PoseLandmarkerResult;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Map;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
 
 public class PoseLandmarkerHelper {
     private static final String TAG = "PoseLandmarkerHelper";
     public static final int DELEGATE_CPU = 0;
     public static final int DELEGATE_GPU = 1;
-    private static final String MODEL_PATH = "pose_landmarker_lite.task";
+    public static final String DEFAULT_MODEL_PATH = "pose_landmarker_lite.task";
+    /** Shared desks seat two; each extra pose costs one landmark pass */
+    public static final int DEFAULT_NUM_POSES = 2;
 
     private final Context context;
     private final LandmarkerListener listener;
-    private PoseLandmarker poseLandmarker;
-    private int currentDelegate = DELEGATE_CPU;
-    private final Object lock = new Object(); // Synchronization lock
+    // Delegate, model and pose count changes rebuild the landmarker on
+    // swapExecutor; frames keep going to the current one until the swap
+    private final ExecutorService swapExecutor = Executors.newSingleThreadExecutor(r -> {
+        Thread t = new Thread(r, "LandmarkerSwap");
+        t.setDaemon(true);
+        return t;
+    });
+    private final HotSwap<PoseLandmarker> landmarkers = new HotSwap<>(landmarker -> {
+        try {
+            // Waits for frames already submitted to it to come back
+            landmarker.close();
+        } catch (Exception e) {
+            Log.e(TAG, "Error closing retired PoseLandmarker", e);
+        }
+    }, swapExecutor);
+    private volatile int currentDelegate = DELEGATE_CPU;
+    private volatile int numPoses = DEFAULT_NUM_POSES;
+    private volatile String modelPath = DEFAULT_MODEL_PATH;
+    private final Object lock = new Object(); // Orders setup, clear and swaps
+    private int generation; // Bumped by setup and clear; a swap started under an older one is dropped
+    private volatile long lastResultMs = -1;
     private volatile boolean isInitialized = false;
     private volatile boolean isProcessing = false; // Track if currently processing a frame
+    private volatile int lastRotationDegrees = 0; // Rotation of the frame in flight
     
     private final PerformanceMonitor performanceMonitor = new PerformanceMonitor("PoseLandmarker");
 
@@ -36,97 +63,154 @@ public class PoseLandmarkerHelper {
 
     public void setupPoseLandmarker() {
         synchronized (lock) {
-            try {
-                // Clear any existing instance first
-                if (poseLandmarker != null) {
-                    poseLandmarker.close();
-                    poseLandmarker = null;
-                }
-                
+            generation++;
+            PoseLandmarker landmarker = buildPoseLandmarker();
+            if (landmarker != null) {
+                // Replaces any running instance; it is closed once its frames are back
+                landmarkers.publish(landmarker, 0);
+                performanceMonitor.reset();
+                lastResultMs = -1;
+                isInitialized = true;
+            } else {
+                landmarkers.clear();
                 isInitialized = false;
-                
-                BaseOptions.Builder baseOptionsBuilder = BaseOptions.builder();
-                if (currentDelegate == DELEGATE_GPU) {
-                    Log.d(TAG, "Setting up PoseLandmarker with GPU delegate");
-                    try {
-                        baseOptionsBuilder.setDelegate(Delegate.GPU);
-                        Log.d(TAG, "  ✓ GPU delegate set for MediaPipe");
-                    } catch (Exception e) {
-                        Log.e(TAG, "  ✗ Failed to set GPU delegate, falling back to CPU", e);
-                        currentDelegate = DELEGATE_CPU; // Fallback to CPU
+            }
+        }
+    }
+
+    /**
+     * Rebuild with the current settings on the swap thread and swap the new
+     * landmarker in when it is ready. Only the latest request is built.
+     */
+    private void swapPoseLandmarker() {
+        final int requested;
+        synchronized (lock) {
+            requested = ++generation;
+        }
+        swapExecutor.execute(() -> {
+            synchronized (lock) {
+                if (requested != generation) {
+                    return;
+                }
+            }
+            landmarkers.beginSwap();
+            long startMs = SystemClock.uptimeMillis();
+            PoseLandmarker landmarker = buildPoseLandmarker();
+            long buildMs = SystemClock.uptimeMillis() - startMs;
+            synchronized (lock) {
+                if (landmarker == null || requested != generation) {
+                    // Failed, or cleared / set up again while building: keep what is running
+                    landmarkers.abortSwap();
+                    if (landmarker != null) {
+                        landmarker.close();
                     }
-                } else {
-                    Log.d(TAG, "Setting up PoseLandmarker with CPU");
+                    return;
                 }
-                baseOptionsBuilder.setModelAssetPath(MODEL_PATH);
-
-                PoseLandmarker.PoseLandmarkerOptions.Builder optionsBuilder =
-                        PoseLandmarker.PoseLandmarkerOptions.builder()
-                                .setBaseOptions(baseOptionsBuilder.build())
-                                .setRunningMode(RunningMode.LIVE_STREAM)
-                                .setResultListener(this::returnLivestreamResult)
-                                .setErrorListener(this::returnLivestreamError);
-                                
-                poseLandmarker = PoseLandmarker.createFromOptions(context, optionsBuilder.build());
-                isInitialized = true;
+                landmarkers.publish(landmarker, buildMs);
                 performanceMonitor.reset();
-                
-                String delegateStr = (currentDelegate == DELEGATE_GPU) ? "GPU" : "CPU";
-                Log.d(TAG, "✓ PoseLandmarker initialized successfully with " + delegateStr);
-            } catch (Exception e) {
-                isInitialized = false;
-                String delegateStr = (currentDelegate == DELEGATE_GPU) ? "GPU" : "CPU";
-                Log.e(TAG, "✗ MediaPipe failed to load with " + delegateStr, e);
-                
-                // Try fallback to CPU if GPU failed
-                if (currentDelegate == DELEGATE_GPU) {
-                    Log.w(TAG, "→ Attempting fallback to CPU...");
-                    currentDelegate = DELEGATE_CPU;
-                    setupPoseLandmarker(); // Retry with CPU
-                } else {
-                    listener.onError("Pose Landmarker failed to initialize. See error logs for details.");
-                    Log.e(TAG, "Critical: CPU initialization also failed", e);
+                isInitialized = true;
+            }
+            Log.d(TAG, "✓ Swapped in new PoseLandmarker after " + buildMs + "ms in the background");
+        });
+    }
+
+    /**
+     * Create a landmarker with the current settings, falling back to CPU if
+     * GPU fails. Returns null (after reporting the error) if CPU fails too.
+     */
+    private PoseLandmarker buildPoseLandmarker() {
+        try {
+            BaseOptions.Builder baseOptionsBuilder = BaseOptions.builder();
+            if (currentDelegate == DELEGATE_GPU) {
+                Log.d(TAG, "Setting up PoseLandmarker with GPU delegate");
+                try {
+                    baseOptionsBuilder.setDelegate(Delegate.GPU);
+                    Log.d(TAG, "  ✓ GPU delegate set for MediaPipe");
+                } catch (Exception e) {
+                    Log.e(TAG, "  ✗ Failed to set GPU delegate, falling back to CPU", e);
+                    currentDelegate = DELEGATE_CPU; // Fallback to CPU
                 }
+            } else {
+                Log.d(TAG, "Setting up PoseLandmarker with CPU");
+            }
+            baseOptionsBuilder.setModelAssetPath(modelPath);
+
+            PoseLandmarker.PoseLandmarkerOptions.Builder optionsBuilder =
+                    PoseLandmarker.PoseLandmarkerOptions.builder()
+                            .setBaseOptions(baseOptionsBuilder.build())
+                            .setRunningMode(RunningMode.LIVE_STREAM)
+                            .setNumPoses(numPoses)
+                            .setResultListener(this::returnLivestreamResult)
+                            .setErrorListener(this::returnLivestreamError);
+                            
+            PoseLandmarker landmarker = PoseLandmarker.createFromOptions(context, optionsBuilder.build());
+            
+            String delegateStr = (currentDelegate == DELEGATE_GPU) ? "GPU" : "CPU";
+            Log.d(TAG, "✓ PoseLandmarker initialized successfully with " + delegateStr
+                    + " (" + modelPath + ", up to " + numPoses + " poses)");
+            return landmarker;
+        } catch (Exception e) {
+            String delegateStr = (currentDelegate == DELEGATE_GPU) ? "GPU" : "CPU";
+            Log.e(TAG, "✗ MediaPipe failed to load with " + delegateStr, e);
+            
+            // Try fallback to CPU if GPU failed
+            if (currentDelegate == DELEGATE_GPU) {
+                Log.w(TAG, "→ Attempting fallback to CPU...");
+                currentDelegate = DELEGATE_CPU;
+                return buildPoseLandmarker(); // Retry with CPU
+            } else {
+                listener.onError("Pose Landmarker failed to initialize. See error logs for details.");
+                Log.e(TAG, "Critical: CPU initialization also failed", e);
+                return null;
             }
         }
     }
 
     public void detectLiveStream(Bitmap bitmap, int imageRotation) {
-        if (!isInitialized || poseLandmarker == null) {
+        if (bitmap == null || bitmap.isRecycled()) {
+            Log.w(TAG, "Bitmap is null or recycled, skipping detection");
+            return;
+        }
+        detectLiveStream(new BitmapImageBuilder(bitmap).build(), imageRotation);
+    }
+
+    /**
+     * Run detection on a frame in sensor orientation. The rotation is handed to
+     * MediaPipe as metadata instead of rotating the pixels, and the returned
+     * landmarks are mapped back to the upright frame in returnLivestreamResult.
+     */
+    public void detectLiveStream(MPImage mpImage, int imageRotation) {
+        if (!isInitialized) {
             Log.w(TAG, "PoseLandmarker not initialized, skipping detection");
             return;
         }
         
-        if (bitmap == null || bitmap.isRecycled()) {
-            Log.w(TAG, "Bitmap is null or recycled, skipping detection");
+        if (mpImage == null) {
+            Log.w(TAG, "Image is null, skipping detection");
             return;
         }
         
-        synchronized (lock) {
-            if (!isInitialized || poseLandmarker == null) {
+        // The lease keeps a landmarker being swapped out open until detectAsync
+        // has taken the frame; no lock is shared with the swap
+        try (HotSwap.Lease<PoseLandmarker> lease = landmarkers.acquire()) {
+            if (lease == null) {
                 return;
             }
+            PoseLandmarker poseLandmarker = lease.get();
             
             try {
                 isProcessing = true;
                 performanceMonitor.startTotal();
                 
-                Matrix matrix = new Matrix();
-                matrix.postRotate(imageRotation);
-                Bitmap rotatedBitmap = Bitmap.createBitmap(bitmap, 0, 0, bitmap.getWidth(), bitmap.getHeight(), matrix, false);
-                
-                if (rotatedBitmap == null || rotatedBitmap.isRecycled()) {
-                    Log.w(TAG, "Rotated bitmap is invalid, skipping detection");
-                    isProcessing = false;
-                    return;
-                }
-                
-                MPImage mpImage = new BitmapImageBuilder(rotatedBitmap).build();
+                ImageProcessingOptions processingOptions = ImageProcessingOptions.builder()
+                        .setRotationDegrees(imageRotation)
+                        .build();
+                lastRotationDegrees = imageRotation;
                 
                 performanceMonitor.startInference();
-                poseLandmarker.detectAsync(mpImage, SystemClock.uptimeMillis());
-                
-                // Don't recycle rotatedBitmap here as MediaPipe might still be using it
+                // detectAsync copies the pixels into its own packet, so the caller
+                // may release the backing buffer as soon as this returns
+                poseLandmarker.detectAsync(mpImage, processingOptions, SystemClock.uptimeMillis());
             } catch (IllegalStateException e) {
                 Log.e(TAG, "MediaPipe closed during detection", e);
                 isInitialized = false;
@@ -148,8 +232,19 @@ public class PoseLandmarkerHelper {
                 Log.w(TAG, "Null result or input in callback");
                 return;
             }
+            // A stalled swap shows up as a gap between results
+            long nowMs = SystemClock.uptimeMillis();
+            if (lastResultMs >= 0) {
+                landmarkers.recordFrame(nowMs - lastResultMs);
+            }
+            lastResultMs = nowMs;
             long inferenceTime = performanceMonitor.getLastTotalMs();
-            listener.onResults(new ResultBundle(result, inferenceTime, input.getWidth(), input.getHeight()));
+            int rotation = lastRotationDegrees;
+            boolean swapAxes = rotation == 90 || rotation == 270;
+            int width = swapAxes ? input.getHeight() : input.getWidth();
+            int height = swapAxes ? input.getWidth() : input.getHeight();
+            listener.onResults(new ResultBundle(result, toUpright(result.landmarks(), rotation),
+                    inferenceTime, width, height));
         } catch (Exception e) {
             Log.e(TAG, "Error in returnLivestreamResult", e);
             isProcessing = false;
@@ -171,39 +266,107 @@ public class PoseLandmarkerHelper {
         }
     }
 
+    /**
+     * Map normalized landmarks from sensor orientation to the upright frame
+     * (rotationDegrees clockwise). Returns the input lists untouched for 0°.
+     */
+    static List<List<NormalizedLandmark>> toUpright(List<List<NormalizedLandmark>> poses, int rotationDegrees) {
+        if (rotationDegrees == 0 || poses.isEmpty()) {
+            return poses;
+        }
+        List<List<NormalizedLandmark>> upright = new ArrayList<>(poses.size());
+        for (List<NormalizedLandmark> pose : poses) {
+            List<NormalizedLandmark> rotated = new ArrayList<>(pose.size());
+            for (NormalizedLandmark lm : pose) {
+                float x;
+                float y;
+                switch (rotationDegrees) {
+                    case 90:  x = 1f - lm.y(); y = lm.x();      break;
+                    case 180: x = 1f - lm.x(); y = 1f - lm.y(); break;
+                    case 270: x = lm.y();      y = 1f - lm.x(); break;
+                    default:  x = lm.x();      y = lm.y();      break;
+                }
+                rotated.add(NormalizedLandmark.create(x, y, lm.z(), lm.visibility(), lm.presence()));
+            }
+            upright.add(rotated);
+        }
+        return upright;
+    }
+
     public void clearPoseLandmarker() {
         synchronized (lock) {
-            try {
-                isInitialized = false;
-                if (poseLandmarker != null) {
-                    poseLandmarker.close();
-                    poseLandmarker = null;
-                    Log.d(TAG, "PoseLandmarker cleared");
-                }
-            } catch (Exception e) {
-                Log.e(TAG, "Error clearing PoseLandmarker", e);
-                poseLandmarker = null; // Force null even if close fails
+            generation++; // Drops any swap still building
+            isInitialized = false;
+            if (!landmarkers.isEmpty()) {
+                // Closed on the swap thread once in-flight frames are back
+                landmarkers.clear();
+                Log.d(TAG, "PoseLandmarker cleared");
             }
         }
     }
 
+    /**
+     * Switch the MediaPipe delegate. The new landmarker is built in the
+     * background and swapped in; frames keep using the current one meanwhile.
+     */
     public void setCurrentDelegate(int delegate) {
         if (currentDelegate != delegate) {
             currentDelegate = delegate;
-            clearPoseLandmarker();
-            setupPoseLandmarker();
+            swapPoseLandmarker();
         }
     }
     
     public int getCurrentDelegate() {
         return currentDelegate;
     }
+
+    /**
+     * Set the maximum number of people detected per frame. Swaps in a
+     * rebuilt landmarker if one is already running.
+     */
+    public void setNumPoses(int poses) {
+        int clamped = Math.max(1, poses);
+        if (numPoses != clamped) {
+            numPoses = clamped;
+            if (isInitialized) {
+                swapPoseLandmarker();
+            }
+        }
+    }
+
+    public int getNumPoses() {
+        return numPoses;
+    }
+
+    /**
+     * Switch the pose model (a .task asset), e.g. when the model cascade
+     * changes level. Swaps in a rebuilt landmarker if one is already running.
+     */
+    public void setModelPath(String path) {
+        if (!modelPath.equals(path)) {
+            modelPath = path;
+            if (isInitialized) {
+                swapPoseLandmarker();
+            }
+        }
+    }
+
+    public String getModelPath() {
+        return modelPath;
+    }
     
     /**
      * Get performance statistics
      */
     public String getPerformanceStats() {
-        return performanceMonitor.getStats();
+        return performanceMonitor.getStats() + "\n\nSwaps (result gap):\n" + landmarkers.getStats();
+    }
+
+    /**
+     * Landmarker swap counts, build times and the worst result gap around a swap
+     */
+    public Map<String, Object> getSwapMetrics() {
+        return landmarkers.getMetricsMap();
     }
 
     public interface LandmarkerListener {
@@ -213,17 +376,22 @@ public class PoseLandmarkerHelper {
 
     public static class ResultBundle {
         private final PoseLandmarkerResult results;
+        private final List<List<NormalizedLandmark>> landmarks;
         private final long inferenceTime;
         private final int inputImageWidth;
         private final int inputImageHeight;
 
-        public ResultBundle(PoseLandmarkerResult results, long inferenceTime, int width, int height) {
+        public ResultBundle(PoseLandmarkerResult results, List<List<NormalizedLandmark>> landmarks,
+                            long inferenceTime, int width, int height) {
             this.results = results;
+            this.landmarks = landmarks;
             this.inferenceTime = inferenceTime;
             this.inputImageWidth = width;
             this.inputImageHeight = height;
         }
         public PoseLandmarkerResult getResults() { return results; }
+        /** Landmarks in the upright frame (width/height below are upright too) */
+        public List<List<NormalizedLandmark>> getLandmarks() { return landmarks; }
         public long getInferenceTime() { return inferenceTime; }
         public int getInputImageWidth() { return inputImageWidth; }
         public int getInputImageHeight() { return inputImageHeight; }
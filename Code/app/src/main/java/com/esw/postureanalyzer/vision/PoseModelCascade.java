@@ -0,0 +1,380 @@
+package com.esw.postureanalyzer.vision;
+
+import com.google.mediapipe.tasks.components.containers.NormalizedLandmark;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Collection;
+import java.util.EnumMap;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Locale;
+import java.util.Map;
+
+/**
+ * Picks the pose model variant and camera input resolution from recent
+ * landmark quality and pose latency.
+ *
+ * Levels run cheapest first. Quality is the mean of PDJ and OKS
+ * (EvaluationMetrics) over the people in view, leaving out joints only a
+ * gated-off posture model needs (see scoredJoints); latency is the landmarker's
+ * time per frame against the frame interval the pipeline is admitting.
+ * Both are smoothed over the current stint at a level, and nothing moves
+ * before the stint is MIN_DWELL_MS old:
+ *   - latency over budget steps down one level
+ *   - quality under LOW_QUALITY steps up one level
+ *   - quality over HIGH_QUALITY tries one level down
+ * The gap between the two quality thresholds is the first guard against
+ * flapping. The second: a level that is backed out of (left the way it was
+ * entered from) within PROBE_WINDOW_MS is locked against quality-driven
+ * re-entry for a backoff that doubles each time, so the cascade settles on
+ * the cheapest level that holds instead of bouncing between neighbours.
+ * Latency overruns ignore locks.
+ *
+ * Times are caller-supplied milliseconds on a monotonic clock.
+ */
+public class PoseModelCascade {
+    public static final double LOW_QUALITY = 60.0;
+    public static final double HIGH_QUALITY = 85.0;
+    public static final long MIN_DWELL_MS = 5000;
+    public static final long PROBE_WINDOW_MS = 30_000;
+    public static final long INITIAL_BACKOFF_MS = 30_000;
+    public static final long MAX_BACKOFF_MS = 5 * 60_000;
+    /** No level change for this long counts as converged */
+    public static final long CONVERGED_MS = 60_000;
+    public static final double DEFAULT_LATENCY_BUDGET_MS = 1000.0 / LandmarkFilter.SMOOTHED_POSE_FPS;
+
+    // Samples a stint needs before its averages are trusted
+    private static final int MIN_SAMPLES = 15;
+    private static final double EWMA_ALPHA = 0.1;
+    private static final double PDJ_VISIBILITY = 0.5;
+
+    /**
+     * Model and input resolution per level, cheapest first. LITE is what the
+     * app ran before the cascade and is where it starts.
+     */
+    public enum Level {
+        //        model asset                   width height
+        LITE_LOW( "pose_landmarker_lite.task",  640,  480),
+        LITE(     "pose_landmarker_lite.task",  1280, 720),
+        FULL(     "pose_landmarker_full.task",  1280, 720),
+        HEAVY(    "pose_landmarker_heavy.task", 1280, 720);
+
+        public final String modelAsset;
+        public final int inputWidth;
+        public final int inputHeight;
+
+        Level(String modelAsset, int inputWidth, int inputHeight) {
+            this.modelAsset = modelAsset;
+            this.inputWidth = inputWidth;
+            this.inputHeight = inputHeight;
+        }
+    }
+
+    public enum Reason {
+        LATENCY,      // over the latency budget
+        LOW_QUALITY,  // landmarks too poor, heavier level
+        HIGH_QUALITY, // landmarks good enough to try cheaper
+    }
+
+    /**
+     * A recorded level change
+     */
+    public static class Switch {
+        public final Level from;
+        public final Level to;
+        public final Reason reason;
+        public final double quality;
+        public final double latencyMs;
+
+        Switch(Level from, Level to, Reason reason, double quality, double latencyMs) {
+            this.from = from;
+            this.to = to;
+            this.reason = reason;
+            this.quality = quality;
+            this.latencyMs = latencyMs;
+        }
+
+        @Override
+        public String toString() {
+            return String.format(Locale.US, "%s -> %s (%s, quality %.0f, latency %.1f ms)",
+                    from, to, reason, quality, latencyMs);
+        }
+    }
+
+    public interface LevelListener {
+        void onLevelChanged(Switch change);
+    }
+
+    /**
+     * Lifetime totals for one level
+     */
+    private static class LevelStats {
+        long timeMs;
+        int frames;
+        int qualityFrames;
+        double qualitySum;
+        double latencySumMs;
+        long lockedUntilMs = -1;
+        long backoffMs = INITIAL_BACKOFF_MS;
+    }
+
+    private final List<Level> levels;
+    private final Map<Level, LevelStats> stats = new EnumMap<>(Level.class);
+    private int index;
+    private double latencyBudgetMs = DEFAULT_LATENCY_BUDGET_MS;
+    private LevelListener listener;
+
+    private long levelSinceMs = -1;
+    private int enteredFrom; // +1 stepped up into the level, -1 stepped down, 0 start
+    private long lastSampleMs;
+    private double quality;
+    private int qualitySamples;
+    private double latencyMs;
+    private int latencySamples;
+    private int switches;
+
+    /**
+     * @param available levels whose model asset is installed; LITE must be one of them
+     */
+    public PoseModelCascade(Collection<Level> available) {
+        levels = new ArrayList<>();
+        for (Level level : Level.values()) {
+            if (available.contains(level)) {
+                levels.add(level);
+                stats.put(level, new LevelStats());
+            }
+        }
+        if (!levels.contains(Level.LITE)) {
+            throw new IllegalArgumentException("LITE level is required");
+        }
+        index = levels.indexOf(Level.LITE);
+    }
+
+    /**
+     * Levels whose model is among the given asset names
+     */
+    public static List<Level> availableLevels(Collection<String> assetNames) {
+        List<Level> available = new ArrayList<>();
+        for (Level level : Level.values()) {
+            if (assetNames.contains(level.modelAsset)) {
+                available.add(level);
+            }
+        }
+        return available;
+    }
+
+    /**
+     * Mean of PDJ and OKS over the people in view (0-100), or NaN with nobody in view
+     */
+    public static double qualityScore(List<List<NormalizedLandmark>> people) {
+        if (people == null || people.isEmpty()) {
+            return Double.NaN;
+        }
+        double sum = 0.0;
+        for (List<NormalizedLandmark> pose : people) {
+            boolean[] joints = scoredJoints(pose);
+            double pdj = EvaluationMetrics.calculatePDJ(pose, PDJ_VISIBILITY, joints);
+            double oks = EvaluationMetrics.calculateOKS(pose, joints);
+            if (Double.isNaN(pdj) || Double.isNaN(oks)) {
+                // Too few landmarks to score at all
+                pdj = 0.0;
+                oks = 0.0;
+            }
+            sum += (pdj + oks) / 2.0;
+        }
+        return sum / people.size();
+    }
+
+    /**
+     * Joints that count towards quality. Landmarks only a gated-off model
+     * needs, typically knees and ankles under a desk, are left out: that
+     * occlusion is not something a heavier landmarker fixes, and scoring it
+     * would hold the cascade at its most expensive level. The torso is
+     * always scored, since anyone at the desk has it in frame and low
+     * visibility there is the landmarker's doing.
+     */
+    static boolean[] scoredJoints(List<NormalizedLandmark> pose) {
+        boolean[] scored = new boolean[pose.size()];
+        Arrays.fill(scored, true);
+        for (VisibilityGate.Model model : VisibilityGate.Model.values()) {
+            if (!VisibilityGate.inView(model, pose)) {
+                markJoints(scored, model, false);
+            }
+        }
+        markJoints(scored, VisibilityGate.Model.SLOUCH, true);
+        return scored;
+    }
+
+    private static void markJoints(boolean[] scored, VisibilityGate.Model model, boolean value) {
+        for (int index : model.landmarks) {
+            if (index < scored.length) {
+                scored[index] = value;
+            }
+        }
+    }
+
+    public void setLevelListener(LevelListener listener) {
+        this.listener = listener;
+    }
+
+    /**
+     * Latency the landmarker must stay under, normally the admitted frame interval
+     */
+    public synchronized void setLatencyBudgetMs(double budgetMs) {
+        latencyBudgetMs = budgetMs;
+    }
+
+    /**
+     * Record one pose result and move between levels if needed.
+     *
+     * @param qualityScore qualityScore() of the frame; NaN (nobody in view) only counts latency
+     * @param latencyMs    landmarker time for the frame
+     * @param nowMs        monotonic time in milliseconds
+     * @return the level in effect after this sample
+     */
+    public Level record(double qualityScore, double latencyMs, long nowMs) {
+        Switch change;
+        synchronized (this) {
+            change = update(qualityScore, latencyMs, nowMs);
+        }
+        // Outside the lock so the listener may call back in
+        if (change != null && listener != null) {
+            listener.onLevelChanged(change);
+        }
+        return getLevel();
+    }
+
+    private Switch update(double qualityScore, double sampleLatencyMs, long nowMs) {
+        if (levelSinceMs < 0) {
+            levelSinceMs = nowMs;
+        }
+        lastSampleMs = nowMs;
+
+        Level level = levels.get(index);
+        LevelStats levelStats = stats.get(level);
+        levelStats.frames++;
+        levelStats.latencySumMs += sampleLatencyMs;
+        latencyMs = latencySamples == 0 ? sampleLatencyMs : latencyMs + EWMA_ALPHA * (sampleLatencyMs - latencyMs);
+        latencySamples++;
+        if (!Double.isNaN(qualityScore)) {
+            levelStats.qualityFrames++;
+            levelStats.qualitySum += qualityScore;
+            quality = qualitySamples == 0 ? qualityScore : quality + EWMA_ALPHA * (qualityScore - quality);
+            qualitySamples++;
+        }
+
+        if (nowMs - levelSinceMs < MIN_DWELL_MS) {
+            return null;
+        }
+        if (latencySamples >= MIN_SAMPLES && latencyMs > latencyBudgetMs && index > 0) {
+            return moveTo(index - 1, Reason.LATENCY, nowMs);
+        }
+        if (qualitySamples < MIN_SAMPLES) {
+            return null;
+        }
+        if (quality < LOW_QUALITY && index < levels.size() - 1 && !isLocked(index + 1, nowMs)) {
+            return moveTo(index + 1, Reason.LOW_QUALITY, nowMs);
+        }
+        if (quality > HIGH_QUALITY && index > 0 && !isLocked(index - 1, nowMs)) {
+            return moveTo(index - 1, Reason.HIGH_QUALITY, nowMs);
+        }
+        return null;
+    }
+
+    private boolean isLocked(int target, long nowMs) {
+        return nowMs < stats.get(levels.get(target)).lockedUntilMs;
+    }
+
+    private Switch moveTo(int target, Reason reason, long nowMs) {
+        Level from = levels.get(index);
+        LevelStats fromStats = stats.get(from);
+        long stint = nowMs - levelSinceMs;
+        int direction = target > index ? 1 : -1;
+        fromStats.timeMs += stint;
+        if (direction == -enteredFrom && stint < PROBE_WINDOW_MS) {
+            // Backed out of a level that didn't hold: keep quality moves off it for a while
+            fromStats.lockedUntilMs = nowMs + fromStats.backoffMs;
+            fromStats.backoffMs = Math.min(fromStats.backoffMs * 2, MAX_BACKOFF_MS);
+        } else if (stint >= PROBE_WINDOW_MS) {
+            fromStats.backoffMs = INITIAL_BACKOFF_MS;
+        }
+
+        Switch change = new Switch(from, levels.get(target), reason, quality, latencyMs);
+        index = target;
+        enteredFrom = direction;
+        levelSinceMs = nowMs;
+        quality = 0.0;
+        qualitySamples = 0;
+        latencyMs = 0.0;
+        latencySamples = 0;
+        switches++;
+        return change;
+    }
+
+    public synchronized Level getLevel() {
+        return levels.get(index);
+    }
+
+    public synchronized List<Level> getLevels() {
+        return new ArrayList<>(levels);
+    }
+
+    /**
+     * No level change for CONVERGED_MS
+     */
+    public synchronized boolean isConverged() {
+        return levelSinceMs >= 0 && lastSampleMs - levelSinceMs >= CONVERGED_MS;
+    }
+
+    public synchronized int getSwitches() {
+        return switches;
+    }
+
+    /**
+     * Operating point: current level, its smoothed quality and latency,
+     * whether it has converged, and time share and means per level
+     */
+    public synchronized Map<String, Object> getMetricsMap() {
+        Level level = levels.get(index);
+        Map<String, Object> metrics = new HashMap<>();
+        metrics.put("level", level.name());
+        metrics.put("model", level.modelAsset);
+        metrics.put("inputResolution", level.inputWidth + "x" + level.inputHeight);
+        metrics.put("quality", qualitySamples > 0 ? Math.round(quality * 10.0) / 10.0 : null);
+        metrics.put("latencyMs", latencySamples > 0 ? Math.round(latencyMs * 10.0) / 10.0 : null);
+        metrics.put("latencyBudgetMs", Math.round(latencyBudgetMs * 10.0) / 10.0);
+        metrics.put("stableForMs", levelSinceMs >= 0 ? lastSampleMs - levelSinceMs : 0);
+        metrics.put("converged", isConverged());
+        metrics.put("switches", switches);
+
+        Map<String, Object> perLevel = new HashMap<>();
+        for (Level l : levels) {
+            LevelStats s = stats.get(l);
+            long timeMs = s.timeMs + (l == level && levelSinceMs >= 0 ? lastSampleMs - levelSinceMs : 0);
+            if (s.frames == 0) {
+                continue;
+            }
+            Map<String, Object> entry = new HashMap<>();
+            entry.put("timeMs", timeMs);
+            entry.put("frames", s.frames);
+            entry.put("meanLatencyMs", Math.round(s.latencySumMs / s.frames * 10.0) / 10.0);
+            if (s.qualityFrames > 0) {
+                entry.put("meanQuality", Math.round(s.qualitySum / s.qualityFrames * 10.0) / 10.0);
+            }
+            perLevel.put(l.name(), entry);
+        }
+        metrics.put("levels", perLevel);
+        return metrics;
+    }
+
+    /**
+     * One-line operating point for the stats panel
+     */
+    public synchronized String getStats() {
+        Level level = levels.get(index);
+        return String.format(Locale.US, "%s (%dx%d)%s\nQuality: %.0f, latency %.1f / %.1f ms, %d switches",
+                level.name(), level.inputWidth, level.inputHeight, isConverged() ? ", converged" : "",
+                quality, latencyMs, latencyBudgetMs, switches);
+    }
+}
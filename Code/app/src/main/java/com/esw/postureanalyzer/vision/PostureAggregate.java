@@ -0,0 +1,165 @@
+package com.esw.postureanalyzer.vision;
+
+import java.util.Calendar;
+import java.util.HashMap;
+import java.util.Locale;
+import java.util.Map;
+
+/**
+ * Mergeable summary of posture_logs records: a state-code histogram plus the
+ * sums behind the metric averages.
+ *
+ * Per-day aggregates are cached under daily_aggregates/{yyyy-MM-dd} so
+ * multi-day reports only scan raw records for days not yet summarised. A
+ * cached day is removed whenever a record for it is written or deleted.
+ */
+public class PostureAggregate {
+    private static final String STATE_KEY_PREFIX = "s";
+
+    public final String date; // yyyy-MM-dd, or null for an arbitrary range
+    public final int[] stateHistogram = new int[PostureState.CODE_COUNT];
+    public int totalEntries;
+    public double pdjSum;
+    public int pdjCount;
+    public double oksSum;
+    public int oksCount;
+    public double inferenceTimeSum;
+    public int inferenceCount;
+
+    public PostureAggregate(String date) {
+        this.date = date;
+    }
+
+    /**
+     * daily_aggregates key (local date) of the day containing a timestamp
+     */
+    public static String dayKey(long timestampMs) {
+        Calendar cal = Calendar.getInstance();
+        cal.setTimeInMillis(timestampMs);
+        return String.format(Locale.US, "%04d-%02d-%02d",
+                cal.get(Calendar.YEAR), cal.get(Calendar.MONTH) + 1, cal.get(Calendar.DAY_OF_MONTH));
+    }
+
+    /**
+     * Add one posture_logs record in its map form
+     */
+    @SuppressWarnings("unchecked")
+    public void addRecord(Map<String, Object> entry) {
+        Object metrics = entry.get("metrics");
+        Object inferenceTime = entry.containsKey("inferenceTimeMs")
+                ? entry.get("inferenceTimeMs") : entry.get("inferenceTime");
+        add(PostureState.fromRecord(entry),
+                metrics instanceof Map ? (Map<String, Object>) metrics : null,
+                inferenceTime instanceof Number ? (Number) inferenceTime : null);
+    }
+
+    /**
+     * Add one record from its decoded parts
+     */
+    public void add(byte state, Map<String, Object> metrics, Number inferenceTime) {
+        stateHistogram[PostureState.index(state)]++;
+        totalEntries++;
+
+        if (metrics != null) {
+            Object pdj = metrics.get("pdj");
+            if (pdj instanceof Number) {
+                pdjSum += ((Number) pdj).doubleValue();
+                pdjCount++;
+            }
+            Object oks = metrics.get("oks");
+            if (oks instanceof Number) {
+                oksSum += ((Number) oks).doubleValue();
+                oksCount++;
+            }
+        }
+
+        if (inferenceTime != null) {
+            inferenceTimeSum += inferenceTime.doubleValue();
+            inferenceCount++;
+        }
+    }
+
+    public void merge(PostureAggregate other) {
+        for (int code = 0; code < PostureState.CODE_COUNT; code++) {
+            stateHistogram[code] += other.stateHistogram[code];
+        }
+        totalEntries += other.totalEntries;
+        pdjSum += other.pdjSum;
+        pdjCount += other.pdjCount;
+        oksSum += other.oksSum;
+        oksCount += other.oksCount;
+        inferenceTimeSum += other.inferenceTimeSum;
+        inferenceCount += other.inferenceCount;
+    }
+
+    public FirebaseDataRetriever.PostureStatistics toStatistics() {
+        FirebaseDataRetriever.PostureStatistics stats = new FirebaseDataRetriever.PostureStatistics();
+        stats.totalEntries = totalEntries;
+        FirebaseDataRetriever.foldStateHistogram(stateHistogram, stats);
+        stats.avgPdj = pdjCount > 0 ? pdjSum / pdjCount : 0;
+        stats.avgOks = oksCount > 0 ? oksSum / oksCount : 0;
+        stats.avgInferenceTime = inferenceCount > 0 ? inferenceTimeSum / inferenceCount : 0;
+        return stats;
+    }
+
+    /**
+     * Firebase form; the histogram is stored sparsely as "s<code>" -> count
+     */
+    public Map<String, Object> toMap() {
+        Map<String, Object> states = new HashMap<>();
+        for (int code = 0; code < PostureState.CODE_COUNT; code++) {
+            if (stateHistogram[code] > 0) {
+                states.put(STATE_KEY_PREFIX + code, stateHistogram[code]);
+            }
+        }
+
+        Map<String, Object> map = new HashMap<>();
+        map.put("states", states);
+        map.put("totalEntries", totalEntries);
+        map.put("pdjSum", pdjSum);
+        map.put("pdjCount", pdjCount);
+        map.put("oksSum", oksSum);
+        map.put("oksCount", oksCount);
+        map.put("inferenceTimeSum", inferenceTimeSum);
+        map.put("inferenceCount", inferenceCount);
+        return map;
+    }
+
+    public static PostureAggregate fromMap(String date, Map<?, ?> map) {
+        PostureAggregate aggregate = new PostureAggregate(date);
+        Object states = map.get("states");
+        if (states instanceof Map) {
+            for (Map.Entry<?, ?> entry : ((Map<?, ?>) states).entrySet()) {
+                String key = String.valueOf(entry.getKey());
+                if (!key.startsWith(STATE_KEY_PREFIX) || !(entry.getValue() instanceof Number)) {
+                    continue;
+                }
+                try {
+                    int code = Integer.parseInt(key.substring(STATE_KEY_PREFIX.length()));
+                    if (code >= 0 && code < PostureState.CODE_COUNT) {
+                        aggregate.stateHistogram[code] = ((Number) entry.getValue()).intValue();
+                    }
+                } catch (NumberFormatException e) {
+                    // Unknown key, skip
+                }
+            }
+        }
+        aggregate.totalEntries = intValue(map.get("totalEntries"));
+        aggregate.pdjSum = doubleValue(map.get("pdjSum"));
+        aggregate.pdjCount = intValue(map.get("pdjCount"));
+        aggregate.oksSum = doubleValue(map.get("oksSum"));
+        aggregate.oksCount = intValue(map.get("oksCount"));
+        aggregate.inferenceTimeSum = doubleValue(map.get("inferenceTimeSum"));
+        aggregate.inferenceCount = intValue(map.get("inferenceCount"));
+        return aggregate;
+    }
+
+    // Firebase returns whole doubles as Long
+    private static int intValue(Object value) {
+        return value instanceof Number ? ((Number) value).intValue() : 0;
+    }
+
+    private static double doubleValue(Object value) {
+        return value instanceof Number ? ((Number) value).doubleValue() : 0;
+    }
+}
@@ -1,14 +1,21 @@
 package com.esw.postureanalyzer.vision;
 
 import android.content.Context;
+import android.os.Debug;
 import android.util.Log;
 import com.google.mediapipe.tasks.components.containers.NormalizedLandmark;
-import com.google.mediapipe.tasks.vision.poselandmarker.PoseLandmarkerResult;
 import java.io.FileInputStream;
 import java.io.IOException;
 import java.nio.MappedByteBuffer;
 import java.nio.channels.FileChannel;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Collections;
 import java.util.List;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.RejectedExecutionException;
+import java.util.concurrent.atomic.AtomicReference;
 import org.tensorflow.lite.Interpreter;
 import org.tensorflow.lite.gpu.CompatibilityList;
 import org.tensorflow.lite.gpu.GpuDelegate;
@@ -16,22 +23,110 @@ import org.tensorflow.lite.nnapi.NnApiDelegate;
 
 public class PostureClassifier {
     private static final String TAG = "PostureClassifier";
-    
-    // Model interpreters
-    private Interpreter slouchInterpreter;
-    private Interpreter crossLeggedInterpreter;
-    private Interpreter leanInterpreter;
-    
-    // Delegates
-    private GpuDelegate gpuDelegate;
-    private NnApiDelegate nnApiDelegate;
-    
-    private DelegateType currentDelegate = DelegateType.CPU;
+
+    /**
+     * Interpreters and delegates built for one delegate type. Classification
+     * holds the set's monitor while it runs, since interpreters are not
+     * thread-safe; a delegate switch builds a whole new set instead of
+     * touching this one.
+     */
+    private static final class ModelSet {
+        final DelegateType delegate;
+        Interpreter slouchInterpreter;
+        Interpreter crossLeggedInterpreter;
+        Interpreter leanInterpreter;
+        GpuDelegate gpuDelegate;
+        NnApiDelegate nnApiDelegate;
+
+        // Rows each interpreter is currently sized for (one per person it classifies),
+        // indexed by VisibilityGate.Model
+        final int[] batchSizes = {1, 1, 1};
+        boolean batchResizeSupported = true;
+
+        // Input z-score constants the models were trained with, indexed by
+        // VisibilityGate.Model; a null entry feeds raw features
+        final float[][] featureMean;
+        final float[][] featureStd;
+
+        ModelSet(DelegateType delegate, float[][] featureMean, float[][] featureStd) {
+            this.delegate = delegate;
+            this.featureMean = featureMean;
+            this.featureStd = featureStd;
+        }
+
+        void close() {
+            if (slouchInterpreter != null) {
+                slouchInterpreter.close();
+                slouchInterpreter = null;
+            }
+            if (crossLeggedInterpreter != null) {
+                crossLeggedInterpreter.close();
+                crossLeggedInterpreter = null;
+            }
+            if (leanInterpreter != null) {
+                leanInterpreter.close();
+                leanInterpreter = null;
+            }
+
+            if (gpuDelegate != null) {
+                gpuDelegate.close();
+                gpuDelegate = null;
+            }
+            if (nnApiDelegate != null) {
+                nnApiDelegate.close();
+                nnApiDelegate = null;
+            }
+        }
+    }
+
+    /**
+     * Called on the swap thread once a setDelegate request has been served
+     */
+    public interface SwapListener {
+        /**
+         * @param requested delegate asked for
+         * @param active    delegate now running; differs from requested when the build failed
+         */
+        void onModelsSwapped(DelegateType requested, DelegateType active, long loadTimeMs, long warmupTimeMs);
+    }
+
+    // Models are built and warmed on swapExecutor and swapped in whole, so
+    // classification never waits for a delegate switch
+    private final ExecutorService swapExecutor = Executors.newSingleThreadExecutor(r -> {
+        Thread t = new Thread(r, "PostureModelSwap");
+        t.setDaemon(true);
+        return t;
+    });
+    private final HotSwap<ModelSet> models = new HotSwap<>(ModelSet::close, swapExecutor);
+
+    /**
+     * Candidate models for shadow evaluation, indexed by VisibilityGate.Model.
+     * Bundled next to the production models while a retrained set is under test.
+     */
+    public static final String[] CANDIDATE_MODELS = {
+            "candidate_posture_model.tflite", "candidate_crosslegged.tflite", "candidate_lean_direction_model.tflite"
+    };
+
+    // Shadow evaluation: a candidate set run on sampled frames on its own
+    // low-priority thread; all guarded by this for start/stop
+    private final HotSwap<ModelSet> shadowModels = new HotSwap<>(ModelSet::close, swapExecutor);
+    private volatile ShadowEvaluator shadowEvaluator;
+    private volatile ExecutorService shadowExecutor;
+
+    private volatile DelegateType currentDelegate = DelegateType.CPU;
+    // Last delegate asked for; a swap whose target is no longer wanted is dropped
+    private final AtomicReference<DelegateType> requestedDelegate = new AtomicReference<>(DelegateType.CPU);
     private final Context context;
     
     // Performance tracking
-    private long lastModelLoadTimeMs = 0;
-    private long lastWarmupTimeMs = 0;
+    private volatile long lastModelLoadTimeMs = 0;
+    private volatile long lastWarmupTimeMs = 0;
+
+    // Input features per row, indexed by VisibilityGate.Model
+    private static final int[] FEATURE_COUNTS = {3, 6, 9};
+
+    // Skips models whose landmarks are not visible
+    private final VisibilityGate visibilityGate = new VisibilityGate();
     
     // Performance monitors
     private final PerformanceMonitor slouchMonitor = new PerformanceMonitor("Slouch Model");
@@ -53,66 +148,75 @@ public class PostureClassifier {
             16.067474f, 37.209052f, 37.186269f  // Placeholder - update with: torsoTilt_std, leftAngle_std, rightAngle_std
     };
 
+    // Production scaling per VisibilityGate.Model; slouch normalization is
+    // disabled below and the lean model takes raw features
+    private static final float[][] PRODUCTION_MEAN = {null, CROSS_LEGGED_MEAN, null};
+    private static final float[][] PRODUCTION_STD = {null, CROSS_LEGGED_STD, null};
+
+    // Lean model output index -> PostureState lean value (0:left, 1:right, 2:upright)
+    private static final int[] LEAN_CLASSES = {
+            PostureState.LEAN_LEFT, PostureState.LEAN_RIGHT, PostureState.LEAN_UPRIGHT
+    };
+
     // Reference resolution from dataset generation
     private static final int REF_WIDTH = 640;
     private static final int REF_HEIGHT = 480;
 
     public PostureClassifier(Context context) {
         this.context = context;
-        initializeModels(DelegateType.CPU);
+        // Nothing to swap out yet, so the first set is built inline
+        installModels(buildModels(DelegateType.CPU));
     }
 
     /**
-     * Initialize all models with the specified delegate
+     * Build and warm a model set for the specified delegate. Touches nothing
+     * the running set uses, so it is safe off the classification thread.
+     *
+     * @throws RuntimeException if the models cannot be loaded with the delegate
      */
-    private void initializeModels(DelegateType delegateType) {
-        // Clean up existing resources
-        cleanup();
-
+    private ModelSet buildModels(DelegateType delegateType) {
+        ModelSet set = new ModelSet(delegateType, PRODUCTION_MEAN, PRODUCTION_STD);
         try {
-            Interpreter.Options options = createInterpreterOptions(delegateType);
+            Interpreter.Options options = createInterpreterOptions(set, delegateType);
             
             Log.d(TAG, "Loading models with " + delegateType.getDisplayName() + "...");
             long startTime = System.currentTimeMillis();
             
-            slouchInterpreter = new Interpreter(loadModelFile(context, "posture_model.tflite"), options);
+            set.slouchInterpreter = new Interpreter(loadModelFile(context, "posture_model.tflite"), options);
             Log.d(TAG, "  ✓ Slouch model loaded");
             
-            crossLeggedInterpreter = new Interpreter(loadModelFile(context, "crosslegged.tflite"), options);
+            set.crossLeggedInterpreter = new Interpreter(loadModelFile(context, "crosslegged.tflite"), options);
             Log.d(TAG, "  ✓ CrossLegged model loaded");
             
-            leanInterpreter = new Interpreter(loadModelFile(context, "lean_direction_model.tflite"), options);
+            set.leanInterpreter = new Interpreter(loadModelFile(context, "lean_direction_model.tflite"), options);
             Log.d(TAG, "  ✓ Lean model loaded");
             
             long loadTime = System.currentTimeMillis() - startTime;
             lastModelLoadTimeMs = loadTime;
             
-            currentDelegate = delegateType;
-            resetPerformanceMonitors();
-            
             Log.d(TAG, "✓ All models initialized with " + delegateType.getDisplayName() + " in " + loadTime + "ms");
             
-            // Run a test inference to warm up the delegate
-            if (delegateType == DelegateType.NNAPI) {
-                Log.d(TAG, "Running NNAPI warmup inference...");
-                try {
-                    float[][] testInput = new float[1][3];
-                    float[][] testOutput = new float[1][1];
-                    long warmupStart = System.nanoTime();
-                    slouchInterpreter.run(testInput, testOutput);
-                    long warmupTime = (System.nanoTime() - warmupStart) / 1_000_000;
-                    lastWarmupTimeMs = warmupTime;
-                    Log.d(TAG, "  → NNAPI warmup completed in " + warmupTime + "ms");
-                    if (warmupTime > 100) {
-                        Log.w(TAG, "  ⚠ NNAPI warmup took longer than expected - may not be using hardware accelerator");
-                    }
-                } catch (Exception e) {
-                    Log.e(TAG, "  ✗ NNAPI warmup failed", e);
+            // Run a test inference through every model so the first real frame
+            // on the new set doesn't pay for delegate compilation
+            Log.d(TAG, "Running " + delegateType.getDisplayName() + " warmup inference...");
+            try {
+                long warmupStart = System.nanoTime();
+                set.slouchInterpreter.run(new float[1][3], new float[1][1]);
+                set.crossLeggedInterpreter.run(new float[1][6], new float[1][1]);
+                set.leanInterpreter.run(new float[1][9], new float[1][3]);
+                long warmupTime = (System.nanoTime() - warmupStart) / 1_000_000;
+                lastWarmupTimeMs = warmupTime;
+                Log.d(TAG, "  → Warmup completed in " + warmupTime + "ms");
+                if (delegateType == DelegateType.NNAPI && warmupTime > 100) {
+                    Log.w(TAG, "  ⚠ NNAPI warmup took longer than expected - may not be using hardware accelerator");
                 }
-            } else {
-                lastWarmupTimeMs = 0; // No warmup for CPU/GPU
+            } catch (Exception e) {
+                Log.e(TAG, "  ✗ " + delegateType.getDisplayName() + " warmup failed", e);
             }
+            return set;
         } catch (Exception e) {
+            // Clean up failed delegates before any fallback
+            set.close();
             Log.e(TAG, "✗ Error initializing models with " + delegateType, e);
             Log.e(TAG, "  → Error type: " + e.getClass().getSimpleName());
             Log.e(TAG, "  → Error message: " + e.getMessage());
@@ -121,19 +225,10 @@ public class PostureClassifier {
             if (delegateType != DelegateType.CPU) {
                 Log.w(TAG, "→ Falling back to CPU due to " + delegateType + " failure");
                 try {
-                    // Clean up failed delegates before fallback
-                    cleanup();
-                    currentDelegate = DelegateType.CPU; // Update to CPU before retry
-                    Interpreter.Options cpuOptions = new Interpreter.Options();
-                    cpuOptions.setNumThreads(4);
-                    
-                    slouchInterpreter = new Interpreter(loadModelFile(context, "posture_model.tflite"), cpuOptions);
-                    crossLeggedInterpreter = new Interpreter(loadModelFile(context, "crosslegged.tflite"), cpuOptions);
-                    leanInterpreter = new Interpreter(loadModelFile(context, "lean_direction_model.tflite"), cpuOptions);
-                    
+                    ModelSet cpuSet = buildModels(DelegateType.CPU);
                     Log.d(TAG, "✓ Successfully fell back to CPU");
-                    resetPerformanceMonitors();
-                } catch (Exception cpuError) {
+                    return cpuSet;
+                } catch (RuntimeException cpuError) {
                     Log.e(TAG, "→ CPU fallback also failed - this is critical!", cpuError);
                     throw new RuntimeException("Failed to initialize models even with CPU", cpuError);
                 }
@@ -144,10 +239,20 @@ public class PostureClassifier {
         }
     }
 
+    /**
+     * Publish a built set; frames still on the previous set finish on it
+     * and it is closed once they are done
+     */
+    private void installModels(ModelSet set) {
+        models.publish(set, lastModelLoadTimeMs + lastWarmupTimeMs);
+        currentDelegate = set.delegate;
+        resetPerformanceMonitors();
+    }
+
     /**
      * Create interpreter options with the specified delegate
      */
-    private Interpreter.Options createInterpreterOptions(DelegateType delegateType) {
+    private Interpreter.Options createInterpreterOptions(ModelSet set, DelegateType delegateType) {
         Interpreter.Options options = new Interpreter.Options();
 
         switch (delegateType) {
@@ -175,8 +280,8 @@ public class PostureClassifier {
                         Log.w(TAG, "  → Device has OpenGL ES 3.2 + Adreno 750, should work");
                     }
                     
-                    gpuDelegate = new GpuDelegate(gpuOptions);
-                    options.addDelegate(gpuDelegate);
+                    set.gpuDelegate = new GpuDelegate(gpuOptions);
+                    options.addDelegate(set.gpuDelegate);
                     Log.d(TAG, "✓ GPU delegate enabled successfully");
                 } catch (Exception e) {
                     Log.e(TAG, "✗ GPU delegate initialization failed with exception", e);
@@ -197,13 +302,13 @@ public class PostureClassifier {
                     String acceleratorName = "Unknown";
                     try {
                         // NNAPI will select best available: NPU > DSP > GPU > CPU
-                        nnApiDelegate = new NnApiDelegate(nnApiOptions);
-                        acceleratorName = nnApiDelegate.toString();
+                        set.nnApiDelegate = new NnApiDelegate(nnApiOptions);
+                        acceleratorName = set.nnApiDelegate.toString();
                     } catch (Exception e) {
                         Log.w(TAG, "Could not get NNAPI accelerator info", e);
                     }
                     
-                    options.addDelegate(nnApiDelegate);
+                    options.addDelegate(set.nnApiDelegate);
                     options.setNumThreads(1); // NNAPI handles threading internally
                     
                     Log.d(TAG, "✓ NNAPI delegate enabled");
@@ -244,10 +349,166 @@ public class PostureClassifier {
     /**
      * Set the delegate type for all models
      */
-    public synchronized void setDelegate(DelegateType delegateType) {
-        if (currentDelegate != delegateType) {
-            Log.d(TAG, "Switching delegate from " + currentDelegate + " to " + delegateType);
-            initializeModels(delegateType);
+    public void setDelegate(DelegateType delegateType) {
+        setDelegate(delegateType, null);
+    }
+
+    /**
+     * Switch all models to a delegate without blocking classification: the
+     * new set is built and warmed on a background thread and swapped in when
+     * ready, while frames keep running on the current set. Requests made
+     * while a build is queued replace it.
+     *
+     * @param listener told on the swap thread once the switch is done or has failed; may be null
+     */
+    public void setDelegate(DelegateType delegateType, SwapListener listener) {
+        if (requestedDelegate.getAndSet(delegateType) == delegateType) {
+            return;
+        }
+        Log.d(TAG, "Switching delegate from " + currentDelegate + " to " + delegateType);
+        swapExecutor.execute(() -> swapModels(delegateType, listener));
+    }
+
+    private void swapModels(DelegateType delegateType, SwapListener listener) {
+        if (requestedDelegate.get() != delegateType) {
+            Log.d(TAG, "Skipping superseded switch to " + delegateType);
+            return;
+        }
+        if (delegateType == currentDelegate) {
+            // Asked back to the running delegate before the swap started
+            notifySwapped(listener, delegateType);
+            return;
+        }
+        models.beginSwap();
+        ModelSet set;
+        try {
+            set = buildModels(delegateType);
+        } catch (RuntimeException e) {
+            Log.e(TAG, "✗ Delegate switch to " + delegateType + " failed, staying on " + currentDelegate, e);
+            models.abortSwap();
+            requestedDelegate.compareAndSet(delegateType, currentDelegate);
+            notifySwapped(listener, delegateType);
+            return;
+        }
+        if (requestedDelegate.get() != delegateType && requestedDelegate.get() != set.delegate) {
+            // A newer request is queued behind this one; don't flip twice
+            Log.d(TAG, "Dropping " + delegateType + " models, superseded while building");
+            models.abortSwap();
+            set.close();
+            return;
+        }
+        installModels(set);
+        requestedDelegate.compareAndSet(delegateType, set.delegate);
+        Log.d(TAG, "✓ Swapped in " + set.delegate.getDisplayName() + " models");
+        notifySwapped(listener, delegateType);
+    }
+
+    private void notifySwapped(SwapListener listener, DelegateType requested) {
+        if (listener == null) {
+            return;
+        }
+        try {
+            listener.onModelsSwapped(requested, currentDelegate, lastModelLoadTimeMs, lastWarmupTimeMs);
+        } catch (Exception e) {
+            Log.e(TAG, "Error in swap listener", e);
+        }
+    }
+
+    /**
+     * Start comparing a candidate model set against the production one.
+     * The candidate is loaded on the swap thread and then run on a sampled
+     * fraction of frames, on its own low-priority thread and within a CPU
+     * budget (see ShadowEvaluator), using the raw features production
+     * computed. Production results never wait for it.
+     *
+     * The candidate is assumed to be trained with production's feature
+     * scaling; use the overload taking scaling constants when it was not.
+     *
+     * @param candidateAssets model assets indexed by VisibilityGate.Model, e.g. CANDIDATE_MODELS
+     * @param sampleFraction  share of frames to shadow, 0-1
+     * @param cpuBudget       CPU seconds the candidate may use per wall second
+     */
+    public void startShadow(String[] candidateAssets, double sampleFraction, double cpuBudget) {
+        startShadow(candidateAssets, PRODUCTION_MEAN, PRODUCTION_STD, sampleFraction, cpuBudget);
+    }
+
+    /**
+     * Start shadow evaluation of a candidate trained with its own scaling
+     *
+     * @param featureMean z-score means indexed by VisibilityGate.Model (a null entry feeds raw features),
+     *                    e.g. from the retrained model's scaler.npz
+     * @param featureStd  matching standard deviations
+     */
+    public synchronized void startShadow(String[] candidateAssets, float[][] featureMean, float[][] featureStd,
+                                         double sampleFraction, double cpuBudget) {
+        stopShadow();
+        ShadowEvaluator evaluator = new ShadowEvaluator(sampleFraction, cpuBudget);
+        shadowEvaluator = evaluator;
+        shadowExecutor = Executors.newSingleThreadExecutor(r -> {
+            Thread t = new Thread(r, "PostureShadow");
+            t.setDaemon(true);
+            t.setPriority(Thread.MIN_PRIORITY);
+            return t;
+        });
+        String[] assets = candidateAssets.clone();
+        float[][] mean = featureMean.clone();
+        float[][] std = featureStd.clone();
+        swapExecutor.execute(() -> {
+            long startMs = System.currentTimeMillis();
+            ModelSet candidate;
+            try {
+                candidate = buildCandidate(assets, mean, std);
+            } catch (Exception e) {
+                Log.e(TAG, "✗ Failed to load candidate models " + Arrays.toString(assets), e);
+                return;
+            }
+            synchronized (this) {
+                if (shadowEvaluator != evaluator) {
+                    candidate.close(); // Stopped or restarted while loading
+                    return;
+                }
+                shadowModels.publish(candidate, System.currentTimeMillis() - startMs);
+            }
+            Log.d(TAG, "✓ Shadow evaluation started with " + Arrays.toString(assets));
+        });
+    }
+
+    /**
+     * Stop shadow evaluation; the summary so far is discarded
+     */
+    public synchronized void stopShadow() {
+        shadowEvaluator = null;
+        shadowModels.clear();
+        if (shadowExecutor != null) {
+            shadowExecutor.shutdown();
+            shadowExecutor = null;
+        }
+    }
+
+    /**
+     * Agreement and latency summary of the running shadow evaluation, or null when off
+     */
+    public ShadowEvaluator getShadowEvaluator() {
+        return shadowEvaluator;
+    }
+
+    /**
+     * Candidate interpreters on CPU with one thread: the candidate is held to
+     * its budget, not raced against production
+     */
+    private ModelSet buildCandidate(String[] assets, float[][] featureMean, float[][] featureStd)
+            throws IOException {
+        ModelSet set = new ModelSet(DelegateType.CPU, featureMean, featureStd);
+        Interpreter.Options options = new Interpreter.Options();
+        options.setNumThreads(1);
+        try {
+            set.slouchInterpreter = new Interpreter(loadModelFile(context, assets[0]), options);
+            set.crossLeggedInterpreter = new Interpreter(loadModelFile(context, assets[1]), options);
+            set.leanInterpreter = new Interpreter(loadModelFile(context, assets[2]), options);
+            return set;
+        } catch (IOException | RuntimeException e) {
+            set.close();
+            throw e;
         }
     }
 
@@ -258,177 +519,475 @@ public class PostureClassifier {
         return currentDelegate;
     }
 
-    public synchronized ClassificationResult classify(PoseLandmarkerResult poseResult, int imageWidth, int imageHeight) {
-        if (poseResult.landmarks().isEmpty()) {
+    /**
+     * Landmark visibility gate in front of the models, with its skip counters
+     */
+    public VisibilityGate getVisibilityGate() {
+        return visibilityGate;
+    }
+
+    public ClassificationResult classify(List<NormalizedLandmark> landmarks, int imageWidth, int imageHeight) {
+        if (landmarks == null || landmarks.isEmpty()) {
             return null;
         }
-        
+        List<ClassificationResult> results =
+                classifyBatch(Collections.singletonList(landmarks), imageWidth, imageHeight);
+        return results.isEmpty() ? null : results.get(0);
+    }
+
+    /**
+     * Classify every detected person with one inference per model. Rows are
+     * stacked into a [people][features] input so the interpreter overhead is
+     * paid once per frame instead of once per person. Results line up with
+     * the input list; a null or empty pose yields a null entry.
+     */
+    public List<ClassificationResult> classifyBatch(List<List<NormalizedLandmark>> people,
+                                                    int imageWidth, int imageHeight) {
+        if (people == null || people.isEmpty()) {
+            return new ArrayList<>();
+        }
+        long startNs = System.nanoTime();
+        // Lease the current set: a delegate switch can publish a new one
+        // meanwhile, and this frame still finishes on the set it started with
+        try (HotSwap.Lease<ModelSet> lease = models.acquire()) {
+            if (lease == null) {
+                Log.w(TAG, "Interpreters not initialized yet, skipping classification");
+                return new ArrayList<>();
+            }
+            ModelSet set = lease.get();
+            synchronized (set) {
+                return classifyBatch(set, people, imageWidth, imageHeight);
+            }
+        } finally {
+            models.recordFrame((System.nanoTime() - startNs) / 1_000_000.0);
+        }
+    }
+
+    private List<ClassificationResult> classifyBatch(ModelSet set, List<List<NormalizedLandmark>> people,
+                                                     int imageWidth, int imageHeight) {
+        List<ClassificationResult> results = new ArrayList<>();
+
         // Safety check: ensure interpreters are initialized
-        if (slouchInterpreter == null || crossLeggedInterpreter == null || leanInterpreter == null) {
+        if (set.slouchInterpreter == null || set.crossLeggedInterpreter == null || set.leanInterpreter == null) {
             Log.w(TAG, "Interpreters not initialized yet, skipping classification");
-            return null;
+            return results;
         }
-        List<NormalizedLandmark> landmarks = poseResult.landmarks().get(0);
+        Log.d(TAG, "Classifying " + people.size() + " people with image dimensions: "
+                + imageWidth + "x" + imageHeight);
 
-        Log.d(TAG, "Classifying with image dimensions: " + imageWidth + "x" + imageHeight);
+        // Each model only gets the poses whose landmarks it can trust; the
+        // rest keep an UNKNOWN field for that model
+        VisibilityGate.Model[] models = VisibilityGate.Model.values();
+        int[][] rowOf = new int[models.length][people.size()];
+        int[] rows = new int[models.length];
+        int present = 0;
+        for (int p = 0; p < people.size(); p++) {
+            List<NormalizedLandmark> landmarks = people.get(p);
+            boolean hasPose = landmarks != null && !landmarks.isEmpty();
+            if (hasPose) {
+                present++;
+            }
+            for (VisibilityGate.Model model : models) {
+                int m = model.ordinal();
+                rowOf[m][p] = hasPose && visibilityGate.allows(model, landmarks) ? rows[m]++ : -1;
+            }
+        }
+        if (present == 0) {
+            for (int p = 0; p < people.size(); p++) {
+                results.add(null);
+            }
+            return results;
+        }
 
-        // Extract features using actual image dimensions (matching training data collection)
-        float[] slouchFeatures = FeatureExtractor.getSlouchFeatures(landmarks, imageWidth, imageHeight);
-        float[] crossLeggedFeatures = FeatureExtractor.getCrossLeggedFeatures(landmarks, imageWidth, imageHeight);
-        float[] leaningFeatures = FeatureExtractor.getLeaningFeatures(landmarks, imageWidth, imageHeight);
+        int slouchModel = VisibilityGate.Model.SLOUCH.ordinal();
+        int legsModel = VisibilityGate.Model.LEGS.ordinal();
+        int leanModel = VisibilityGate.Model.LEAN.ordinal();
+        float[][] slouchFeatures = new float[rows[slouchModel]][];
+        float[][] crossLeggedFeatures = new float[rows[legsModel]][];
+        float[][] leaningFeatures = new float[rows[leanModel]][];
+        for (int p = 0; p < people.size(); p++) {
+            List<NormalizedLandmark> landmarks = people.get(p);
 
-        // Log raw features before normalization
-        Log.d(TAG, String.format("RAW slouch features: [%.2f, %.2f, %.2f]", 
-                slouchFeatures[0], slouchFeatures[1], slouchFeatures[2]));
+            // Extract features using actual image dimensions (matching training data collection)
+            int row = rowOf[slouchModel][p];
+            if (row >= 0) {
+                slouchFeatures[row] = FeatureExtractor.getSlouchFeatures(landmarks, imageWidth, imageHeight);
 
-        // TESTING: Try WITHOUT normalization first
-        // If your model was trained without StandardScaler, it expects raw features
-        // Comment out the normalization below to test
-        
-        // Apply z-score normalization to slouching features (matching training)
-        // TEMPORARILY DISABLED - Testing without normalization
-        /*
-        for (int i = 0; i < slouchFeatures.length; i++) {
-            slouchFeatures[i] = (slouchFeatures[i] - SLOUCHING_MEAN[i]) / (SLOUCHING_STD[i] + 1e-8f);
+                // Log raw features before normalization
+                Log.d(TAG, String.format("RAW slouch features [%d]: [%.2f, %.2f, %.2f]", row,
+                        slouchFeatures[row][0], slouchFeatures[row][1], slouchFeatures[row][2]));
+
+                // TESTING: Try WITHOUT normalization first
+                // If your model was trained without StandardScaler, it expects raw features
+                // Comment out the normalization below to test
+
+                // Apply z-score normalization to slouching features (matching training)
+                // TEMPORARILY DISABLED - Testing without normalization
+                /*
+                for (int i = 0; i < slouchFeatures[row].length; i++) {
+                    slouchFeatures[row][i] = (slouchFeatures[row][i] - SLOUCHING_MEAN[i]) / (SLOUCHING_STD[i] + 1e-8f);
+                }
+                */
+            }
+
+            row = rowOf[legsModel][p];
+            if (row >= 0) {
+                crossLeggedFeatures[row] = FeatureExtractor.getCrossLeggedFeatures(landmarks, imageWidth, imageHeight);
+            }
+
+            row = rowOf[leanModel][p];
+            if (row >= 0) {
+                leaningFeatures[row] = FeatureExtractor.getLeaningFeatures(landmarks, imageWidth, imageHeight);
+            }
         }
-        */
-        
-        Log.d(TAG, String.format("Features sent to model: [%.2f, %.2f, %.2f]", 
-                slouchFeatures[0], slouchFeatures[1], slouchFeatures[2]));
 
-        // Normalize cross-legged features
-        for (int i = 0; i < crossLeggedFeatures.length; i++) {
-            crossLeggedFeatures[i] = (crossLeggedFeatures[i] - CROSS_LEGGED_MEAN[i]) / CROSS_LEGGED_STD[i];
+        for (VisibilityGate.Model model : models) {
+            visibilityGate.recordSkipped(model, present - rows[model.ordinal()]);
+        }
+
+        float[][] slouchInput = normalize(set, VisibilityGate.Model.SLOUCH, slouchFeatures);
+        float[][] crossLeggedInput = normalize(set, VisibilityGate.Model.LEGS, crossLeggedFeatures);
+        float[][] leaningInput = normalize(set, VisibilityGate.Model.LEAN, leaningFeatures);
+
+        // Run inference, one call per model for the whole batch; gated-off models don't run at all
+        long startNs = System.nanoTime();
+        ensureBatchSize(set, VisibilityGate.Model.SLOUCH, slouchFeatures.length);
+        ensureBatchSize(set, VisibilityGate.Model.LEGS, crossLeggedFeatures.length);
+        ensureBatchSize(set, VisibilityGate.Model.LEAN, leaningFeatures.length);
+        long[] runUs = new long[models.length];
+        long runStartNs = System.nanoTime();
+        int[] slouch = slouchInput.length > 0 ? runSlouchInference(set, slouchInput) : new int[0];
+        long slouchDoneNs = System.nanoTime();
+        int[] legs = crossLeggedInput.length > 0 ? runCrossLeggedInference(set, crossLeggedInput) : new int[0];
+        long legsDoneNs = System.nanoTime();
+        int[] lean = leaningInput.length > 0 ? runLeaningInference(set, leaningInput) : new int[0];
+        long endNs = System.nanoTime();
+        runUs[slouchModel] = (slouchDoneNs - runStartNs) / 1_000;
+        runUs[legsModel] = (legsDoneNs - slouchDoneNs) / 1_000;
+        runUs[leanModel] = (endNs - legsDoneNs) / 1_000;
+        long batchUs = (endNs - startNs) / 1_000;
+        if (present > 1) {
+            Log.d(TAG, String.format("Batch of %d classified in %d μs (%d μs/person)",
+                    present, batchUs, batchUs / present));
+        }
+
+        // Raw features and results are per-frame arrays, so the shadow thread
+        // can keep them and apply the candidate's own scaling
+        submitShadow(new float[][][]{slouchFeatures, crossLeggedFeatures, leaningFeatures},
+                new int[][]{slouch, legs, lean}, runUs);
+
+        for (int p = 0; p < people.size(); p++) {
+            List<NormalizedLandmark> landmarks = people.get(p);
+            if (landmarks == null || landmarks.isEmpty()) {
+                results.add(null);
+                continue;
+            }
+            results.add(new ClassificationResult(PostureState.encode(
+                    stateFor(slouch, rowOf[slouchModel][p]),
+                    stateFor(legs, rowOf[legsModel][p]),
+                    stateFor(lean, rowOf[leanModel][p]))));
+        }
+        return results;
+    }
+
+    private static int stateFor(int[] states, int row) {
+        return row >= 0 ? states[row] : PostureState.UNKNOWN;
+    }
+
+    /**
+     * Z-score rows with the set's constants for the model; raw rows are
+     * left untouched for the shadow run
+     */
+    private static float[][] normalize(ModelSet set, VisibilityGate.Model model, float[][] features) {
+        float[] mean = set.featureMean[model.ordinal()];
+        float[] std = set.featureStd[model.ordinal()];
+        if (mean == null) {
+            return features;
+        }
+        float[][] normalized = new float[features.length][];
+        for (int r = 0; r < features.length; r++) {
+            normalized[r] = new float[features[r].length];
+            for (int i = 0; i < features[r].length; i++) {
+                normalized[r][i] = (features[r][i] - mean[i]) / std[i];
+            }
+        }
+        return normalized;
+    }
+
+    /**
+     * Hand a frame to the candidate models if the shadow sampler admits it
+     */
+    private void submitShadow(float[][][] features, int[][] production, long[] productionUs) {
+        ShadowEvaluator evaluator = shadowEvaluator;
+        ExecutorService executor = shadowExecutor;
+        if (evaluator == null || executor == null || shadowModels.isEmpty()
+                || !evaluator.admit(System.nanoTime())) {
+            return;
+        }
+        try {
+            executor.execute(() -> runShadow(evaluator, features, production, productionUs));
+        } catch (RejectedExecutionException e) {
+            evaluator.abandon(0); // Stopped in between
+        }
+    }
+
+    /**
+     * Run the candidate set on a production frame's features and record how
+     * its decisions and latency compare. Runs on the shadow thread.
+     */
+    private void runShadow(ShadowEvaluator evaluator, float[][][] features, int[][] production, long[] productionUs) {
+        long cpuStartNs = threadCpuTimeNs();
+        boolean completed = false;
+        try (HotSwap.Lease<ModelSet> lease = shadowModels.acquire()) {
+            if (lease != null) {
+                ModelSet candidate = lease.get();
+                Interpreter[] interpreters = {
+                        candidate.slouchInterpreter, candidate.crossLeggedInterpreter, candidate.leanInterpreter
+                };
+                for (VisibilityGate.Model model : VisibilityGate.Model.values()) {
+                    int m = model.ordinal();
+                    if (features[m].length == 0) {
+                        continue;
+                    }
+                    float[][] input = normalize(candidate, model, features[m]);
+                    float[][] output = new float[input.length][model == VisibilityGate.Model.LEAN ? 3 : 1];
+                    ensureBatchSize(candidate, model, input.length);
+                    long startNs = System.nanoTime();
+                    runRows(candidate, interpreters[m], model, input, output);
+                    long candidateUs = (System.nanoTime() - startNs) / 1_000;
+                    evaluator.recordModel(model, production[m], decodeStates(model, output),
+                            productionUs[m], candidateUs);
+                }
+                completed = true;
+            }
+        } catch (Exception e) {
+            Log.e(TAG, "Shadow inference error", e);
+        } finally {
+            long cpuNs = threadCpuTimeNs() - cpuStartNs;
+            if (completed) {
+                evaluator.complete(cpuNs);
+            } else {
+                evaluator.abandon(cpuNs);
+            }
+        }
+    }
+
+    /**
+     * CPU time of the calling thread, or wall time where that isn't available
+     */
+    private static long threadCpuTimeNs() {
+        long cpuNs = Debug.threadCpuTimeNanos();
+        return cpuNs >= 0 ? cpuNs : System.nanoTime();
+    }
+
+    // Decision rules shared by production and shadow runs
+
+    private static int slouchState(float score) {
+        // Interpretation: score >= 0.5 means good posture (straight/not slouching)
+        //                 score < 0.5 means slouching
+        return score >= 0.5f ? PostureState.SLOUCH_GOOD : PostureState.SLOUCH_SLOUCHING;
+    }
+
+    private static int legsState(float score) {
+        return score >= 0.5f ? PostureState.LEGS_CROSSED : PostureState.LEGS_NORMAL;
+    }
+
+    private static int leanState(float[] scores) {
+        int maxIndex = 0;
+        for (int i = 1; i < scores.length; i++) {
+            if (scores[i] > scores[maxIndex]) {
+                maxIndex = i;
+            }
+        }
+        // FIXED: Corrected label order to match training (0:left, 1:right, 2:upright)
+        return LEAN_CLASSES[maxIndex];
+    }
+
+    private static int[] decodeStates(VisibilityGate.Model model, float[][] output) {
+        int[] states = new int[output.length];
+        for (int r = 0; r < output.length; r++) {
+            switch (model) {
+                case SLOUCH: states[r] = slouchState(output[r][0]); break;
+                case LEGS:   states[r] = legsState(output[r][0]);   break;
+                default:     states[r] = leanState(output[r]);      break;
+            }
         }
+        return states;
+    }
 
-        // Run inference
-        String slouchStatus = runSlouchInference(slouchFeatures);
-        String legsStatus = runCrossLeggedInference(crossLeggedFeatures);
-        String leanStatus = runLeaningInference(leaningFeatures);
+    /**
+     * Resize the batch dimension of one model. Resizing re-allocates tensors
+     * (and re-applies a GPU delegate), so it only happens when the number of
+     * people the model classifies changes. If a model rejects the resize,
+     * every model is run row by row from then on.
+     */
+    private void ensureBatchSize(ModelSet set, VisibilityGate.Model model, int rows) {
+        int m = model.ordinal();
+        if (rows == 0 || rows == set.batchSizes[m] || !set.batchResizeSupported) {
+            return;
+        }
+        Interpreter[] interpreters = {set.slouchInterpreter, set.crossLeggedInterpreter, set.leanInterpreter};
+        try {
+            interpreters[m].resizeInput(0, new int[]{rows, FEATURE_COUNTS[m]});
+            set.batchSizes[m] = rows;
+            Log.d(TAG, "Resized " + model.displayName + " batch to " + rows);
+        } catch (Exception e) {
+            Log.w(TAG, "Batch resize not supported with " + set.delegate.getDisplayName()
+                    + ", classifying people one at a time", e);
+            set.batchResizeSupported = false;
+            for (int i = 0; i < interpreters.length; i++) {
+                try {
+                    interpreters[i].resizeInput(0, new int[]{1, FEATURE_COUNTS[i]});
+                } catch (Exception ignored) {
+                    // Interpreter keeps its original single-row shape
+                }
+            }
+            Arrays.fill(set.batchSizes, 1);
+        }
+    }
 
-        return new ClassificationResult(slouchStatus, legsStatus, leanStatus);
+    /**
+     * Run one interpreter over all rows: a single call when the batch
+     * dimension matches, otherwise one call per row.
+     */
+    private void runRows(ModelSet set, Interpreter interpreter, VisibilityGate.Model model,
+                         float[][] input, float[][] output) {
+        if (input.length == set.batchSizes[model.ordinal()]) {
+            interpreter.run(input, output);
+            return;
+        }
+        float[][] rowIn = new float[1][];
+        float[][] rowOut = new float[1][output[0].length];
+        for (int r = 0; r < input.length; r++) {
+            rowIn[0] = input[r];
+            interpreter.run(rowIn, rowOut);
+            System.arraycopy(rowOut[0], 0, output[r], 0, rowOut[0].length);
+        }
     }
 
-    private String runSlouchInference(float[] input) {
-        if (slouchInterpreter == null) {
+    private int[] runSlouchInference(ModelSet set, float[][] input) {
+        int[] states = unknownStates(input.length);
+        if (set.slouchInterpreter == null) {
             Log.e(TAG, "Slouch interpreter is NULL!");
-            return "N/A";
+            return states;
         }
         try {
             slouchMonitor.startTotal();
             
-            float[][] inputArray = new float[1][3];
-            System.arraycopy(input, 0, inputArray[0], 0, 3);
-            float[][] output = new float[1][1];
+            float[][] output = new float[input.length][1];
             
             slouchMonitor.startInference();
             long startNs = System.nanoTime();
-            slouchInterpreter.run(inputArray, output);
+            runRows(set, set.slouchInterpreter, VisibilityGate.Model.SLOUCH, input, output);
             long endNs = System.nanoTime();
             slouchMonitor.endInference();
 
-            float slouchScore = output[0][0];
-            
-            // Interpretation: score >= 0.5 means good posture (straight/not slouching)
-            //                 score < 0.5 means slouching
-            boolean isGoodPosture = slouchScore >= 0.5f;
-            
-            slouchMonitor.endTotal();
-            
             long inferenceUs = (endNs - startNs) / 1_000;
-            Log.d(TAG, String.format("Slouch [%s]: %.4f -> %s (raw: %d μs)", 
-                currentDelegate.getDisplayName(), slouchScore, 
-                (isGoodPosture ? "Good" : "Slouch"), inferenceUs));
+            visibilityGate.recordRun(VisibilityGate.Model.SLOUCH, input.length, inferenceUs);
+            for (int r = 0; r < input.length; r++) {
+                float slouchScore = output[r][0];
+                states[r] = slouchState(slouchScore);
+                boolean isGoodPosture = states[r] == PostureState.SLOUCH_GOOD;
+
+                Log.d(TAG, String.format("Slouch [%s] #%d: %.4f -> %s (raw: %d μs)",
+                    set.delegate.getDisplayName(), r, slouchScore,
+                    (isGoodPosture ? "Good" : "Slouch"), inferenceUs));
+            }
             
-            return isGoodPosture ? "Good Posture" : "Slouching";
+            slouchMonitor.endTotal();
+            return states;
         } catch (Exception e) {
             Log.e(TAG, "Slouch inference error", e);
-            return "Error";
+            return unknownStates(input.length);
         }
     }
 
-    private String runCrossLeggedInference(float[] input) {
-        if (crossLeggedInterpreter == null) return "N/A";
+    private int[] runCrossLeggedInference(ModelSet set, float[][] input) {
+        int[] states = unknownStates(input.length);
+        if (set.crossLeggedInterpreter == null) return states;
         try {
             crossLeggedMonitor.startTotal();
             
-            float[][] inputArray = new float[1][6];
-            System.arraycopy(input, 0, inputArray[0], 0, 6);
-            float[][] output = new float[1][1];
+            float[][] output = new float[input.length][1];
             
             crossLeggedMonitor.startInference();
             long startNs = System.nanoTime();
-            crossLeggedInterpreter.run(inputArray, output);
+            runRows(set, set.crossLeggedInterpreter, VisibilityGate.Model.LEGS, input, output);
             long endNs = System.nanoTime();
             crossLeggedMonitor.endInference();
 
-            float crossLeggedScore = output[0][0];
-            boolean isCrossLegged = crossLeggedScore >= 0.5f;
-            
-            crossLeggedMonitor.endTotal();
-            
             long inferenceUs = (endNs - startNs) / 1_000;
-            Log.d(TAG, String.format("CrossLegged [%s]: %.4f -> %s (raw: %d μs)", 
-                currentDelegate.getDisplayName(), crossLeggedScore,
-                (isCrossLegged ? "CrossLegged" : "Uncrossed"), inferenceUs));
+            visibilityGate.recordRun(VisibilityGate.Model.LEGS, input.length, inferenceUs);
+            for (int r = 0; r < input.length; r++) {
+                float crossLeggedScore = output[r][0];
+                states[r] = legsState(crossLeggedScore);
+                boolean isCrossLegged = states[r] == PostureState.LEGS_CROSSED;
+
+                Log.d(TAG, String.format("CrossLegged [%s] #%d: %.4f -> %s (raw: %d μs)",
+                    set.delegate.getDisplayName(), r, crossLeggedScore,
+                    (isCrossLegged ? "CrossLegged" : "Uncrossed"), inferenceUs));
+            }
             
-            return isCrossLegged ? "Cross-legged" : "Normal";
+            crossLeggedMonitor.endTotal();
+            return states;
         } catch (Exception e) {
             Log.e(TAG, "CrossLegged inference error", e);
-            return "Error";
+            return unknownStates(input.length);
         }
     }
 
-    private String runLeaningInference(float[] input) {
-        if (leanInterpreter == null) return "N/A";
+    private int[] runLeaningInference(ModelSet set, float[][] input) {
+        int[] states = unknownStates(input.length);
+        if (set.leanInterpreter == null) return states;
         try {
             leanMonitor.startTotal();
             
-            float[][] inputArray = new float[1][9];
-            System.arraycopy(input, 0, inputArray[0], 0, 9);
-            float[][] output = new float[1][3];
+            float[][] output = new float[input.length][3];
             
             leanMonitor.startInference();
             long startNs = System.nanoTime();
-            leanInterpreter.run(inputArray, output);
+            runRows(set, set.leanInterpreter, VisibilityGate.Model.LEAN, input, output);
             long endNs = System.nanoTime();
             leanMonitor.endInference();
 
-            int maxIndex = 0;
-            for (int i = 1; i < output[0].length; i++) {
-                if (output[0][i] > output[0][maxIndex]) {
-                    maxIndex = i;
-                }
-            }
+            long inferenceUs = (endNs - startNs) / 1_000;
+            visibilityGate.recordRun(VisibilityGate.Model.LEAN, input.length, inferenceUs);
+            for (int r = 0; r < input.length; r++) {
+                states[r] = leanState(output[r]);
 
-            // FIXED: Corrected label order to match training (0:left, 1:right, 2:upright)
-            String[] labels = {"Left", "Right", "Upright"};
-            String result = labels[maxIndex];
+                Log.d(TAG, String.format("Lean [%s] #%d: [%.2f,%.2f,%.2f] -> %d (raw: %d μs)",
+                    set.delegate.getDisplayName(), r, output[r][0], output[r][1], output[r][2],
+                    states[r], inferenceUs));
+            }
             
             leanMonitor.endTotal();
-            
-            long inferenceUs = (endNs - startNs) / 1_000;
-            Log.d(TAG, String.format("Lean [%s]: [%.2f,%.2f,%.2f] -> %s (raw: %d μs)", 
-                currentDelegate.getDisplayName(), output[0][0], output[0][1], output[0][2], 
-                result, inferenceUs));
-            
-            return result;
+            return states;
         } catch (Exception e) {
             Log.e(TAG, "Lean inference error", e);
-            return "Error";
+            return unknownStates(input.length);
         }
     }
 
+    private static int[] unknownStates(int rows) {
+        int[] states = new int[rows];
+        Arrays.fill(states, PostureState.UNKNOWN);
+        return states;
+    }
+
     /**
      * Get comprehensive performance statistics
      */
     public String getPerformanceStats() {
+        ShadowEvaluator evaluator = shadowEvaluator;
         return String.format(
-            "Delegate: %s\n\n%s\n\n%s\n\n%s",
+            "Delegate: %s\n\n%s\n\n%s\n\n%s\n\nVisibility gate:\n%s\n\nDelegate swaps:\n%s%s",
             currentDelegate.getDisplayName(),
             slouchMonitor.getStats(),
             crossLeggedMonitor.getStats(),
-            leanMonitor.getStats()
+            leanMonitor.getStats(),
+            visibilityGate.getStats(),
+            models.getStats(),
+            evaluator != null ? "\n\nShadow candidate:\n" + evaluator.getStats() : ""
         );
     }
 
@@ -449,6 +1008,7 @@ public class PostureClassifier {
         slouchMonitor.reset();
         crossLeggedMonitor.reset();
         leanMonitor.reset();
+        visibilityGate.reset();
     }
     
     /**
@@ -485,55 +1045,40 @@ public class PostureClassifier {
         allModels.put("slouchModel", slouchMonitor.getMetricsMap());
         allModels.put("crossLeggedModel", crossLeggedMonitor.getMetricsMap());
         allModels.put("leanModel", leanMonitor.getMetricsMap());
+        allModels.put("visibilityGate", visibilityGate.getMetricsMap());
+        allModels.put("hotSwap", models.getMetricsMap());
+        ShadowEvaluator evaluator = shadowEvaluator;
+        if (evaluator != null) {
+            allModels.put("shadow", evaluator.getMetricsMap());
+        }
         allModels.put("delegate", currentDelegate.getDisplayName());
         
         return allModels;
     }
 
     /**
-     * Clean up delegates and interpreters
+     * Release the models once in-flight frames are done; pending switches are dropped
      */
-    private void cleanup() {
-        if (slouchInterpreter != null) {
-            slouchInterpreter.close();
-            slouchInterpreter = null;
-        }
-        if (crossLeggedInterpreter != null) {
-            crossLeggedInterpreter.close();
-            crossLeggedInterpreter = null;
-        }
-        if (leanInterpreter != null) {
-            leanInterpreter.close();
-            leanInterpreter = null;
-        }
-        
-        if (gpuDelegate != null) {
-            gpuDelegate.close();
-            gpuDelegate = null;
-        }
-        if (nnApiDelegate != null) {
-            nnApiDelegate.close();
-            nnApiDelegate = null;
-        }
-    }
-
     public void close() {
-        cleanup();
+        requestedDelegate.set(null);
+        stopShadow();
+        shadowModels.close();
+        models.close();
+        swapExecutor.shutdown();
     }
 
     public static class ClassificationResult {
-        private final String slouchStatus;
-        private final String legsStatus;
-        private final String leanStatus;
+        private final byte stateCode;
 
-        public ClassificationResult(String slouchStatus, String legsStatus, String leanStatus) {
-            this.slouchStatus = slouchStatus;
-            this.legsStatus = legsStatus;
-            this.leanStatus = leanStatus;
+        public ClassificationResult(byte stateCode) {
+            this.stateCode = stateCode;
         }
 
-        public String getSlouchStatus() { return slouchStatus; }
-        public String getLegsStatus() { return legsStatus; }
-        public String getLeanStatus() { return leanStatus; }
+        /** Packed posture state, see {@link PostureState} */
+        public byte getStateCode() { return stateCode; }
+
+        public String getSlouchStatus() { return PostureState.slouchLabel(stateCode); }
+        public String getLegsStatus() { return PostureState.legsLabel(stateCode); }
+        public String getLeanStatus() { return PostureState.leanLabel(stateCode); }
     }
 }
\ No newline at end of file
@@ -0,0 +1,198 @@
+package com.esw.postureanalyzer.vision;
+
+import java.util.HashMap;
+import java.util.Map;
+
+/**
+ * Compact posture state code.
+ *
+ * One byte carries the output of all three classifiers plus a presence bit:
+ *
+ *   bit  7     presence (1 = person in frame)
+ *   bits 4-5   lean   (0 unknown, 1 upright, 2 left, 3 right)
+ *   bits 2-3   legs   (0 unknown, 1 normal, 2 cross-legged)
+ *   bits 0-1   slouch (0 unknown, 1 good posture, 2 slouching)
+ *
+ * A field is unknown when its classifier did not run, e.g. VisibilityGate
+ * held the legs model back because the knees and ankles were out of view.
+ * Aggregations count only the samples where a field is known.
+ *
+ * The code is what the classifier produces, what is written to posture_logs
+ * (as the "state" field) and what the aggregators in FirebaseDataRetriever
+ * index their lookup tables with. Legacy records that still carry the
+ * "posture" label map are decoded through {@link #fromLegacy(Map)}.
+ */
+public final class PostureState {
+    // Field values
+    public static final int UNKNOWN = 0;
+
+    public static final int SLOUCH_GOOD = 1;
+    public static final int SLOUCH_SLOUCHING = 2;
+
+    public static final int LEGS_NORMAL = 1;
+    public static final int LEGS_CROSSED = 2;
+
+    public static final int LEAN_UPRIGHT = 1;
+    public static final int LEAN_LEFT = 2;
+    public static final int LEAN_RIGHT = 3;
+
+    // Bit layout
+    private static final int SLOUCH_SHIFT = 0;
+    private static final int LEGS_SHIFT = 2;
+    private static final int LEAN_SHIFT = 4;
+    private static final int FIELD_MASK = 0x3;
+    public static final int PRESENCE_BIT = 0x80;
+    private static final int UNUSED_BIT = 0x40;
+
+    /** Number of distinct codes, used to size aggregation tables */
+    public static final int CODE_COUNT = 256;
+
+    /** Code stored for frames without a person */
+    public static final byte ABSENT = 0;
+
+    // Display labels indexed by field value (match the strings the UI always showed)
+    private static final String[] SLOUCH_LABELS = {"N/A", "Good Posture", "Slouching", "N/A"};
+    private static final String[] LEGS_LABELS = {"N/A", "Normal", "Cross-legged", "N/A"};
+    private static final String[] LEAN_LABELS = {"N/A", "Upright", "Left", "Right"};
+
+    // Legacy label -> field value, including the old "yes"/"no" aliases
+    private static final Map<String, Integer> LEGACY_SLOUCH = new HashMap<>();
+    private static final Map<String, Integer> LEGACY_LEGS = new HashMap<>();
+    private static final Map<String, Integer> LEGACY_LEAN = new HashMap<>();
+
+    static {
+        LEGACY_SLOUCH.put("Good Posture", SLOUCH_GOOD);
+        LEGACY_SLOUCH.put("no", SLOUCH_GOOD);
+        LEGACY_SLOUCH.put("Slouching", SLOUCH_SLOUCHING);
+        LEGACY_SLOUCH.put("yes", SLOUCH_SLOUCHING);
+
+        LEGACY_LEGS.put("Normal", LEGS_NORMAL);
+        LEGACY_LEGS.put("no", LEGS_NORMAL);
+        LEGACY_LEGS.put("Cross-legged", LEGS_CROSSED);
+        LEGACY_LEGS.put("yes", LEGS_CROSSED);
+
+        LEGACY_LEAN.put("Upright", LEAN_UPRIGHT);
+        LEGACY_LEAN.put("upright", LEAN_UPRIGHT);
+        LEGACY_LEAN.put("Left", LEAN_LEFT);
+        LEGACY_LEAN.put("left", LEAN_LEFT);
+        LEGACY_LEAN.put("Right", LEAN_RIGHT);
+        LEGACY_LEAN.put("right", LEAN_RIGHT);
+    }
+
+    private PostureState() {
+    }
+
+    /**
+     * Pack classifier outputs into a state code (presence bit set)
+     */
+    public static byte encode(int slouch, int legs, int lean) {
+        return (byte) (PRESENCE_BIT
+                | ((slouch & FIELD_MASK) << SLOUCH_SHIFT)
+                | ((legs & FIELD_MASK) << LEGS_SHIFT)
+                | ((lean & FIELD_MASK) << LEAN_SHIFT));
+    }
+
+    public static int slouch(int code) {
+        return (code >> SLOUCH_SHIFT) & FIELD_MASK;
+    }
+
+    public static int legs(int code) {
+        return (code >> LEGS_SHIFT) & FIELD_MASK;
+    }
+
+    public static int lean(int code) {
+        return (code >> LEAN_SHIFT) & FIELD_MASK;
+    }
+
+    public static boolean isPresent(int code) {
+        return (code & PRESENCE_BIT) != 0;
+    }
+
+    /**
+     * Whether encode() can produce the code: bit 6 is never set, and slouch
+     * and legs have no value 3
+     */
+    public static boolean isWritable(int code) {
+        return (code & UNUSED_BIT) == 0
+                && slouch(code) != FIELD_MASK
+                && legs(code) != FIELD_MASK;
+    }
+
+    public static boolean isSlouching(int code) {
+        return slouch(code) == SLOUCH_SLOUCHING;
+    }
+
+    public static boolean isGoodPosture(int code) {
+        return slouch(code) == SLOUCH_GOOD;
+    }
+
+    public static String slouchLabel(int code) {
+        return SLOUCH_LABELS[slouch(code)];
+    }
+
+    public static String legsLabel(int code) {
+        return LEGS_LABELS[legs(code)];
+    }
+
+    public static String leanLabel(int code) {
+        return LEAN_LABELS[lean(code)];
+    }
+
+    /**
+     * Unsigned table index for a code
+     */
+    public static int index(byte code) {
+        return code & 0xFF;
+    }
+
+    /**
+     * Decode a legacy "posture" map ({slouch, legs, lean} label strings)
+     */
+    public static byte fromLegacy(Map<?, ?> posture) {
+        if (posture == null) {
+            return ABSENT;
+        }
+        return encode(
+                lookup(LEGACY_SLOUCH, posture.get("slouch")),
+                lookup(LEGACY_LEGS, posture.get("legs")),
+                lookup(LEGACY_LEAN, posture.get("lean")));
+    }
+
+    /**
+     * Lean field value for a direction label ("Left", "right", ...)
+     */
+    public static int parseLean(String direction) {
+        return lookup(LEGACY_LEAN, direction);
+    }
+
+    /**
+     * Decode the state of a posture_logs record, preferring the packed
+     * "state" field and falling back to the legacy label map.
+     */
+    public static byte fromRecord(Map<String, Object> record) {
+        Object state = record.get("state");
+        if (state instanceof Number) {
+            return (byte) ((Number) state).intValue();
+        }
+        Object posture = record.get("posture");
+        if (posture instanceof Map) {
+            return fromLegacy((Map<?, ?>) posture);
+        }
+        return ABSENT;
+    }
+
+    private static int lookup(Map<String, Integer> table, Object label) {
+        if (!(label instanceof String)) {
+            return UNKNOWN;
+        }
+        Integer value = table.get(label);
+        return value != null ? value : UNKNOWN;
+    }
+
+    public static String toString(int code) {
+        if (!isPresent(code)) {
+            return "Absent";
+        }
+        return slouchLabel(code) + " / " + legsLabel(code) + " / " + leanLabel(code);
+    }
+}
@@ -0,0 +1,258 @@
+package com.esw.postureanalyzer.vision;
+
+import java.util.HashMap;
+import java.util.Locale;
+import java.util.Map;
+
+/**
+ * Sampling, compute budget and agreement statistics for shadow evaluation
+ * of a candidate posture model set against the production one.
+ *
+ * Frames are sampled at sampleFraction (evenly, not randomly, so the
+ * sampled share is exact). A sampled frame is only run if the CPU budget
+ * allows it: a token bucket fills at cpuBudget seconds of CPU per second
+ * of wall time, up to MAX_BURST_MS, and each shadow run is charged the
+ * thread CPU time it actually used. At most one shadow run is in flight;
+ * a sample that finds one still running is dropped rather than queued, so
+ * a slow candidate can never build a backlog behind production.
+ *
+ * Per model the evaluator keeps a production x candidate confusion matrix
+ * over the rows both ran on, plus per-row latency of both. Only this
+ * summary leaves the device.
+ */
+public class ShadowEvaluator {
+    public static final double DEFAULT_SAMPLE_FRACTION = 0.1;
+    /** Five percent of one core */
+    public static final double DEFAULT_CPU_BUDGET = 0.05;
+    public static final long MAX_BURST_MS = 200;
+
+    // Field values per model, indexed like PostureState (0 is unknown)
+    private static final String[][] VALUE_NAMES = {
+            {"unknown", "good", "slouching"},         // SLOUCH
+            {"unknown", "normal", "crossed"},         // LEGS
+            {"unknown", "upright", "left", "right"},  // LEAN
+    };
+
+    private final double sampleFraction;
+    private final double cpuBudget;
+    private final long maxBurstNs;
+
+    private long startNs = -1;
+    private long lastRefillNs;
+    private double tokensNs;
+    private double sampleCredit;
+    private boolean inFlight;
+
+    private long frames;
+    private long runs;
+    private long skippedBudget;
+    private long skippedBusy;
+    private long errors;
+    private long cpuNs;
+
+    private final long[][][] confusion = new long[VALUE_NAMES.length][][];
+    private final double[] productionUs = new double[VALUE_NAMES.length];
+    private final double[] candidateUs = new double[VALUE_NAMES.length];
+    private final double[] candidateMaxUs = new double[VALUE_NAMES.length];
+    private final long[] timedRows = new long[VALUE_NAMES.length];
+
+    public ShadowEvaluator() {
+        this(DEFAULT_SAMPLE_FRACTION, DEFAULT_CPU_BUDGET);
+    }
+
+    /**
+     * @param sampleFraction share of frames to shadow, 0-1
+     * @param cpuBudget      CPU seconds the candidate may use per wall second
+     */
+    public ShadowEvaluator(double sampleFraction, double cpuBudget) {
+        if (sampleFraction < 0 || sampleFraction > 1 || cpuBudget <= 0) {
+            throw new IllegalArgumentException("sampleFraction must be in [0, 1] and cpuBudget positive");
+        }
+        this.sampleFraction = sampleFraction;
+        this.cpuBudget = cpuBudget;
+        this.maxBurstNs = MAX_BURST_MS * 1_000_000L;
+        for (int m = 0; m < VALUE_NAMES.length; m++) {
+            confusion[m] = new long[VALUE_NAMES[m].length][VALUE_NAMES[m].length];
+        }
+    }
+
+    /**
+     * Called once per classified frame; true means run the candidate on it
+     * and report back with record() or abandon()
+     */
+    public synchronized boolean admit(long nowNs) {
+        if (startNs < 0) {
+            startNs = nowNs;
+            lastRefillNs = nowNs;
+            tokensNs = maxBurstNs;
+        }
+        tokensNs = Math.min(maxBurstNs, tokensNs + (nowNs - lastRefillNs) * cpuBudget);
+        lastRefillNs = nowNs;
+        frames++;
+
+        sampleCredit += sampleFraction;
+        if (sampleCredit < 1.0) {
+            return false;
+        }
+        sampleCredit -= 1.0;
+        if (inFlight) {
+            skippedBusy++;
+            return false;
+        }
+        if (tokensNs <= 0) {
+            skippedBudget++;
+            return false;
+        }
+        inFlight = true;
+        return true;
+    }
+
+    /**
+     * Production and candidate field values for the rows one model ran on
+     *
+     * @param productionRunUs production inference time for these rows
+     * @param candidateRunUs  candidate inference time for these rows
+     */
+    public synchronized void recordModel(VisibilityGate.Model model, int[] production, int[] candidate,
+                                         long productionRunUs, long candidateRunUs) {
+        int m = model.ordinal();
+        int rows = Math.min(production.length, candidate.length);
+        if (rows == 0) {
+            return;
+        }
+        for (int r = 0; r < rows; r++) {
+            confusion[m][clamp(m, production[r])][clamp(m, candidate[r])]++;
+        }
+        productionUs[m] += productionRunUs;
+        candidateUs[m] += candidateRunUs;
+        candidateMaxUs[m] = Math.max(candidateMaxUs[m], candidateRunUs / (double) rows);
+        timedRows[m] += rows;
+    }
+
+    /**
+     * The admitted run finished and used cpuNs of thread CPU time
+     */
+    public synchronized void complete(long runCpuNs) {
+        inFlight = false;
+        runs++;
+        cpuNs += runCpuNs;
+        tokensNs -= runCpuNs;
+    }
+
+    /**
+     * The admitted run failed; nothing was recorded for it
+     */
+    public synchronized void abandon(long runCpuNs) {
+        inFlight = false;
+        errors++;
+        cpuNs += runCpuNs;
+        tokensNs -= runCpuNs;
+    }
+
+    private static int clamp(int m, int value) {
+        return value >= 0 && value < VALUE_NAMES[m].length ? value : PostureState.UNKNOWN;
+    }
+
+    /**
+     * Share of rows where candidate and production agree, or NaN before any
+     */
+    public synchronized double getAgreement(VisibilityGate.Model model) {
+        long[][] matrix = confusion[model.ordinal()];
+        long agree = 0;
+        long total = 0;
+        for (int p = 0; p < matrix.length; p++) {
+            for (int c = 0; c < matrix[p].length; c++) {
+                total += matrix[p][c];
+                if (p == c) {
+                    agree += matrix[p][c];
+                }
+            }
+        }
+        return total > 0 ? agree / (double) total : Double.NaN;
+    }
+
+    public synchronized long getCount(VisibilityGate.Model model, int production, int candidate) {
+        return confusion[model.ordinal()][production][candidate];
+    }
+
+    public synchronized long getRuns() {
+        return runs;
+    }
+
+    public synchronized long getSkippedBudget() {
+        return skippedBudget;
+    }
+
+    public synchronized long getSkippedBusy() {
+        return skippedBusy;
+    }
+
+    /**
+     * Candidate CPU time as a share of wall time since the first frame
+     */
+    public synchronized double getCpuShare() {
+        long wallNs = lastRefillNs - startNs;
+        return startNs >= 0 && wallNs > 0 ? cpuNs / (double) wallNs : 0.0;
+    }
+
+    public synchronized String getStats() {
+        StringBuilder stats = new StringBuilder(String.format(Locale.US,
+                "%d of %d frames (%d over budget, %d busy, %d failed)\nCPU: %.1f%% of a core (budget %.1f%%)",
+                runs, frames, skippedBudget, skippedBusy, errors, getCpuShare() * 100, cpuBudget * 100));
+        for (VisibilityGate.Model model : VisibilityGate.Model.values()) {
+            int m = model.ordinal();
+            if (timedRows[m] == 0) {
+                continue;
+            }
+            stats.append(String.format(Locale.US, "\n%s: %.1f%% agree, %.0f vs %.0f μs/row",
+                    model.displayName, getAgreement(model) * 100,
+                    candidateUs[m] / timedRows[m], productionUs[m] / timedRows[m]));
+        }
+        return stats.toString();
+    }
+
+    /**
+     * Summary for upload: counts, budget use, and per model the agreement,
+     * the confusion matrix (production value -> candidate value -> rows) and latency
+     */
+    public synchronized Map<String, Object> getMetricsMap() {
+        Map<String, Object> metrics = new HashMap<>();
+        metrics.put("frames", frames);
+        metrics.put("runs", runs);
+        metrics.put("skippedBudget", skippedBudget);
+        metrics.put("skippedBusy", skippedBusy);
+        metrics.put("errors", errors);
+        metrics.put("sampleFraction", sampleFraction);
+        metrics.put("cpuBudget", cpuBudget);
+        metrics.put("cpuShare", Math.round(getCpuShare() * 10000.0) / 10000.0);
+        metrics.put("cpuMs", cpuNs / 1_000_000);
+
+        for (VisibilityGate.Model model : VisibilityGate.Model.values()) {
+            int m = model.ordinal();
+            if (timedRows[m] == 0) {
+                continue;
+            }
+            Map<String, Object> matrix = new HashMap<>();
+            for (int p = 0; p < confusion[m].length; p++) {
+                Map<String, Object> row = new HashMap<>();
+                for (int c = 0; c < confusion[m][p].length; c++) {
+                    if (confusion[m][p][c] > 0) {
+                        row.put(VALUE_NAMES[m][c], confusion[m][p][c]);
+                    }
+                }
+                if (!row.isEmpty()) {
+                    matrix.put(VALUE_NAMES[m][p], row);
+                }
+            }
+            Map<String, Object> entry = new HashMap<>();
+            entry.put("rows", timedRows[m]);
+            entry.put("agreement", Math.round(getAgreement(model) * 10000.0) / 10000.0);
+            entry.put("confusion", matrix);
+            entry.put("productionUsPerRow", Math.round(productionUs[m] / timedRows[m] * 10.0) / 10.0);
+            entry.put("candidateUsPerRow", Math.round(candidateUs[m] / timedRows[m] * 10.0) / 10.0);
+            entry.put("candidateMaxUsPerRow", Math.round(candidateMaxUs[m] * 10.0) / 10.0);
+            metrics.put(model.name().toLowerCase(Locale.US), entry);
+        }
+        return metrics;
+    }
+}
@@ -0,0 +1,120 @@
+package com.esw.postureanalyzer.vision;
+
+import android.util.Log;
+
+import dalvik.annotation.optimization.FastNative;
+
+/**
+ * Java handle on the native synthetic capture backend (synthetic_source.h):
+ * a moving test pattern as YUYV or MJPEG at any size and rate, each frame
+ * stamped with its sequence number and capture time (see FrameStamp).
+ *
+ * With dropLate the source behaves like a sensor: frames the reader was too
+ * slow for are skipped and show up as sequence gaps.
+ */
+public final class SyntheticFrameSource {
+    private static final String TAG = "SyntheticFrameSource";
+
+    // V4L2 fourccs, as negotiated by the native backends
+    public static final int PIXEL_FORMAT_YUYV = 0x56595559;
+    public static final int PIXEL_FORMAT_MJPEG = 0x47504A4D;
+
+    private static boolean nativeAvailable = false;
+
+    static {
+        try {
+            System.loadLibrary("uvccamera");
+            nativeAvailable = true;
+        } catch (UnsatisfiedLinkError e) {
+            Log.e(TAG, "Native library unavailable", e);
+        }
+    }
+
+    private static native long nativeCreate(int width, int height, int pixelFormat, int fps,
+                                            boolean dropLate, byte[] mjpegTemplate);
+    private static native void nativeDestroy(long nativePtr);
+    @FastNative
+    private static native int nativeRead(long nativePtr, byte[] dst, int timeoutMs);
+    private static native int[] nativeGetFormat(long nativePtr);
+    private static native long[] nativeGetStats(long nativePtr);
+
+    private long nativePtr;
+    private final int width;
+    private final int height;
+    private final int pixelFormat;
+    private final int maxFrameSize;
+
+    private SyntheticFrameSource(long nativePtr, int[] format) {
+        this.nativePtr = nativePtr;
+        this.width = format[0];
+        this.height = format[1];
+        this.pixelFormat = format[2];
+        this.maxFrameSize = format[3];
+    }
+
+    public static boolean isAvailable() {
+        return nativeAvailable;
+    }
+
+    /**
+     * Start a stream. fps <= 0 generates as fast as frames are read.
+     * mjpegTemplate, if given, is streamed instead of the pattern when
+     * pixelFormat is MJPEG (e.g. a photo with a person in it) and fixes the
+     * frame size. Returns null if the format is not supported.
+     */
+    public static SyntheticFrameSource open(int width, int height, int pixelFormat, int fps,
+                                            boolean dropLate, byte[] mjpegTemplate) {
+        if (!nativeAvailable) {
+            return null;
+        }
+        long ptr = nativeCreate(width, height, pixelFormat, fps, dropLate, mjpegTemplate);
+        if (ptr == 0) {
+            return null;
+        }
+        return new SyntheticFrameSource(ptr, nativeGetFormat(ptr));
+    }
+
+    /**
+     * Buffer large enough for any frame of this stream
+     */
+    public byte[] newFrameBuffer() {
+        return new byte[maxFrameSize];
+    }
+
+    /**
+     * Copy the next frame into dst. Returns its size, 0 if none arrived
+     * within timeoutMs, -1 on error.
+     */
+    public synchronized int read(byte[] dst, int timeoutMs) {
+        if (nativePtr == 0) {
+            return -1;
+        }
+        return nativeRead(nativePtr, dst, timeoutMs);
+    }
+
+    /**
+     * {frames read, frames dropped, timeouts, errors, last timestamp ns}
+     */
+    public synchronized long[] getStats() {
+        return nativePtr != 0 ? nativeGetStats(nativePtr) : null;
+    }
+
+    public int getWidth() {
+        return width;
+    }
+
+    public int getHeight() {
+        return height;
+    }
+
+    public int getPixelFormat() {
+        return pixelFormat;
+    }
+
+    public synchronized void close() {
+        if (nativePtr != 0) {
+            nativeDestroy(nativePtr);
+            nativePtr = 0;
+        }
+    }
+}
@@ -16,6 +16,8 @@ import android.hardware.usb.UsbManager;
 import android.os.Build;
 import android.os.Handler;
 import android.os.HandlerThread;
+import android.os.Looper;
+import android.os.SystemClock;
 import android.util.Log;
 import android.view.Surface;
 import android.widget.ImageView;
@@ -23,8 +25,12 @@ import android.widget.Toast;
 
 import androidx.core.content.ContextCompat;
 
+import dalvik.annotation.optimization.CriticalNative;
+
 import java.io.ByteArrayOutputStream;
 import java.util.HashMap;
+import java.util.Locale;
+import java.util.Map;
 
 /**
  * USB Camera Manager - V4L2 Implementation for QIDK
@@ -54,8 +60,20 @@ public class UVCCameraManager {
     private native boolean nativeStartStreaming(long nativePtr);
     private native void nativeStopStreaming(long nativePtr);
     private native byte[] nativeGetFrame(long nativePtr);
-    private native int getYUYVFormat();
-    private native int getMJPEGFormat();
+    private native long[] nativeGetStats(long nativePtr);
+    private static native String nativeGetBackendName();
+    private static native String nativeDiscover(int vendorId, int productId);
+    private static native int[] nativeDiscoveredFormats(int vendorId, int productId);
+    private static native void nativeInvalidateDiscovery(int vendorId, int productId);
+
+    // Leaf getters take no objects and never throw, so they skip the JNI
+    // transition on API 26+ (registered in uvc_camera.cpp)
+    @CriticalNative
+    private static native float nativeGetMotionScore(long nativePtr);
+    @CriticalNative
+    private static native int getYUYVFormat();
+    @CriticalNative
+    private static native int getMJPEGFormat();
     
     private final Context context;
     private final FrameListener frameListener;
@@ -78,6 +96,46 @@ public class UVCCameraManager {
     private HandlerThread frameThread;
     private Handler frameHandler;
     private volatile boolean shouldCaptureFrames = false;
+    private volatile MotionGate motionGate; // Optional, skips static frames
+
+    // Only used when sysfs discovery is unavailable (e.g. blocked by SELinux)
+    private static final String[] FALLBACK_DEVICE_PATHS = {"/dev/video2", "/dev/video3", "/dev/video1", "/dev/video0"};
+
+    // Permission granted -> streaming, for the last successful start
+    private volatile long lastColdStartMs = -1;
+
+    /**
+     * Node and format of the running stream, reused to reopen the same camera
+     * after a stall or a detach/attach without probing or format search
+     */
+    private static final class CachedSession {
+        final int vendorId;
+        final int productId;
+        final String devicePath;
+        final int width;
+        final int height;
+        final int pixelFormat;
+
+        CachedSession(int vendorId, int productId, String devicePath, int width, int height, int pixelFormat) {
+            this.vendorId = vendorId;
+            this.productId = productId;
+            this.devicePath = devicePath;
+            this.width = width;
+            this.height = height;
+            this.pixelFormat = pixelFormat;
+        }
+
+        boolean matches(UsbDevice device) {
+            return device.getVendorId() == vendorId && device.getProductId() == productId;
+        }
+    }
+
+    private volatile CachedSession cachedSession;
+    private final CameraReconnectSupervisor reconnectSupervisor = new CameraReconnectSupervisor();
+    private final Handler mainHandler = new Handler(Looper.getMainLooper());
+    // False while the native device is closed for a reconnect
+    private volatile boolean deviceOpen = false;
+    private int currentPixelFormat;
 
     public interface FrameListener {
         void onFrame(Bitmap bitmap, int rotationDegrees);
@@ -87,6 +145,8 @@ public class UVCCameraManager {
         void onCameraConnected();
         void onCameraDisconnected();
         void onError(String message);
+        // Stream resumed after a stall or detach, without a disconnect
+        void onCameraRecovered(long recoveryMs);
     }
 
     private ConnectionListener connectionListener;
@@ -103,6 +163,10 @@ public class UVCCameraManager {
     /**
      * Set the ImageView to display USB camera frames
      */
+    public void setMotionGate(MotionGate gate) {
+        this.motionGate = gate;
+    }
+    
     public void setPreviewView(ImageView usbPreviewView) {
         this.usbPreviewView = usbPreviewView;
         Log.d(TAG, "USB preview ImageView set");
@@ -137,14 +201,22 @@ public class UVCCameraManager {
             
             if (UsbManager.ACTION_USB_DEVICE_ATTACHED.equals(action)) {
                 UsbDevice device = intent.getParcelableExtra(UsbManager.EXTRA_DEVICE);
-                if (device != null && isUVCCamera(device)) {
+                if (device != null && isAwaitedCamera(device)) {
+                    Log.i(TAG, "USB camera re-attached: " + device.getProductName());
+                    usbCamera = device;
+                    requestPermission(device);
+                } else if (device != null && isUVCCamera(device)) {
                     Log.d(TAG, "USB camera attached: " + device.getProductName());
                     Toast.makeText(context, "USB camera detected: " + device.getProductName(), Toast.LENGTH_SHORT).show();
                 }
             } else if (UsbManager.ACTION_USB_DEVICE_DETACHED.equals(action)) {
                 UsbDevice device = intent.getParcelableExtra(UsbManager.EXTRA_DEVICE);
-                if (device != null && device.equals(usbCamera)) {
+                CachedSession session = cachedSession;
+                if (device != null && session != null && session.matches(device) && isStreaming) {
+                    onStreamingCameraDetached();
+                } else if (device != null && device.equals(usbCamera)) {
                     Log.d(TAG, "USB camera detached");
+                    nativeInvalidateDiscovery(device.getVendorId(), device.getProductId());
                     stopCamera();
                     if (connectionListener != null) {
                         connectionListener.onCameraDisconnected();
@@ -234,6 +306,11 @@ public class UVCCameraManager {
      */
     private void onPermissionGranted(UsbDevice device) {
         Log.d(TAG, "USB permission granted for: " + device.getProductName());
+        if (isAwaitedCamera(device)) {
+            resumeAfterReattach(device);
+            return;
+        }
+        long coldStartBegin = SystemClock.elapsedRealtime();
         
         // Open connection to device
         usbConnection = usbManager.openDevice(device);
@@ -254,36 +331,11 @@ public class UVCCameraManager {
                 return;
             }
             
-            boolean opened = false;
-            String openedPath = null;
-            
-            // Try /dev/video* paths (permissions already fixed with chmod 666)
-            String[] devicePaths = {"/dev/video2", "/dev/video3", "/dev/video1", "/dev/video0"};
+            String openedPath = openCaptureNode(device);
+            long openedAt = SystemClock.elapsedRealtime();
             
-            for (String path : devicePaths) {
-                Log.d(TAG, "Trying to open: " + path);
-                if (nativeOpen(nativeCameraPtr, path)) {
-                    opened = true;
-                    openedPath = path;
-                    Log.i(TAG, "Successfully opened: " + path);
-                    break;
-                }
-            }
-            
-            if (!opened) {
-                Log.e(TAG, "Failed to open any /dev/video* device");
-                Log.e(TAG, "Checked: /dev/video2, /dev/video3, /dev/video1, /dev/video0");
-                
-                // Check current permissions
-                try {
-                    Process p = Runtime.getRuntime().exec("ls -l /dev/video2");
-                    java.io.BufferedReader reader = new java.io.BufferedReader(
-                        new java.io.InputStreamReader(p.getInputStream()));
-                    String perms = reader.readLine();
-                    Log.e(TAG, "Permissions on /dev/video2: " + perms);
-                } catch (Exception e) {
-                    Log.e(TAG, "Could not check permissions: " + e.getMessage());
-                }
+            if (openedPath == null) {
+                Log.e(TAG, "Failed to open a V4L2 capture node for " + device.getDeviceName());
                 
                 Toast.makeText(context, 
                     "Cannot access /dev/video* devices\n\n" +
@@ -303,14 +355,20 @@ public class UVCCameraManager {
             // Try 640x480 first - most stable across USB cameras, prevents alternating resolution bug
             int[][] resolutions = {{640, 480}, {800, 600}, {1280, 720}, {1920, 1080}, {320, 240}};
             
-            for (int[] res : resolutions) {
-                Log.d(TAG, "Trying MJPEG " + res[0] + "x" + res[1]);
-                if (nativeSetFormat(nativeCameraPtr, res[0], res[1], getMJPEGFormat())) {
-                    formatSet = true;
-                    currentWidth = res[0];
-                    currentHeight = res[1];
-                    Log.i(TAG, "Successfully set MJPEG " + res[0] + "x" + res[1]);
-                    break;
+            // Pick from the enumerated formats first so unsupported modes cost no S_FMT round trip
+            formatSet = setDiscoveredFormat(device, resolutions);
+            
+            if (!formatSet) {
+                for (int[] res : resolutions) {
+                    Log.d(TAG, "Trying MJPEG " + res[0] + "x" + res[1]);
+                    if (nativeSetFormat(nativeCameraPtr, res[0], res[1], getMJPEGFormat())) {
+                        formatSet = true;
+                        currentWidth = res[0];
+                        currentHeight = res[1];
+                        currentPixelFormat = getMJPEGFormat();
+                        Log.i(TAG, "Successfully set MJPEG " + res[0] + "x" + res[1]);
+                        break;
+                    }
                 }
             }
             
@@ -322,6 +380,7 @@ public class UVCCameraManager {
                         formatSet = true;
                         currentWidth = res[0];
                         currentHeight = res[1];
+                        currentPixelFormat = getYUYVFormat();
                         Log.i(TAG, "Successfully set YUYV " + res[0] + "x" + res[1]);
                         break;
                     }
@@ -339,6 +398,8 @@ public class UVCCameraManager {
                 return;
             }
             
+            long formatSetAt = SystemClock.elapsedRealtime();
+            
             // Start streaming
             if (!nativeStartStreaming(nativeCameraPtr)) {
                 Log.e(TAG, "Failed to start streaming");
@@ -351,6 +412,11 @@ public class UVCCameraManager {
                 return;
             }
             
+            cachedSession = new CachedSession(device.getVendorId(), device.getProductId(), openedPath,
+                    currentWidth, currentHeight, currentPixelFormat);
+            deviceOpen = true;
+            reconnectSupervisor.onStreamStarted(SystemClock.elapsedRealtime());
+            
             // Start frame capture thread
             frameThread = new HandlerThread("UVC-FrameThread");
             frameThread.start();
@@ -362,6 +428,12 @@ public class UVCCameraManager {
             
             isStreaming = true;
             
+            lastColdStartMs = SystemClock.elapsedRealtime() - coldStartBegin;
+            Log.i(TAG, String.format(Locale.US,
+                    "Cold start %d ms (open %d ms, format %d ms, stream %d ms)",
+                    lastColdStartMs, openedAt - coldStartBegin, formatSetAt - openedAt,
+                    SystemClock.elapsedRealtime() - formatSetAt));
+            
             if (connectionListener != null) {
                 connectionListener.onCameraConnected();
             }
@@ -370,7 +442,7 @@ public class UVCCameraManager {
                 "✓ USB Camera Streaming!\n" + openedPath + " @ " + currentWidth + "x" + currentHeight, 
                 Toast.LENGTH_SHORT).show();
             
-            Log.i(TAG, "V4L2 streaming started successfully from " + openedPath);
+            Log.i(TAG, nativeGetBackendName() + " streaming started successfully from " + openedPath);
             
         } else {
             Log.e(TAG, "Failed to open USB device connection");
@@ -382,6 +454,80 @@ public class UVCCameraManager {
         }
     }
     
+    /**
+     * Open the V4L2 capture node belonging to the permitted device. The node is
+     * found through sysfs by VID/PID; the fixed path list is the fallback.
+     */
+    private String openCaptureNode(UsbDevice device) {
+        int vendorId = device.getVendorId();
+        int productId = device.getProductId();
+        
+        String discovered = nativeDiscover(vendorId, productId);
+        if (discovered != null) {
+            if (nativeOpen(nativeCameraPtr, discovered)) {
+                Log.i(TAG, "Successfully opened discovered node: " + discovered);
+                return discovered;
+            }
+            // Cached node went away between discovery and open
+            nativeInvalidateDiscovery(vendorId, productId);
+            Log.e(TAG, "Discovered node " + discovered + " failed to open");
+        } else {
+            Log.d(TAG, String.format(Locale.US, "No sysfs match for %04x:%04x, probing fixed paths",
+                    vendorId, productId));
+        }
+        
+        for (String path : FALLBACK_DEVICE_PATHS) {
+            if (path.equals(discovered)) {
+                continue;
+            }
+            Log.d(TAG, "Trying to open: " + path);
+            if (nativeOpen(nativeCameraPtr, path)) {
+                Log.i(TAG, "Successfully opened: " + path);
+                return path;
+            }
+        }
+        return null;
+    }
+    
+    /**
+     * Set the first preferred resolution the node reported during discovery,
+     * MJPEG before YUYV. Returns false if nothing was enumerated or matched.
+     */
+    private boolean setDiscoveredFormat(UsbDevice device, int[][] resolutions) {
+        int[] formats = nativeDiscoveredFormats(device.getVendorId(), device.getProductId());
+        if (formats == null || formats.length == 0) {
+            return false;
+        }
+        
+        int[] pixelFormats = {getMJPEGFormat(), getYUYVFormat()};
+        for (int pixelFormat : pixelFormats) {
+            for (int[] res : resolutions) {
+                if (supportsFormat(formats, pixelFormat, res[0], res[1])
+                        && nativeSetFormat(nativeCameraPtr, res[0], res[1], pixelFormat)) {
+                    currentWidth = res[0];
+                    currentHeight = res[1];
+                    currentPixelFormat = pixelFormat;
+                    Log.i(TAG, String.format(Locale.US, "Set enumerated format 0x%08x %dx%d",
+                            pixelFormat, res[0], res[1]));
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+    
+    /**
+     * Whether flattened {fourcc, width, height} triples contain the mode
+     */
+    static boolean supportsFormat(int[] formats, int pixelFormat, int width, int height) {
+        for (int i = 0; i + 2 < formats.length; i += 3) {
+            if (formats[i] == pixelFormat && formats[i + 1] == width && formats[i + 2] == height) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
     // Frame timing control - don't skip frames, just throttle
     private long lastFrameTime = 0;
     private static final long MIN_FRAME_INTERVAL_MS = 33; // 30 FPS max
@@ -410,10 +556,14 @@ public class UVCCameraManager {
             
             lastFrameTime = currentTime;
             
-            // Get frame from native code
-            byte[] frameData = nativeGetFrame(nativeCameraPtr);
+            // Get frame from native code (nothing while closed for a reconnect)
+            byte[] frameData = deviceOpen ? nativeGetFrame(nativeCameraPtr) : null;
+            long now = SystemClock.elapsedRealtime();
             
             if (frameData != null && frameData.length > 0) {
+                if (reconnectSupervisor.onFrame(now)) {
+                    onStreamRecovered();
+                }
                 Bitmap bitmap = null;
                 
                 // Check if it's MJPEG (starts with JPEG magic bytes FF D8)
@@ -445,11 +595,27 @@ public class UVCCameraManager {
                     // Display on PreviewView if available
                     displayBitmapOnPreview(bitmap);
                     
-                    // Send to MediaPipe for pose detection (non-blocking)
-                    if (frameListener != null) {
+                    // Send to MediaPipe for pose detection (non-blocking), unless the scene is static.
+                    // YUYV is scored natively during nativeGetFrame; MJPEG only after decoding.
+                    boolean process = true;
+                    MotionGate gate = motionGate;
+                    if (gate != null) {
+                        float motion = nativeGetMotionScore(nativeCameraPtr);
+                        if (motion < 0) {
+                            motion = gate.measureBitmap(bitmap);
+                        }
+                        process = gate.shouldProcess(motion);
+                    }
+                    
+                    if (process && frameListener != null) {
                         frameListener.onFrame(bitmap, 0);
                     }
                 }
+            } else if (reconnectSupervisor.checkStall(now)) {
+                Log.w(TAG, "No frames for " + CameraReconnectSupervisor.DEFAULT_STALL_TIMEOUT_MS + " ms, reopening");
+                reopenCachedDevice();
+            } else if (reconnectSupervisor.getState() == CameraReconnectSupervisor.State.FAILED) {
+                mainHandler.post(giveUpRunnable);
             }
             
             // Schedule next frame capture
@@ -459,10 +625,135 @@ public class UVCCameraManager {
         }
     };
     
+    private final Runnable reopenRunnable = this::reopenCachedDevice;
+    private final Runnable giveUpRunnable = this::giveUpReconnect;
+    
+    /**
+     * Whether device is the camera a detached stream is waiting for
+     */
+    private boolean isAwaitedCamera(UsbDevice device) {
+        CachedSession session = cachedSession;
+        return session != null && session.matches(device)
+                && reconnectSupervisor.getState() == CameraReconnectSupervisor.State.WAITING_FOR_DEVICE;
+    }
+    
+    /**
+     * Detach of the streaming camera: close the native device but keep the
+     * frame thread and pipeline up while waiting for it to come back
+     */
+    private void onStreamingCameraDetached() {
+        Log.i(TAG, "USB camera detached, waiting " + reconnectSupervisor.getGiveUpMs() + " ms for it to return");
+        reconnectSupervisor.onDetached(SystemClock.elapsedRealtime());
+        
+        Handler handler = frameHandler;
+        if (handler != null) {
+            handler.removeCallbacks(reopenRunnable);
+            handler.post(this::closeNativeDevice);
+        }
+        if (usbConnection != null) {
+            usbConnection.close();
+            usbConnection = null;
+        }
+        mainHandler.removeCallbacks(giveUpRunnable);
+        mainHandler.postDelayed(giveUpRunnable, reconnectSupervisor.getGiveUpMs());
+    }
+    
     /**
-     * Convert YUYV frame data to Bitmap
+     * The detached camera is back and permitted: reclaim it and reopen on the frame thread
      */
-    private Bitmap convertYUYVToBitmap(byte[] yuyv, int width, int height) {
+    private void resumeAfterReattach(UsbDevice device) {
+        usbConnection = usbManager.openDevice(device);
+        if (usbConnection == null) {
+            // The give-up timer is still pending and will stop the camera
+            Log.e(TAG, "Failed to reopen USB connection after re-attach");
+            return;
+        }
+        Handler handler = frameHandler;
+        if (reconnectSupervisor.onAttached(SystemClock.elapsedRealtime()) && handler != null) {
+            handler.post(reopenRunnable);
+        }
+    }
+    
+    /**
+     * Runs on the frame thread. Reopens the cached node with the cached
+     * format: one open, one S_FMT and STREAMON, no path probing or format
+     * search. The node is re-resolved through discovery, which only rescans
+     * if the cached node no longer belongs to this VID/PID. Failed attempts
+     * are retried with the supervisor's backoff.
+     */
+    private void reopenCachedDevice() {
+        CachedSession session = cachedSession;
+        if (session == null || nativeCameraPtr == 0
+                || reconnectSupervisor.getState() != CameraReconnectSupervisor.State.RECOVERING) {
+            return;
+        }
+        closeNativeDevice();
+        
+        String path = nativeDiscover(session.vendorId, session.productId);
+        if (path == null) {
+            path = session.devicePath;
+        }
+        if (nativeOpen(nativeCameraPtr, path)
+                && nativeSetFormat(nativeCameraPtr, session.width, session.height, session.pixelFormat)
+                && nativeStartStreaming(nativeCameraPtr)) {
+            deviceOpen = true;
+            reconnectSupervisor.onReopened(SystemClock.elapsedRealtime());
+            Log.i(TAG, "Reopened " + path + " @ " + session.width + "x" + session.height);
+            return;
+        }
+        
+        nativeClose(nativeCameraPtr);
+        long delay = reconnectSupervisor.onReopenFailed(SystemClock.elapsedRealtime());
+        if (delay < 0) {
+            mainHandler.post(giveUpRunnable);
+        } else if (frameHandler != null) {
+            frameHandler.postDelayed(reopenRunnable, delay);
+        }
+    }
+    
+    private void closeNativeDevice() {
+        deviceOpen = false;
+        if (nativeCameraPtr != 0) {
+            nativeStopStreaming(nativeCameraPtr);
+            nativeClose(nativeCameraPtr);
+        }
+    }
+    
+    private void onStreamRecovered() {
+        final long recoveryMs = reconnectSupervisor.getLastRecoveryMs();
+        Log.i(TAG, String.format(Locale.US, "Recovered from %s in %d ms",
+                reconnectSupervisor.getFault(), recoveryMs));
+        mainHandler.post(() -> {
+            mainHandler.removeCallbacks(giveUpRunnable);
+            if (connectionListener != null) {
+                connectionListener.onCameraRecovered(recoveryMs);
+            }
+        });
+    }
+    
+    /**
+     * Main thread. Falls back to a full stop once the supervisor gives up.
+     */
+    private void giveUpReconnect() {
+        if (!reconnectSupervisor.giveUpIfExpired(SystemClock.elapsedRealtime())) {
+            return;
+        }
+        Log.w(TAG, "USB camera did not recover, stopping");
+        CachedSession session = cachedSession;
+        if (session != null) {
+            nativeInvalidateDiscovery(session.vendorId, session.productId);
+        }
+        stopCamera();
+        if (connectionListener != null) {
+            connectionListener.onCameraDisconnected();
+        }
+    }
+    
+    /**
+     * Convert YUYV frame data to Bitmap. Also used by PipelineStressRunner,
+     * so stress runs decode exactly like live USB frames.
+     */
+    static Bitmap convertYUYVToBitmap(byte[] yuyv, int width, int height) {
         try {
             // Convert YUYV to YUV420 (NV21)
             byte[] yuv420 = new byte[width * height * 3 / 2];
@@ -517,9 +808,14 @@ public class UVCCameraManager {
         
         // Stop frame capture
         shouldCaptureFrames = false;
+        mainHandler.removeCallbacks(giveUpRunnable);
+        reconnectSupervisor.reset();
+        cachedSession = null;
+        deviceOpen = false;
         
         if (frameHandler != null) {
             frameHandler.removeCallbacks(frameCaptureRunnable);
+            frameHandler.removeCallbacks(reopenRunnable);
         }
         
         if (frameThread != null) {
@@ -535,6 +831,12 @@ public class UVCCameraManager {
         
         // Stop native streaming
         if (nativeCameraPtr != 0) {
+            long[] stats = nativeGetStats(nativeCameraPtr);
+            if (stats != null) {
+                Log.i(TAG, String.format(Locale.US,
+                        "Capture stats: %d frames, %d dropped, %d timeouts, %d errors",
+                        stats[0], stats[1], stats[2], stats[3]));
+            }
             nativeStopStreaming(nativeCameraPtr);
             nativeClose(nativeCameraPtr);
             nativeDestroy(nativeCameraPtr);
@@ -569,6 +871,27 @@ public class UVCCameraManager {
         usbManager = null;
     }
 
+    /**
+     * Permission-to-streaming time of the last successful start, or -1
+     */
+    public long getLastColdStartMs() {
+        return lastColdStartMs;
+    }
+
+    /**
+     * Fault-to-first-frame time of the last USB reconnect, or -1
+     */
+    public long getLastRecoveryMs() {
+        return reconnectSupervisor.getLastRecoveryMs();
+    }
+    
+    /**
+     * Stall, detach and recovery counts plus recovery times
+     */
+    public Map<String, Object> getReconnectMetrics() {
+        return reconnectSupervisor.getMetricsMap();
+    }
+
     /**
      * Check if camera is streaming
      */
@@ -1,18 +1,23 @@
 package com.esw.postureanalyzer.vision;
 
 import android.content.Context;
-import android.graphics.Bitmap;
+import android.util.Log;
 import android.view.Surface;
 import android.widget.ImageView;
 
 import androidx.appcompat.app.AppCompatActivity;
 import androidx.camera.view.PreviewView;
+import com.google.mediapipe.framework.image.BitmapImageBuilder;
+import com.google.mediapipe.framework.image.MPImage;
+
+import java.util.Map;
 
 /**
  * Unified Camera Manager that supports both internal cameras (CameraX) and USB cameras (UVC)
  * This allows seamless switching between camera types
  */
 public class UnifiedCameraManager {
+    private static final String TAG = "UnifiedCameraManager";
     
     public enum CameraType {
         INTERNAL,  // Use Android CameraX API (built-in cameras)
@@ -26,9 +31,17 @@ public class UnifiedCameraManager {
     private UVCCameraManager uvcCameraManager;
     private CameraType currentCameraType;
     private boolean isStarted = false;
+    private final MotionGate motionGate = new MotionGate(); // Shared by both backends
+    private int analysisWidth = 1280;
+    private int analysisHeight = 720;
+    private PreviewView internalPreviewView;
 
+    /**
+     * Frames from either backend in sensor orientation; the image is only valid
+     * for the duration of the call.
+     */
     public interface FrameListener {
-        void onFrame(Bitmap bitmap, int rotationDegrees);
+        void onFrame(MPImage image, int rotationDegrees);
     }
     
     public interface CameraStatusListener {
@@ -59,8 +72,12 @@ public class UnifiedCameraManager {
         
         if (cameraXManager == null) {
             cameraXManager = new CameraXManager(activity, previewView, 
-                (bitmap, rotation) -> frameListener.onFrame(bitmap, rotation));
+                (image, rotation) -> frameListener.onFrame(image, rotation));
+            cameraXManager.setMotionGate(motionGate);
         }
+        internalPreviewView = previewView;
+        cameraXManager.setTargetResolution(analysisWidth, analysisHeight);
+        motionGate.reset();
         
         cameraXManager.startCamera();
         isStarted = true;
@@ -87,7 +104,7 @@ public class UnifiedCameraManager {
         
         if (uvcCameraManager == null) {
             uvcCameraManager = new UVCCameraManager(activity, 
-                (bitmap, rotation) -> frameListener.onFrame(bitmap, rotation));
+                (bitmap, rotation) -> frameListener.onFrame(new BitmapImageBuilder(bitmap).build(), rotation));
             
             uvcCameraManager.setConnectionListener(new UVCCameraManager.ConnectionListener() {
                 @Override
@@ -110,10 +127,18 @@ public class UnifiedCameraManager {
                         statusListener.onError(message);
                     }
                 }
+
+                @Override
+                public void onCameraRecovered(long recoveryMs) {
+                    // Stream resumed in place; the pipeline never saw a stop
+                    Log.i(TAG, "USB camera recovered in " + recoveryMs + " ms");
+                }
             });
             
+            uvcCameraManager.setMotionGate(motionGate);
             uvcCameraManager.initialize();
         }
+        motionGate.reset();
         
         // Set the USB preview ImageView for displaying USB camera frames
         if (usbPreviewView != null) {
@@ -149,7 +174,9 @@ public class UnifiedCameraManager {
     }
 
     /**
-     * Release all camera resources
+     * Release all camera resources. The manager can be started again
+     * afterwards: backends are rebuilt and the motion gate reallocates its
+     * native state on the next start.
      */
     public void release() {
         if (uvcCameraManager != null) {
@@ -160,9 +187,40 @@ public class UnifiedCameraManager {
         // CameraX manager doesn't need explicit release (lifecycle-aware)
         cameraXManager = null;
         
+        motionGate.release();
+        
         isStarted = false;
     }
 
+    /**
+     * Change the internal camera's analysis resolution, rebinding it if running.
+     * USB cameras keep their negotiated format.
+     */
+    public void setAnalysisResolution(int width, int height) {
+        if (width == analysisWidth && height == analysisHeight) {
+            return;
+        }
+        analysisWidth = width;
+        analysisHeight = height;
+        if (isStarted && currentCameraType == CameraType.INTERNAL && internalPreviewView != null) {
+            startInternalCamera(internalPreviewView);
+        }
+    }
+
+    /**
+     * Motion gate applied to frames from either camera before pose detection
+     */
+    public MotionGate getMotionGate() {
+        return motionGate;
+    }
+
+    /**
+     * USB reconnect counts and recovery times, or null if the USB camera was never used
+     */
+    public Map<String, Object> getUsbReconnectMetrics() {
+        return uvcCameraManager != null ? uvcCameraManager.getReconnectMetrics() : null;
+    }
+
     /**
      * Get current camera type
      */
@@ -0,0 +1,159 @@
+package com.esw.postureanalyzer.vision;
+
+import android.util.Log;
+
+import java.io.BufferedReader;
+import java.io.File;
+import java.io.FileReader;
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Locale;
+
+/**
+ * Compares V4L2 buffer memory types end to end (v4l2_memory_benchmark.cpp):
+ * each frame is leased, brought into memory the pipeline owns and read once.
+ * MMAP needs one copy out of the driver's buffer per frame. USERPTR and
+ * DMABUF have the driver write straight into a caller-owned frame pool.
+ *
+ * CPU time is the capture thread's, split into user and sys. Intended for
+ * the vivid test driver, which offers all three memory types (and MPLANE
+ * with multiplanar=2), so the modes can be compared on any rooted board.
+ */
+public final class V4L2MemoryBenchmark {
+    private static final String TAG = "V4L2MemoryBenchmark";
+
+    // enum v4l2_memory
+    public static final int MEMORY_MMAP = 1;
+    public static final int MEMORY_USERPTR = 2;
+    public static final int MEMORY_DMABUF = 4;
+
+    public static final int[] ALL_MEMORY = {MEMORY_MMAP, MEMORY_USERPTR, MEMORY_DMABUF};
+
+    private static final int METRIC_COUNT = 6;
+
+    private static boolean nativeAvailable = false;
+
+    static {
+        try {
+            System.loadLibrary("uvccamera");
+            nativeAvailable = true;
+        } catch (UnsatisfiedLinkError e) {
+            Log.e(TAG, "Native library unavailable", e);
+        }
+    }
+
+    private static native String nativeRun(String devicePath, int width, int height, int pixelFormat,
+                                           int memory, int frames, double[] metrics);
+
+    /**
+     * One memory type's run. failure is null on success.
+     */
+    public static class Result {
+        public final int memory;
+        public final String failure;
+        public final int frames;
+        public final double fps;
+        public final double userMsPerFrame;
+        public final double sysMsPerFrame;
+        public final double copiesPerFrame;
+        public final double bytesCopiedPerFrame;
+
+        Result(int memory, String failure, double[] metrics) {
+            this.memory = memory;
+            this.failure = failure;
+            this.frames = (int) metrics[0];
+            this.fps = metrics[1];
+            this.userMsPerFrame = metrics[2];
+            this.sysMsPerFrame = metrics[3];
+            this.copiesPerFrame = metrics[4];
+            this.bytesCopiedPerFrame = metrics[5];
+        }
+
+        public boolean passed() {
+            return failure == null;
+        }
+
+        public double cpuMsPerFrame() {
+            return userMsPerFrame + sysMsPerFrame;
+        }
+
+        @Override
+        public String toString() {
+            if (!passed()) {
+                return memoryName(memory) + " FAILED: " + failure;
+            }
+            return String.format(Locale.US,
+                    "%s: %d frames, %.1f fps, cpu %.3f ms/frame (user %.3f, sys %.3f), %.1f copies (%.0f KB) per frame",
+                    memoryName(memory), frames, fps, cpuMsPerFrame(), userMsPerFrame, sysMsPerFrame,
+                    copiesPerFrame, bytesCopiedPerFrame / 1024.0);
+        }
+    }
+
+    private V4L2MemoryBenchmark() {
+    }
+
+    public static boolean isAvailable() {
+        return nativeAvailable;
+    }
+
+    public static String memoryName(int memory) {
+        switch (memory) {
+            case MEMORY_MMAP:
+                return "mmap";
+            case MEMORY_USERPTR:
+                return "userptr";
+            case MEMORY_DMABUF:
+                return "dmabuf";
+            default:
+                return "memory-" + memory;
+        }
+    }
+
+    /**
+     * Capture frames from devicePath with one memory type; pixelFormat is a V4L2 fourcc
+     */
+    public static Result run(String devicePath, int width, int height, int pixelFormat, int memory, int frames) {
+        double[] metrics = new double[METRIC_COUNT];
+        Result result = new Result(memory,
+                nativeRun(devicePath, width, height, pixelFormat, memory, frames, metrics), metrics);
+        if (result.passed()) {
+            Log.i(TAG, result.toString());
+        } else {
+            Log.e(TAG, result.toString());
+        }
+        return result;
+    }
+
+    /**
+     * run() for every memory type in ALL_MEMORY order
+     */
+    public static List<Result> runAll(String devicePath, int width, int height, int pixelFormat, int frames) {
+        List<Result> results = new ArrayList<>();
+        for (int memory : ALL_MEMORY) {
+            results.add(run(devicePath, width, height, pixelFormat, memory, frames));
+        }
+        return results;
+    }
+
+    /**
+     * First vivid capture node (e.g. "vivid-000-vid-cap"), or null if vivid is not loaded
+     */
+    public static String findVividCaptureNode() {
+        File[] nodes = new File("/sys/class/video4linux").listFiles();
+        if (nodes == null) {
+            return null;
+        }
+        for (File node : nodes) {
+            try (BufferedReader reader = new BufferedReader(new FileReader(new File(node, "name")))) {
+                String name = reader.readLine();
+                if (name != null && name.startsWith("vivid") && name.endsWith("vid-cap")) {
+                    return "/dev/" + node.getName();
+                }
+            } catch (IOException e) {
+                // Not readable under this SELinux domain; keep looking
+            }
+        }
+        return null;
+    }
+}
@@ -0,0 +1,173 @@
+package com.esw.postureanalyzer.vision;
+
+import com.google.mediapipe.tasks.components.containers.NormalizedLandmark;
+
+import java.util.HashMap;
+import java.util.List;
+import java.util.Locale;
+import java.util.Map;
+
+/**
+ * Decides per pose which posture models have trustworthy inputs.
+ *
+ * Each model lists the landmarks its features are built from; all of them
+ * must reach MIN_VISIBILITY for the model to run. A model that is gated off
+ * is not run for that pose and its PostureState field stays UNKNOWN, instead
+ * of carrying a guess made from landmarks MediaPipe could not see (legs
+ * under a desk being the usual case).
+ *
+ * Saved inference time is estimated from each model's measured cost per
+ * pose, the same way MotionGate costs skipped frames.
+ */
+public class VisibilityGate {
+    /** Same threshold EvaluationMetrics uses for a detected joint */
+    public static final float MIN_VISIBILITY = 0.5f;
+
+    // Cost per row is smoothed so one slow batch doesn't swing the estimate
+    private static final double COST_ALPHA = 0.1;
+
+    /**
+     * Posture models and the landmarks their features need
+     */
+    public enum Model {
+        SLOUCH("Slouch", 11, 12, 23, 24),          // shoulders, hips
+        LEGS("CrossLegged", 23, 24, 25, 26, 27, 28), // hips, knees, ankles
+        LEAN("Lean", 11, 12, 23, 24);              // shoulders, hips; ear visibility is a model input
+
+        public final String displayName;
+        final int[] landmarks;
+
+        Model(String displayName, int... landmarks) {
+            this.displayName = displayName;
+            this.landmarks = landmarks;
+        }
+    }
+
+    private volatile boolean enabled = true;
+    private final long[] evaluated = new long[Model.values().length];
+    private final long[] skipped = new long[Model.values().length];
+    private final double[] usPerRow = new double[Model.values().length];
+
+    /**
+     * Whether the model's landmarks are all visible enough in this pose
+     */
+    public boolean allows(Model model, List<NormalizedLandmark> landmarks) {
+        return !enabled || inView(model, landmarks);
+    }
+
+    /**
+     * The visibility check itself, regardless of whether gating is enabled
+     */
+    static boolean inView(Model model, List<NormalizedLandmark> landmarks) {
+        for (int index : model.landmarks) {
+            if (index >= landmarks.size() || landmarks.get(index).visibility().orElse(0f) < MIN_VISIBILITY) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Same check on a flat [33 * LANDMARK_STRIDE] landmark array (x, y, z, visibility)
+     */
+    public boolean allows(Model model, float[] landmarks) {
+        if (!enabled) {
+            return true;
+        }
+        for (int index : model.landmarks) {
+            int offset = index * FeatureExtractor.LANDMARK_STRIDE + 3;
+            if (offset >= landmarks.length || landmarks[offset] < MIN_VISIBILITY) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * A model ran for rows poses in inferenceUs
+     */
+    public synchronized void recordRun(Model model, int rows, long inferenceUs) {
+        if (rows <= 0) {
+            return;
+        }
+        int m = model.ordinal();
+        evaluated[m] += rows;
+        double cost = inferenceUs / (double) rows;
+        usPerRow[m] = usPerRow[m] == 0 ? cost : usPerRow[m] + COST_ALPHA * (cost - usPerRow[m]);
+    }
+
+    /**
+     * A model was gated off for rows poses
+     */
+    public synchronized void recordSkipped(Model model, int rows) {
+        if (rows > 0) {
+            skipped[model.ordinal()] += rows;
+        }
+    }
+
+    public void setEnabled(boolean enabled) {
+        this.enabled = enabled;
+    }
+
+    public boolean isEnabled() {
+        return enabled;
+    }
+
+    public synchronized long getSkipped(Model model) {
+        return skipped[model.ordinal()];
+    }
+
+    public synchronized double getSkipRatio(Model model) {
+        int m = model.ordinal();
+        long total = evaluated[m] + skipped[m];
+        return total > 0 ? skipped[m] / (double) total : 0.0;
+    }
+
+    public synchronized double getSavedInferenceMs(Model model) {
+        int m = model.ordinal();
+        return skipped[m] * usPerRow[m] / 1000.0;
+    }
+
+    public synchronized double getSavedInferenceMs() {
+        double saved = 0;
+        for (Model model : Model.values()) {
+            saved += getSavedInferenceMs(model);
+        }
+        return saved;
+    }
+
+    public synchronized void reset() {
+        for (int m = 0; m < evaluated.length; m++) {
+            evaluated[m] = 0;
+            skipped[m] = 0;
+            usPerRow[m] = 0;
+        }
+    }
+
+    public synchronized String getStats() {
+        StringBuilder stats = new StringBuilder();
+        for (Model model : Model.values()) {
+            int m = model.ordinal();
+            stats.append(String.format(Locale.US, "%s: %d run, %d unknown (%.1f%%)\n",
+                    model.displayName, evaluated[m], skipped[m], getSkipRatio(model) * 100));
+        }
+        stats.append(String.format(Locale.US, "Saved: %.1f ms inference", getSavedInferenceMs()));
+        return stats.toString();
+    }
+
+    public synchronized Map<String, Object> getMetricsMap() {
+        Map<String, Object> metrics = new HashMap<>();
+        for (Model model : Model.values()) {
+            int m = model.ordinal();
+            Map<String, Object> entry = new HashMap<>();
+            entry.put("evaluated", evaluated[m]);
+            entry.put("skipped", skipped[m]);
+            entry.put("skipRatio", getSkipRatio(model));
+            entry.put("savedInferenceMs", getSavedInferenceMs(model));
+            metrics.put(model.name().toLowerCase(Locale.US), entry);
+        }
+        metrics.put("savedInferenceMs", getSavedInferenceMs());
+        metrics.put("enabled", enabled);
+        return metrics;
+    }
+}
@@ -0,0 +1,151 @@
+package com.esw.postureanalyzer.performance;
+
+import org.junit.Before;
+import org.junit.Rule;
+import org.junit.Test;
+import org.junit.rules.TemporaryFolder;
+
+import java.io.File;
+import java.io.FileWriter;
+import java.io.IOException;
+
+import static org.junit.Assert.*;
+
+/**
+ * ResourceSampler against a fake /proc/self and /sys/class/power_supply tree.
+ */
+public class ResourceSamplerTest {
+    @Rule
+    public TemporaryFolder root = new TemporaryFolder();
+
+    private File proc;
+    private File power;
+    private ResourceSampler sampler;
+
+    @Before
+    public void setUp() throws IOException {
+        proc = root.newFolder("proc", "self");
+        power = root.newFolder("power_supply");
+        sampler = new ResourceSampler(proc, power, 4096, 100);
+
+        writeStatm(25600);                     // 100 MB resident
+        write(new File(proc, "stat"), stat(1234, "ureanalyzer", 100, 50));
+        writeThread(1234, "ureanalyzer", 10, 5);
+        writeThread(1240, "UVC-FrameThread", 0, 0);
+
+        File usb = new File(power, "usb");
+        usb.mkdirs();
+        write(new File(usb, "type"), "USB");
+        File battery = new File(power, "battery");
+        battery.mkdirs();
+        write(new File(battery, "type"), "Battery");
+        writeBattery(-500000, 4000000);       // 0.5 A discharge at 4.0 V = 2000 mW
+    }
+
+    private static String stat(int pid, String comm, long utime, long stime) {
+        // Fields 3..13 are padding here; utime/stime are fields 14 and 15
+        return pid + " (" + comm + ") S 1 1 0 0 -1 4194624 100 0 0 0 " + utime + " " + stime + " 0 0 20 0 30";
+    }
+
+    private void writeStatm(long residentPages) throws IOException {
+        write(new File(proc, "statm"), "400000 " + residentPages + " 8000 10 0 90000 0");
+    }
+
+    private void writeThread(int tid, String comm, long utime, long stime) throws IOException {
+        File task = new File(new File(proc, "task"), String.valueOf(tid));
+        task.mkdirs();
+        write(new File(task, "stat"), stat(tid, comm, utime, stime));
+    }
+
+    private void writeBattery(long microAmps, long microVolts) throws IOException {
+        File battery = new File(power, "battery");
+        write(new File(battery, "current_now"), String.valueOf(microAmps));
+        write(new File(battery, "voltage_now"), String.valueOf(microVolts));
+    }
+
+    private static void write(File file, String content) throws IOException {
+        try (FileWriter writer = new FileWriter(file)) {
+            writer.write(content + "\n");
+        }
+    }
+
+    @Test
+    public void parsesStatWithSpacesInComm() {
+        String line = "42 (Binder: 42_3) S 1 1 0 0 -1 0 0 0 0 0 7 3 0 0 20 0 1";
+        assertEquals(10, ResourceSampler.parseStatCpuTicks(line));
+        assertEquals("Binder: 42_3", ResourceSampler.parseStatName(line));
+        assertEquals(-1, ResourceSampler.parseStatCpuTicks("garbage"));
+    }
+
+    @Test
+    public void tracksPeakMemoryCpuAndEnergy() throws IOException {
+        sampler.beginSession(10_000);
+
+        writeStatm(51200);                     // 200 MB
+        write(new File(proc, "stat"), stat(1234, "ureanalyzer", 150, 100)); // +100 ticks = 1 s CPU
+        writeThread(1240, "UVC-FrameThread", 30, 10);
+        sampler.sample(12_000);                // 2 s elapsed -> 50% CPU
+
+        writeStatm(38400);                     // back to 150 MB
+        writeBattery(-250000, 4000000);        // 1000 mW
+        sampler.sample(14_000);                // no CPU since last sample -> 0%
+
+        ResourceSampler.SessionStats stats = sampler.getSessionStats(14_000);
+        assertEquals(4000, stats.durationMs);
+        assertEquals(200, stats.peakMemoryMb);
+        assertEquals(150, sampler.getCurrentMemoryMb());
+        assertEquals(25.0, stats.avgCpuPercent, 0.01);
+        assertEquals(1500.0, stats.avgPowerMw, 0.01);
+        // 2000 mW * 2 s + 1000 mW * 2 s
+        assertEquals(6000.0, stats.energyMj, 0.01);
+        assertEquals(60.0, stats.energyPerInferenceMj(100), 0.01);
+        assertEquals(Long.valueOf(400), stats.threadCpuMs.get("UVC-FrameThread"));
+        assertNull(stats.threadCpuMs.get("ureanalyzer")); // No CPU during the session
+    }
+
+    @Test
+    public void newSessionResetsAccumulators() throws IOException {
+        sampler.beginSession(1_000);
+        writeStatm(51200);
+        sampler.sample(2_000);
+        assertEquals(200, sampler.getSessionStats(2_000).peakMemoryMb);
+
+        writeStatm(25600);
+        sampler.beginSession(3_000);
+        sampler.sample(4_000);
+        ResourceSampler.SessionStats stats = sampler.getSessionStats(4_000);
+        assertEquals(100, stats.peakMemoryMb);
+        assertEquals(2000.0, stats.energyMj, 0.01);
+    }
+
+    @Test
+    public void chargingOrFullBatteryReportsNoPower() throws IOException {
+        File battery = new File(power, "battery");
+        for (String status : new String[]{"Charging", "Full"}) {
+            write(new File(battery, "status"), status);
+            writeBattery(1500000, 4200000);   // 1.5 A into the battery
+            sampler.beginSession(1_000);
+            sampler.sample(2_000);
+            ResourceSampler.SessionStats stats = sampler.getSessionStats(2_000);
+            assertEquals(status, 0.0, stats.avgPowerMw, 0.0);
+            assertEquals(status, 0.0, stats.energyMj, 0.0);
+        }
+
+        write(new File(battery, "status"), "Discharging");
+        writeBattery(-500000, 4000000);
+        sampler.beginSession(3_000);
+        sampler.sample(4_000);
+        assertEquals(2000.0, sampler.getSessionStats(4_000).avgPowerMw, 0.01);
+    }
+
+    @Test
+    public void missingBatteryReportsNoPower() throws IOException {
+        ResourceSampler noBattery = new ResourceSampler(proc, root.newFolder("empty"), 4096, 100);
+        noBattery.beginSession(1_000);
+        noBattery.sample(2_000);
+        ResourceSampler.SessionStats stats = noBattery.getSessionStats(2_000);
+        assertEquals(0.0, stats.avgPowerMw, 0.0);
+        assertEquals(0.0, stats.energyMj, 0.0);
+        assertEquals(100, stats.peakMemoryMb);
+    }
+}
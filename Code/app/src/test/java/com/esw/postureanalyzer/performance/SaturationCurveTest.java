@@ -0,0 +1,113 @@
+package com.esw.postureanalyzer.performance;
+
+import org.junit.Test;
+
+import static org.junit.Assert.*;
+
+/**
+ * SaturationCurve rate, loss and knee arithmetic on hand-fed steps.
+ */
+public class SaturationCurveTest {
+    private static final long SECOND_NS = 1_000_000_000L;
+    private static final long MS_NS = 1_000_000L;
+
+    /**
+     * One second at the given offered rate, capturing every frame and
+     * processing every processEvery-th one with latencies 1..n ms.
+     */
+    private static SaturationCurve.Point step(SaturationCurve curve, int fps, int processEvery) {
+        SaturationCurve.Step step = curve.beginStep(fps);
+        int processed = 0;
+        for (int seq = 100; seq < 100 + fps; seq++) {
+            step.onCaptured(seq);
+            if ((seq - 100) % processEvery == 0) {
+                processed++;
+                step.onProcessed(processed * MS_NS, 2 * MS_NS, 10 * MS_NS, MS_NS);
+            }
+        }
+        SaturationCurve.Point point = step.finish(SECOND_NS);
+        curve.add(point);
+        return point;
+    }
+
+    @Test
+    public void ratesAndLoss() {
+        SaturationCurve.Point point = step(new SaturationCurve(), 100, 4);
+
+        assertEquals(100.0, point.capturedFps, 1e-9);
+        assertEquals(25.0, point.processedFps, 1e-9);
+        assertEquals(75.0, point.lossPercent, 1e-9);
+        assertEquals(2.0, point.decodeMs, 1e-9);
+        assertEquals(10.0, point.poseMs, 1e-9);
+        assertEquals(1.0, point.classifyMs, 1e-9);
+        assertTrue(point.isSaturated());
+    }
+
+    @Test
+    public void lossCountsFramesTheReaderNeverSaw() {
+        SaturationCurve curve = new SaturationCurve();
+        SaturationCurve.Step step = curve.beginStep(10);
+        // Source dropped 1..9 before the reader got to them
+        step.onCaptured(0);
+        step.onProcessed(MS_NS, 0, 0, 0);
+        step.onCaptured(10);
+        step.onProcessed(MS_NS, 0, 0, 0);
+
+        SaturationCurve.Point point = step.finish(SECOND_NS);
+        assertEquals(2.0, point.capturedFps, 1e-9);
+        assertEquals(100.0 * 9 / 11, point.lossPercent, 1e-9);
+    }
+
+    @Test
+    public void latencyPercentiles() {
+        SaturationCurve.Point point = step(new SaturationCurve(), 100, 1);
+
+        assertEquals(50.0, point.p50LatencyMs, 1e-9);
+        assertEquals(95.0, point.p95LatencyMs, 1e-9);
+        assertEquals(99.0, point.p99LatencyMs, 1e-9);
+        assertEquals(0.0, point.lossPercent, 1e-9);
+        assertFalse(point.isSaturated());
+    }
+
+    @Test
+    public void emptyStepIsAllZero() {
+        SaturationCurve.Point point = new SaturationCurve().beginStep(30).finish(SECOND_NS);
+
+        assertEquals(0.0, point.capturedFps, 1e-9);
+        assertEquals(0.0, point.processedFps, 1e-9);
+        assertEquals(0.0, point.p99LatencyMs, 1e-9);
+        assertEquals(0.0, point.decodeMs, 1e-9);
+    }
+
+    @Test
+    public void sustainedFpsIsLastUnsaturatedStep() {
+        SaturationCurve curve = new SaturationCurve();
+        step(curve, 30, 1);
+        step(curve, 60, 1);
+        step(curve, 120, 2);
+
+        assertEquals(60, curve.getSustainedFps());
+        assertEquals(60.0, curve.getPeakProcessedFps(), 1e-9);
+        assertEquals(3, curve.getPoints().size());
+    }
+
+    @Test
+    public void saturatedEverywhereReportsNoSustainedRate() {
+        SaturationCurve curve = new SaturationCurve();
+        step(curve, 60, 3);
+        assertEquals(-1, curve.getSustainedFps());
+    }
+
+    @Test
+    public void csvHasHeaderAndOneRowPerStep() {
+        SaturationCurve curve = new SaturationCurve();
+        step(curve, 30, 1);
+        step(curve, 60, 2);
+
+        String[] lines = curve.toCsv().trim().split("\\R");
+        assertEquals(3, lines.length);
+        assertTrue(lines[0].startsWith("offered_fps,captured_fps,processed_fps,loss_pct"));
+        assertTrue(lines[1].startsWith("30,30.0,30.0,0.0,"));
+        assertTrue(lines[2].startsWith("60,60.0,30.0,50.0,"));
+    }
+}
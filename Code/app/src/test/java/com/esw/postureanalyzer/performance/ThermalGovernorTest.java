@@ -0,0 +1,133 @@
+package com.esw.postureanalyzer.performance;
+
+import org.junit.Before;
+import org.junit.Rule;
+import org.junit.Test;
+import org.junit.rules.TemporaryFolder;
+
+import java.io.File;
+import java.io.FileWriter;
+import java.io.IOException;
+import java.util.List;
+
+import static org.junit.Assert.*;
+
+/**
+ * ThermalGovernor against a fake /sys/class/thermal tree.
+ */
+public class ThermalGovernorTest {
+    @Rule
+    public TemporaryFolder sysfs = new TemporaryFolder();
+
+    private ThermalGovernor governor;
+
+    @Before
+    public void setUp() throws IOException {
+        writeZone(0, "cpu-0-0", "45000");
+        writeZone(1, "battery", "31000");
+        governor = new ThermalGovernor(sysfs.getRoot());
+    }
+
+    private void writeZone(int index, String type, String temp) throws IOException {
+        File zone = new File(sysfs.getRoot(), "thermal_zone" + index);
+        zone.mkdirs();
+        write(new File(zone, "type"), type);
+        write(new File(zone, "temp"), temp);
+    }
+
+    private static void write(File file, String content) throws IOException {
+        try (FileWriter writer = new FileWriter(file)) {
+            writer.write(content + "\n");
+        }
+    }
+
+    @Test
+    public void readsHottestZoneInDegrees() throws IOException {
+        assertEquals(45f, governor.readMaxZoneTempC(), 0.01f);
+
+        writeZone(2, "gpu", "52500");
+        writeZone(3, "broken", "-273000");
+        writeZone(4, "legacy", "48"); // degrees, not millidegrees
+        assertEquals(52.5f, governor.readMaxZoneTempC(), 0.01f);
+    }
+
+    @Test
+    public void missingRootReadsAsUnknown() {
+        ThermalGovernor empty = new ThermalGovernor(new File(sysfs.getRoot(), "absent"));
+        assertTrue(Float.isNaN(empty.readMaxZoneTempC()));
+        assertEquals(ThermalGovernor.Tier.NOMINAL, empty.sample(ThermalGovernor.STATUS_UNKNOWN, 0));
+    }
+
+    @Test
+    public void heatingJumpsStraightToRequiredTier() throws IOException {
+        assertEquals(ThermalGovernor.Tier.NOMINAL, governor.sample(ThermalGovernor.STATUS_NONE, 0));
+
+        writeZone(0, "cpu-0-0", "86000");
+        assertEquals(ThermalGovernor.Tier.CRITICAL, governor.sample(ThermalGovernor.STATUS_NONE, 1000));
+
+        List<ThermalGovernor.Transition> transitions = governor.drainTransitions();
+        assertEquals(1, transitions.size());
+        assertEquals(ThermalGovernor.Tier.NOMINAL, transitions.get(0).from);
+        assertEquals(ThermalGovernor.Tier.CRITICAL, transitions.get(0).to);
+        assertTrue(governor.drainTransitions().isEmpty());
+    }
+
+    @Test
+    public void androidStatusEscalatesWithCoolZones() {
+        assertEquals(ThermalGovernor.Tier.HOT, governor.sample(ThermalGovernor.STATUS_MODERATE, 0));
+    }
+
+    @Test
+    public void coolingStepsDownOneTierAfterDwellAndHysteresis() throws IOException {
+        writeZone(0, "cpu-0-0", "86000");
+        governor.sample(ThermalGovernor.STATUS_NONE, 0);
+
+        // Cooled, but inside the hysteresis band of CRITICAL
+        writeZone(0, "cpu-0-0", "83000");
+        assertEquals(ThermalGovernor.Tier.CRITICAL,
+                governor.sample(ThermalGovernor.STATUS_NONE, ThermalGovernor.MIN_DWELL_MS));
+
+        // Fully cool, but the dwell time has not elapsed since entering CRITICAL
+        writeZone(0, "cpu-0-0", "40000");
+        assertEquals(ThermalGovernor.Tier.CRITICAL,
+                governor.sample(ThermalGovernor.STATUS_NONE, ThermalGovernor.MIN_DWELL_MS - 1));
+
+        long t = ThermalGovernor.MIN_DWELL_MS;
+        assertEquals(ThermalGovernor.Tier.HOT, governor.sample(ThermalGovernor.STATUS_NONE, t));
+        assertEquals(ThermalGovernor.Tier.HOT, governor.sample(ThermalGovernor.STATUS_NONE, t + 1000));
+        t += ThermalGovernor.MIN_DWELL_MS;
+        assertEquals(ThermalGovernor.Tier.WARM, governor.sample(ThermalGovernor.STATUS_NONE, t));
+        t += ThermalGovernor.MIN_DWELL_MS;
+        assertEquals(ThermalGovernor.Tier.NOMINAL, governor.sample(ThermalGovernor.STATUS_NONE, t));
+
+        assertEquals(4, governor.drainTransitions().size());
+        assertEquals(86f, governor.getMaxTempC(), 0.01f);
+    }
+
+    @Test
+    public void frameCapFollowsTier() throws IOException {
+        assertTrue(governor.admitFrame(1000));
+        assertTrue(governor.admitFrame(1034));      // 30 FPS cap: 33 ms
+
+        writeZone(0, "cpu-0-0", "86000");
+        governor.sample(ThermalGovernor.STATUS_NONE, 0);
+        assertFalse(governor.admitFrame(1068));     // 8 FPS cap: 125 ms
+        assertTrue(governor.admitFrame(1034 + 125));
+    }
+
+    @Test
+    public void poseLimitOnlyTightensTierCap() throws IOException {
+        governor.setPoseFpsLimit(15);
+        assertEquals(66, governor.getMinFrameIntervalMs());  // 15 FPS beats the 30 FPS tier
+        assertTrue(governor.admitFrame(1000));
+        assertFalse(governor.admitFrame(1034));
+        assertTrue(governor.admitFrame(1066));
+
+        writeZone(0, "cpu-0-0", "86000");
+        governor.sample(ThermalGovernor.STATUS_NONE, 0);
+        assertEquals(125, governor.getMinFrameIntervalMs()); // 8 FPS tier is stricter
+
+        governor.setPoseFpsLimit(0);
+        assertEquals(125, governor.getMinFrameIntervalMs());
+    }
+}
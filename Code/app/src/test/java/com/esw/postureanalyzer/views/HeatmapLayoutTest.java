@@ -0,0 +1,56 @@
+package com.esw.postureanalyzer.views;
+
+import org.junit.Test;
+
+import java.util.Random;
+
+import static org.junit.Assert.*;
+
+/**
+ * HeatmapLayout geometry for the calendar and hourly views. Rendering is
+ * benchmarked on a device by the instrumented HeatmapRenderBenchmarkTest.
+ */
+public class HeatmapLayoutTest {
+    private static final int WIDTH = 1080;
+    private static final int DAYS = 365;
+
+    private static float[] yearOfScores() {
+        Random random = new Random(42);
+        float[] scores = new float[DAYS];
+        for (int i = 0; i < DAYS; i++) {
+            scores[i] = random.nextFloat() * 100f;
+        }
+        return scores;
+    }
+
+    @Test
+    public void calendarIsSevenColumnGrid() {
+        float[] scores = yearOfScores();
+        HeatmapLayout layout = HeatmapLayout.calendar(WIDTH, scores);
+        float cell = HeatmapLayout.calendarCellSize(WIDTH);
+        float pitch = cell + HeatmapLayout.CELL_PADDING;
+
+        assertEquals(DAYS, layout.count);
+        // Day 8 sits in the second row, second column
+        assertEquals(HeatmapLayout.CELL_PADDING + pitch, layout.rects[8 * 4], 0.001f);
+        assertEquals(HeatmapLayout.CALENDAR_HEADER + pitch, layout.rects[8 * 4 + 1], 0.001f);
+        assertEquals(cell, layout.rects[8 * 4 + 2] - layout.rects[8 * 4], 0.001f);
+        assertEquals(HeatmapLayout.colorForScore(scores[8]), layout.colors[8]);
+        // 365 days fill 53 rows
+        assertEquals(HeatmapLayout.CALENDAR_HEADER + 53 * pitch, layout.contentBottom, 0.001f);
+        assertEquals((int) (layout.contentBottom + HeatmapLayout.CALENDAR_FOOTER),
+                HeatmapLayout.calendarHeight(WIDTH, DAYS));
+    }
+
+    @Test
+    public void hourlyBarsScaleWithScore() {
+        HeatmapLayout layout = HeatmapLayout.hourly(1000, 400, new float[]{0f, 50f, 100f});
+        float bottom = HeatmapLayout.HOURLY_TOP + 300f;
+
+        assertEquals(bottom, layout.contentBottom, 0.001f);
+        assertEquals(bottom, layout.rects[1], 0.001f);              // Empty bar
+        assertEquals(bottom - 150f, layout.rects[4 + 1], 0.001f);   // Half height
+        assertEquals(HeatmapLayout.HOURLY_TOP, layout.rects[8 + 1], 0.001f);
+        assertEquals(0xFF00C853, layout.colors[2]);
+    }
+}
@@ -0,0 +1,150 @@
+package com.esw.postureanalyzer.vision;
+
+import org.junit.Before;
+import org.junit.Test;
+
+import java.util.Map;
+
+import static org.junit.Assert.*;
+
+/**
+ * CameraReconnectSupervisor driven with hand-fed timestamps.
+ */
+public class CameraReconnectSupervisorTest {
+    private static final long STALL_MS = 1000;
+    private static final long GIVE_UP_MS = 5000;
+
+    private CameraReconnectSupervisor supervisor;
+
+    @Before
+    public void setUp() {
+        supervisor = new CameraReconnectSupervisor(STALL_MS, GIVE_UP_MS);
+        supervisor.onStreamStarted(0);
+    }
+
+    @Test
+    public void framesKeepTheStreamHealthy() {
+        for (long t = 100; t <= 5000; t += 100) {
+            assertFalse(supervisor.onFrame(t));
+            assertFalse(supervisor.checkStall(t + 50));
+        }
+        assertEquals(CameraReconnectSupervisor.State.STREAMING, supervisor.getState());
+    }
+
+    @Test
+    public void stallReopensAndMeasuresRecovery() {
+        supervisor.onFrame(1000);
+        assertFalse(supervisor.checkStall(2000));
+        assertTrue(supervisor.checkStall(2001));
+        assertEquals(CameraReconnectSupervisor.State.RECOVERING, supervisor.getState());
+        assertEquals(CameraReconnectSupervisor.Fault.STALL, supervisor.getFault());
+
+        supervisor.onReopened(2100);
+        assertTrue(supervisor.onFrame(2250));
+        assertEquals(CameraReconnectSupervisor.State.STREAMING, supervisor.getState());
+        // From the last good frame, including the time it took to notice
+        assertEquals(1250, supervisor.getLastRecoveryMs());
+        assertEquals(1, supervisor.getRecoveries());
+    }
+
+    @Test
+    public void noRecoveryBeforeTheReopen() {
+        supervisor.checkStall(1500);
+        // A late frame from the old stream does not count as recovered
+        assertFalse(supervisor.onFrame(1600));
+        assertEquals(CameraReconnectSupervisor.State.RECOVERING, supervisor.getState());
+    }
+
+    @Test
+    public void detachWaitsForAttach() {
+        supervisor.onDetached(500);
+        assertEquals(CameraReconnectSupervisor.State.WAITING_FOR_DEVICE, supervisor.getState());
+        assertFalse("waiting, not stalled", supervisor.checkStall(3000));
+
+        assertTrue(supervisor.onAttached(1800));
+        assertFalse("second attach is ignored", supervisor.onAttached(1801));
+        supervisor.onReopened(1900);
+        assertTrue(supervisor.onFrame(2000));
+        assertEquals(1500, supervisor.getLastRecoveryMs());
+        assertEquals(CameraReconnectSupervisor.Fault.DETACH, supervisor.getFault());
+    }
+
+    @Test
+    public void stallThenDetachKeepsTheFirstFaultTime() {
+        assertTrue(supervisor.checkStall(1200));
+        supervisor.onDetached(1500);
+        supervisor.onAttached(2000);
+        supervisor.onReopened(2100);
+        assertTrue(supervisor.onFrame(2200));
+        assertEquals(2200, supervisor.getLastRecoveryMs());
+    }
+
+    @Test
+    public void failedReopensBackOff() {
+        supervisor.checkStall(1500);
+        long first = supervisor.onReopenFailed(1500);
+        long second = supervisor.onReopenFailed(1600);
+        long third = supervisor.onReopenFailed(1900);
+        assertTrue(first > 0);
+        assertTrue(second > first);
+        assertTrue(third > second);
+        for (int i = 0; i < 10; i++) {
+            assertTrue(supervisor.onReopenFailed(2000) > 0);
+        }
+    }
+
+    @Test
+    public void givesUpAfterTheWindow() {
+        supervisor.onFrame(500);
+        supervisor.checkStall(1600);
+        // The window runs from the last frame
+        assertFalse(supervisor.giveUpIfExpired(5499));
+        assertEquals(-1, supervisor.onReopenFailed(5500));
+        assertEquals(CameraReconnectSupervisor.State.FAILED, supervisor.getState());
+        assertEquals(1, supervisor.getFailures());
+        assertFalse(supervisor.onFrame(5600));
+    }
+
+    @Test
+    public void silentReopenRetriesThenGivesUp() {
+        supervisor.checkStall(1500);
+        supervisor.onReopened(1600);
+        assertFalse(supervisor.checkStall(2600));
+        assertTrue(supervisor.checkStall(2601));
+
+        supervisor.onReopened(5000);
+        assertFalse(supervisor.checkStall(6600));
+        assertEquals(CameraReconnectSupervisor.State.FAILED, supervisor.getState());
+    }
+
+    @Test
+    public void detachAfterStopIsIgnored() {
+        supervisor.reset();
+        supervisor.onDetached(100);
+        assertEquals(CameraReconnectSupervisor.State.IDLE, supervisor.getState());
+        assertFalse(supervisor.checkStall(10_000));
+    }
+
+    @Test
+    public void metricsSummarizeRecoveries() {
+        supervisor.onFrame(500);
+        supervisor.checkStall(1600);
+        supervisor.onReopened(1650);
+        supervisor.onFrame(1700);   // 1200 ms
+
+        supervisor.onDetached(3000);
+        supervisor.onAttached(3300);
+        supervisor.onReopenFailed(3300);
+        supervisor.onReopened(3500);
+        supervisor.onFrame(3600);   // 600 ms
+
+        Map<String, Object> metrics = supervisor.getMetricsMap();
+        assertEquals(1, metrics.get("stalls"));
+        assertEquals(1, metrics.get("detaches"));
+        assertEquals(2, metrics.get("recoveries"));
+        assertEquals(3, metrics.get("reopenAttempts"));
+        assertEquals(600L, metrics.get("lastRecoveryMs"));
+        assertEquals(1200L, metrics.get("maxRecoveryMs"));
+        assertEquals(900L, metrics.get("meanRecoveryMs"));
+    }
+}
@@ -0,0 +1,67 @@
+package com.esw.postureanalyzer.vision;
+
+import org.junit.Test;
+
+import java.io.BufferedReader;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.InputStreamReader;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.List;
+
+import static org.junit.Assert.*;
+
+/**
+ * Pins FeatureExtractor to feature_golden.csv, the same file
+ * training/test_posture_features.py checks the NumPy implementation against.
+ */
+public class FeatureExtractorGoldenTest {
+    private static final int LANDMARK_VALUES = 33 * FeatureExtractor.LANDMARK_STRIDE;
+    private static final float TOLERANCE = 1e-4f;
+
+    private static List<float[]> loadGolden() throws IOException {
+        List<float[]> rows = new ArrayList<>();
+        InputStream in = FeatureExtractorGoldenTest.class.getClassLoader()
+                .getResourceAsStream("feature_golden.csv");
+        assertNotNull("feature_golden.csv missing from test resources", in);
+        try (BufferedReader reader = new BufferedReader(new InputStreamReader(in, StandardCharsets.UTF_8))) {
+            String line;
+            while ((line = reader.readLine()) != null) {
+                if (line.isEmpty() || line.startsWith("#")) {
+                    continue;
+                }
+                String[] parts = line.split(",");
+                float[] values = new float[parts.length];
+                for (int i = 0; i < parts.length; i++) {
+                    values[i] = Float.parseFloat(parts[i]);
+                }
+                rows.add(values);
+            }
+        }
+        return rows;
+    }
+
+    @Test
+    public void matchesGoldenFeatures() throws IOException {
+        List<float[]> rows = loadGolden();
+        assertFalse(rows.isEmpty());
+
+        for (int r = 0; r < rows.size(); r++) {
+            float[] row = rows.get(r);
+            assertEquals(2 + LANDMARK_VALUES + FeatureExtractor.FEATURE_COUNT, row.length);
+
+            int width = (int) row[0];
+            int height = (int) row[1];
+            float[] landmarks = new float[LANDMARK_VALUES];
+            System.arraycopy(row, 2, landmarks, 0, LANDMARK_VALUES);
+
+            float[] features = FeatureExtractor.computeFeatures(landmarks, width, height);
+            assertEquals(FeatureExtractor.FEATURE_COUNT, features.length);
+            for (int f = 0; f < features.length; f++) {
+                assertEquals("row " + r + " feature " + f,
+                        row[2 + LANDMARK_VALUES + f], features[f], TOLERANCE);
+            }
+        }
+    }
+}
@@ -0,0 +1,76 @@
+package com.esw.postureanalyzer.vision;
+
+import org.junit.Test;
+
+import static org.junit.Assert.*;
+
+/**
+ * FrameStamp against stamps laid out as synthetic_source.cpp writes them.
+ */
+public class FrameStampTest {
+    private static void putStamp(byte[] frame, int offset, long sequence, long timestampNs) {
+        frame[offset] = 'S';
+        frame[offset + 1] = 'Y';
+        frame[offset + 2] = 'N';
+        frame[offset + 3] = 'F';
+        for (int i = 0; i < 4; i++) {
+            frame[offset + 4 + i] = (byte) (sequence >>> (8 * i));
+        }
+        for (int i = 0; i < 8; i++) {
+            frame[offset + 8 + i] = (byte) (timestampNs >>> (8 * i));
+        }
+    }
+
+    @Test
+    public void readsYuyvStamp() {
+        byte[] frame = new byte[64];
+        putStamp(frame, 0, 42, 123_456_789_012L);
+
+        FrameStamp stamp = FrameStamp.parse(frame, frame.length);
+        assertNotNull(stamp);
+        assertEquals(42, stamp.sequence);
+        assertEquals(123_456_789_012L, stamp.timestampNs);
+    }
+
+    @Test
+    public void readsMjpegCommentStamp() {
+        // SOI, then COM marker and length 18 (2 length bytes + 16 stamp bytes)
+        byte[] frame = new byte[64];
+        frame[0] = (byte) 0xFF;
+        frame[1] = (byte) 0xD8;
+        frame[2] = (byte) 0xFF;
+        frame[3] = (byte) 0xFE;
+        frame[4] = 0;
+        frame[5] = 18;
+        putStamp(frame, 6, 7, 5_000_000_000L);
+
+        FrameStamp stamp = FrameStamp.parse(frame, frame.length);
+        assertNotNull(stamp);
+        assertEquals(7, stamp.sequence);
+        assertEquals(5_000_000_000L, stamp.timestampNs);
+    }
+
+    @Test
+    public void sequenceIsUnsigned() {
+        byte[] frame = new byte[FrameStamp.SIZE];
+        putStamp(frame, 0, 0xFFFFFFFEL, 1);
+
+        assertEquals(0xFFFFFFFEL, FrameStamp.parse(frame, frame.length).sequence);
+    }
+
+    @Test
+    public void unstampedFrameReturnsNull() {
+        byte[] frame = new byte[64];
+        frame[0] = 'X';
+        assertNull(FrameStamp.parse(frame, frame.length));
+    }
+
+    @Test
+    public void shortFrameReturnsNull() {
+        byte[] frame = new byte[FrameStamp.SIZE];
+        putStamp(frame, 0, 1, 1);
+        assertNull(FrameStamp.parse(frame, FrameStamp.SIZE - 1));
+        assertNull(FrameStamp.parse(frame, FrameStamp.SIZE + 1));
+        assertNull(FrameStamp.parse(null, 0));
+    }
+}
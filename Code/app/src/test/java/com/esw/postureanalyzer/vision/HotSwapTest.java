@@ -0,0 +1,177 @@
+package com.esw.postureanalyzer.vision;
+
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Map;
+import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.concurrent.atomic.AtomicInteger;
+import java.util.concurrent.atomic.AtomicReference;
+
+import static org.junit.Assert.*;
+
+/**
+ * HotSwap leases, retirement of swapped-out versions and swap latency accounting.
+ */
+public class HotSwapTest {
+    /**
+     * Stand-in for an interpreter set: counts closes, fails if used after one
+     */
+    private static class Resource {
+        final int id;
+        final AtomicInteger closes = new AtomicInteger();
+
+        Resource(int id) {
+            this.id = id;
+        }
+
+        void use() {
+            assertEquals("used after close", 0, closes.get());
+        }
+    }
+
+    private static HotSwap<Resource> slot() {
+        return new HotSwap<>(r -> r.closes.incrementAndGet(), Runnable::run);
+    }
+
+    @Test
+    public void readerKeepsTheOldVersionUntilItsLeaseIsReturned() {
+        HotSwap<Resource> slot = slot();
+        Resource a = new Resource(1);
+        Resource b = new Resource(2);
+        slot.publish(a, 0);
+
+        HotSwap.Lease<Resource> inFlight = slot.acquire();
+        slot.publish(b, 0);
+        assertEquals(0, a.closes.get());
+        inFlight.get().use();
+
+        try (HotSwap.Lease<Resource> next = slot.acquire()) {
+            assertSame(b, next.get());
+        }
+        inFlight.close();
+        assertEquals(1, a.closes.get());
+        assertEquals(0, b.closes.get());
+    }
+
+    @Test
+    public void clearAndCloseRetireEverything() {
+        HotSwap<Resource> slot = slot();
+        Resource a = new Resource(1);
+        slot.publish(a, 0);
+        slot.clear();
+        assertNull(slot.acquire());
+        assertEquals(1, a.closes.get());
+
+        slot.close();
+        Resource late = new Resource(2);
+        slot.publish(late, 0); // A build that finished after close
+        assertNull(slot.acquire());
+        assertEquals(1, late.closes.get());
+    }
+
+    @Test
+    public void publishRacingCloseLeavesNothingPublished() throws Exception {
+        for (int round = 0; round < 200; round++) {
+            HotSwap<Resource> slot = slot();
+            List<Resource> published = new ArrayList<>();
+            Thread builder = new Thread(() -> {
+                for (int i = 0; i < 50; i++) {
+                    Resource next = new Resource(i);
+                    synchronized (published) {
+                        published.add(next);
+                    }
+                    slot.publish(next, 0);
+                }
+            });
+            builder.start();
+            slot.close();
+            builder.join();
+
+            assertNull("round " + round, slot.acquire());
+            for (Resource r : published) {
+                assertEquals("round " + round + " version " + r.id, 1, r.closes.get());
+            }
+        }
+    }
+
+    @Test
+    public void readersNeverSeeAClosedVersion() throws Exception {
+        HotSwap<Resource> slot = slot();
+        slot.publish(new Resource(0), 0);
+        List<Resource> published = new ArrayList<>();
+        AtomicBoolean stop = new AtomicBoolean();
+        AtomicReference<Throwable> failure = new AtomicReference<>();
+
+        Thread reader = new Thread(() -> {
+            try {
+                while (!stop.get()) {
+                    try (HotSwap.Lease<Resource> lease = slot.acquire()) {
+                        lease.get().use();
+                    }
+                }
+            } catch (Throwable t) {
+                failure.set(t);
+            }
+        });
+        reader.start();
+        for (int i = 1; i <= 2000; i++) {
+            Resource next = new Resource(i);
+            published.add(next);
+            slot.publish(next, 0);
+        }
+        stop.set(true);
+        reader.join();
+
+        assertNull(String.valueOf(failure.get()), failure.get());
+        for (Resource r : published.subList(0, published.size() - 1)) {
+            assertEquals("version " + r.id, 1, r.closes.get());
+        }
+        assertEquals(0, published.get(published.size() - 1).closes.get());
+    }
+
+    @Test
+    public void swapReportsItsWorstFrameAgainstTheBaseline() {
+        HotSwap<Resource> slot = slot();
+        slot.publish(new Resource(1), 0); // Initial build is not a swap
+        for (int i = 0; i < 40; i++) {
+            slot.recordFrame(10.0);
+        }
+        assertEquals(0, slot.getSwaps());
+
+        slot.beginSwap();
+        slot.recordFrame(12.0); // Still on the old version while building
+        slot.publish(new Resource(2), 250);
+        assertTrue(slot.isSwapping());
+        slot.recordFrame(40.0);
+        for (int i = 1; i < HotSwap.SETTLE_FRAMES; i++) {
+            slot.recordFrame(10.0);
+        }
+
+        assertFalse(slot.isSwapping());
+        assertEquals(1, slot.getSwaps());
+        assertEquals(40.0, slot.getLastSwapMaxFrameMs(), 1e-9);
+        assertEquals(10.0, slot.getLastBaselineMaxFrameMs(), 1e-9);
+
+        Map<String, Object> metrics = slot.getMetricsMap();
+        assertEquals(250L, metrics.get("lastBuildMs"));
+        assertEquals(40.0, metrics.get("maxSwapFrameMs"));
+    }
+
+    @Test
+    public void failedBuildKeepsTheCurrentVersion() {
+        HotSwap<Resource> slot = slot();
+        Resource a = new Resource(1);
+        slot.publish(a, 0);
+
+        slot.beginSwap();
+        slot.abortSwap();
+        try (HotSwap.Lease<Resource> lease = slot.acquire()) {
+            assertSame(a, lease.get());
+        }
+        assertFalse(slot.isSwapping());
+        assertEquals(0, slot.getSwaps());
+        assertEquals(1, slot.getMetricsMap().get("failedSwaps"));
+    }
+}
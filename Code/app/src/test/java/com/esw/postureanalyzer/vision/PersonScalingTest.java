@@ -0,0 +1,106 @@
+package com.esw.postureanalyzer.vision;
+
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.List;
+
+import static org.junit.Assert.*;
+
+/**
+ * Host-side multi-person path for 1..8 synthetic people: tracking,
+ * visibility gating, feature extraction and stacking each model's rows into
+ * one batch. Checks that IDs stay stable while everyone sways and that every
+ * person lands in every model's batch; timing belongs on device, where
+ * inference is part of the frame.
+ */
+public class PersonScalingTest {
+    private static final int MAX_PEOPLE = 8;
+    private static final int LANDMARKS = 33;
+    private static final int WIDTH = 1280;
+    private static final int HEIGHT = 720;
+    private static final int FRAMES = 500;
+    private static final int[] TORSO = {11, 12, 23, 24};
+
+    /**
+     * Upright pose centred on x; landmarks spread down the body so features stay finite
+     */
+    private static float[] pose(float x) {
+        float[] landmarks = new float[LANDMARKS * FeatureExtractor.LANDMARK_STRIDE];
+        for (int i = 0; i < LANDMARKS; i++) {
+            int offset = i * FeatureExtractor.LANDMARK_STRIDE;
+            landmarks[offset] = x + ((i % 2 == 0) ? 0.02f : -0.02f);
+            landmarks[offset + 1] = 0.1f + 0.8f * i / LANDMARKS;
+            landmarks[offset + 3] = 0.95f;
+        }
+        return landmarks;
+    }
+
+    private static float[] torsoCentroid(float[] landmarks) {
+        float sx = 0f;
+        float sy = 0f;
+        for (int index : TORSO) {
+            sx += landmarks[index * FeatureExtractor.LANDMARK_STRIDE];
+            sy += landmarks[index * FeatureExtractor.LANDMARK_STRIDE + 1];
+        }
+        return new float[]{sx / TORSO.length, sy / TORSO.length};
+    }
+
+    /**
+     * One frame of the host-side path; returns the track IDs
+     */
+    private static int[] frame(PersonTracker tracker, VisibilityGate gate, float[][] people, long nowMs) {
+        List<float[]> centroids = new ArrayList<>(people.length);
+        for (float[] person : people) {
+            centroids.add(torsoCentroid(person));
+        }
+        int[] ids = tracker.update(centroids, nowMs);
+
+        VisibilityGate.Model[] models = VisibilityGate.Model.values();
+        float[][][] batches = new float[models.length][][];
+        int[] rows = new int[models.length];
+        float[][] features = new float[people.length][];
+        for (VisibilityGate.Model model : models) {
+            batches[model.ordinal()] = new float[people.length][];
+        }
+        for (int p = 0; p < people.length; p++) {
+            for (VisibilityGate.Model model : models) {
+                if (!gate.allows(model, people[p])) {
+                    continue;
+                }
+                if (features[p] == null) {
+                    features[p] = FeatureExtractor.computeFeatures(people[p], WIDTH, HEIGHT);
+                }
+                batches[model.ordinal()][rows[model.ordinal()]++] = features[p];
+            }
+        }
+        for (VisibilityGate.Model model : models) {
+            assertEquals(people.length, rows[model.ordinal()]);
+        }
+        return ids;
+    }
+
+    @Test
+    public void idsAndBatchesStayStableForUpToEightPeople() {
+        for (int n = 1; n <= MAX_PEOPLE; n++) {
+            PersonTracker tracker = new PersonTracker();
+            VisibilityGate gate = new VisibilityGate();
+            float[][] people = new float[n][];
+            int[] firstIds = null;
+
+            for (int f = 0; f < FRAMES; f++) {
+                // People spread across the frame, each swaying a little
+                float sway = 0.005f * (float) Math.sin(f * 0.1);
+                for (int p = 0; p < n; p++) {
+                    people[p] = pose(0.1f + 0.8f * (p + 0.5f) / n + sway);
+                }
+                int[] ids = frame(tracker, gate, people, f * 33L);
+                if (firstIds == null) {
+                    firstIds = ids;
+                }
+                assertArrayEquals("IDs changed with " + n + " people", firstIds, ids);
+            }
+            assertEquals(n, tracker.getTrackCount());
+        }
+    }
+}
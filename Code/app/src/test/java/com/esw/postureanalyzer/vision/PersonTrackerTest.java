@@ -0,0 +1,87 @@
+package com.esw.postureanalyzer.vision;
+
+import org.junit.Test;
+
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.List;
+
+import static org.junit.Assert.*;
+
+/**
+ * PersonTracker ID assignment, swaps in detection order and expiry.
+ */
+public class PersonTrackerTest {
+    private static List<float[]> poses(float[]... centroids) {
+        return Arrays.asList(centroids);
+    }
+
+    @Test
+    public void keepsIdsWhenDetectionOrderSwaps() {
+        PersonTracker tracker = new PersonTracker();
+        int[] first = tracker.update(poses(new float[]{0.25f, 0.5f}, new float[]{0.75f, 0.5f}), 0);
+        assertArrayEquals(new int[]{1, 2}, first);
+
+        // Same people, slightly moved, reported in the opposite order
+        int[] second = tracker.update(poses(new float[]{0.77f, 0.52f}, new float[]{0.24f, 0.49f}), 33);
+        assertArrayEquals(new int[]{2, 1}, second);
+        assertEquals(2, tracker.getTrackCount());
+    }
+
+    @Test
+    public void closestPairWinsWhenPeopleAreNear() {
+        PersonTracker tracker = new PersonTracker();
+        tracker.update(poses(new float[]{0.40f, 0.5f}, new float[]{0.55f, 0.5f}), 0);
+
+        // Person 1 stepped right; greedy closest-first must not steal person 2's track
+        int[] ids = tracker.update(poses(new float[]{0.56f, 0.5f}, new float[]{0.45f, 0.5f}), 33);
+        assertArrayEquals(new int[]{2, 1}, ids);
+    }
+
+    @Test
+    public void farPoseStartsNewTrack() {
+        PersonTracker tracker = new PersonTracker();
+        tracker.update(poses(new float[]{0.2f, 0.5f}), 0);
+        int[] ids = tracker.update(poses(new float[]{0.8f, 0.5f}), 33);
+        assertArrayEquals(new int[]{2}, ids);
+        assertEquals(2, tracker.getTrackCount());
+    }
+
+    @Test
+    public void expiresUnseenTracks() {
+        PersonTracker tracker = new PersonTracker(0.2f, 1000);
+        tracker.update(poses(new float[]{0.2f, 0.5f}, new float[]{0.8f, 0.5f}), 0);
+        tracker.update(poses(new float[]{0.2f, 0.5f}), 900);
+        assertTrue(tracker.drainExpired().isEmpty());
+
+        tracker.update(poses(new float[]{0.2f, 0.5f}), 1500);
+        assertEquals(Collections.singletonList(2), tracker.drainExpired());
+        assertTrue(tracker.drainExpired().isEmpty());
+        assertEquals(1, tracker.getTrackCount());
+
+        // A returning person after expiry gets a fresh ID
+        int[] ids = tracker.update(poses(new float[]{0.2f, 0.5f}, new float[]{0.8f, 0.5f}), 1600);
+        assertArrayEquals(new int[]{1, 3}, ids);
+    }
+
+    @Test
+    public void emptyFrameKeepsTracksUntilTimeout() {
+        PersonTracker tracker = new PersonTracker(0.2f, 1000);
+        tracker.update(poses(new float[]{0.5f, 0.5f}), 0);
+        assertEquals(0, tracker.update(Collections.emptyList(), 500).length);
+        assertArrayEquals(new int[]{1}, tracker.update(poses(new float[]{0.5f, 0.5f}), 800));
+    }
+
+    @Test
+    public void resetExpiresLiveTracksWithoutReusingIds() {
+        PersonTracker tracker = new PersonTracker(0.2f, 1000);
+        tracker.update(poses(new float[]{0.2f, 0.5f}, new float[]{0.8f, 0.5f}), 0);
+        tracker.update(poses(new float[]{0.2f, 0.5f}), 1500); // Person 2 expires, not drained yet
+
+        tracker.reset();
+        assertEquals(0, tracker.getTrackCount());
+        assertEquals(Arrays.asList(2, 1), tracker.drainExpired());
+
+        assertArrayEquals(new int[]{3}, tracker.update(poses(new float[]{0.2f, 0.5f}), 1600));
+    }
+}
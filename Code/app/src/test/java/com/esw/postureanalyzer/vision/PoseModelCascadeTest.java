@@ -0,0 +1,246 @@
+package com.esw.postureanalyzer.vision;
+
+import com.google.mediapipe.tasks.components.containers.NormalizedLandmark;
+
+import org.junit.Test;
+
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.EnumMap;
+import java.util.EnumSet;
+import java.util.List;
+import java.util.Map;
+import java.util.Optional;
+
+import static org.junit.Assert.*;
+
+/**
+ * PoseModelCascade against simulated conditions, one pose result every 100 ms.
+ */
+public class PoseModelCascadeTest {
+    private static final long FRAME_MS = 100;
+    private static final double BUDGET_MS = 66.0;
+
+    private static final List<PoseModelCascade.Level> LITE_ONLY =
+            Arrays.asList(PoseModelCascade.Level.LITE_LOW, PoseModelCascade.Level.LITE);
+
+    /**
+     * Quality and latency each level produces under the simulated conditions
+     */
+    private static class World {
+        final Map<PoseModelCascade.Level, Double> quality = new EnumMap<>(PoseModelCascade.Level.class);
+        final Map<PoseModelCascade.Level, Double> latencyMs = new EnumMap<>(PoseModelCascade.Level.class);
+
+        World set(PoseModelCascade.Level level, double q, double latency) {
+            quality.put(level, q);
+            latencyMs.put(level, latency);
+            return this;
+        }
+    }
+
+    /**
+     * Seated pose with the given torso and leg (knees down) visibility; arms stay visible
+     */
+    private static List<NormalizedLandmark> seated(float torso, float legs) {
+        List<NormalizedLandmark> pose = new ArrayList<>();
+        for (int i = 0; i < 33; i++) {
+            float visibility = i >= 25 ? legs : (i == 11 || i == 12 || i == 23 || i == 24) ? torso : 0.95f;
+            // Spread down the body so joint pair distances stay plausible
+            pose.add(NormalizedLandmark.create(0.5f + ((i % 2 == 0) ? 0.05f : -0.05f), 0.1f + 0.025f * i, 0f,
+                    Optional.of(visibility), Optional.of(visibility)));
+        }
+        return pose;
+    }
+
+    private final List<PoseModelCascade.Switch> switches = new ArrayList<>();
+    private final List<Long> switchTimes = new ArrayList<>();
+    private final Map<PoseModelCascade.Level, Long> timeAt = new EnumMap<>(PoseModelCascade.Level.class);
+    private long now = 0;
+
+    private PoseModelCascade cascade(List<PoseModelCascade.Level> levels) {
+        PoseModelCascade cascade = new PoseModelCascade(levels);
+        cascade.setLatencyBudgetMs(BUDGET_MS);
+        cascade.setLevelListener(change -> {
+            switches.add(change);
+            switchTimes.add(now);
+        });
+        return cascade;
+    }
+
+    /**
+     * Run until untilMs; returns the level in effect at the end
+     */
+    private PoseModelCascade.Level run(PoseModelCascade cascade, World world, long untilMs) {
+        for (; now < untilMs; now += FRAME_MS) {
+            PoseModelCascade.Level level = cascade.getLevel();
+            Long spent = timeAt.get(level);
+            timeAt.put(level, (spent == null ? 0 : spent) + FRAME_MS);
+            cascade.record(world.quality.get(level), world.latencyMs.get(level), now);
+        }
+        return cascade.getLevel();
+    }
+
+    private double shareAt(PoseModelCascade.Level level) {
+        Long spent = timeAt.get(level);
+        return spent == null ? 0.0 : spent / (double) now;
+    }
+
+    @Test
+    public void startsAtLiteAndHoldsInTheDeadBand() {
+        PoseModelCascade cascade = cascade(Arrays.asList(PoseModelCascade.Level.values()));
+        assertEquals(PoseModelCascade.Level.LITE, cascade.getLevel());
+
+        World world = new World();
+        for (PoseModelCascade.Level level : PoseModelCascade.Level.values()) {
+            world.set(level, 70, 30);
+        }
+        assertEquals(PoseModelCascade.Level.LITE, run(cascade, world, 10 * 60_000));
+        assertTrue(switches.isEmpty());
+        assertTrue(cascade.isConverged());
+    }
+
+    @Test
+    public void lowQualityStepsUpAfterTheDwell() {
+        PoseModelCascade cascade = cascade(Arrays.asList(PoseModelCascade.Level.values()));
+        World world = new World()
+                .set(PoseModelCascade.Level.LITE, 40, 20)
+                .set(PoseModelCascade.Level.FULL, 75, 35);
+
+        assertEquals(PoseModelCascade.Level.LITE, run(cascade, world, PoseModelCascade.MIN_DWELL_MS));
+        assertEquals(PoseModelCascade.Level.FULL, run(cascade, world, 5 * 60_000));
+        assertEquals(1, switches.size());
+        assertEquals(PoseModelCascade.Reason.LOW_QUALITY, switches.get(0).reason);
+        assertEquals(PoseModelCascade.MIN_DWELL_MS, (long) switchTimes.get(0));
+    }
+
+    @Test
+    public void highQualityStepsDown() {
+        PoseModelCascade cascade = cascade(LITE_ONLY);
+        World world = new World()
+                .set(PoseModelCascade.Level.LITE, 95, 30)
+                .set(PoseModelCascade.Level.LITE_LOW, 90, 15);
+
+        assertEquals(PoseModelCascade.Level.LITE_LOW, run(cascade, world, 5 * 60_000));
+        assertEquals(PoseModelCascade.Reason.HIGH_QUALITY, switches.get(0).reason);
+        assertEquals(1, switches.size());
+    }
+
+    @Test
+    public void heavierLevelOverBudgetIsLockedOut() {
+        PoseModelCascade cascade = cascade(Arrays.asList(PoseModelCascade.Level.values()));
+        World world = new World()
+                .set(PoseModelCascade.Level.LITE, 40, 20)
+                .set(PoseModelCascade.Level.FULL, 75, 120);
+
+        run(cascade, world, 10_000 + FRAME_MS);
+        assertEquals(2, switches.size());
+        assertEquals(PoseModelCascade.Reason.LATENCY, switches.get(1).reason);
+        assertEquals(PoseModelCascade.Level.LITE, cascade.getLevel());
+
+        // FULL is retried only once the lock has run out
+        long lockEnd = 10_000 + PoseModelCascade.INITIAL_BACKOFF_MS;
+        assertEquals(PoseModelCascade.Level.LITE, run(cascade, world, lockEnd));
+        assertEquals(PoseModelCascade.Level.FULL, run(cascade, world, lockEnd + FRAME_MS));
+    }
+
+    @Test
+    public void failedCheaperProbesBackOff() {
+        PoseModelCascade cascade = cascade(LITE_ONLY);
+        World world = new World()
+                .set(PoseModelCascade.Level.LITE, 95, 30)
+                .set(PoseModelCascade.Level.LITE_LOW, 45, 15);
+
+        run(cascade, world, 10 * 60_000);
+
+        List<Long> probes = new ArrayList<>();
+        for (int i = 0; i < switches.size(); i++) {
+            if (switches.get(i).to == PoseModelCascade.Level.LITE_LOW) {
+                probes.add(switchTimes.get(i));
+            }
+        }
+        assertTrue("probes: " + probes, probes.size() >= 3);
+        for (int i = 2; i < probes.size(); i++) {
+            assertTrue("gaps should grow: " + probes, probes.get(i) - probes.get(i - 1) > probes.get(i - 1) - probes.get(i - 2));
+        }
+        assertTrue(shareAt(PoseModelCascade.Level.LITE) > 0.9);
+    }
+
+    @Test
+    public void overBudgetEverywhereSettlesOnTheCheapestLevel() {
+        // Lite-only install with poor landmarks: LITE would be wanted for
+        // quality but misses the budget
+        PoseModelCascade cascade = cascade(LITE_ONLY);
+        World world = new World()
+                .set(PoseModelCascade.Level.LITE, 45, 90)
+                .set(PoseModelCascade.Level.LITE_LOW, 40, 30);
+
+        assertEquals(PoseModelCascade.Level.LITE_LOW, run(cascade, world, 10 * 60_000));
+        assertTrue("switches: " + switches.size(), switches.size() <= 12);
+        assertTrue(shareAt(PoseModelCascade.Level.LITE_LOW) > 0.9);
+    }
+
+    @Test
+    public void emptyFramesOnlyCountLatency() {
+        PoseModelCascade cascade = cascade(LITE_ONLY);
+        World world = new World()
+                .set(PoseModelCascade.Level.LITE, Double.NaN, 30)
+                .set(PoseModelCascade.Level.LITE_LOW, Double.NaN, 15);
+
+        assertEquals(PoseModelCascade.Level.LITE, run(cascade, world, 5 * 60_000));
+        assertTrue(Double.isNaN(PoseModelCascade.qualityScore(Collections.emptyList())));
+    }
+
+    @Test
+    public void legsUnderTheDeskDoNotLowerQuality() {
+        double visible = PoseModelCascade.qualityScore(Collections.singletonList(seated(0.95f, 0.95f)));
+        double underDesk = PoseModelCascade.qualityScore(Collections.singletonList(seated(0.95f, 0.1f)));
+        assertEquals(visible, underDesk, 0.01);
+        assertTrue(underDesk > PoseModelCascade.HIGH_QUALITY);
+
+        // A poorly seen torso still counts against the level
+        double poorTorso = PoseModelCascade.qualityScore(Collections.singletonList(seated(0.1f, 0.1f)));
+        assertTrue(poorTorso < PoseModelCascade.LOW_QUALITY);
+    }
+
+    @Test
+    public void levelsFollowInstalledModels() {
+        List<PoseModelCascade.Level> liteOnly = PoseModelCascade.availableLevels(
+                Arrays.asList("pose_landmarker_lite.task", "posture_model.tflite"));
+        assertEquals(LITE_ONLY, liteOnly);
+
+        List<PoseModelCascade.Level> withFull = PoseModelCascade.availableLevels(
+                Arrays.asList("pose_landmarker_lite.task", "pose_landmarker_full.task"));
+        assertTrue(withFull.contains(PoseModelCascade.Level.FULL));
+        assertFalse(withFull.contains(PoseModelCascade.Level.HEAVY));
+
+        try {
+            new PoseModelCascade(EnumSet.of(PoseModelCascade.Level.FULL));
+            fail("LITE is required");
+        } catch (IllegalArgumentException expected) {
+            // expected
+        }
+    }
+
+    @Test
+    public void metricsReportTheOperatingPoint() {
+        PoseModelCascade cascade = cascade(LITE_ONLY);
+        World world = new World()
+                .set(PoseModelCascade.Level.LITE, 95, 30)
+                .set(PoseModelCascade.Level.LITE_LOW, 88, 12);
+        run(cascade, world, 3 * 60_000);
+
+        Map<String, Object> metrics = cascade.getMetricsMap();
+        assertEquals("LITE_LOW", metrics.get("level"));
+        assertEquals("640x480", metrics.get("inputResolution"));
+        assertEquals(88.0, (Double) metrics.get("quality"), 0.1);
+        assertEquals(12.0, (Double) metrics.get("latencyMs"), 0.1);
+        assertEquals(Boolean.TRUE, metrics.get("converged"));
+        assertEquals(1, metrics.get("switches"));
+
+        @SuppressWarnings("unchecked")
+        Map<String, Object> levels = (Map<String, Object>) metrics.get("levels");
+        assertTrue(levels.containsKey("LITE"));
+        assertTrue(levels.containsKey("LITE_LOW"));
+    }
+}
@@ -0,0 +1,127 @@
+package com.esw.postureanalyzer.vision;
+
+import org.junit.Test;
+
+import java.util.Calendar;
+import java.util.HashMap;
+import java.util.Map;
+
+import static org.junit.Assert.*;
+
+/**
+ * PostureAggregate folding, merging and its daily_aggregates map form.
+ */
+public class PostureAggregateTest {
+    private static Map<String, Object> record(byte state, Double pdj, Long inferenceTimeMs) {
+        Map<String, Object> record = new HashMap<>();
+        record.put("state", (long) PostureState.index(state));
+        if (pdj != null) {
+            Map<String, Object> metrics = new HashMap<>();
+            metrics.put("pdj", pdj);
+            record.put("metrics", metrics);
+        }
+        if (inferenceTimeMs != null) {
+            record.put("inferenceTimeMs", inferenceTimeMs);
+        }
+        return record;
+    }
+
+    private static final byte GOOD = PostureState.encode(
+            PostureState.SLOUCH_GOOD, PostureState.LEGS_NORMAL, PostureState.LEAN_UPRIGHT);
+    private static final byte SLOUCH_CROSSED = PostureState.encode(
+            PostureState.SLOUCH_SLOUCHING, PostureState.LEGS_CROSSED, PostureState.LEAN_LEFT);
+
+    @Test
+    public void foldsRecordsIntoStatistics() {
+        PostureAggregate day = new PostureAggregate("2026-10-16");
+        day.addRecord(record(GOOD, 0.8, 20L));
+        day.addRecord(record(GOOD, 0.6, null));
+        day.addRecord(record(SLOUCH_CROSSED, null, 40L));
+        day.addRecord(new HashMap<>()); // No state: counted as absent
+
+        FirebaseDataRetriever.PostureStatistics stats = day.toStatistics();
+        assertEquals(4, stats.totalEntries);
+        assertEquals(2, stats.goodPostureCount);
+        assertEquals(1, stats.slouchingCount);
+        assertEquals(1, stats.crossLeggedCount);
+        assertEquals(1, stats.leanLeftCount);
+        assertEquals(2, stats.uprightCount);
+        assertEquals(0.7, stats.avgPdj, 1e-9);
+        assertEquals(30.0, stats.avgInferenceTime, 1e-9);
+        // The absent record has no slouch result, so it is not a sample
+        assertEquals(2 * 100.0 / 3, stats.getGoodPosturePercentage(), 1e-9);
+    }
+
+    @Test
+    public void unknownFieldsAreLeftOutOfPercentages() {
+        // Legs under the desk: slouch and lean known, legs gated off
+        byte legsUnknown = PostureState.encode(
+                PostureState.SLOUCH_GOOD, PostureState.UNKNOWN, PostureState.LEAN_UPRIGHT);
+        byte slouchOnly = PostureState.encode(
+                PostureState.SLOUCH_SLOUCHING, PostureState.UNKNOWN, PostureState.UNKNOWN);
+
+        PostureAggregate day = new PostureAggregate("2026-10-17");
+        for (int i = 0; i < 6; i++) {
+            day.addRecord(record(legsUnknown, null, null));
+        }
+        day.addRecord(record(slouchOnly, null, null));
+        day.addRecord(record(SLOUCH_CROSSED, null, null));
+        day.addRecord(record(GOOD, null, null));
+
+        FirebaseDataRetriever.PostureStatistics stats = day.toStatistics();
+        assertEquals(9, stats.totalEntries);
+        assertEquals(9, stats.getSlouchSamples());
+        assertEquals(2, stats.getLegsSamples());
+        assertEquals(7 * 100.0 / 9, stats.getGoodPosturePercentage(), 1e-9);
+        // One of the two entries that saw the legs, not one of nine
+        assertEquals(50.0, stats.getCrossLeggedPercentage(), 1e-9);
+    }
+
+    @Test
+    public void mergeMatchesSingleAggregate() {
+        PostureAggregate monday = new PostureAggregate("2026-10-12");
+        monday.addRecord(record(GOOD, 0.9, 10L));
+        PostureAggregate tuesday = new PostureAggregate("2026-10-13");
+        tuesday.addRecord(record(SLOUCH_CROSSED, 0.5, 30L));
+
+        PostureAggregate both = new PostureAggregate(null);
+        both.addRecord(record(GOOD, 0.9, 10L));
+        both.addRecord(record(SLOUCH_CROSSED, 0.5, 30L));
+
+        PostureAggregate merged = new PostureAggregate(null);
+        merged.merge(monday);
+        merged.merge(tuesday);
+
+        assertArrayEquals(both.stateHistogram, merged.stateHistogram);
+        assertEquals(both.toStatistics().toString(), merged.toStatistics().toString());
+    }
+
+    @Test
+    public void mapRoundTripSurvivesFirebaseLongs() {
+        PostureAggregate day = new PostureAggregate("2026-10-16");
+        day.addRecord(record(GOOD, 1.0, 25L));
+        day.addRecord(record(SLOUCH_CROSSED, 0.5, 35L));
+
+        // Firebase hands whole numbers back as Long
+        Map<String, Object> stored = day.toMap();
+        stored.put("pdjSum", 2L);
+        stored.put("pdjCount", 2L);
+
+        PostureAggregate restored = PostureAggregate.fromMap("2026-10-16", stored);
+        assertEquals("2026-10-16", restored.date);
+        assertArrayEquals(day.stateHistogram, restored.stateHistogram);
+        assertEquals(2, restored.totalEntries);
+        assertEquals(1.0, restored.toStatistics().avgPdj, 1e-9);
+        assertEquals(30.0, restored.toStatistics().avgInferenceTime, 1e-9);
+    }
+
+    @Test
+    public void dayKeyIsTheLocalDate() {
+        Calendar cal = Calendar.getInstance();
+        cal.clear();
+        cal.set(2026, Calendar.MARCH, 5, 23, 59, 59);
+        assertEquals("2026-03-05", PostureAggregate.dayKey(cal.getTimeInMillis()));
+        cal.add(Calendar.SECOND, 1);
+        assertEquals("2026-03-06", PostureAggregate.dayKey(cal.getTimeInMillis()));
+    }
+}
@@ -0,0 +1,92 @@
+package com.esw.postureanalyzer.vision;
+
+import org.junit.Test;
+
+import java.util.Map;
+
+import static org.junit.Assert.*;
+
+/**
+ * ShadowEvaluator sampling, CPU budget and agreement summary.
+ */
+public class ShadowEvaluatorTest {
+    private static final long FRAME_NS = 33_000_000L;
+
+    @Test
+    public void samplesTheConfiguredShareOfFrames() {
+        ShadowEvaluator shadow = new ShadowEvaluator(0.25, 1.0);
+        int admitted = 0;
+        for (int i = 0; i < 400; i++) {
+            if (shadow.admit(i * FRAME_NS)) {
+                admitted++;
+                shadow.complete(1_000_000L);
+            }
+        }
+        assertEquals(100, admitted);
+        assertEquals(100, shadow.getRuns());
+        assertEquals(0, shadow.getSkippedBudget());
+    }
+
+    @Test
+    public void sampleIsDroppedWhileARunIsInFlight() {
+        ShadowEvaluator shadow = new ShadowEvaluator(1.0, 1.0);
+        assertTrue(shadow.admit(0));
+        assertFalse(shadow.admit(FRAME_NS));
+        assertFalse(shadow.admit(2 * FRAME_NS));
+        assertEquals(2, shadow.getSkippedBusy());
+
+        shadow.abandon(0);
+        assertTrue(shadow.admit(3 * FRAME_NS));
+    }
+
+    @Test
+    public void cpuUseStaysWithinTheBudget() {
+        // A candidate costing 5 ms of CPU per frame at 30 fps wants 15% of a core
+        ShadowEvaluator shadow = new ShadowEvaluator(1.0, 0.05);
+        long frames = 60_000_000_000L / FRAME_NS;
+        for (long i = 0; i < frames; i++) {
+            if (shadow.admit(i * FRAME_NS)) {
+                shadow.complete(5_000_000L);
+            }
+        }
+        assertTrue("skipped " + shadow.getSkippedBudget(), shadow.getSkippedBudget() > frames / 2);
+        // Budget plus the initial burst spread over the minute
+        double share = shadow.getCpuShare();
+        assertTrue("share " + share, share > 0.045 && share < 0.056);
+    }
+
+    @Test
+    public void confusionMatrixAndLatencyPerModel() {
+        ShadowEvaluator shadow = new ShadowEvaluator();
+        int good = PostureState.SLOUCH_GOOD;
+        int slouching = PostureState.SLOUCH_SLOUCHING;
+        shadow.recordModel(VisibilityGate.Model.SLOUCH,
+                new int[]{good, good, slouching, slouching},
+                new int[]{good, slouching, slouching, slouching}, 400, 800);
+
+        assertEquals(0.75, shadow.getAgreement(VisibilityGate.Model.SLOUCH), 1e-9);
+        assertEquals(1, shadow.getCount(VisibilityGate.Model.SLOUCH, good, slouching));
+        assertEquals(2, shadow.getCount(VisibilityGate.Model.SLOUCH, slouching, slouching));
+        assertTrue(Double.isNaN(shadow.getAgreement(VisibilityGate.Model.LEGS)));
+
+        Map<String, Object> metrics = shadow.getMetricsMap();
+        assertFalse(metrics.containsKey("legs"));
+        @SuppressWarnings("unchecked")
+        Map<String, Object> slouch = (Map<String, Object>) metrics.get("slouch");
+        assertEquals(0.75, (Double) slouch.get("agreement"), 1e-9);
+        assertEquals(100.0, (Double) slouch.get("productionUsPerRow"), 1e-9);
+        assertEquals(200.0, (Double) slouch.get("candidateUsPerRow"), 1e-9);
+
+        @SuppressWarnings("unchecked")
+        Map<String, Map<String, Object>> confusion = (Map<String, Map<String, Object>>) slouch.get("confusion");
+        assertEquals(1L, confusion.get("good").get("good"));
+        assertEquals(1L, confusion.get("good").get("slouching"));
+        assertEquals(2L, confusion.get("slouching").get("slouching"));
+        assertNull(confusion.get("unknown"));
+    }
+
+    @Test(expected = IllegalArgumentException.class)
+    public void rejectsSampleFractionAboveOne() {
+        new ShadowEvaluator(1.5, 0.05);
+    }
+}
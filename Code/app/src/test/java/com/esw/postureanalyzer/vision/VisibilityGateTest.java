@@ -0,0 +1,117 @@
+package com.esw.postureanalyzer.vision;
+
+import org.junit.Before;
+import org.junit.Test;
+
+import java.util.Arrays;
+import java.util.Map;
+
+import static org.junit.Assert.*;
+
+/**
+ * VisibilityGate on flat landmark arrays and its skip accounting.
+ */
+public class VisibilityGateTest {
+    private static final int LANDMARKS = 33;
+
+    private VisibilityGate gate;
+
+    @Before
+    public void setUp() {
+        gate = new VisibilityGate();
+    }
+
+    /**
+     * Landmark array with every visibility set to the given value
+     */
+    private static float[] pose(float visibility) {
+        float[] landmarks = new float[LANDMARKS * FeatureExtractor.LANDMARK_STRIDE];
+        for (int i = 0; i < LANDMARKS; i++) {
+            landmarks[i * FeatureExtractor.LANDMARK_STRIDE] = 0.5f;
+            landmarks[i * FeatureExtractor.LANDMARK_STRIDE + 1] = 0.5f;
+            landmarks[i * FeatureExtractor.LANDMARK_STRIDE + 3] = visibility;
+        }
+        return landmarks;
+    }
+
+    private static void setVisibility(float[] landmarks, float visibility, int... indices) {
+        for (int index : indices) {
+            landmarks[index * FeatureExtractor.LANDMARK_STRIDE + 3] = visibility;
+        }
+    }
+
+    @Test
+    public void fullyVisiblePoseRunsEveryModel() {
+        float[] landmarks = pose(0.95f);
+        for (VisibilityGate.Model model : VisibilityGate.Model.values()) {
+            assertTrue(model.name(), gate.allows(model, landmarks));
+        }
+    }
+
+    @Test
+    public void legsUnderTheDeskOnlyGateTheLegsModel() {
+        float[] landmarks = pose(0.95f);
+        setVisibility(landmarks, 0.05f, 25, 26, 27, 28); // knees and ankles
+        assertTrue(gate.allows(VisibilityGate.Model.SLOUCH, landmarks));
+        assertTrue(gate.allows(VisibilityGate.Model.LEAN, landmarks));
+        assertFalse(gate.allows(VisibilityGate.Model.LEGS, landmarks));
+    }
+
+    @Test
+    public void oneHiddenAnkleIsEnoughToGate() {
+        float[] landmarks = pose(0.9f);
+        setVisibility(landmarks, VisibilityGate.MIN_VISIBILITY - 0.01f, 27);
+        assertFalse(gate.allows(VisibilityGate.Model.LEGS, landmarks));
+
+        setVisibility(landmarks, VisibilityGate.MIN_VISIBILITY, 27);
+        assertTrue(gate.allows(VisibilityGate.Model.LEGS, landmarks));
+    }
+
+    @Test
+    public void hiddenHipsGateEverything() {
+        float[] landmarks = pose(0.9f);
+        setVisibility(landmarks, 0.1f, 23, 24);
+        for (VisibilityGate.Model model : VisibilityGate.Model.values()) {
+            assertFalse(model.name(), gate.allows(model, landmarks));
+        }
+    }
+
+    @Test
+    public void truncatedPoseIsGated() {
+        float[] landmarks = Arrays.copyOf(pose(0.9f), 20 * FeatureExtractor.LANDMARK_STRIDE);
+        assertFalse(gate.allows(VisibilityGate.Model.LEGS, landmarks));
+    }
+
+    @Test
+    public void disabledGateAllowsEverything() {
+        gate.setEnabled(false);
+        float[] landmarks = pose(0f);
+        for (VisibilityGate.Model model : VisibilityGate.Model.values()) {
+            assertTrue(model.name(), gate.allows(model, landmarks));
+        }
+    }
+
+    @Test
+    public void skippedRowsAreCostedAtTheMeasuredRate() {
+        // Legs run 1 of 4 frames at 200 us per pose, skipped on the rest
+        gate.recordRun(VisibilityGate.Model.LEGS, 1, 200);
+        gate.recordSkipped(VisibilityGate.Model.LEGS, 3);
+        gate.recordRun(VisibilityGate.Model.SLOUCH, 4, 400);
+
+        assertEquals(3, gate.getSkipped(VisibilityGate.Model.LEGS));
+        assertEquals(0.75, gate.getSkipRatio(VisibilityGate.Model.LEGS), 1e-9);
+        assertEquals(0.6, gate.getSavedInferenceMs(VisibilityGate.Model.LEGS), 1e-9);
+        assertEquals(0.0, gate.getSkipRatio(VisibilityGate.Model.SLOUCH), 1e-9);
+        assertEquals(0.6, gate.getSavedInferenceMs(), 1e-9);
+
+        Map<String, Object> metrics = gate.getMetricsMap();
+        @SuppressWarnings("unchecked")
+        Map<String, Object> legs = (Map<String, Object>) metrics.get("legs");
+        assertEquals(3L, legs.get("skipped"));
+        assertEquals(1L, legs.get("evaluated"));
+
+        gate.reset();
+        assertEquals(0, gate.getSkipped(VisibilityGate.Model.LEGS));
+        assertEquals(0.0, gate.getSavedInferenceMs(), 1e-9);
+    }
+}
@@ -2,33 +2,26 @@
 """
 Performance Data Collection Script for Posture Analyzer
 Fetches data from Firebase and generates comparison tables
+
+Usage:
+    python collect_performance_data.py [guide|fetch] [device_name] [--offline firebase_export.json]
 """
 
-import json
+import argparse
 import time
 from datetime import datetime
 
-# Firebase REST API endpoint
-FIREBASE_URL = "https://postureanalyzer-b24a3-default-rtdb.asia-southeast1.firebasedatabase.app"
+from firebase_data import add_data_arguments, store_from_args
 
-def fetch_firebase_data():
-    """Fetch latest performance data from Firebase"""
-    try:
-        import urllib.request
-        
-        # Fetch all performance data
-        url = f"{FIREBASE_URL}/performance_data.json"
-        with urllib.request.urlopen(url) as response:
-            data = json.loads(response.read().decode())
-        
-        # Handle nested structure - data might be under "performance_data" key
-        if data and "performance_data" in data:
-            return data["performance_data"]
-        
-        return data
-    except Exception as e:
-        print(f"Error fetching data: {e}")
-        return None
+def fetch_firebase_data(store):
+    """Fetch latest performance data: {processor: {device: {timestamp: session}}}"""
+    data = store.load("performance_data", depth=2)
+    
+    # Handle nested structure - data might be under "performance_data" key
+    if "performance_data" in data:
+        return store.load("performance_data/performance_data", depth=2)
+    
+    return data
 
 def get_latest_session_by_processor(data, target_device=None):
     """Extract latest session data for each processor (highest totalInferences)"""
@@ -183,9 +176,15 @@ def countdown_timer(minutes, label):
     print(f"\r{label}: COMPLETE! ✓" + " "*20)
 
 def main():
-    import sys
+    parser = argparse.ArgumentParser(description="Collect and compare per-delegate performance data")
+    parser.add_argument("mode", nargs="?", choices=["guide", "fetch"], default="fetch",
+                        help="guide: timed 3-minute test before fetching (default: fetch)")
+    parser.add_argument("device", nargs="?", default=None,
+                        help="Device model to report (default: any device)")
+    add_data_arguments(parser)
+    args = parser.parse_args()
     
-    if len(sys.argv) > 1 and sys.argv[1] == "guide":
+    if args.mode == "guide":
         # Show guided test mode
         print_instructions()
         
@@ -218,7 +217,7 @@ def main():
     
     # Fetch and display results
     print("Fetching data from Firebase...")
-    data = fetch_firebase_data()
+    data = fetch_firebase_data(store_from_args(args))
     
     if not data:
         print("❌ No data found in Firebase")
@@ -229,9 +228,7 @@ def main():
         return
     
     # Check for device argument
-    target_device = None
-    if len(sys.argv) > 2 and sys.argv[2]:
-        target_device = sys.argv[2]
+    target_device = args.device
     
     # Extract latest sessions
     sessions = get_latest_session_by_processor(data, target_device)
@@ -3,30 +3,25 @@
 Device Performance Comparison Script
 Compares performance metrics across different devices and delegates
 Uses last 100 recordings from each device/delegate combination
+
+Usage:
+    python compare_performance.py [sample_size] [--offline firebase_export.json] [--no-refresh]
 """
 
-import json
-import urllib.request
+import argparse
 from collections import defaultdict
 
-# Firebase REST API endpoint
-FIREBASE_URL = "https://postureanalyzer-b24a3-default-rtdb.asia-southeast1.firebasedatabase.app"
+from firebase_data import add_data_arguments, store_from_args
 
-def fetch_firebase_data():
-    """Fetch all performance data from Firebase"""
-    try:
-        url = f"{FIREBASE_URL}/performance_data.json"
-        with urllib.request.urlopen(url) as response:
-            data = json.loads(response.read().decode())
-        
-        # Handle nested structure
-        if data and "performance_data" in data:
-            return data["performance_data"]
-        
-        return data
-    except Exception as e:
-        print(f"Error fetching data: {e}")
-        return None
+def fetch_firebase_data(store, limit=None):
+    """Fetch performance data: {processor: {device: {timestamp: session}}}"""
+    data = store.load("performance_data", depth=2, limit=limit)
+    
+    # Handle nested structure
+    if "performance_data" in data:
+        return store.load("performance_data/performance_data", depth=2, limit=limit)
+    
+    return data
 
 def get_last_n_sessions(data, n=100):
     """
@@ -238,18 +233,16 @@ def save_to_csv(device_data, filename="device_comparison.csv", sample_size=100):
     print(f"\n✓ Data saved to {filename}")
 
 def main():
-    import sys
-    
     # Parse arguments
-    sample_size = 100
-    if len(sys.argv) > 1:
-        try:
-            sample_size = int(sys.argv[1])
-        except ValueError:
-            print(f"Invalid sample size: {sys.argv[1]}, using default 100")
+    parser = argparse.ArgumentParser(description="Compare performance across devices and delegates")
+    parser.add_argument("sample_size", type=int, nargs="?", default=100,
+                        help="Recordings per device/delegate (default: 100)")
+    add_data_arguments(parser)
+    args = parser.parse_args()
+    sample_size = args.sample_size
     
     print(f"Fetching data from Firebase (last {sample_size} recordings per device/delegate)...")
-    data = fetch_firebase_data()
+    data = fetch_firebase_data(store_from_args(args), sample_size)
     
     if not data:
         print("❌ No data found in Firebase")
@@ -0,0 +1,524 @@
+#!/usr/bin/env python3
+"""
+Firebase Data Access
+Shared loader for the benchmark scripts (benchmark_models.py,
+compare_devices.py, compare_performance.py, collect_performance_data.py).
+
+- Leaf collections (one per device, or per processor/device) are fetched
+  concurrently and paged by key, so large nodes never arrive in one response
+- Each leaf is kept as a compressed Parquet snapshot under --cache-dir
+  (needs pyarrow, see requirements_benchmark.txt)
+- Later runs only fetch records newer than the last cached key; record keys
+  are push IDs or millisecond timestamps, so key order is time order
+- --offline points every script at a local JSON export of the database, so
+  analyses run without network access and reproduce exactly
+
+Usage:
+    from firebase_data import add_data_arguments, store_from_args
+    add_data_arguments(parser)
+    store = store_from_args(args)
+    data = store.load("device_performance_data", depth=1, limit=1000)
+    # {deviceId: {pushId: record}}
+
+    # Refresh snapshots for both nodes
+    python firebase_data.py sync
+
+    # Serve from snapshots only (no network)
+    python benchmark_models.py --no-refresh
+
+    # Write the snapshots as a JSON stand-in for the database, then use it
+    python firebase_data.py export --output firebase_export.json
+    python compare_devices.py --offline firebase_export.json
+"""
+
+import argparse
+import bisect
+import json
+import os
+import re
+import threading
+import time
+from concurrent.futures import ThreadPoolExecutor
+from typing import Any, Dict, List, Optional
+
+import pandas as pd
+
+try:
+    import requests
+except ImportError:  # Only needed when talking to Firebase
+    requests = None
+
+# Firebase configuration
+FIREBASE_PROJECT_ID = "postureanalyzer-b24a3"
+FIREBASE_DATABASE_URL = f"https://{FIREBASE_PROJECT_ID}-default-rtdb.asia-southeast1.firebasedatabase.app"
+
+DEFAULT_CACHE_DIR = ".firebase_cache"
+DEFAULT_WORKERS = 8
+DEFAULT_PAGE_SIZE = 500
+
+# Nodes refreshed by `python firebase_data.py sync`: node -> depth of the record level
+KNOWN_NODES = {
+    "device_performance_data": 1,   # {deviceId}/{pushId}
+    "performance_data": 2,          # {processor}/{deviceModel}/{timestamp}
+}
+
+KEY_COLUMN = "_key"
+JSON_PREFIX = "json:"   # Columns whose values are stored JSON-encoded
+SEPARATOR = "."         # Firebase keys cannot contain "."
+
+SNAPSHOT_EXT = ".parquet"
+
+
+class FirebaseSource:
+    """Firebase Realtime Database REST API."""
+
+    def __init__(self, database_url: str = FIREBASE_DATABASE_URL, timeout: float = 30.0):
+        if requests is None:
+            raise RuntimeError("The 'requests' package is required to fetch from Firebase "
+                               "(pip install -r requirements_benchmark.txt), or use --offline")
+        self.database_url = database_url.rstrip("/")
+        self.timeout = timeout
+        self._local = threading.local()
+
+    def _get(self, path: str, params: Dict[str, Any]) -> Any:
+        # One session per worker thread keeps connections alive between pages
+        session = getattr(self._local, "session", None)
+        if session is None:
+            session = self._local.session = requests.Session()
+        response = session.get(f"{self.database_url}/{path}.json", params=params, timeout=self.timeout)
+        response.raise_for_status()
+        return response.json()
+
+    def children(self, path: str) -> List[str]:
+        data = self._get(path, {"shallow": "true"})
+        return sorted(data.keys()) if isinstance(data, dict) else []
+
+    def query(self, path: str, start_at: Optional[str] = None, end_at: Optional[str] = None,
+              first: Optional[int] = None, last: Optional[int] = None) -> Dict[str, Any]:
+        params = {"orderBy": '"$key"'}
+        if start_at is not None:
+            params["startAt"] = json.dumps(start_at)
+        if end_at is not None:
+            params["endAt"] = json.dumps(end_at)
+        if first is not None:
+            params["limitToFirst"] = first
+        if last is not None:
+            params["limitToLast"] = last
+        data = self._get(path, params)
+        return data if isinstance(data, dict) else {}
+
+
+class OfflineSource:
+    """
+    Local JSON stand-in for the database: a full export (root object holding
+    device_performance_data, performance_data, ...) with the same query
+    semantics as the REST API. The export is treated as read-only; sorted
+    keys are cached per path so paging through a large node stays linear.
+    """
+
+    def __init__(self, json_path: str):
+        with open(json_path, "r") as f:
+            self.root = json.load(f) or {}
+        self.database_url = os.path.abspath(json_path)
+        self._sorted_keys: Dict[str, List[str]] = {}
+
+    def _node(self, path: str) -> Any:
+        node = self.root
+        for part in path.strip("/").split("/"):
+            if not isinstance(node, dict):
+                return None
+            node = node.get(part)
+        return node
+
+    def children(self, path: str) -> List[str]:
+        node = self._node(path)
+        return sorted(node.keys()) if isinstance(node, dict) else []
+
+    def query(self, path: str, start_at: Optional[str] = None, end_at: Optional[str] = None,
+              first: Optional[int] = None, last: Optional[int] = None) -> Dict[str, Any]:
+        node = self._node(path)
+        if not isinstance(node, dict):
+            return {}
+        keys = self._sorted_keys.get(path)
+        if keys is None:
+            keys = self._sorted_keys[path] = sorted(node)
+        lo = bisect.bisect_left(keys, start_at) if start_at is not None else 0
+        hi = bisect.bisect_right(keys, end_at) if end_at is not None else len(keys)
+        keys = keys[lo:hi]
+        if first is not None:
+            keys = keys[:first]
+        if last is not None:
+            keys = keys[-last:] if last > 0 else []
+        return {k: node[k] for k in keys}
+
+
+def flatten_records(records: Dict[str, Any]) -> pd.DataFrame:
+    """
+    One row per record, one typed column per leaf field ("individualModels.leanModel.avgFps").
+    Columns that are not uniformly int, float, bool or str are stored JSON-encoded.
+
+    Args:
+        records: Mapping of record key -> record dict
+
+    Returns:
+        DataFrame sorted by KEY_COLUMN
+    """
+    keys = sorted(k for k, v in records.items() if isinstance(v, dict))
+    columns: Dict[str, List[Any]] = {KEY_COLUMN: keys}
+
+    def walk(value: Any, prefix: str, row: int):
+        if isinstance(value, dict) and value:
+            for name, child in value.items():
+                walk(child, f"{prefix}{SEPARATOR}{name}" if prefix else name, row)
+            return
+        column = columns.get(prefix)
+        if column is None:
+            column = columns[prefix] = [None] * len(keys)
+        column[row] = value
+
+    for row, key in enumerate(keys):
+        walk(records[key], "", row)
+
+    frame = {}
+    for name, values in columns.items():
+        present = [v for v in values if v is not None]
+        kinds = {type(v) for v in present}
+        if name == KEY_COLUMN or kinds == {str}:
+            frame[name] = pd.array(values, dtype="string")
+        elif kinds == {bool}:
+            frame[name] = pd.array(values, dtype="boolean")
+        elif kinds == {int}:
+            frame[name] = pd.array(values, dtype="Int64")
+        elif kinds and kinds <= {int, float}:
+            frame[name] = pd.array([float("nan") if v is None else float(v) for v in values],
+                                   dtype="float64")
+        else:
+            frame[JSON_PREFIX + name] = pd.array(
+                [None if v is None else json.dumps(v) for v in values], dtype="string")
+    return pd.DataFrame(frame)
+
+
+def unflatten_records(df: pd.DataFrame) -> Dict[str, Any]:
+    """Inverse of flatten_records: record key -> nested record dict."""
+    records: Dict[str, Any] = {}
+    if df is None or df.empty:
+        return records
+
+    columns = []
+    for name in df.columns:
+        if name == KEY_COLUMN:
+            continue
+        encoded = name.startswith(JSON_PREFIX)
+        path = (name[len(JSON_PREFIX):] if encoded else name).split(SEPARATOR)
+        columns.append((path, encoded, df[name].tolist()))
+
+    for row, key in enumerate(df[KEY_COLUMN].tolist()):
+        record: Dict[str, Any] = {}
+        for path, encoded, values in columns:
+            value = values[row]
+            if value is None or value is pd.NA or (isinstance(value, float) and value != value):
+                continue
+            if encoded:
+                value = json.loads(value)
+            node = record
+            for part in path[:-1]:
+                node = node.setdefault(part, {})
+            node[path[-1]] = value
+        records[key] = record
+    return records
+
+
+def read_snapshot(path: str) -> pd.DataFrame:
+    return pd.read_parquet(path)
+
+
+def write_snapshot(df: pd.DataFrame, path: str):
+    # Write then rename, so an interrupted run never leaves a truncated snapshot
+    tmp_path = path + ".tmp"
+    df.to_parquet(tmp_path, index=False, compression="zstd")
+    os.replace(tmp_path, path)
+
+
+class SnapshotStore:
+    """
+    Concurrent, paged, snapshot-backed loader.
+
+    Snapshots live in <cache_dir>/<node>/, one file per leaf collection, plus
+    manifest.json with the first/last cached key of each leaf and whether the
+    snapshot reaches back to the first record.
+    """
+
+    def __init__(self, source=None, cache_dir: Optional[str] = DEFAULT_CACHE_DIR,
+                 refresh: bool = True, workers: int = DEFAULT_WORKERS,
+                 page_size: int = DEFAULT_PAGE_SIZE):
+        self.source = source
+        self.cache_dir = cache_dir
+        self.refresh = refresh and source is not None
+        self.workers = max(1, workers)
+        self.page_size = max(1, page_size)
+
+    # -- Public API --------------------------------------------------------
+
+    def load(self, node: str, depth: int = 1, limit: Optional[int] = None,
+             leaves: Optional[List[str]] = None) -> Dict[str, Any]:
+        """
+        Nested dict shaped like the Firebase JSON for the node.
+
+        Args:
+            node: Top-level node, e.g. "device_performance_data"
+            depth: Number of path levels above the records
+                   (1 for {device}/{record}, 2 for {processor}/{device}/{record})
+            limit: Most recent records to return per leaf collection (None = all)
+            leaves: Collections to load, e.g. ["Samsung_SM_G991B"] (default: discover all)
+
+        Returns:
+            {child: {...: {record_key: record}}}, leaves without records omitted
+        """
+        start = time.perf_counter()
+        manifest = self._read_manifest(node)
+        if leaves is None:
+            leaves = self._list_leaves(node, depth, manifest)
+        if not leaves:
+            print(f"No collections found under '{node}'")
+            return {}
+
+        with ThreadPoolExecutor(max_workers=self.workers) as pool:
+            results = list(pool.map(lambda leaf: self._load_leaf(node, leaf, manifest.get(leaf), limit),
+                                    leaves))
+
+        data: Dict[str, Any] = {}
+        fetched = 0
+        for leaf, (records, state, new_count) in zip(leaves, results):
+            if state is not None:
+                manifest[leaf] = state
+            fetched += new_count
+            if not records:
+                continue
+            parent = data
+            parts = leaf.split("/")
+            for part in parts[:-1]:
+                parent = parent.setdefault(part, {})
+            parent[parts[-1]] = records
+        self._write_manifest(node, manifest)
+
+        total = sum(len(r) for r, _, _ in results)
+        origin = "source" if self.refresh else "snapshots only"
+        print(f"Loaded {total} records from {len(leaves)} collection(s) under '{node}' "
+              f"({fetched} new, via {origin}) in {time.perf_counter() - start:.2f}s")
+        return data
+
+    # -- Discovery ---------------------------------------------------------
+
+    def _list_leaves(self, node: str, depth: int, manifest: Dict[str, Any]) -> List[str]:
+        if not self.refresh:
+            return sorted(manifest.keys())
+
+        paths = [""]
+        for _ in range(depth):
+            with ThreadPoolExecutor(max_workers=self.workers) as pool:
+                listed = list(pool.map(lambda p: self._children(f"{node}/{p}" if p else node), paths))
+            paths = [f"{p}/{c}" if p else c for p, children in zip(paths, listed) for c in children]
+        print(f"Found {len(paths)} collection(s) under '{node}'")
+        return paths
+
+    def _children(self, path: str) -> List[str]:
+        try:
+            return self.source.children(path)
+        except Exception as e:
+            print(f"Error listing {path}: {e}")
+            return []
+
+    # -- Per-leaf sync -----------------------------------------------------
+
+    def _load_leaf(self, node: str, leaf: str, state: Optional[Dict[str, Any]],
+                   limit: Optional[int]):
+        """Returns (records, updated manifest entry or None, number of new records)."""
+        snapshot_path = self._snapshot_path(node, leaf)
+        cached: Dict[str, Any] = {}
+        if state and snapshot_path and os.path.exists(snapshot_path):
+            try:
+                cached = unflatten_records(read_snapshot(snapshot_path))
+            except Exception as e:
+                print(f"  Discarding unreadable snapshot {snapshot_path}: {e}")
+                state = None
+        else:
+            state = None
+
+        if not self.refresh:
+            return self._newest(cached, limit), None, 0
+
+        path = f"{node}/{leaf}"
+        try:
+            new, complete = self._fetch_new(path, state, limit)
+            if state is not None and not state.get("complete"):
+                # Snapshot was seeded with a smaller limit: backfill older records
+                missing = None if limit is None else limit - len(cached) - len(new)
+                if missing is None or missing > 0:
+                    older, complete = self._fetch_backward(path, state["first_key"], missing)
+                    new.update(older)
+        except Exception as e:
+            print(f"  Error fetching {path}: {e}")
+            return self._newest(cached, limit), None, 0
+
+        if not new and state is not None:
+            return self._newest(cached, limit), None, 0
+
+        merged = dict(cached)
+        merged.update(new)
+        keys = sorted(k for k, v in merged.items() if isinstance(v, dict))
+        if not keys:
+            return {}, None, 0
+
+        state = {
+            "first_key": keys[0],
+            "last_key": keys[-1],
+            "count": len(keys),
+            "complete": bool(complete or (state or {}).get("complete")),
+            "fetched_at": int(time.time()),
+        }
+        if snapshot_path:
+            os.makedirs(os.path.dirname(snapshot_path), exist_ok=True)
+            write_snapshot(flatten_records(merged), snapshot_path)
+        return self._newest(merged, limit), state, len(new)
+
+    def _fetch_new(self, path: str, state: Optional[Dict[str, Any]], limit: Optional[int]):
+        """Records after the cached last key; on a cold start, the newest `limit` (or all)."""
+        if state is None and limit is not None:
+            return self._fetch_backward(path, None, limit)
+
+        records: Dict[str, Any] = {}
+        cursor = state["last_key"] if state else None
+        while True:
+            # startAt is inclusive, so ask for one extra and drop the cursor itself
+            page = self.source.query(path, start_at=cursor, first=self.page_size + 1)
+            page.pop(cursor, None)
+            records.update(page)
+            if len(page) < self.page_size:
+                return records, True if state is None else False
+            cursor = max(page.keys())
+
+    def _fetch_backward(self, path: str, before: Optional[str], count: Optional[int]):
+        """
+        Up to `count` records (None = all) older than `before`; complete is True
+        once the first record has been reached.
+        """
+        records: Dict[str, Any] = {}
+        cursor = before
+        while count is None or len(records) < count:
+            want = self.page_size if count is None else min(self.page_size, count - len(records))
+            page = self.source.query(path, end_at=cursor, last=want + (1 if cursor else 0))
+            if cursor is not None:
+                page.pop(cursor, None)
+            records.update(page)
+            if len(page) < want:
+                return records, True
+            cursor = min(page.keys())
+        return records, False
+
+    @staticmethod
+    def _newest(records: Dict[str, Any], limit: Optional[int]) -> Dict[str, Any]:
+        if limit is None or len(records) <= limit:
+            return records
+        keys = sorted(records.keys())[-limit:] if limit > 0 else []
+        return {k: records[k] for k in keys}
+
+    # -- Cache layout ------------------------------------------------------
+
+    def _node_dir(self, node: str) -> Optional[str]:
+        if not self.cache_dir:
+            return None
+        return os.path.join(self.cache_dir, _safe_name(node))
+
+    def _snapshot_path(self, node: str, leaf: str) -> Optional[str]:
+        node_dir = self._node_dir(node)
+        if node_dir is None:
+            return None
+        return os.path.join(node_dir, *[_safe_name(p) for p in leaf.split("/")]) + SNAPSHOT_EXT
+
+    def _read_manifest(self, node: str) -> Dict[str, Any]:
+        node_dir = self._node_dir(node)
+        path = os.path.join(node_dir, "manifest.json") if node_dir else None
+        if not path or not os.path.exists(path):
+            return {}
+        with open(path, "r") as f:
+            manifest = json.load(f)
+        # Snapshots in an older format (gzip pickles) are refetched, never read
+        if manifest.get("format") != SNAPSHOT_EXT:
+            return {}
+        return manifest.get("leaves", {})
+
+    def _write_manifest(self, node: str, leaves: Dict[str, Any]):
+        node_dir = self._node_dir(node)
+        if not node_dir or not leaves:
+            return
+        os.makedirs(node_dir, exist_ok=True)
+        path = os.path.join(node_dir, "manifest.json")
+        with open(path + ".tmp", "w") as f:
+            json.dump({"format": SNAPSHOT_EXT, "leaves": leaves}, f, indent=2, sort_keys=True)
+        os.replace(path + ".tmp", path)
+
+
+def _safe_name(part: str) -> str:
+    return re.sub(r"[^A-Za-z0-9_.-]", "_", part) or "_"
+
+
+def add_data_arguments(parser: argparse.ArgumentParser):
+    """Data-source options shared by the benchmark scripts."""
+    group = parser.add_argument_group("data source")
+    group.add_argument("--offline", type=str, default=None, metavar="JSON",
+                       help="Read from a local JSON export of the database instead of Firebase")
+    group.add_argument("--cache-dir", type=str, default=DEFAULT_CACHE_DIR,
+                       help=f"Snapshot directory (default: {DEFAULT_CACHE_DIR})")
+    group.add_argument("--no-cache", action="store_true",
+                       help="Do not read or write snapshots")
+    group.add_argument("--no-refresh", action="store_true",
+                       help="Use cached snapshots only, without contacting Firebase")
+    group.add_argument("--workers", type=int, default=DEFAULT_WORKERS,
+                       help=f"Concurrent requests (default: {DEFAULT_WORKERS})")
+    group.add_argument("--page-size", type=int, default=DEFAULT_PAGE_SIZE,
+                       help=f"Records per request (default: {DEFAULT_PAGE_SIZE})")
+
+
+def store_from_args(args: argparse.Namespace) -> SnapshotStore:
+    """
+    SnapshotStore for the parsed add_data_arguments options. --offline runs
+    without snapshots, since the JSON file already is the local copy.
+    """
+    if args.offline:
+        source = OfflineSource(args.offline)
+        cache_dir = None
+    else:
+        source = None if args.no_refresh else FirebaseSource()
+        cache_dir = None if args.no_cache else args.cache_dir
+    print(f"Data source: {source.database_url if source else 'snapshots in ' + str(cache_dir)}")
+    return SnapshotStore(source, cache_dir=cache_dir, refresh=not args.no_refresh,
+                         workers=args.workers, page_size=args.page_size)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Refresh or export local Firebase snapshots")
+    parser.add_argument("command", choices=["sync", "export"],
+                        help="sync: refresh snapshots; export: write snapshots as a JSON database stand-in")
+    parser.add_argument("--node", type=str, nargs="+", default=list(KNOWN_NODES),
+                        help="Nodes to process (default: all known nodes)")
+    parser.add_argument("--output", type=str, default="firebase_export.json",
+                        help="Export file (default: firebase_export.json)")
+    add_data_arguments(parser)
+    args = parser.parse_args()
+
+    if args.command == "export":
+        args.no_refresh = True
+    store = store_from_args(args)
+
+    exported = {}
+    for node in args.node:
+        exported[node] = store.load(node, depth=KNOWN_NODES.get(node, 1))
+
+    if args.command == "export":
+        with open(args.output, "w") as f:
+            json.dump(exported, f)
+        print(f"Exported {len(exported)} node(s) to {args.output}")
+
+
+if __name__ == "__main__":
+    main()
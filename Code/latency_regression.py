@@ -0,0 +1,348 @@
+#!/usr/bin/env python3
+"""
+Latency Regression Gate
+Flags builds that make inference slower on a given device and delegate, using
+the device_performance_data sessions uploaded by the app.
+
+For every (device, delegate, model) the most recent sessions (or the sessions
+of --candidate-build) are compared with the sessions just before them:
+- p50 / p95 inference time per session (higher is worse)
+- Average FPS per session (lower is worse)
+
+A metric is a regression when all of the following hold:
+- The median degrades by at least --threshold (relative)
+- The bootstrap confidence interval of that degradation excludes zero
+- A one-sided Mann-Whitney U test is significant at --alpha
+
+Exit code: 0 = no regression, 1 = regression found, 2 = no usable data.
+
+Usage:
+    # Latest 10 sessions per device/delegate/model vs the 50 before them
+    python latency_regression.py
+
+    # A specific build vs everything uploaded before it
+    python latency_regression.py --candidate-build "1.1 (2)"
+
+    # Run from local snapshots / a JSON export, write the report for CI
+    python latency_regression.py --no-refresh --report regression_report.txt
+    python latency_regression.py --offline firebase_export.json --threshold 0.05
+"""
+
+import argparse
+import math
+import sys
+from datetime import datetime
+from typing import Any, Dict, List, Optional, Tuple
+
+import numpy as np
+import pandas as pd
+
+from firebase_data import add_data_arguments, store_from_args
+
+MODELS = {
+    "slouchModel": "Slouching",
+    "crossLeggedModel": "Cross-Legged",
+    "leanModel": "Leaning"
+}
+
+# (name, column, higher_is_worse)
+METRICS = [
+    ("p50", "p50_ms", True),
+    ("p95", "p95_ms", True),
+    ("fps", "fps", False),
+]
+
+GROUP_COLUMNS = ["device_id", "delegate", "model"]
+
+EXIT_OK = 0
+EXIT_REGRESSION = 1
+EXIT_NO_DATA = 2
+
+
+def sessions_frame(all_device_data: Dict[str, Dict[str, Any]]) -> pd.DataFrame:
+    """
+    One row per (session, model) with the per-session latency metrics.
+
+    Args:
+        all_device_data: {device_id: {record_id: record}} from device_performance_data
+
+    Returns:
+        DataFrame sorted by time within each device
+    """
+    rows = []
+    for device_id, records in all_device_data.items():
+        for record_id, record in records.items():
+            if not isinstance(record, dict):
+                continue
+            models = record.get("individualModels") or {}
+            for model_key, display_name in MODELS.items():
+                metrics = models.get(model_key) or {}
+                if not metrics.get("hasData", False):
+                    continue
+                # p50/p95 are only present in sessions uploaded by builds that report them
+                p50 = metrics.get("p50InferenceUs")
+                p95 = metrics.get("p95InferenceUs")
+                rows.append({
+                    "device_id": device_id,
+                    "delegate": record.get("delegate", "Unknown"),
+                    "model": display_name,
+                    "record_id": record_id,
+                    "timestamp": record.get("timestamp", 0),
+                    "app_version": record.get("appVersion", "unknown"),
+                    "p50_ms": p50 / 1000.0 if p50 is not None else np.nan,
+                    "p95_ms": p95 / 1000.0 if p95 is not None else np.nan,
+                    "fps": metrics.get("avgFps", np.nan),
+                })
+
+    df = pd.DataFrame(rows)
+    if not df.empty:
+        # Push IDs break timestamp ties in upload order
+        df = df.sort_values(["device_id", "timestamp", "record_id"], kind="mergesort").reset_index(drop=True)
+    return df
+
+
+def split_windows(group: pd.DataFrame, candidate_build: Optional[str],
+                  recent: int, baseline: int) -> Tuple[pd.DataFrame, pd.DataFrame]:
+    """
+    Baseline and candidate sessions for one (device, delegate, model), oldest first.
+
+    Args:
+        group: Sessions sorted by time
+        candidate_build: appVersion under test, or None for the most recent sessions
+        recent: Candidate window size when candidate_build is None
+        baseline: Maximum baseline sessions (the most recent ones before the candidate)
+
+    Returns:
+        (baseline, candidate) DataFrames
+    """
+    if candidate_build is None:
+        candidate = group.iloc[-recent:] if recent > 0 else group.iloc[0:0]
+        before = group.iloc[:len(group) - len(candidate)]
+    else:
+        candidate = group[group["app_version"] == candidate_build]
+        if candidate.empty:
+            return group.iloc[0:0], candidate
+        first = candidate["timestamp"].min()
+        before = group[(group["app_version"] != candidate_build) & (group["timestamp"] < first)]
+    return before.iloc[-baseline:] if baseline > 0 else before.iloc[0:0], candidate
+
+
+def mann_whitney_greater(x: np.ndarray, y: np.ndarray) -> float:
+    """
+    One-sided Mann-Whitney U p-value for "y tends to be larger than x"
+    (normal approximation with tie and continuity correction).
+    """
+    n1, n2 = len(x), len(y)
+    if n1 == 0 or n2 == 0:
+        return 1.0
+    combined = np.concatenate([x, y])
+    ranks = pd.Series(combined).rank(method="average").to_numpy()
+    u = ranks[n1:].sum() - n2 * (n2 + 1) / 2.0
+
+    _, counts = np.unique(combined, return_counts=True)
+    n = n1 + n2
+    tie_term = (counts ** 3 - counts).sum() / (n * (n - 1)) if n > 1 else 0.0
+    variance = n1 * n2 / 12.0 * ((n + 1) - tie_term)
+    if variance <= 0:
+        return 1.0
+    z = (u - n1 * n2 / 2.0 - 0.5) / math.sqrt(variance)
+    return 0.5 * math.erfc(z / math.sqrt(2.0))
+
+
+def relative_degradation(base: np.ndarray, cand: np.ndarray, higher_is_worse: bool) -> np.ndarray:
+    """Relative worsening of the median along the last axis; positive = worse."""
+    base_med = np.median(base, axis=-1)
+    cand_med = np.median(cand, axis=-1)
+    with np.errstate(divide="ignore", invalid="ignore"):
+        change = (cand_med - base_med) / np.abs(base_med)
+    return change if higher_is_worse else -change
+
+
+def bootstrap_interval(base: np.ndarray, cand: np.ndarray, higher_is_worse: bool,
+                       confidence: float, resamples: int,
+                       rng: np.random.Generator) -> Tuple[float, float]:
+    """Percentile bootstrap interval of relative_degradation, resampling both windows."""
+    base_samples = base[rng.integers(0, len(base), size=(resamples, len(base)))]
+    cand_samples = cand[rng.integers(0, len(cand), size=(resamples, len(cand)))]
+    changes = relative_degradation(base_samples, cand_samples, higher_is_worse)
+    changes = changes[np.isfinite(changes)]
+    if changes.size == 0:
+        return float("nan"), float("nan")
+    tail = (1.0 - confidence) / 2.0
+    low, high = np.quantile(changes, [tail, 1.0 - tail])
+    return float(low), float(high)
+
+
+def analyze(df: pd.DataFrame, args: argparse.Namespace) -> pd.DataFrame:
+    """
+    Change detection for every (device, delegate, model) and metric.
+
+    Returns:
+        One row per comparison with medians, degradation, interval, p-value and status
+    """
+    rng = np.random.default_rng(args.seed)
+    results = []
+
+    for key, group in df.groupby(GROUP_COLUMNS, sort=True):
+        base_rows, cand_rows = split_windows(group, args.candidate_build, args.recent, args.baseline)
+        if cand_rows.empty:
+            continue
+
+        for name, column, higher_is_worse in METRICS:
+            base = base_rows[column].dropna().to_numpy(dtype=float)
+            cand = cand_rows[column].dropna().to_numpy(dtype=float)
+            result = dict(zip(GROUP_COLUMNS, key))
+            result.update({
+                "metric": name,
+                "baseline_n": len(base),
+                "candidate_n": len(cand),
+                "baseline_median": float(np.median(base)) if len(base) else np.nan,
+                "candidate_median": float(np.median(cand)) if len(cand) else np.nan,
+                "degradation": np.nan,
+                "ci_low": np.nan,
+                "ci_high": np.nan,
+                "p_value": np.nan,
+            })
+
+            if len(base) < args.min_sessions or len(cand) < args.min_sessions:
+                result["status"] = "insufficient data"
+                results.append(result)
+                continue
+
+            degradation = float(relative_degradation(base, cand, higher_is_worse))
+            ci_low, ci_high = bootstrap_interval(base, cand, higher_is_worse,
+                                                 args.confidence, args.resamples, rng)
+            p_value = (mann_whitney_greater(base, cand) if higher_is_worse
+                       else mann_whitney_greater(cand, base))
+
+            if degradation >= args.threshold and ci_low > 0 and p_value < args.alpha:
+                status = "REGRESSION"
+            elif degradation <= -args.threshold and ci_high < 0:
+                status = "improved"
+            else:
+                status = "ok"
+
+            result.update({
+                "degradation": degradation,
+                "ci_low": ci_low,
+                "ci_high": ci_high,
+                "p_value": p_value,
+                "status": status,
+            })
+            results.append(result)
+
+    return pd.DataFrame(results)
+
+
+def format_report(results: pd.DataFrame, args: argparse.Namespace) -> str:
+    """Readable report, regressions first."""
+    if args.candidate_build:
+        window = f"build '{args.candidate_build}' vs up to {args.baseline} earlier sessions"
+    else:
+        window = f"latest {args.recent} sessions vs the {args.baseline} before them"
+
+    lines = [
+        "=" * 120,
+        " " * 42 + "LATENCY REGRESSION REPORT",
+        "=" * 120,
+        f"Generated: {datetime.now().strftime('%Y-%m-%d %H:%M:%S')}",
+        f"Comparison: {window}",
+        f"Regression: median worse by >= {args.threshold:.0%}, {args.confidence:.0%} bootstrap "
+        f"interval above 0, Mann-Whitney p < {args.alpha}",
+        "",
+    ]
+
+    regressions = results[results["status"] == "REGRESSION"]
+    if regressions.empty:
+        lines.append("No regressions detected.")
+    else:
+        lines.append(f"{len(regressions)} REGRESSION(S):")
+        for _, r in regressions.iterrows():
+            unit = "" if r["metric"] == "fps" else " ms"
+            lines.append(
+                f"  {r['device_id']} / {r['delegate']} / {r['model']} {r['metric']}: "
+                f"{r['baseline_median']:.2f}{unit} -> {r['candidate_median']:.2f}{unit} "
+                f"({r['degradation']:+.1%} worse, CI [{r['ci_low']:+.1%}, {r['ci_high']:+.1%}], "
+                f"p={r['p_value']:.4f})")
+    lines.append("")
+
+    header = (f"{'Device':<28} {'Delegate':<12} {'Model':<13} {'Metric':<6} {'Base n':>6} {'Cand n':>6} "
+              f"{'Base med':>9} {'Cand med':>9} {'Worse':>8} {'p':>8}  Status")
+    lines.append(header)
+    lines.append("-" * 120)
+
+    order = {"REGRESSION": 0, "ok": 1, "improved": 2, "insufficient data": 3}
+    ranked = results.assign(_order=results["status"].map(order)).sort_values(
+        ["_order"] + GROUP_COLUMNS, kind="mergesort")
+    for _, r in ranked.iterrows():
+        worse = f"{r['degradation']:+.1%}" if np.isfinite(r["degradation"]) else "-"
+        p_value = f"{r['p_value']:.4f}" if np.isfinite(r["p_value"]) else "-"
+        base_med = f"{r['baseline_median']:.2f}" if np.isfinite(r["baseline_median"]) else "-"
+        cand_med = f"{r['candidate_median']:.2f}" if np.isfinite(r["candidate_median"]) else "-"
+        lines.append(f"{str(r['device_id'])[:28]:<28} {str(r['delegate'])[:12]:<12} {r['model']:<13} "
+                     f"{r['metric']:<6} {r['baseline_n']:>6} {r['candidate_n']:>6} "
+                     f"{base_med:>9} {cand_med:>9} {worse:>8} {p_value:>8}  {r['status']}")
+
+    lines.append("=" * 120)
+    return "\n".join(lines)
+
+
+def build_parser() -> argparse.ArgumentParser:
+    parser = argparse.ArgumentParser(
+        description="Detect p50/p95/FPS regressions per device, delegate and model"
+    )
+    parser.add_argument("--node", type=str, default="device_performance_data",
+                        help="Firebase node path (default: device_performance_data)")
+    parser.add_argument("--devices", type=str, nargs="+", default=None,
+                        help="Device IDs to check (default: all devices)")
+    parser.add_argument("--candidate-build", type=str, default=None,
+                        help="appVersion to test against earlier builds (default: most recent sessions)")
+    parser.add_argument("--recent", type=int, default=10,
+                        help="Candidate sessions when no build is given (default: 10)")
+    parser.add_argument("--baseline", type=int, default=50,
+                        help="Maximum baseline sessions (default: 50)")
+    parser.add_argument("--min-sessions", type=int, default=5,
+                        help="Minimum sessions on each side to test (default: 5)")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="Relative median degradation that counts as a regression (default: 0.10)")
+    parser.add_argument("--alpha", type=float, default=0.05,
+                        help="Mann-Whitney significance level (default: 0.05)")
+    parser.add_argument("--confidence", type=float, default=0.95,
+                        help="Bootstrap interval confidence (default: 0.95)")
+    parser.add_argument("--resamples", type=int, default=2000,
+                        help="Bootstrap resamples (default: 2000)")
+    parser.add_argument("--seed", type=int, default=0,
+                        help="Bootstrap random seed (default: 0)")
+    parser.add_argument("--report", type=str, default=None,
+                        help="Also write the report to this file")
+    add_data_arguments(parser)
+    return parser
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    args = build_parser().parse_args(argv)
+
+    store = store_from_args(args)
+    all_device_data = store.load(args.node, depth=1, leaves=args.devices)
+    df = sessions_frame(all_device_data)
+    if df.empty:
+        print("No sessions with model metrics found. Exiting.")
+        return EXIT_NO_DATA
+
+    results = analyze(df, args)
+    if results.empty or (results["status"] == "insufficient data").all():
+        print(f"Not enough sessions to compare (need {args.min_sessions} on each side).")
+        return EXIT_NO_DATA
+
+    report = format_report(results, args)
+    print(report)
+    if args.report:
+        with open(args.report, "w") as f:
+            f.write(report + "\n")
+        print(f"Report saved to: {args.report}")
+
+    return EXIT_REGRESSION if (results["status"] == "REGRESSION").any() else EXIT_OK
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""
+Tests for latency_regression.py
+
+Usage:
+    python -m unittest test_latency_regression
+"""
+
+import json
+import os
+import tempfile
+import unittest
+
+import numpy as np
+
+import latency_regression as lr
+
+
+def make_database(sessions_per_build: int = 20, slowdown: float = 1.0, seed: int = 1) -> dict:
+    """Two builds per device; the second one's lean model latency is scaled by `slowdown`."""
+    rng = np.random.default_rng(seed)
+    devices = {}
+    for device in ("Acme_A1", "Acme_B2"):
+        records = {}
+        for i in range(2 * sessions_per_build):
+            second = i >= sessions_per_build
+            models = {}
+            for key in lr.MODELS:
+                scale = slowdown if (second and key == "leanModel" and device == "Acme_A1") else 1.0
+                p50 = rng.normal(8000, 300) * scale
+                models[key] = {
+                    "hasData": True,
+                    "samples": 30,
+                    "p50InferenceUs": int(p50),
+                    "p95InferenceUs": int(p50 * 1.4),
+                    "avgFps": 1_000_000.0 / (p50 * 1.2),
+                }
+            records[f"-N{i:06d}"] = {
+                "timestamp": 1700000000000 + i * 60000,
+                "delegate": "GPU",
+                "appVersion": "1.1 (2)" if second else "1.0 (1)",
+                "individualModels": models,
+            }
+        devices[device] = records
+    return {"device_performance_data": devices}
+
+
+class StatisticsTest(unittest.TestCase):
+
+    def test_mann_whitney_matches_normal_approximation(self):
+        # U = 9, mean 4.5, sd sqrt(9 * 7 / 12); z = (9 - 4.5 - 0.5) / sd
+        p = lr.mann_whitney_greater(np.array([1.0, 2.0, 3.0]), np.array([4.0, 5.0, 6.0]))
+        self.assertAlmostEqual(p, 0.04043, places=4)
+        self.assertGreater(lr.mann_whitney_greater(np.array([4.0, 5.0, 6.0]), np.array([1.0, 2.0, 3.0])), 0.9)
+
+    def test_degradation_direction(self):
+        base = np.array([10.0, 10.0, 10.0])
+        self.assertAlmostEqual(float(lr.relative_degradation(base, base * 1.2, True)), 0.2)
+        # Lower FPS is worse
+        self.assertAlmostEqual(float(lr.relative_degradation(base, base * 0.8, False)), 0.2)
+
+
+class GateTest(unittest.TestCase):
+
+    def run_gate(self, database: dict, *extra: str) -> int:
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "db.json")
+            with open(path, "w") as f:
+                json.dump(database, f)
+            return lr.main(["--offline", path, "--candidate-build", "1.1 (2)", *extra])
+
+    def test_flags_slower_build(self):
+        self.assertEqual(self.run_gate(make_database(slowdown=1.3)), lr.EXIT_REGRESSION)
+
+    def test_passes_unchanged_build(self):
+        self.assertEqual(self.run_gate(make_database(slowdown=1.0)), lr.EXIT_OK)
+
+    def test_small_slowdown_below_threshold_passes(self):
+        self.assertEqual(self.run_gate(make_database(slowdown=1.05)), lr.EXIT_OK)
+
+    def test_recent_window_mode(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, "db.json")
+            with open(path, "w") as f:
+                json.dump(make_database(slowdown=1.3), f)
+            self.assertEqual(lr.main(["--offline", path, "--recent", "20"]), lr.EXIT_REGRESSION)
+
+    def test_no_data(self):
+        self.assertEqual(self.run_gate({"device_performance_data": {}}), lr.EXIT_NO_DATA)
+
+
+if __name__ == "__main__":
+    unittest.main()
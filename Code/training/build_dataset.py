@@ -0,0 +1,446 @@
+#!/usr/bin/env python3
+"""
+Offline Dataset Builder
+Extracts MediaPipe pose landmarks from recorded videos with a pool of worker
+processes, caches the raw landmarks as memory-mappable arrays, and regenerates
+the lean / slouching / cross-legged feature CSVs from that cache.
+
+Pose detection only runs in `extract`. When a feature definition changes,
+`features` rebuilds all three CSVs from the cache in seconds using
+posture_features.py.
+
+Video layout (label directories match the create-dataset scripts):
+    videos/lean/<0|1|2>/*.mp4       0 = lean left, 1 = lean right, 2 = other
+    videos/slouch/<0|1>/*.mp4       0 = slouching, 1 = straight
+    videos/crossleg/<0|1>/*.mp4     0 = normal sitting, 1 = cross-legged
+
+Cache layout:
+    cache/index.json                videos, fingerprints, extraction settings
+    cache/shards/<id>.npy           per-video landmarks, float32 [F, 33, 4]
+    cache/shards/<id>.frames.npy    per-video source frame numbers, int32 [F]
+    cache/landmarks.npy             all videos, float32 [N, 33, 4] (x, y, z, visibility)
+    cache/meta.npy                  int32 [N, 4] (video_id, frame, width, height)
+    cache/labels.npy                int8 [N, 3] (lean, slouch, crossleg), -1 = unlabeled
+
+Usage:
+    # Extract landmarks from all videos with 8 workers (already cached videos are skipped)
+    python build_dataset.py extract --videos ./videos --cache ./landmark_cache --workers 8
+
+    # Regenerate the three feature CSVs from the cache
+    python build_dataset.py features --cache ./landmark_cache --output-dir ./generated
+
+    # Only every 5th cached frame, like slouching_create_dataset.py
+    python build_dataset.py features --cache ./landmark_cache --stride 5
+"""
+
+import argparse
+import hashlib
+import json
+import multiprocessing
+import os
+import time
+from typing import Any, Dict, List, Tuple
+
+import numpy as np
+import pandas as pd
+
+from posture_features import CROSSLEG, LEAN, SLOUCH, compute_features
+
+TASKS = ["lean", "slouch", "crossleg"]
+TASK_LABELS = {"lean": {0, 1, 2}, "slouch": {0, 1}, "crossleg": {0, 1}}
+VIDEO_EXTENSIONS = {".mp4", ".avi", ".mov", ".mkv", ".webm"}
+
+NUM_LANDMARKS = 33
+LANDMARK_DIMS = 4  # x, y, z, visibility
+
+# Output files, same names and columns as the live create-dataset scripts
+LEAN_CSV = "lean_dataset.csv"
+SLOUCH_CSV = "pose_dataset.csv"
+CROSSLEG_CSV = "crosslegged_sitting_data.csv"
+
+LEAN_COLUMNS = [
+    "torso_angle", "shoulder_angle", "head_tilt_angle",
+    "left_shoulder_vis", "right_shoulder_vis",
+    "left_hip_vis", "right_hip_vis",
+    "left_ear_vis", "right_ear_vis",
+    "label"
+]
+SLOUCH_COLUMNS = ["torso_tilt", "left_angle", "right_angle", "label"]
+CROSSLEG_COLUMNS = [
+    "left_leg_angle", "right_leg_angle",
+    "knee_dist", "ankle_dist",
+    "ankle_cross", "knee_cross", "label"
+]
+
+
+# ===== Video discovery =====
+
+def find_videos(video_root: str) -> List[Dict[str, Any]]:
+    """
+    Collect labelled videos from <root>/<task>/<label>/.
+
+    Returns:
+        List of dicts with path, relpath, task and label
+    """
+    videos = []
+    for task in TASKS:
+        task_dir = os.path.join(video_root, task)
+        if not os.path.isdir(task_dir):
+            continue
+        for label_name in sorted(os.listdir(task_dir)):
+            label_dir = os.path.join(task_dir, label_name)
+            if not os.path.isdir(label_dir):
+                continue
+            try:
+                label = int(label_name)
+            except ValueError:
+                print(f"Warning: skipping non-numeric label directory {label_dir}")
+                continue
+            if label not in TASK_LABELS[task]:
+                print(f"Warning: label {label} is not valid for {task}, skipping {label_dir}")
+                continue
+            for name in sorted(os.listdir(label_dir)):
+                if os.path.splitext(name)[1].lower() not in VIDEO_EXTENSIONS:
+                    continue
+                path = os.path.join(label_dir, name)
+                videos.append({
+                    "path": path,
+                    "relpath": os.path.relpath(path, video_root),
+                    "task": task,
+                    "label": label,
+                })
+    return videos
+
+
+def fingerprint(path: str) -> Dict[str, Any]:
+    """Size and mtime, enough to notice a re-recorded video without hashing it."""
+    stat = os.stat(path)
+    return {"size": stat.st_size, "mtime": int(stat.st_mtime)}
+
+
+def shard_id(relpath: str) -> str:
+    return hashlib.sha1(relpath.encode("utf-8")).hexdigest()[:16]
+
+
+# ===== Landmark extraction (runs in worker processes) =====
+
+def _init_worker():
+    # One OpenCV thread per process; the pool provides the parallelism
+    import cv2
+    cv2.setNumThreads(1)
+
+
+def extract_video(job: Dict[str, Any]) -> Dict[str, Any]:
+    """
+    Run pose detection over one video and write its shard.
+
+    Each video gets a fresh Pose instance so tracking state never leaks
+    between videos. Frames without a detected pose are dropped, like the
+    create-dataset scripts do.
+    """
+    import cv2
+    import mediapipe as mp
+
+    start = time.time()
+    cap = cv2.VideoCapture(job["path"])
+    if not cap.isOpened():
+        return {"relpath": job["relpath"], "error": "cannot open video"}
+
+    fps = cap.get(cv2.CAP_PROP_FPS) or 0.0
+    width = int(cap.get(cv2.CAP_PROP_FRAME_WIDTH))
+    height = int(cap.get(cv2.CAP_PROP_FRAME_HEIGHT))
+    stride = max(1, job["stride"])
+
+    landmarks = []
+    frame_numbers = []
+    frame_index = -1
+    processed = 0
+
+    with mp.solutions.pose.Pose(static_image_mode=False,
+                                model_complexity=job["model_complexity"],
+                                min_detection_confidence=job["min_confidence"],
+                                min_tracking_confidence=job["min_confidence"]) as pose:
+        while True:
+            # grab() skips the colour conversion of frames we do not sample
+            if not cap.grab():
+                break
+            frame_index += 1
+            if frame_index % stride != 0:
+                continue
+            ok, frame = cap.retrieve()
+            if not ok:
+                break
+
+            if job["flip"]:
+                # The live scripts mirror the webcam before detection
+                frame = cv2.flip(frame, 1)
+            height, width = frame.shape[:2]
+            result = pose.process(cv2.cvtColor(frame, cv2.COLOR_BGR2RGB))
+            processed += 1
+
+            if result.pose_landmarks:
+                landmarks.append([(lm.x, lm.y, lm.z, lm.visibility)
+                                  for lm in result.pose_landmarks.landmark])
+                frame_numbers.append(frame_index)
+
+    cap.release()
+
+    array = np.asarray(landmarks, dtype=np.float32).reshape(-1, NUM_LANDMARKS, LANDMARK_DIMS)
+    shard_path = os.path.join(job["shard_dir"], job["shard"] + ".npy")
+    np.save(shard_path, array)
+    np.save(os.path.join(job["shard_dir"], job["shard"] + ".frames.npy"),
+            np.asarray(frame_numbers, dtype=np.int32))
+
+    return {
+        "relpath": job["relpath"],
+        "frames": int(array.shape[0]),
+        "processed": processed,
+        "width": width,
+        "height": height,
+        "fps": fps,
+        "seconds": time.time() - start,
+    }
+
+
+# ===== Cache =====
+
+def load_index(cache_dir: str) -> Dict[str, Any]:
+    path = os.path.join(cache_dir, "index.json")
+    if not os.path.exists(path):
+        return {"videos": {}}
+    with open(path, "r") as f:
+        return json.load(f)
+
+
+def save_index(cache_dir: str, index: Dict[str, Any]):
+    path = os.path.join(cache_dir, "index.json")
+    tmp = path + ".tmp"
+    with open(tmp, "w") as f:
+        json.dump(index, f, indent=2, sort_keys=True)
+    os.replace(tmp, path)
+
+
+def consolidate(cache_dir: str, index: Dict[str, Any]) -> int:
+    """
+    Concatenate all shards into landmarks.npy / meta.npy / labels.npy so the
+    feature pass can memory-map one contiguous array.
+
+    Returns:
+        Total number of cached frames
+    """
+    shard_dir = os.path.join(cache_dir, "shards")
+    entries = sorted(index["videos"].items())
+    total = sum(entry["frames"] for _, entry in entries)
+
+    landmarks = np.lib.format.open_memmap(
+        os.path.join(cache_dir, "landmarks.npy"), mode="w+", dtype=np.float32,
+        shape=(total, NUM_LANDMARKS, LANDMARK_DIMS))
+    meta = np.empty((total, 4), dtype=np.int32)
+    labels = np.full((total, len(TASKS)), -1, dtype=np.int8)
+
+    offset = 0
+    for video_id, (relpath, entry) in enumerate(entries):
+        count = entry["frames"]
+        if count == 0:
+            entry["video_id"] = video_id
+            continue
+        shard = np.load(os.path.join(shard_dir, entry["shard"] + ".npy"), mmap_mode="r")
+        frames = np.load(os.path.join(shard_dir, entry["shard"] + ".frames.npy"))
+
+        rows = slice(offset, offset + count)
+        landmarks[rows] = shard
+        meta[rows, 0] = video_id
+        meta[rows, 1] = frames
+        meta[rows, 2] = entry["width"]
+        meta[rows, 3] = entry["height"]
+        labels[rows, TASKS.index(entry["task"])] = entry["label"]
+        entry["video_id"] = video_id
+        offset += count
+
+    landmarks.flush()
+    del landmarks
+    np.save(os.path.join(cache_dir, "meta.npy"), meta)
+    np.save(os.path.join(cache_dir, "labels.npy"), labels)
+    return total
+
+
+def load_cache(cache_dir: str) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+    """
+    Memory-map the consolidated cache.
+
+    Returns:
+        (landmarks [N,33,4], meta [N,4], labels [N,3])
+    """
+    landmarks = np.load(os.path.join(cache_dir, "landmarks.npy"), mmap_mode="r")
+    meta = np.load(os.path.join(cache_dir, "meta.npy"), mmap_mode="r")
+    labels = np.load(os.path.join(cache_dir, "labels.npy"), mmap_mode="r")
+    return landmarks, meta, labels
+
+
+def run_extract(args):
+    videos = find_videos(args.videos)
+    if not videos:
+        raise SystemExit(f"No labelled videos under {args.videos} (expected <task>/<label>/*.mp4)")
+
+    shard_dir = os.path.join(args.cache, "shards")
+    os.makedirs(shard_dir, exist_ok=True)
+    index = load_index(args.cache)
+
+    settings = {
+        "stride": args.stride,
+        "flip": not args.no_flip,
+        "min_confidence": args.min_confidence,
+        "model_complexity": args.model_complexity,
+    }
+
+    # Videos whose file and extraction settings are unchanged keep their shard
+    jobs = []
+    current = set()
+    for video in videos:
+        current.add(video["relpath"])
+        entry = index["videos"].get(video["relpath"])
+        fp = fingerprint(video["path"])
+        if (entry and entry.get("fingerprint") == fp and entry.get("settings") == settings
+                and entry.get("task") == video["task"] and entry.get("label") == video["label"]):
+            continue
+        job = dict(settings)
+        job.update({
+            "path": video["path"],
+            "relpath": video["relpath"],
+            "shard": shard_id(video["relpath"]),
+            "shard_dir": shard_dir,
+        })
+        jobs.append((video, fp, job))
+
+    # Forget videos that were removed from the video root
+    for relpath in list(index["videos"].keys()):
+        if relpath not in current:
+            del index["videos"][relpath]
+
+    print(f"Found {len(videos)} video(s), {len(jobs)} to extract, "
+          f"{len(videos) - len(jobs)} cached")
+
+    workers = max(1, min(args.workers, len(jobs))) if jobs else 0
+    start = time.time()
+    processed = 0
+    failed = 0
+
+    if jobs:
+        by_relpath = {job["relpath"]: (video, fp) for video, fp, job in jobs}
+        with multiprocessing.Pool(workers, initializer=_init_worker) as pool:
+            # Largest files first so one long video does not finish last
+            ordered = sorted((job for _, _, job in jobs),
+                             key=lambda j: -os.path.getsize(j["path"]))
+            for done, result in enumerate(pool.imap_unordered(extract_video, ordered), 1):
+                video, fp = by_relpath[result["relpath"]]
+                if "error" in result:
+                    failed += 1
+                    print(f"  [{done}/{len(jobs)}] {result['relpath']}: {result['error']}")
+                    continue
+                processed += result["processed"]
+                index["videos"][result["relpath"]] = {
+                    "task": video["task"],
+                    "label": video["label"],
+                    "shard": shard_id(result["relpath"]),
+                    "fingerprint": fp,
+                    "settings": settings,
+                    "frames": result["frames"],
+                    "width": result["width"],
+                    "height": result["height"],
+                    "fps": result["fps"],
+                }
+                print(f"  [{done}/{len(jobs)}] {result['relpath']}: {result['frames']}/"
+                      f"{result['processed']} frames with pose ({result['seconds']:.1f}s)")
+                # Keep progress if the run is interrupted
+                save_index(args.cache, index)
+
+    elapsed = time.time() - start
+    if processed:
+        print(f"Extracted {processed} frames in {elapsed:.1f}s "
+              f"({processed / elapsed:.1f} frames/sec across {workers} workers)")
+
+    total = consolidate(args.cache, index)
+    save_index(args.cache, index)
+    print(f"Cache holds {total} frames from {len(index['videos'])} video(s) in {args.cache}")
+    if failed:
+        print(f"Warning: {failed} video(s) failed to open")
+
+
+# ===== Features =====
+
+FEATURE_SETS = [
+    ("lean", LEAN_CSV, LEAN_COLUMNS, LEAN),
+    ("slouch", SLOUCH_CSV, SLOUCH_COLUMNS, SLOUCH),
+    ("crossleg", CROSSLEG_CSV, CROSSLEG_COLUMNS, CROSSLEG),
+]
+
+
+def run_features(args):
+    start = time.time()
+    landmarks, meta, labels = load_cache(args.cache)
+    os.makedirs(args.output_dir, exist_ok=True)
+    print(f"Loaded {landmarks.shape[0]} cached frames from {args.cache}")
+
+    for task, filename, columns, columns_slice in FEATURE_SETS:
+        label_column = labels[:, TASKS.index(task)]
+        rows = np.flatnonzero(label_column >= 0)
+        if args.stride > 1:
+            # Per-video stride keyed on the source frame number
+            rows = rows[meta[rows, 1] % args.stride == 0]
+        if rows.size == 0:
+            print(f"  {task}: no labelled frames, skipping {filename}")
+            continue
+
+        task_start = time.time()
+        task_meta = np.asarray(meta[rows])
+        features = compute_features(landmarks[rows], task_meta[:, 2], task_meta[:, 3])[:, columns_slice]
+        frame = pd.DataFrame(features, columns=columns[:-1])
+        for flag in ("ankle_cross", "knee_cross"):
+            if flag in frame:
+                frame[flag] = frame[flag].astype(np.int64)
+        frame["label"] = np.asarray(label_column[rows], dtype=np.int64)
+
+        out_path = os.path.join(args.output_dir, filename)
+        frame.to_csv(out_path, index=False)
+        print(f"  {task}: {rows.size} rows -> {out_path} ({time.time() - task_start:.2f}s)")
+
+    print(f"Features regenerated in {time.time() - start:.2f}s")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Build posture datasets offline from recorded videos"
+    )
+    sub = parser.add_subparsers(dest="command")
+    sub.required = True
+
+    extract = sub.add_parser("extract", help="Run pose detection and update the landmark cache")
+    extract.add_argument("--videos", required=True, help="Root with <task>/<label>/ video folders")
+    extract.add_argument("--cache", default="landmark_cache", help="Cache directory (default: landmark_cache)")
+    extract.add_argument("--workers", type=int, default=max(1, os.cpu_count() or 1),
+                         help="Worker processes (default: CPU count)")
+    extract.add_argument("--stride", type=int, default=1,
+                         help="Run pose on every Nth frame (default: 1)")
+    extract.add_argument("--min-confidence", type=float, default=0.5,
+                         help="Pose detection/tracking confidence (default: 0.5)")
+    extract.add_argument("--model-complexity", type=int, choices=[0, 1, 2], default=1,
+                         help="MediaPipe Pose model complexity (default: 1)")
+    extract.add_argument("--no-flip", action="store_true",
+                         help="Do not mirror frames (the live scripts mirror the webcam)")
+
+    features = sub.add_parser("features", help="Regenerate feature CSVs from the landmark cache")
+    features.add_argument("--cache", default="landmark_cache", help="Cache directory (default: landmark_cache)")
+    features.add_argument("--output-dir", default="generated",
+                          help="Output directory for the CSVs (default: generated)")
+    features.add_argument("--stride", type=int, default=1,
+                          help="Keep every Nth source frame (default: 1)")
+
+    args = parser.parse_args()
+    if args.command == "extract":
+        run_extract(args)
+    else:
+        run_features(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -4,6 +4,8 @@ import numpy as np
 import pandas as pd
 import os
 
+from posture_features import CROSSLEG, as_csv_row, compute_features, landmarks_to_array
+
 # ===== CONFIG =====
 CSV_FILE = "crosslegged_sitting_data.csv"
 LABEL = int(input("Enter label (1 = cross-legged, 0 = normal sitting): "))
@@ -12,47 +14,13 @@ LABEL = int(input("Enter label (1 = cross-legged, 0 = normal sitting): "))
 mp_pose = mp.solutions.pose
 mp_drawing = mp.solutions.drawing_utils
 
-# ===== Helper: compute angle between 3 points =====
-def angle_3pts(a, b, c):
-    a, b, c = np.array(a), np.array(b), np.array(c)
-    ba, bc = a - b, c - b
-    cosine = np.dot(ba, bc) / (np.linalg.norm(ba) * np.linalg.norm(bc) + 1e-6)
-    return round(np.degrees(np.arccos(np.clip(cosine, -1.0, 1.0))), 2)
-
 # ===== Feature extraction =====
 def get_features(landmarks, w, h):
-    def to_pixel(lm): return np.array([lm.x * w, lm.y * h])
-
-    # Key joints
-    left_hip = to_pixel(landmarks[mp_pose.PoseLandmark.LEFT_HIP.value])
-    right_hip = to_pixel(landmarks[mp_pose.PoseLandmark.RIGHT_HIP.value])
-    left_knee = to_pixel(landmarks[mp_pose.PoseLandmark.LEFT_KNEE.value])
-    right_knee = to_pixel(landmarks[mp_pose.PoseLandmark.RIGHT_KNEE.value])
-    left_ankle = to_pixel(landmarks[mp_pose.PoseLandmark.LEFT_ANKLE.value])
-    right_ankle = to_pixel(landmarks[mp_pose.PoseLandmark.RIGHT_ANKLE.value])
-
-    # Angles
-    left_leg_angle = angle_3pts(left_hip, left_knee, left_ankle)
-    right_leg_angle = angle_3pts(right_hip, right_knee, right_ankle)
-
-    # Distances
-    knee_dist = np.linalg.norm(left_knee - right_knee)
-    ankle_dist = np.linalg.norm(left_ankle - right_ankle)
-    hip_dist = np.linalg.norm(left_hip - right_hip) + 1e-6  # avoid div0
-
-    # Normalize distances by hip width (removes zoom effect)
-    knee_dist /= hip_dist
-    ankle_dist /= hip_dist
-
-    # Crossing flags
-    ankle_cross = 1 if left_ankle[0] > right_ankle[0] else 0
-    knee_cross = 1 if left_knee[0] > right_knee[0] else 0
-
-    return [
-        left_leg_angle, right_leg_angle,
-        knee_dist, ankle_dist,
-        ankle_cross, knee_cross
-    ]
+    # left/right leg angle, knee/ankle distance over hip width, ankle/knee crossing flags
+    features = as_csv_row(compute_features(landmarks_to_array(landmarks), w, h)[0, CROSSLEG])
+    features[4] = int(features[4])
+    features[5] = int(features[5])
+    return features
 
 # ===== CSV Setup =====
 columns = [
@@ -0,0 +1,303 @@
+#!/usr/bin/env python3
+"""
+Landmark Filter Agreement
+Replays recorded landmark traces (the build_dataset.py cache) to find how far
+the pose rate can drop once landmarks are smoothed by the app's One-Euro
+filter (app/src/main/cpp/landmark_filter.cpp), while posture decisions still
+agree with the unfiltered full-rate baseline.
+
+For every cached video and candidate rate:
+- Baseline: every cached frame classified from raw landmarks (the 30 FPS reference)
+- Candidate: frames admitted at the candidate rate (like ThermalGovernor.admitFrame),
+  filtered, classified, and each decision held until the next admitted frame
+- Agreement: fraction of baseline frames whose state code the candidate matches
+  (also per model), next to the agreement of the same rate without filtering
+
+The filter below mirrors landmark_filter.cpp step for step in float32, so
+parameters tuned here carry over to LandmarkFilter.setParams unchanged.
+
+Usage:
+    # Sweep the default rates with the app's filter parameters
+    python filter_agreement.py --cache ./landmark_cache
+
+    # Require 97% agreement, try stronger smoothing
+    python filter_agreement.py --cache ./landmark_cache --threshold 0.97 --beta 3 --min-cutoff 0.5
+
+Exit codes: 0 = a rate below the baseline meets the threshold, 1 = none does,
+2 = no usable traces.
+"""
+
+import argparse
+import os
+import sys
+from typing import Dict, List, Optional, Tuple
+
+import numpy as np
+
+from build_dataset import load_cache, load_index
+from posture_features import CROSSLEG, LEAN, SLOUCH, compute_features
+from rescore_archive import (ASSETS_DIR, CROSSLEG_MEAN, CROSSLEG_STD, LEAN_CLASSES, LEGS_CROSSED,
+                             LEGS_NORMAL, SLOUCH_GOOD, SLOUCH_SLOUCHING, BatchModel, encode_state,
+                             gate_fields)
+
+EXIT_OK = 0
+EXIT_NO_RATE = 1
+EXIT_NO_DATA = 2
+
+DEFAULT_RATES = [20.0, 15.0, 10.0, 7.5, 5.0]
+
+# LandmarkFilter defaults (landmark_filter.cpp)
+DEFAULT_MIN_CUTOFF = 1.0       # Hz, x / y / z at rest
+DEFAULT_BETA = 5.0             # Hz per unit/s of speed
+DEFAULT_VIS_MIN_CUTOFF = 1.0   # Hz, visibility
+DEFAULT_D_CUTOFF = 1.0         # Hz, speed estimate
+DEFAULT_RESET_GAP_S = 1.0
+
+# State code bit fields
+FIELDS = {"slouch": 0x03, "legs": 0x0C, "lean": 0x30}
+
+
+# ===== Filter =====
+
+def one_euro(landmarks: np.ndarray, times: np.ndarray, min_cutoff: np.ndarray, beta: np.ndarray,
+             d_cutoff: float = DEFAULT_D_CUTOFF, reset_gap: float = DEFAULT_RESET_GAP_S) -> np.ndarray:
+    """
+    One-Euro filter over a trace, as LandmarkFilter::filter.
+
+    Args:
+        landmarks: [F, 33, 4] raw landmarks in frame order
+        times: [F] frame times in seconds
+        min_cutoff, beta: [4] per-channel parameters (x, y, z, visibility)
+
+    Returns:
+        [F, 33, 4] filtered landmarks (float32)
+    """
+    landmarks = np.asarray(landmarks, dtype=np.float32)
+    out = np.empty_like(landmarks)
+    two_pi = np.float32(6.2831853)
+    min_cutoff = np.asarray(min_cutoff, dtype=np.float32)
+    beta = np.asarray(beta, dtype=np.float32)
+    value = deriv = None
+    last = None
+
+    for f in range(landmarks.shape[0]):
+        x = landmarks[f]
+        dt = None if last is None else times[f] - last
+        if dt is None or dt > reset_gap or dt < 0:
+            value = x.copy()
+            deriv = np.zeros_like(x)
+            last = times[f]
+            out[f] = value
+            continue
+        if dt == 0:
+            out[f] = value
+            continue
+        last = times[f]
+
+        dt32 = np.float32(dt)
+        rd = two_pi * np.float32(d_cutoff) * dt32
+        alpha_d = rd / (rd + np.float32(1.0))
+        deriv = deriv + alpha_d * ((x - value) * (np.float32(1.0) / dt32) - deriv)
+        r = (two_pi * dt32) * (min_cutoff + beta * np.abs(deriv))
+        alpha = r / (r + np.float32(1.0))
+        value = value + alpha * (x - value)
+        out[f] = value
+    return out
+
+
+def filter_params(args) -> Tuple[np.ndarray, np.ndarray]:
+    min_cutoff = np.array([args.min_cutoff] * 3 + [args.vis_min_cutoff], dtype=np.float32)
+    beta = np.array([args.beta] * 3 + [0.0], dtype=np.float32)
+    return min_cutoff, beta
+
+
+# ===== Classification =====
+
+class Classifier:
+    """The three posture models with PostureClassifier's decision rules."""
+
+    def __init__(self, slouch_path: str, crossleg_path: str, lean_path: str,
+                 crossleg_mean: np.ndarray, crossleg_std: np.ndarray):
+        self.slouch = BatchModel(slouch_path)
+        self.crossleg = BatchModel(crossleg_path)
+        self.lean = BatchModel(lean_path)
+        self.crossleg_mean = crossleg_mean
+        self.crossleg_std = crossleg_std
+
+    def __call__(self, landmarks: np.ndarray, width: int, height: int) -> np.ndarray:
+        """uint8 state codes for [F, 33, 4] landmarks of one video."""
+        features = compute_features(landmarks, width, height)
+        slouch_score = self.slouch(features[:, SLOUCH])[:, 0]
+        crossleg_score = self.crossleg((features[:, CROSSLEG] - self.crossleg_mean) / self.crossleg_std)[:, 0]
+        lean_scores = self.lean(features[:, LEAN])
+
+        slouch = np.where(slouch_score >= 0.5, SLOUCH_GOOD, SLOUCH_SLOUCHING).astype(np.uint8)
+        legs = np.where(crossleg_score >= 0.5, LEGS_CROSSED, LEGS_NORMAL).astype(np.uint8)
+        lean = LEAN_CLASSES[np.argmax(lean_scores, axis=1)]
+        slouch, legs, lean = gate_fields(landmarks, slouch, legs, lean)
+        return encode_state(slouch, legs, lean).astype(np.uint8)
+
+
+# ===== Replay =====
+
+def admitted_frames(times: np.ndarray, rate: float) -> np.ndarray:
+    """Indices of the frames a 1/rate frame-rate cap lets through (ThermalGovernor.admitFrame)."""
+    interval = 1.0 / rate
+    keep = []
+    last = -np.inf
+    for i, t in enumerate(times):
+        # Small slack so a 30 FPS trace is not thinned by timestamp rounding
+        if t - last >= interval - 1e-3:
+            keep.append(i)
+            last = t
+    return np.asarray(keep, dtype=np.int64)
+
+
+def held(codes: np.ndarray, kept: np.ndarray, frames: int) -> np.ndarray:
+    """Per-frame decision when only `kept` frames are classified and each result is held."""
+    slot = np.searchsorted(kept, np.arange(frames), side="right") - 1
+    return codes[np.maximum(slot, 0)]
+
+
+def new_totals() -> Dict[str, float]:
+    totals = {"frames": 0, "seconds": 0.0, "raw": 0, "filtered": 0, "flips": 0}
+    for field in FIELDS:
+        totals["filtered_" + field] = 0
+    return totals
+
+
+def replay_video(classifier: Classifier, landmarks: np.ndarray, times: np.ndarray, width: int, height: int,
+                 rates: List[float], min_cutoff: np.ndarray, beta: np.ndarray, args,
+                 results: Dict[float, Dict[str, float]]):
+    """Add one video's agreement counts for every rate to `results`."""
+    frames = landmarks.shape[0]
+    baseline = classifier(landmarks, width, height)
+    seconds = float(times[-1] - times[0]) if frames > 1 else 0.0
+
+    for rate in rates:
+        kept = admitted_frames(times, rate)
+        raw = held(baseline[kept], kept, frames)
+        smoothed = one_euro(landmarks[kept], times[kept], min_cutoff, beta, args.d_cutoff, args.reset_gap)
+        filtered = held(classifier(smoothed, width, height), kept, frames)
+
+        totals = results.setdefault(rate, new_totals())
+        totals["frames"] += frames
+        totals["seconds"] += seconds
+        totals["raw"] += int(np.count_nonzero(raw == baseline))
+        totals["filtered"] += int(np.count_nonzero(filtered == baseline))
+        totals["flips"] += int(np.count_nonzero(filtered[1:] != filtered[:-1]))
+        for field, mask in FIELDS.items():
+            totals["filtered_" + field] += int(np.count_nonzero((filtered & mask) == (baseline & mask)))
+
+    base = results.setdefault("baseline", {"frames": 0, "seconds": 0.0, "flips": 0})
+    base["frames"] += frames
+    base["seconds"] += seconds
+    base["flips"] += int(np.count_nonzero(baseline[1:] != baseline[:-1]))
+
+
+def iter_videos(cache_dir: str, default_fps: float, min_frames: int):
+    """(relpath, landmarks [F,33,4], times [F], width, height) per cached video."""
+    landmarks, meta, _ = load_cache(cache_dir)
+    index = load_index(cache_dir)
+    video_ids = np.asarray(meta[:, 0])
+    for relpath, entry in sorted(index["videos"].items()):
+        if "video_id" not in entry or entry.get("frames", 0) < min_frames:
+            continue
+        rows = np.flatnonzero(video_ids == entry["video_id"])
+        if rows.size < min_frames:
+            continue
+        fps = entry.get("fps") or default_fps
+        times = np.asarray(meta[rows, 1], dtype=np.float64) / fps
+        yield relpath, np.asarray(landmarks[rows]), times, int(meta[rows[0], 2]), int(meta[rows[0], 3])
+
+
+def print_report(results: Dict, threshold: float) -> Optional[float]:
+    """
+    Print the sweep and return the lowest rate meeting the threshold, counting
+    down from the highest rate and stopping at the first one that misses it.
+    """
+    base = results["baseline"]
+    base_changes = base["flips"] * 60 / base["seconds"] if base["seconds"] else 0.0
+    print(f"\nBaseline: {base['frames']} frames over {base['seconds'] / 60:.1f} min, "
+          f"{base_changes:.1f} decision changes/min")
+    print(f"{'Rate':>6}  {'Raw':>7}  {'Filtered':>8}  {'Slouch':>7}  {'Legs':>7}  {'Lean':>7}  {'Changes/min':>11}")
+
+    best = None
+    failed = False
+    for rate in sorted((r for r in results if r != "baseline"), reverse=True):
+        t = results[rate]
+        n = max(1, t["frames"])
+        filtered = t["filtered"] / n
+        changes = t["flips"] * 60 / t["seconds"] if t["seconds"] else 0.0
+        passed = filtered >= threshold
+        print(f"{rate:>6.1f}  {t['raw'] / n:>7.1%}  {filtered:>8.1%}  {t['filtered_slouch'] / n:>7.1%}  "
+              f"{t['filtered_legs'] / n:>7.1%}  {t['filtered_lean'] / n:>7.1%}  {changes:>11.1f}"
+              f"{'  ok' if passed else ''}")
+        failed |= not passed
+        if passed and not failed:
+            best = rate
+    return best
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(
+        description="Measure posture agreement of filtered, reduced-rate landmarks against the full-rate baseline"
+    )
+    parser.add_argument("--cache", required=True, help="Landmark cache written by build_dataset.py extract")
+    parser.add_argument("--rates", type=float, nargs="+", default=DEFAULT_RATES,
+                        help=f"Candidate pose rates in FPS (default: {' '.join(str(r) for r in DEFAULT_RATES)})")
+    parser.add_argument("--threshold", type=float, default=0.95,
+                        help="Minimum state agreement with the baseline (default: 0.95)")
+    parser.add_argument("--min-cutoff", type=float, default=DEFAULT_MIN_CUTOFF,
+                        help=f"Position cutoff at rest in Hz (default: {DEFAULT_MIN_CUTOFF})")
+    parser.add_argument("--beta", type=float, default=DEFAULT_BETA,
+                        help=f"Cutoff gain per unit/s of landmark speed (default: {DEFAULT_BETA})")
+    parser.add_argument("--vis-min-cutoff", type=float, default=DEFAULT_VIS_MIN_CUTOFF,
+                        help=f"Visibility cutoff in Hz (default: {DEFAULT_VIS_MIN_CUTOFF})")
+    parser.add_argument("--d-cutoff", type=float, default=DEFAULT_D_CUTOFF,
+                        help=f"Speed estimate cutoff in Hz (default: {DEFAULT_D_CUTOFF})")
+    parser.add_argument("--reset-gap", type=float, default=DEFAULT_RESET_GAP_S,
+                        help=f"Restart the filter after a gap this long, in seconds (default: {DEFAULT_RESET_GAP_S})")
+    parser.add_argument("--fps", type=float, default=30.0,
+                        help="Frame rate for videos whose cache entry has none (default: 30)")
+    parser.add_argument("--min-frames", type=int, default=30,
+                        help="Skip traces shorter than this (default: 30)")
+    parser.add_argument("--slouch-model", default=os.path.join(ASSETS_DIR, "posture_model.tflite"),
+                        help="Slouch TFLite model (default: app asset)")
+    parser.add_argument("--crossleg-model", default=os.path.join(ASSETS_DIR, "crosslegged.tflite"),
+                        help="Cross-legged TFLite model (default: app asset)")
+    parser.add_argument("--lean-model", default=os.path.join(ASSETS_DIR, "lean_direction_model.tflite"),
+                        help="Lean TFLite model (default: app asset)")
+    args = parser.parse_args(argv)
+
+    if not os.path.exists(os.path.join(args.cache, "landmarks.npy")):
+        print(f"No consolidated landmark cache in {args.cache}")
+        return EXIT_NO_DATA
+
+    classifier = Classifier(args.slouch_model, args.crossleg_model, args.lean_model,
+                            CROSSLEG_MEAN, CROSSLEG_STD)
+    min_cutoff, beta = filter_params(args)
+
+    results: Dict = {}
+    videos = 0
+    for relpath, landmarks, times, width, height in iter_videos(args.cache, args.fps, args.min_frames):
+        replay_video(classifier, landmarks, times, width, height, args.rates, min_cutoff, beta, args, results)
+        videos += 1
+        print(f"  {relpath}: {landmarks.shape[0]} frames")
+
+    if not videos:
+        print("No traces long enough to replay")
+        return EXIT_NO_DATA
+
+    print(f"Replayed {videos} trace(s); filter min_cutoff={args.min_cutoff} beta={args.beta} "
+          f"vis_min_cutoff={args.vis_min_cutoff} d_cutoff={args.d_cutoff}")
+    best = print_report(results, args.threshold)
+    if best is None:
+        print(f"\nNo candidate rate reaches {args.threshold:.0%} agreement")
+        return EXIT_NO_RATE
+    print(f"\nLowest rate with >= {args.threshold:.0%} agreement: {best:g} FPS")
+    return EXIT_OK
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -16,6 +16,8 @@ import cv2
 import mediapipe as mp
 import numpy as np
 
+from posture_features import LEAN, LEAN_FEATURES, as_csv_row, compute_features, landmarks_to_array
+
 parser = argparse.ArgumentParser()
 parser.add_argument("--out", default="lean_dataset.csv", help="CSV output file")
 parser.add_argument("--label", type=int, choices=[0,1,2], required=True, help="Label (0:left,1:right,2:other)")
@@ -34,51 +36,9 @@ FIELDNAMES = [
     "label"
 ]
 
-def slope_angle(a, b):
-    ax, ay = a
-    bx, by = b
-    dx, dy = bx-ax, by-ay
-    if dx==0 and dy==0:
-        return 0.0
-    return float(np.degrees(np.arctan2(dy, dx)))
-
-def midpoint(p, q):
-    return ((p[0]+q[0])/2.0, (p[1]+q[1])/2.0)
-
 def extract_features(landmarks, w, h):
-    def lm(i):
-        l = landmarks[i]
-        return (l.x*w, l.y*h), l.visibility if hasattr(l, "visibility") else 1.0
-
-    L_SH, R_SH = mp_pose.PoseLandmark.LEFT_SHOULDER.value, mp_pose.PoseLandmark.RIGHT_SHOULDER.value
-    L_HIP, R_HIP = mp_pose.PoseLandmark.LEFT_HIP.value, mp_pose.PoseLandmark.RIGHT_HIP.value
-    L_EAR, R_EAR = mp_pose.PoseLandmark.LEFT_EAR.value, mp_pose.PoseLandmark.RIGHT_EAR.value
-    NOSE = mp_pose.PoseLandmark.NOSE.value
-
-    (lsh, lsh_vis), (rsh, rsh_vis) = lm(L_SH), lm(R_SH)
-    (lh, lh_vis), (rh, rh_vis) = lm(L_HIP), lm(R_HIP)
-    (lear, lear_vis), (rear, rear_vis) = lm(L_EAR), lm(R_EAR)
-    (nose, nose_vis) = lm(NOSE)
-
-    mid_sh = midpoint(lsh, rsh)
-    mid_hip = midpoint(lh, rh)
-
-    v = np.array(mid_sh) - np.array(mid_hip)
-    torso_angle = float(np.degrees(np.arctan2(-v[0], -v[1])))
-    shoulder_angle = slope_angle(lsh, rsh)
-    head_tilt_angle = slope_angle(lear, rear)
-
-    return {
-        "torso_angle": torso_angle,
-        "shoulder_angle": shoulder_angle,
-        "head_tilt_angle": head_tilt_angle,
-        "left_shoulder_vis": lsh_vis,
-        "right_shoulder_vis": rsh_vis,
-        "left_hip_vis": lh_vis,
-        "right_hip_vis": rh_vis,
-        "left_ear_vis": lear_vis,
-        "right_ear_vis": rear_vis
-    }
+    feats = compute_features(landmarks_to_array(landmarks), w, h)[0, LEAN]
+    return dict(zip(LEAN_FEATURES, as_csv_row(feats)))
 
 # Prepare CSV
 write_header = False
@@ -0,0 +1,198 @@
+#!/usr/bin/env python3
+"""
+Posture Features
+Vectorized computation of the 18 model features (slouch 3, cross-legged 6,
+leaning 9) for an [N, 33, 4] array of MediaPipe pose landmarks
+(normalized x, y, z, visibility).
+
+Matches FeatureExtractor.java: float32 arithmetic, trig in double precision
+cast back to float32, epsilon added to each vector magnitude, and angle_3pts
+rounded to 2 decimals. Both implementations are pinned to
+app/src/test/resources/feature_golden.csv (see test_posture_features.py).
+
+Usage:
+    from posture_features import compute_features, landmarks_to_array, SLOUCH
+    features = compute_features(landmarks, width, height)   # [N, 18] float32
+    slouch = features[:, SLOUCH]
+
+    # Throughput benchmark
+    python posture_features.py --frames 200000
+"""
+
+import argparse
+import time
+from typing import Sequence, Union
+
+import numpy as np
+
+NUM_LANDMARKS = 33
+
+# MediaPipe PoseLandmark indices
+LEFT_EAR, RIGHT_EAR = 7, 8
+LEFT_SHOULDER, RIGHT_SHOULDER = 11, 12
+LEFT_HIP, RIGHT_HIP = 23, 24
+LEFT_KNEE, RIGHT_KNEE = 25, 26
+LEFT_ANKLE, RIGHT_ANKLE = 27, 28
+
+SLOUCH_FEATURES = ["torso_tilt", "left_angle", "right_angle"]
+CROSSLEG_FEATURES = [
+    "left_leg_angle", "right_leg_angle",
+    "knee_dist", "ankle_dist",
+    "ankle_cross", "knee_cross"
+]
+LEAN_FEATURES = [
+    "torso_angle", "shoulder_angle", "head_tilt_angle",
+    "left_shoulder_vis", "right_shoulder_vis",
+    "left_hip_vis", "right_hip_vis",
+    "left_ear_vis", "right_ear_vis"
+]
+FEATURE_NAMES = SLOUCH_FEATURES + CROSSLEG_FEATURES + LEAN_FEATURES
+
+# Column ranges in the [N, 18] output, in FeatureExtractor.computeFeatures order
+SLOUCH = slice(0, 3)
+CROSSLEG = slice(3, 9)
+LEAN = slice(9, 18)
+
+_EPS = np.float32(1e-6)
+_HUNDRED = np.float32(100.0)
+
+# angle_3pts(a, b, c) for torso_tilt, left_angle, right_angle, left_leg_angle, right_leg_angle
+_ANGLE_A = [LEFT_SHOULDER, LEFT_SHOULDER, RIGHT_SHOULDER, LEFT_HIP, RIGHT_HIP]
+_ANGLE_B = [LEFT_HIP, LEFT_HIP, RIGHT_HIP, LEFT_KNEE, RIGHT_KNEE]
+_ANGLE_C = [RIGHT_SHOULDER, RIGHT_HIP, LEFT_HIP, LEFT_ANKLE, RIGHT_ANKLE]
+
+# Knee, ankle and hip widths
+_DIST_P = [LEFT_KNEE, LEFT_ANKLE, LEFT_HIP]
+_DIST_Q = [RIGHT_KNEE, RIGHT_ANKLE, RIGHT_HIP]
+
+# slope_angle(a, b) for shoulder_angle and head_tilt_angle
+_SLOPE_A = [LEFT_SHOULDER, LEFT_EAR]
+_SLOPE_B = [RIGHT_SHOULDER, RIGHT_EAR]
+
+_VISIBILITY = [LEFT_SHOULDER, RIGHT_SHOULDER, LEFT_HIP, RIGHT_HIP, LEFT_EAR, RIGHT_EAR]
+
+Size = Union[int, float, np.ndarray]
+
+
+def landmarks_to_array(landmarks: Sequence) -> np.ndarray:
+    """
+    [1, 33, 4] float32 array from a MediaPipe landmark list
+    (results.pose_landmarks.landmark).
+    """
+    return np.array([[(lm.x, lm.y, lm.z, getattr(lm, "visibility", 0.0)) for lm in landmarks]],
+                    dtype=np.float32)
+
+
+def as_csv_row(features: np.ndarray) -> list:
+    """
+    Python floats with the shortest float32 representation, so CSV rows read
+    52.17 rather than 52.16999816894531.
+    """
+    return [float(np.format_float_positional(v, unique=True)) for v in np.asarray(features, np.float32)]
+
+
+def _to_pixels(landmarks: np.ndarray, width: Size, height: Size) -> np.ndarray:
+    """[N, 33, 2] float32 pixel coordinates; width/height are scalars or [N] arrays."""
+    n = landmarks.shape[0]
+    size = np.empty((n, 1, 2), dtype=np.float32)
+    size[:, 0, 0] = width
+    size[:, 0, 1] = height
+    return landmarks[:, :, :2] * size
+
+
+def _degrees32(radians: np.ndarray) -> np.ndarray:
+    return np.degrees(radians).astype(np.float32)
+
+
+def compute_features(landmarks: np.ndarray, width: Size, height: Size,
+                     out: np.ndarray = None) -> np.ndarray:
+    """
+    All 18 features for a batch of frames.
+
+    Args:
+        landmarks: [N, 33, 4] (or [33, 4]) normalized x, y, z, visibility
+        width: Frame width in pixels, scalar or [N]
+        height: Frame height in pixels, scalar or [N]
+        out: Optional preallocated [N, 18] float32 array
+
+    Returns:
+        [N, 18] float32 array, columns in FEATURE_NAMES order
+    """
+    lm = np.asarray(landmarks, dtype=np.float32)
+    if lm.ndim == 2:
+        lm = lm[np.newaxis]
+    n = lm.shape[0]
+    if out is None:
+        out = np.empty((n, len(FEATURE_NAMES)), dtype=np.float32)
+
+    px = _to_pixels(lm, width, height)
+
+    # angle_3pts for all five angles at once: [N, 5, 2]
+    ba = px[:, _ANGLE_A] - px[:, _ANGLE_B]
+    bc = px[:, _ANGLE_C] - px[:, _ANGLE_B]
+    dot = ba[..., 0] * bc[..., 0] + ba[..., 1] * bc[..., 1]
+    mag_ba = np.sqrt((ba[..., 0] * ba[..., 0] + ba[..., 1] * ba[..., 1]).astype(np.float64))
+    mag_bc = np.sqrt((bc[..., 0] * bc[..., 0] + bc[..., 1] * bc[..., 1]).astype(np.float64))
+    cosine = dot / ((mag_ba.astype(np.float32) + _EPS) * (mag_bc.astype(np.float32) + _EPS))
+    angles = _degrees32(np.arccos(np.clip(cosine, -1.0, 1.0).astype(np.float64)))
+    # Math.round(angle * 100f) / 100f
+    angles = np.floor((angles * _HUNDRED).astype(np.float64) + 0.5).astype(np.float32) / _HUNDRED
+
+    # Knee / ankle distances normalized by hip width: [N, 3]
+    d = px[:, _DIST_P] - px[:, _DIST_Q]
+    dist = np.hypot(d[..., 0].astype(np.float64), d[..., 1].astype(np.float64)).astype(np.float32)
+    hip = dist[:, 2] + _EPS
+
+    # Torso direction from mid-hip to mid-shoulder
+    mid_sh = (px[:, LEFT_SHOULDER] + px[:, RIGHT_SHOULDER]) / np.float32(2.0)
+    mid_hip = (px[:, LEFT_HIP] + px[:, RIGHT_HIP]) / np.float32(2.0)
+    v = mid_sh - mid_hip
+
+    # Shoulder and head tilt slopes: [N, 2]
+    s = px[:, _SLOPE_B] - px[:, _SLOPE_A]
+
+    out[:, 0:3] = angles[:, 0:3]
+    out[:, 3:5] = angles[:, 3:5]
+    out[:, 5] = dist[:, 0] / hip
+    out[:, 6] = dist[:, 1] / hip
+    out[:, 7] = px[:, LEFT_ANKLE, 0] > px[:, RIGHT_ANKLE, 0]
+    out[:, 8] = px[:, LEFT_KNEE, 0] > px[:, RIGHT_KNEE, 0]
+    out[:, 9] = _degrees32(np.arctan2(-v[:, 0].astype(np.float64), -v[:, 1].astype(np.float64)))
+    out[:, 10:12] = _degrees32(np.arctan2(s[..., 1].astype(np.float64), s[..., 0].astype(np.float64)))
+    out[:, 12:18] = lm[:, _VISIBILITY, 3]
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark vectorized posture feature computation")
+    parser.add_argument("--frames", type=int, default=200000, help="Frames per batch (default: 200000)")
+    parser.add_argument("--repeats", type=int, default=5, help="Timed repeats (default: 5)")
+    parser.add_argument("--per-frame", type=int, default=5000,
+                        help="Frames for the one-call-per-frame baseline (default: 5000)")
+    args = parser.parse_args()
+
+    rng = np.random.default_rng(62)
+    landmarks = rng.uniform(0.0, 1.0, size=(args.frames, NUM_LANDMARKS, 4)).astype(np.float32)
+    out = np.empty((args.frames, len(FEATURE_NAMES)), dtype=np.float32)
+
+    compute_features(landmarks[:1000], 640, 480)  # Warm-up
+    best = float("inf")
+    for _ in range(args.repeats):
+        start = time.perf_counter()
+        compute_features(landmarks, 640, 480, out=out)
+        best = min(best, time.perf_counter() - start)
+    print(f"Vectorized: {args.frames} frames in {best * 1000:.1f} ms "
+          f"({args.frames / best:,.0f} frames/sec)")
+
+    # How the live scripts call it: one frame at a time
+    count = min(args.per_frame, args.frames)
+    start = time.perf_counter()
+    for i in range(count):
+        compute_features(landmarks[i], 640, 480)
+    elapsed = time.perf_counter() - start
+    print(f"Per-frame:  {count} frames in {elapsed * 1000:.1f} ms "
+          f"({count / elapsed:,.0f} frames/sec)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,486 @@
+#!/usr/bin/env python3
+"""
+Archive Re-scoring
+Recomputes posture state codes for historical posture_logs records that carry
+a landmark dump (FirebaseManager with storeLandmarks enabled), using new
+slouch / cross-legged / lean TFLite models.
+
+- Records are streamed from Firebase (or a JSON export) in key order, one page
+  at a time, with the next page prefetched while the current one is scored
+- Features are computed vectorized (posture_features.py) and each model runs
+  on whole batches in a pool of worker processes
+- Revised codes are written next to the originals in a CSV
+  (key, timestamp, state, revised_state); progress is checkpointed after
+  every batch, so an interrupted run resumes where it stopped
+
+State codes use the PostureState layout (presence bit 7, lean bits 4-5,
+legs bits 2-3, slouch bits 0-1), so revised_state can be compared with the
+"state" field directly.
+
+Usage:
+    # Re-score with the models in ../app/src/main/assets (default)
+    python rescore_archive.py --offline ../firebase_export.json
+
+    # New models, straight from Firebase, 8 workers
+    python rescore_archive.py --slouch-model posture_model.tflite \\
+        --crossleg-model crosslegged.tflite --crossleg-scaler scaler.npz \\
+        --lean-model lean_direction_model.tflite --workers 8
+
+    # Interrupted runs resume from rescored_states.csv.checkpoint.json;
+    # --restart discards the previous output
+    python rescore_archive.py --offline ../firebase_export.json --restart
+"""
+
+import argparse
+import hashlib
+import json
+import multiprocessing
+import os
+import queue
+import sys
+import threading
+import time
+from collections import Counter, deque
+from typing import Any, Dict, Iterator, List, Optional, Tuple
+
+import numpy as np
+import pandas as pd
+
+from posture_features import CROSSLEG, LEAN, NUM_LANDMARKS, SLOUCH, compute_features
+
+# firebase_data.py lives next to the benchmark scripts in Code/
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+from firebase_data import FirebaseSource, OfflineSource  # noqa: E402
+
+ASSETS_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "app", "src", "main", "assets")
+
+# PostureState layout
+PRESENCE_BIT = 0x80
+SLOUCH_GOOD, SLOUCH_SLOUCHING = 1, 2
+LEGS_NORMAL, LEGS_CROSSED = 1, 2
+LEAN_UPRIGHT, LEAN_LEFT, LEAN_RIGHT = 1, 2, 3
+# Lean model output index -> lean value (0:left, 1:right, 2:upright), as in PostureClassifier
+LEAN_CLASSES = np.array([LEAN_LEFT, LEAN_RIGHT, LEAN_UPRIGHT], dtype=np.uint8)
+
+# Legacy "posture" label maps, as in PostureState.fromLegacy
+LEGACY_SLOUCH = {"Good Posture": SLOUCH_GOOD, "no": SLOUCH_GOOD, "Slouching": SLOUCH_SLOUCHING, "yes": SLOUCH_SLOUCHING}
+LEGACY_LEGS = {"Normal": LEGS_NORMAL, "no": LEGS_NORMAL, "Cross-legged": LEGS_CROSSED, "yes": LEGS_CROSSED}
+LEGACY_LEAN = {"Upright": LEAN_UPRIGHT, "upright": LEAN_UPRIGHT, "Left": LEAN_LEFT, "left": LEAN_LEFT,
+               "Right": LEAN_RIGHT, "right": LEAN_RIGHT}
+
+# Cross-legged input normalization shipped in PostureClassifier (CROSS_LEGGED_MEAN / _STD)
+CROSSLEG_MEAN = np.array([106.287895, 110.316536, 1.6213433, 1.8441758, 0.4867459, 0.96107554], dtype=np.float32)
+CROSSLEG_STD = np.array([42.17919, 42.129074, 0.43531278, 0.78367054, 0.49980646, 0.19342752], dtype=np.float32)
+
+# VisibilityGate: landmarks each model needs at MIN_VISIBILITY, else its field stays unknown (0)
+MIN_VISIBILITY = 0.5
+SLOUCH_LANDMARKS = [11, 12, 23, 24]
+LEGS_LANDMARKS = [23, 24, 25, 26, 27, 28]
+LEAN_LANDMARKS = [11, 12, 23, 24]
+
+OUTPUT_COLUMNS = ["key", "timestamp", "state", "revised_state"]
+
+
+def encode_state(slouch, legs, lean):
+    """PostureState.encode for scalars or uint8 arrays."""
+    return PRESENCE_BIT | slouch | (legs << 2) | (lean << 4)
+
+
+def gate_fields(landmarks: np.ndarray, slouch: np.ndarray, legs: np.ndarray, lean: np.ndarray):
+    """VisibilityGate on [N, 33, 4] landmarks: zero the fields whose landmarks were not seen."""
+    visibility = landmarks[:, :, 3]
+
+    def seen(indices):
+        return np.all(visibility[:, indices] >= MIN_VISIBILITY, axis=1)
+
+    return (np.where(seen(SLOUCH_LANDMARKS), slouch, 0).astype(np.uint8),
+            np.where(seen(LEGS_LANDMARKS), legs, 0).astype(np.uint8),
+            np.where(seen(LEAN_LANDMARKS), lean, 0).astype(np.uint8))
+
+
+def original_state(record: Dict[str, Any]) -> int:
+    """PostureState.fromRecord: packed "state" field, else the legacy label map."""
+    state = record.get("state")
+    if isinstance(state, (int, float)):
+        return int(state) & 0xFF
+    posture = record.get("posture")
+    if isinstance(posture, dict):
+        return encode_state(LEGACY_SLOUCH.get(posture.get("slouch"), 0),
+                            LEGACY_LEGS.get(posture.get("legs"), 0),
+                            LEGACY_LEAN.get(posture.get("lean"), 0))
+    return 0
+
+
+def state_label(code: int) -> str:
+    if not code & PRESENCE_BIT:
+        return "Absent"
+    slouch = ["N/A", "Good Posture", "Slouching", "N/A"][code & 0x3]
+    legs = ["N/A", "Normal", "Cross-legged", "N/A"][(code >> 2) & 0x3]
+    lean = ["N/A", "Upright", "Left", "Right"][(code >> 4) & 0x3]
+    return f"{slouch} / {legs} / {lean}"
+
+
+def parse_landmarks(landmarks: Any) -> Optional[List[Tuple[float, float, float, float]]]:
+    """
+    [33][4] rows from a landmark dump: a list of {x, y, z, visibility} maps
+    (or a {"0": ..., "32": ...} map, which is how sparse arrays come back).
+    """
+    if isinstance(landmarks, dict):
+        landmarks = [landmarks.get(str(i)) for i in range(NUM_LANDMARKS)]
+    if not isinstance(landmarks, list) or len(landmarks) != NUM_LANDMARKS:
+        return None
+    try:
+        return [(lm.get("x", 0.0), lm.get("y", 0.0), lm.get("z", 0.0), lm.get("visibility", 0.0))
+                for lm in landmarks]
+    except AttributeError:  # An entry that is not a map
+        return None
+
+
+# ===== Streaming =====
+
+def iter_pages(source, node: str, start_after: Optional[str],
+               page_size: int) -> Iterator[List[Tuple[str, Any]]]:
+    """Pages of (key, record) in key order, one request per page."""
+    cursor = start_after
+    while True:
+        # startAt is inclusive, so ask for one extra and drop the cursor itself
+        page = source.query(node, start_at=cursor, first=page_size + (1 if cursor else 0))
+        page.pop(cursor, None)
+        if page:
+            yield [(key, page[key]) for key in sorted(page)]
+        if len(page) < page_size:
+            return
+        cursor = max(page)
+
+
+def prefetch(iterator: Iterator, depth: int) -> Iterator:
+    """Run an iterator on a background thread, up to `depth` items ahead."""
+    items: queue.Queue = queue.Queue(maxsize=depth)
+    done = object()
+
+    def produce():
+        try:
+            for item in iterator:
+                items.put(item)
+        except Exception as e:  # Surface fetch errors in the consumer
+            items.put(e)
+        items.put(done)
+
+    threading.Thread(target=produce, daemon=True).start()
+    while True:
+        item = items.get()
+        if item is done:
+            return
+        if isinstance(item, Exception):
+            raise item
+        yield item
+
+
+def iter_batches(records: Iterator[Tuple[str, Any]], batch_size: int,
+                 default_size: Tuple[int, int]) -> Iterator[Dict[str, Any]]:
+    """
+    Batches of up to batch_size landmark dumps, left unparsed so the workers do
+    the per-landmark work. Each batch also carries the last key it consumed
+    (records without landmarks included), which is the resume point.
+    """
+    keys, timestamps, states, dumps, widths, heights = [], [], [], [], [], []
+    skipped = 0
+    last_key = None
+
+    def make_batch():
+        return {
+            "keys": keys, "timestamps": timestamps, "states": states, "dumps": dumps,
+            "width": np.asarray(widths, dtype=np.float32),
+            "height": np.asarray(heights, dtype=np.float32),
+            "skipped": skipped, "last_key": last_key,
+        }
+
+    for key, record in records:
+        last_key = key
+        dump = record.get("landmarks") if isinstance(record, dict) else None
+        if not dump:
+            skipped += 1
+            continue
+        keys.append(key)
+        timestamps.append(record.get("timestamp") or 0)
+        states.append(original_state(record))
+        dumps.append(dump)
+        widths.append(record.get("imageWidth") or default_size[0])
+        heights.append(record.get("imageHeight") or default_size[1])
+        if len(dumps) >= batch_size:
+            yield make_batch()
+            keys, timestamps, states, dumps, widths, heights = [], [], [], [], [], []
+            skipped = 0
+
+    if dumps or skipped:
+        yield make_batch()
+
+
+# ===== Scoring (runs in worker processes) =====
+
+class BatchModel:
+    """TFLite interpreter whose input is resized to the batch being scored."""
+
+    def __init__(self, path: str):
+        try:
+            from tflite_runtime.interpreter import Interpreter
+        except ImportError:
+            import tensorflow as tf
+            Interpreter = tf.lite.Interpreter
+        # One thread per interpreter; the pool provides the parallelism
+        self.interpreter = Interpreter(model_path=path, num_threads=1)
+        self.input_index = self.interpreter.get_input_details()[0]["index"]
+        self.output_index = self.interpreter.get_output_details()[0]["index"]
+        self.batch = 0
+
+    def __call__(self, features: np.ndarray) -> np.ndarray:
+        if features.shape[0] != self.batch:
+            self.interpreter.resize_tensor_input(self.input_index, list(features.shape))
+            self.interpreter.allocate_tensors()
+            self.batch = features.shape[0]
+        self.interpreter.set_tensor(self.input_index, np.ascontiguousarray(features, dtype=np.float32))
+        self.interpreter.invoke()
+        return self.interpreter.get_tensor(self.output_index).copy()
+
+
+_models: Dict[str, Any] = {}
+
+
+def _init_worker(model_paths: Dict[str, str], crossleg_mean: np.ndarray, crossleg_std: np.ndarray):
+    _models.update({name: BatchModel(path) for name, path in model_paths.items()})
+    _models["crossleg_mean"] = crossleg_mean
+    _models["crossleg_std"] = crossleg_std
+
+
+def score_batch(dumps: List[Any], width: np.ndarray, height: np.ndarray) -> Dict[str, Any]:
+    """
+    Revised uint8 state codes for the well-formed dumps of one batch (the
+    "valid" mask), with stage timings.
+    """
+    start = time.perf_counter()
+    rows = [parse_landmarks(dump) for dump in dumps]
+    valid = np.array([r is not None for r in rows], dtype=bool)
+    landmarks = np.asarray([r for r in rows if r is not None], dtype=np.float32).reshape(-1, NUM_LANDMARKS, 4)
+    features = compute_features(landmarks, width[valid], height[valid])
+    feature_time = time.perf_counter() - start
+
+    start = time.perf_counter()
+    slouch_score = _models["slouch"](features[:, SLOUCH])[:, 0]
+    crossleg_input = (features[:, CROSSLEG] - _models["crossleg_mean"]) / _models["crossleg_std"]
+    crossleg_score = _models["crossleg"](crossleg_input)[:, 0]
+    lean_scores = _models["lean"](features[:, LEAN])
+    inference_time = time.perf_counter() - start
+
+    # Same decision rules as PostureClassifier
+    slouch = np.where(slouch_score >= 0.5, SLOUCH_GOOD, SLOUCH_SLOUCHING).astype(np.uint8)
+    legs = np.where(crossleg_score >= 0.5, LEGS_CROSSED, LEGS_NORMAL).astype(np.uint8)
+    lean = LEAN_CLASSES[np.argmax(lean_scores, axis=1)]
+    slouch, legs, lean = gate_fields(landmarks, slouch, legs, lean)
+    return {
+        "codes": encode_state(slouch, legs, lean).astype(np.uint8),
+        "valid": valid,
+        "feature_time": feature_time,
+        "inference_time": inference_time,
+    }
+
+
+# ===== Output and checkpoint =====
+
+def file_digest(path: str) -> str:
+    with open(path, "rb") as f:
+        return hashlib.sha1(f.read()).hexdigest()
+
+
+def load_checkpoint(path: str) -> Optional[Dict[str, Any]]:
+    if not os.path.exists(path):
+        return None
+    with open(path, "r") as f:
+        return json.load(f)
+
+
+def save_checkpoint(path: str, checkpoint: Dict[str, Any]):
+    # Write then rename, so the checkpoint never describes a half-written batch
+    with open(path + ".tmp", "w") as f:
+        json.dump(checkpoint, f, indent=2)
+    os.replace(path + ".tmp", path)
+
+
+def write_rows(output, keys: List[str], timestamps: List[Any], states: List[int], codes: np.ndarray):
+    frame = pd.DataFrame({
+        "key": keys,
+        "timestamp": np.asarray(timestamps, dtype=np.int64),
+        "state": np.asarray(states, dtype=np.int64),
+        "revised_state": codes.astype(np.int64),
+    }, columns=OUTPUT_COLUMNS)
+    frame.to_csv(output, header=False, index=False)
+    output.flush()
+    os.fsync(output.fileno())
+
+
+def print_summary(transitions: Counter, frames: int):
+    changed = sum(count for (old, new), count in transitions.items() if old != new)
+    print(f"\nRevised state differs for {changed}/{frames} frames "
+          f"({changed / frames:.1%})" if frames else "\nNo frames re-scored")
+    for (old, new), count in transitions.most_common(10):
+        if old != new:
+            print(f"  {count:>8}  {state_label(old)}  ->  {state_label(new)}")
+
+
+def run(args):
+    model_paths = {"slouch": args.slouch_model, "crossleg": args.crossleg_model, "lean": args.lean_model}
+    for name, path in model_paths.items():
+        if not os.path.exists(path):
+            raise SystemExit(f"{name} model not found: {path}")
+    crossleg_mean, crossleg_std = CROSSLEG_MEAN, CROSSLEG_STD
+    if args.crossleg_scaler:
+        scaler = np.load(args.crossleg_scaler)
+        crossleg_mean = scaler["mean"].astype(np.float32)
+        crossleg_std = scaler["std"].astype(np.float32)
+
+    source = OfflineSource(args.offline) if args.offline else FirebaseSource()
+    settings = {
+        "source": source.database_url,
+        "node": args.node,
+        "models": {name: file_digest(path) for name, path in model_paths.items()},
+        "crossleg_mean": crossleg_mean.tolist(),
+        "crossleg_std": crossleg_std.tolist(),
+        "default_size": [args.width, args.height],
+    }
+
+    # Resume only a run with the same source, models and settings
+    checkpoint_path = args.output + ".checkpoint.json"
+    checkpoint = None if args.restart else load_checkpoint(checkpoint_path)
+    if checkpoint and checkpoint.get("settings") != settings:
+        raise SystemExit(f"{checkpoint_path} was written with different models or settings; "
+                         f"use --restart to re-score from the beginning")
+    if checkpoint is None or not os.path.exists(args.output):
+        checkpoint = {"settings": settings, "last_key": None, "frames": 0, "skipped": 0,
+                      "bytes": 0, "transitions": []}
+        with open(args.output, "w") as f:
+            f.write(",".join(OUTPUT_COLUMNS) + "\n")
+        checkpoint["bytes"] = os.path.getsize(args.output)
+        save_checkpoint(checkpoint_path, checkpoint)
+    else:
+        print(f"Resuming after key {checkpoint['last_key']} "
+              f"({checkpoint['frames']} frames already re-scored)")
+
+    transitions = Counter({(old, new): count for old, new, count in checkpoint["transitions"]})
+    pages = prefetch(iter_pages(source, args.node, checkpoint["last_key"], args.page_size), depth=2)
+    records = (item for page in pages for item in page)
+    batches = iter_batches(records, args.batch_size, (args.width, args.height))
+
+    workers = max(1, args.workers)
+    print(f"Re-scoring '{args.node}' from {source.database_url} with {workers} worker(s), "
+          f"batches of {args.batch_size} frames")
+
+    start = time.perf_counter()
+    frames = skipped = 0
+    feature_time = inference_time = 0.0
+
+    with open(args.output, "r+") as output, \
+            multiprocessing.Pool(workers, initializer=_init_worker,
+                                 initargs=(model_paths, crossleg_mean, crossleg_std)) as pool:
+        # Drop rows written after the last checkpoint by an interrupted run
+        output.truncate(checkpoint["bytes"])
+        output.seek(checkpoint["bytes"])
+
+        pending = deque()
+
+        def finish_oldest():
+            nonlocal frames, skipped, feature_time, inference_time
+            batch, result = pending.popleft()
+            scored = result.get() if result is not None else None
+            batch_frames, batch_skipped = 0, batch["skipped"]
+            last_ts = None
+            if scored is not None:
+                valid = scored["valid"].tolist()
+                keys = [k for k, ok in zip(batch["keys"], valid) if ok]
+                timestamps = [t for t, ok in zip(batch["timestamps"], valid) if ok]
+                states = [st for st, ok in zip(batch["states"], valid) if ok]
+                write_rows(output, keys, timestamps, states, scored["codes"])
+                transitions.update(zip(states, scored["codes"].tolist()))
+                feature_time += scored["feature_time"]
+                inference_time += scored["inference_time"]
+                batch_frames = len(keys)
+                batch_skipped += len(valid) - batch_frames
+                last_ts = timestamps[-1] if timestamps else None
+            frames += batch_frames
+            skipped += batch_skipped
+
+            checkpoint.update({
+                "last_key": batch["last_key"],
+                "frames": checkpoint["frames"] + batch_frames,
+                "skipped": checkpoint["skipped"] + batch_skipped,
+                "bytes": output.tell(),
+                "transitions": [[old, new, count] for (old, new), count in transitions.items()],
+            })
+            save_checkpoint(checkpoint_path, checkpoint)
+
+            elapsed = time.perf_counter() - start
+            day = time.strftime("%Y-%m-%d", time.localtime(last_ts / 1000.0)) if last_ts else "-"
+            print(f"  {checkpoint['frames']} frames re-scored (through {day}), "
+                  f"{frames / elapsed:,.0f} frames/sec")
+
+        # Batches finish in submission order; a bounded window keeps memory flat
+        for batch in batches:
+            result = None
+            if batch["keys"]:
+                result = pool.apply_async(score_batch, (batch.pop("dumps"), batch.pop("width"),
+                                                        batch.pop("height")))
+            pending.append((batch, result))
+            if len(pending) >= 2 * workers:
+                finish_oldest()
+            if args.max_frames and checkpoint["frames"] + sum(len(b["keys"]) for b, _ in pending) \
+                    >= args.max_frames:
+                break
+        while pending:
+            finish_oldest()
+
+    elapsed = time.perf_counter() - start
+    print(f"\nRe-scored {frames} frames in {elapsed:.1f}s "
+          f"({frames / elapsed:,.0f} frames/sec across {workers} workers); "
+          f"{skipped} records without landmarks skipped")
+    if frames:
+        print(f"  Worker time: features {feature_time:.1f}s, inference {inference_time:.1f}s "
+              f"({frames / max(feature_time + inference_time, 1e-9):,.0f} frames/sec per worker)")
+    print_summary(transitions, checkpoint["frames"])
+    print(f"Revised states: {args.output}")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Re-score archived posture_logs landmarks with new posture models"
+    )
+    parser.add_argument("--offline", type=str, default=None, metavar="JSON",
+                        help="Read from a local JSON export of the database instead of Firebase")
+    parser.add_argument("--node", type=str, default="posture_logs",
+                        help="Firebase node path (default: posture_logs)")
+    parser.add_argument("--slouch-model", default=os.path.join(ASSETS_DIR, "posture_model.tflite"),
+                        help="Slouch TFLite model (default: app asset)")
+    parser.add_argument("--crossleg-model", default=os.path.join(ASSETS_DIR, "crosslegged.tflite"),
+                        help="Cross-legged TFLite model (default: app asset)")
+    parser.add_argument("--crossleg-scaler", default=None,
+                        help="scaler.npz from trainingcrossleged.py (default: the app's constants)")
+    parser.add_argument("--lean-model", default=os.path.join(ASSETS_DIR, "lean_direction_model.tflite"),
+                        help="Lean TFLite model (default: app asset)")
+    parser.add_argument("--output", default="rescored_states.csv",
+                        help="Output CSV (default: rescored_states.csv)")
+    parser.add_argument("--restart", action="store_true",
+                        help="Ignore the checkpoint and re-score from the first record")
+    parser.add_argument("--workers", type=int, default=max(1, os.cpu_count() or 1),
+                        help="Worker processes (default: CPU count)")
+    parser.add_argument("--batch-size", type=int, default=20000,
+                        help="Frames per model batch and checkpoint (default: 20000)")
+    parser.add_argument("--page-size", type=int, default=5000,
+                        help="Records per Firebase request (default: 5000)")
+    parser.add_argument("--width", type=int, default=1280,
+                        help="Frame width for records without imageWidth (default: 1280, CameraX)")
+    parser.add_argument("--height", type=int, default=720,
+                        help="Frame height for records without imageHeight (default: 720, CameraX)")
+    parser.add_argument("--max-frames", type=int, default=0,
+                        help="Stop after this many frames, e.g. for a throughput check (default: all)")
+    run(parser.parse_args())
+
+
+if __name__ == "__main__":
+    main()
@@ -3,6 +3,8 @@ import mediapipe as mp
 import numpy as np
 import tensorflow as tf
 
+from posture_features import SLOUCH, compute_features, landmarks_to_array
+
 # ===== CONFIG =====
 TFLITE_MODEL_FILE = "posture_model.tflite"
 
@@ -18,27 +20,9 @@ print("✅ TFLite model loaded successfully")
 mp_pose = mp.solutions.pose
 mp_drawing = mp.solutions.drawing_utils
 
-def angle_3pts(a, b, c):
-    a, b, c = np.array(a), np.array(b), np.array(c)
-    ba, bc = a - b, c - b
-    cosine_angle = np.dot(ba, bc) / (np.linalg.norm(ba) * np.linalg.norm(bc) + 1e-6)
-    angle = np.degrees(np.arccos(np.clip(cosine_angle, -1.0, 1.0)))
-    return round(angle, 2)
-
 def get_upper_body_angles(landmarks, w, h):
-    def to_pixel(lm):
-        return [lm.x * w, lm.y * h]
-
-    left_shoulder = to_pixel(landmarks[mp_pose.PoseLandmark.LEFT_SHOULDER.value])
-    right_shoulder = to_pixel(landmarks[mp_pose.PoseLandmark.RIGHT_SHOULDER.value])
-    left_hip = to_pixel(landmarks[mp_pose.PoseLandmark.LEFT_HIP.value])
-    right_hip = to_pixel(landmarks[mp_pose.PoseLandmark.RIGHT_HIP.value])
-
-    torso_tilt = angle_3pts(left_shoulder, left_hip, right_shoulder)
-    left_angle = angle_3pts(left_shoulder, left_hip, right_hip)
-    right_angle = angle_3pts(right_shoulder, right_hip, left_hip)
-
-    return [torso_tilt, left_angle, right_angle]
+    # torso_tilt, left_angle, right_angle
+    return compute_features(landmarks_to_array(landmarks), w, h)[0, SLOUCH].tolist()
 
 # Live webcam
 cap = cv2.VideoCapture(0)
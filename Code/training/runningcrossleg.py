@@ -16,6 +16,8 @@ import tensorflow as tf
 import time
 import os
 
+from posture_features import CROSSLEG, compute_features, landmarks_to_array
+
 TFLITE_FILE = "crosslegged.tflite"
 SCALER_FILE = "scaler.npz"
 THRESHOLD = 0.5  # classification threshold
@@ -39,44 +41,9 @@ interpreter.allocate_tensors()
 input_details = interpreter.get_input_details()
 output_details = interpreter.get_output_details()
 
-# Helper functions (must match training feature extraction)
-def angle_3pts(a, b, c):
-    a, b, c = np.array(a), np.array(b), np.array(c)
-    ba, bc = a - b, c - b
-    cosine = np.dot(ba, bc) / (np.linalg.norm(ba) * np.linalg.norm(bc) + 1e-6)
-    return float(np.degrees(np.arccos(np.clip(cosine, -1.0, 1.0))))
-
-def to_pixel(lm, w, h):
-    return np.array([lm.x * w, lm.y * h], dtype=np.float32)
-
+# Same feature code as training and the Android app
 def extract_features(landmarks, w, h):
-    # Must match exactly the get_features used for training
-    left_hip = to_pixel(landmarks[mp_pose.PoseLandmark.LEFT_HIP.value], w, h)
-    right_hip = to_pixel(landmarks[mp_pose.PoseLandmark.RIGHT_HIP.value], w, h)
-    left_knee = to_pixel(landmarks[mp_pose.PoseLandmark.LEFT_KNEE.value], w, h)
-    right_knee = to_pixel(landmarks[mp_pose.PoseLandmark.RIGHT_KNEE.value], w, h)
-    left_ankle = to_pixel(landmarks[mp_pose.PoseLandmark.LEFT_ANKLE.value], w, h)
-    right_ankle = to_pixel(landmarks[mp_pose.PoseLandmark.RIGHT_ANKLE.value], w, h)
-
-    left_leg_angle = angle_3pts(left_hip, left_knee, left_ankle)
-    right_leg_angle = angle_3pts(right_hip, right_knee, right_ankle)
-
-    knee_dist = np.linalg.norm(left_knee - right_knee)
-    ankle_dist = np.linalg.norm(left_ankle - right_ankle)
-    hip_dist = np.linalg.norm(left_hip - right_hip) + 1e-6
-
-    knee_dist /= hip_dist
-    ankle_dist /= hip_dist
-
-    ankle_cross = 1.0 if left_ankle[0] > right_ankle[0] else 0.0
-    knee_cross = 1.0 if left_knee[0] > right_knee[0] else 0.0
-
-    feat = np.array([
-        left_leg_angle, right_leg_angle,
-        knee_dist, ankle_dist,
-        ankle_cross, knee_cross
-    ], dtype=np.float32)
-    return feat
+    return compute_features(landmarks_to_array(landmarks), w, h)[0, CROSSLEG]
 
 # Run webcam & inference
 cap = cv2.VideoCapture(0)
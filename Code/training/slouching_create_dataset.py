@@ -4,6 +4,8 @@ import numpy as np
 import pandas as pd
 import os
 
+from posture_features import SLOUCH, as_csv_row, compute_features, landmarks_to_array
+
 # ===== CONFIG =====
 POSTURE_NAME = input("Enter posture (0=slouching, 1=straight): ")
 CSV_FILE = "pose_dataset.csv"
@@ -15,31 +17,9 @@ os.makedirs("frames", exist_ok=True)
 mp_pose = mp.solutions.pose
 mp_drawing = mp.solutions.drawing_utils
 
-# --- Angle calculation ---
-def angle_3pts(a, b, c):
-    a, b, c = np.array(a), np.array(b), np.array(c)
-    ba, bc = a - b, c - b
-    cosine_angle = np.dot(ba, bc) / (np.linalg.norm(ba) * np.linalg.norm(bc) + 1e-6)
-    angle = np.degrees(np.arccos(np.clip(cosine_angle, -1.0, 1.0)))
-    return round(angle, 2)
-
 def get_upper_body_angles(landmarks, w, h):
-    def to_pixel(lm):
-        return [lm.x * w, lm.y * h]
-
-    left_shoulder = to_pixel(landmarks[mp_pose.PoseLandmark.LEFT_SHOULDER.value])
-    right_shoulder = to_pixel(landmarks[mp_pose.PoseLandmark.RIGHT_SHOULDER.value])
-    left_hip = to_pixel(landmarks[mp_pose.PoseLandmark.LEFT_HIP.value])
-    right_hip = to_pixel(landmarks[mp_pose.PoseLandmark.RIGHT_HIP.value])
-
-    # 1. Torso tilt (torsion) angle
-    torso_tilt = angle_3pts(left_shoulder, left_hip, right_shoulder)
-    # 2. Left shoulder-hip-right hip angle
-    left_angle = angle_3pts(left_shoulder, left_hip, right_hip)
-    # 3. Right shoulder-hip-left hip angle
-    right_angle = angle_3pts(right_shoulder, right_hip, left_hip)
-
-    return [torso_tilt, left_angle, right_angle]
+    # torso_tilt, left_angle, right_angle
+    return as_csv_row(compute_features(landmarks_to_array(landmarks), w, h)[0, SLOUCH])
 
 # --- Load or create CSV ---
 if os.path.exists(CSV_FILE) and os.path.getsize(CSV_FILE) > 0:
@@ -0,0 +1,65 @@
+"""
+Tests for the One-Euro reference and replay helpers in filter_agreement.py.
+
+Usage:
+    python -m unittest test_filter_agreement
+"""
+
+import unittest
+
+import numpy as np
+
+from filter_agreement import admitted_frames, held, one_euro
+
+MIN_CUTOFF = np.array([1.0, 1.0, 1.0, 1.0], dtype=np.float32)
+BETA = np.array([5.0, 5.0, 5.0, 0.0], dtype=np.float32)
+
+
+def still_trace(frames: int, noise: float, seed: int = 0) -> np.ndarray:
+    rng = np.random.default_rng(seed)
+    base = np.full((frames, 33, 4), 0.5, dtype=np.float32)
+    return base + rng.normal(0, noise, base.shape).astype(np.float32)
+
+
+class OneEuroTest(unittest.TestCase):
+
+    def test_first_frame_passes_through(self):
+        trace = still_trace(5, 0.01)
+        out = one_euro(trace, np.arange(5) / 30.0, MIN_CUTOFF, BETA)
+        np.testing.assert_array_equal(out[0], trace[0])
+
+    def test_reduces_jitter_on_still_pose(self):
+        trace = still_trace(300, 0.01)
+        out = one_euro(trace, np.arange(300) / 30.0, MIN_CUTOFF, BETA)
+        self.assertLess(np.std(out[30:] - 0.5), 0.5 * np.std(trace[30:] - 0.5))
+
+    def test_tracks_fast_step(self):
+        trace = np.zeros((60, 33, 4), dtype=np.float32)
+        trace[30:, :, 0] = 0.5  # Half a frame width in one step
+        out = one_euro(trace, np.arange(60) / 30.0, MIN_CUTOFF, BETA)
+        # Speed opens the cutoff: within 0.2 s most of the step is followed
+        self.assertGreater(out[36, 0, 0], 0.4)
+
+    def test_gap_restarts_filter(self):
+        trace = still_trace(10, 0.0)
+        trace[5:] += 0.3
+        times = np.arange(10) / 30.0
+        times[5:] += 2.0
+        out = one_euro(trace, times, MIN_CUTOFF, BETA)
+        np.testing.assert_array_equal(out[5], trace[5])
+
+
+class ReplayTest(unittest.TestCase):
+
+    def test_admits_frames_at_rate(self):
+        times = np.arange(30) / 30.0
+        self.assertEqual(len(admitted_frames(times, 30.0)), 30)
+        np.testing.assert_array_equal(admitted_frames(times, 10.0), np.arange(0, 30, 3))
+
+    def test_held_decisions(self):
+        kept = np.array([0, 3])
+        np.testing.assert_array_equal(held(np.array([1, 2]), kept, 5), [1, 1, 1, 2, 2])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,57 @@
+"""
+Golden-file test for posture_features.py.
+
+The expected values in app/src/test/resources/feature_golden.csv are the
+ones FeatureExtractorGoldenTest checks FeatureExtractor.java against, so a
+pass here means training and the Android app compute the same features.
+
+Usage:
+    python -m unittest test_posture_features
+"""
+
+import os
+import unittest
+
+import numpy as np
+
+from posture_features import (CROSSLEG, FEATURE_NAMES, LEAN, NUM_LANDMARKS, SLOUCH,
+                              compute_features)
+
+GOLDEN_FILE = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                           "..", "app", "src", "test", "resources", "feature_golden.csv")
+TOLERANCE = 1e-4
+
+
+def load_golden():
+    rows = np.loadtxt(GOLDEN_FILE, delimiter=",", comments="#", dtype=np.float64, ndmin=2)
+    sizes = rows[:, :2]
+    landmarks = rows[:, 2:2 + NUM_LANDMARKS * 4].astype(np.float32).reshape(-1, NUM_LANDMARKS, 4)
+    expected = rows[:, 2 + NUM_LANDMARKS * 4:]
+    return sizes, landmarks, expected
+
+
+class PostureFeaturesGoldenTest(unittest.TestCase):
+    def setUp(self):
+        self.sizes, self.landmarks, self.expected = load_golden()
+
+    def test_golden_shape(self):
+        self.assertEqual(self.expected.shape[1], len(FEATURE_NAMES))
+
+    def test_batch_matches_golden(self):
+        features = compute_features(self.landmarks, self.sizes[:, 0], self.sizes[:, 1])
+        self.assertEqual(features.dtype, np.float32)
+        np.testing.assert_allclose(features, self.expected, rtol=0, atol=TOLERANCE)
+
+    def test_single_frame_matches_batch(self):
+        batch = compute_features(self.landmarks, self.sizes[:, 0], self.sizes[:, 1])
+        for i in range(len(self.landmarks)):
+            single = compute_features(self.landmarks[i], self.sizes[i, 0], self.sizes[i, 1])
+            np.testing.assert_array_equal(single[0], batch[i])
+
+    def test_slices_cover_all_features(self):
+        covered = list(range(18))[SLOUCH] + list(range(18))[CROSSLEG] + list(range(18))[LEAN]
+        self.assertEqual(covered, list(range(len(FEATURE_NAMES))))
+
+
+if __name__ == "__main__":
+    unittest.main()